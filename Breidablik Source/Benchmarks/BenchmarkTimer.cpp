@@ -0,0 +1,16 @@
+#include "BenchmarkTimer.h"
+#include <stddef.h>
+#include <sys/time.h>
+
+
+/*
+========================
+GetTime
+Milliseconds since epoch
+========================
+*/
+double GetTime( void ) {
+	timeval time;
+	gettimeofday( &time, NULL );
+	return ( time.tv_sec * 1000.0 ) + ( time.tv_usec / 1000.0 );
+}
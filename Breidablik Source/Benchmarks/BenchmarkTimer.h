@@ -0,0 +1,18 @@
+#ifndef _BENCHMARKTIMER_H_
+#define _BENCHMARKTIMER_H_
+
+
+/*
+==========================================================
+BenchmarkTimer
+Wall clock shared by the console benchmarks in Benchmarks/
+- built with each of them, never with the game
+==========================================================
+*/
+
+
+/* Milliseconds since epoch */
+double GetTime( void );
+
+
+#endif
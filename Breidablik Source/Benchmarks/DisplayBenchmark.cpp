@@ -0,0 +1,211 @@
+#include "GameObject.h"
+#include "DisplayList.h"
+#include "BenchmarkTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <queue>
+#include <vector>
+
+
+/* Benchmark Data */
+static const int BENCHMARK_COUNTS = 2;
+static const int BENCHMARK_SPRITE_COUNTS[ BENCHMARK_COUNTS ] = { 1000, 10000 };
+static const int BENCHMARK_ROWS = 512;           // rows of the level - depth is row + 36 as Character::UpdateDepth
+static const int BENCHMARK_FRAMES = 500;
+static const int BENCHMARK_MOVING_PERCENT = 2;   // sprites changing row each frame
+static const int BENCHMARK_SEED = 1234;
+
+
+/*
+======================================================================
+DisplayBenchmark
+Console timing of ordering a frame of sprites by depth - pushing every
+sprite into a priority_queue and popping them as MyPS2Application used
+to, against re-sorting a DisplayList kept from the frame before
+Sprites spread over the rows of a level, a few changing row each frame
+as characters walk - every frame both draw the same depths in the same
+order, checked as they are drawn
+Also the cost of a DisplayList filled in any order, as when the game
+lists everything again
+Build with "make displaybench"
+======================================================================
+*/
+
+
+/* Depths in the order the last frame drew them */
+static vector< float > drawnDepths;
+
+
+/*
+=================================================================
+BenchmarkSprite
+Stands in for the game's sprites - drawing just records its depth
+=================================================================
+*/
+class BenchmarkSprite : public GameObject {
+public:
+	BenchmarkSprite::BenchmarkSprite( float z );
+	
+	void Update( void );
+	void Render( void );
+	void SetDepth( float z );
+};
+
+
+/*
+=================
+Constructor
+Sprite at depth z
+=================
+*/
+BenchmarkSprite::BenchmarkSprite( float z ) :
+ GameObject( 0.0f, 0.0f, z ) {
+}
+
+
+/*
+=================
+Update
+Nothing to update
+=================
+*/
+void BenchmarkSprite::Update( void ) {
+}
+
+
+/*
+=======================
+Render
+Records the depth drawn
+=======================
+*/
+void BenchmarkSprite::Render( void ) {
+	drawnDepths.push_back( mZ );
+}
+
+
+/*
+===========================
+SetDepth
+Moves the sprite to depth z
+===========================
+*/
+void BenchmarkSprite::SetDepth( float z ) {
+	mZ = z;
+}
+
+
+/*
+=======================================================================
+Comparator
+The depth order MyPS2Application's priority_queue used - smallest first
+=======================================================================
+*/
+struct Comparator {
+	bool operator () ( GameObject* G1, GameObject* G2 ) {
+		return G1 -> GetmZ() > G2 -> GetmZ();
+	}
+};
+
+
+/*
+=============================================
+MoveSprites
+A few sprites step a row up or down the level
+=============================================
+*/
+static void MoveSprites( vector< BenchmarkSprite* > &sprites, vector< int > &rows ) {
+	int moving = ( int( sprites.size() ) * BENCHMARK_MOVING_PERCENT ) / 100;
+	for( int i = 0; i < moving; i++ ) {
+		int sprite = rand() % int( sprites.size() );
+		int row = rows[ sprite ] + ( ( rand() % 2 == 0 ) ? -1 : 1 );
+		if( ( row >= 0 ) && ( row < BENCHMARK_ROWS ) ) {
+			rows[ sprite ] = row;
+			sprites[ sprite ] -> SetDepth( float( row + 36 ) );
+		}
+	}
+}
+
+
+/*
+=====================================
+main
+Each sprite count both ways, frame by
+frame - then the times side by side
+=====================================
+*/
+int main( void ) {
+	printf( "%-10s %14s %14s %14s %12s %12s\n", "Sprites", "Queue ms", "List ms", "Refill ms", "Shifts", "Mismatches" );
+	for( int count = 0; count < BENCHMARK_COUNTS; count++ ) {
+		srand( BENCHMARK_SEED );
+		vector< BenchmarkSprite* > sprites;
+		vector< int > rows;
+		for( int i = 0; i < BENCHMARK_SPRITE_COUNTS[ count ]; i++ ) {
+			rows.push_back( rand() % BENCHMARK_ROWS );
+			sprites.push_back( new BenchmarkSprite( float( rows.back() + 36 ) ) );
+		}
+		
+		DisplayList displayList;
+		for( int i = 0; i < ( int )sprites.size(); i++ ) {
+			displayList.Add( sprites[ i ] );
+		}
+		displayList.Sort();
+		
+		priority_queue< GameObject*, vector< GameObject* >, Comparator > displayVector;
+		vector< float > queueDepths;
+		double queueTime = 0.0, listTime = 0.0;
+		long shifts = 0;
+		int mismatches = 0;
+		for( int frame = 0; frame < BENCHMARK_FRAMES; frame++ ) {
+			MoveSprites( sprites, rows );
+			
+			/* Every sprite pushed, then popped and drawn */
+			drawnDepths.clear();
+			double startTime = GetTime();
+			for( int i = 0; i < ( int )sprites.size(); i++ ) {
+				displayVector.push( sprites[ i ] );
+			}
+			while( !displayVector.empty() ) {
+				displayVector.top() -> Render();
+				displayVector.pop();
+			}
+			queueTime += GetTime() - startTime;
+			queueDepths.swap( drawnDepths );
+			
+			/* Last frame's order re-sorted, then drawn */
+			drawnDepths.clear();
+			startTime = GetTime();
+			displayList.Sort();
+			displayList.Render();
+			listTime += GetTime() - startTime;
+			shifts += displayList.GetLastShifts();
+			
+			if( drawnDepths != queueDepths ) {
+				mismatches++;
+			}
+		}
+		
+		/* Listed again in any order */
+		double refillTime = 0.0;
+		for( int frame = 0; frame < BENCHMARK_FRAMES; frame++ ) {
+			drawnDepths.clear();
+			double startTime = GetTime();
+			displayList.Clear();
+			for( int i = 0; i < ( int )sprites.size(); i++ ) {
+				displayList.Add( sprites[ i ] );
+			}
+			displayList.Sort();
+			displayList.Render();
+			refillTime += GetTime() - startTime;
+		}
+		
+		printf( "%-10d %14.4f %14.4f %14.4f %12ld %12d\n", BENCHMARK_SPRITE_COUNTS[ count ], queueTime / BENCHMARK_FRAMES,
+		        listTime / BENCHMARK_FRAMES, refillTime / BENCHMARK_FRAMES, shifts / BENCHMARK_FRAMES, mismatches );
+		
+		for( int i = 0; i < ( int )sprites.size(); i++ ) {
+			delete sprites[ i ];
+		}
+	}
+	
+	return 0;
+}
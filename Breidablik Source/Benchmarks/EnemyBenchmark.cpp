@@ -0,0 +1,229 @@
+#include "Enemy.h"
+#include "EnemyStore.h"
+#include "PathController.h"
+#include "ScreenViewController.h"
+#include "LevelData.h"
+#include "XYCoords.h"
+#include "BenchmarkTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* Benchmark Data */
+static const int BENCHMARK_WORLD_WIDTH = 128;
+static const int BENCHMARK_WORLD_HEIGHT = 512;
+static const int BENCHMARK_BLOCKED_PERCENT = 10;
+static const int BENCHMARK_COUNTS = 3;
+static const int BENCHMARK_ENEMY_COUNTS[ BENCHMARK_COUNTS ] = { 100, 1000, 10000 };
+static const int BENCHMARK_FRAMES = 300;   // an AITimer is at most 300 - every enemy patrols once
+static const int BENCHMARK_MAP_SEED = 1234;
+static const int BENCHMARK_ENEMY_SEED = 4321;
+
+
+/*
+======================================================================
+EnemyBenchmark
+Console timing of a frame of enemies - Enemy objects each running
+Update, against the same enemies in an EnemyStore running its passes
+Both start on the same random map with the same enemies in the same
+places and the same rand() sequence, the player in the middle, and run
+the game's frame around them - flow field, CheckAggro on every enemy,
+the enemy update, then PATHFINDER's queued searches. Only the enemy
+part is timed
+Enemies that end up chasing the player or off their first node are
+counted for each, as a check both did the same work - rand() is only
+called by Patrol, in enemy order both ways, so they should match
+The Enemy objects are allocated one after another on a fresh heap, so
+this is their best case - a game that has been creating and deleting
+objects for a while scatters them further
+Build with "make enemybench"
+======================================================================
+*/
+
+
+/*
+================================================
+GenerateMap
+Random blocked nodes into PATHFINDER - the same
+map every call
+================================================
+*/
+static void GenerateMap( void ) {
+	srand( BENCHMARK_MAP_SEED );
+	vector< vector< int > > arrayVector;
+	for( int y = 0; y < BENCHMARK_WORLD_HEIGHT; y++ ) {
+		vector< int > tempRow;
+		for( int x = 0; x < BENCHMARK_WORLD_WIDTH; x++ ) {
+			tempRow.push_back( ( rand() % 100 < BENCHMARK_BLOCKED_PERCENT ) ? 1 : 0 );
+		}
+		arrayVector.push_back( tempRow );
+	}
+	
+	PATHFINDER->Init( BENCHMARK_WORLD_WIDTH, BENCHMARK_WORLD_HEIGHT );
+	PATHFINDER->LoadPathfindingArray( arrayVector );
+}
+
+
+/*
+=============================================================
+PlaceEnemies
+Random pixel positions whose nodes are free - one enemy to a
+node, and none on the player
+=============================================================
+*/
+static void PlaceEnemies( int enemyCount, XYCoords player, vector< float > &enemyX, vector< float > &enemyY ) {
+	vector< char > taken( BENCHMARK_WORLD_WIDTH * BENCHMARK_WORLD_HEIGHT, 0 );
+	taken[ ( player.mY * BENCHMARK_WORLD_WIDTH ) + player.mX ] = 1;
+	
+	enemyX.clear();
+	enemyY.clear();
+	while( ( int )enemyX.size() < enemyCount ) {
+		float x = float( rand() % ( BENCHMARK_WORLD_WIDTH * 64 ) );
+		float y = float( rand() % ( BENCHMARK_WORLD_HEIGHT * 16 ) );
+		XYCoords node = SCREENVIEW->GetArrayXYCoords( x, y, false );
+		int nodeIndex = ( node.mY * BENCHMARK_WORLD_WIDTH ) + node.mX;
+		if( ( !taken[ nodeIndex ] ) && ( PATHFINDER->IsNodeFree( node ) ) ) {
+			taken[ nodeIndex ] = 1;
+			enemyX.push_back( x );
+			enemyY.push_back( y );
+		}
+	}
+}
+
+
+/*
+==================================================
+StartFrame
+The flow field as MyPS2Application::UpdateEnemies
+==================================================
+*/
+static void StartFrame( XYCoords player ) {
+	if( PATHFINDER->AnyEnemyWithin( player, float( FLOW_FIELD_RADIUS ) ) ) {
+		PATHFINDER->UpdateFlowField( player );
+	}
+}
+
+
+/*
+=======================================================
+BenchmarkObjects
+A frame of Enemy objects - returns milliseconds a frame
+=======================================================
+*/
+static double BenchmarkObjects( const vector< float > &enemyX, const vector< float > &enemyY, XYCoords player, int &chasing, int &moved ) {
+	GenerateMap();
+	PATHFINDER->SetObjectNode( player, Node::PLAYER );
+	srand( BENCHMARK_ENEMY_SEED );
+	
+	vector< Enemy* > enemies;
+	vector< XYCoords > starts;
+	for( int i = 0; i < ( int )enemyX.size(); i++ ) {
+		enemies.push_back( new Enemy( enemyX[ i ], enemyY[ i ], 1000.0f ) );
+		starts.push_back( enemies.back()->GetArrayXYCoords() );
+	}
+	
+	double enemyTime = 0.0;
+	for( int frame = 0; frame < BENCHMARK_FRAMES; frame++ ) {
+		StartFrame( player );
+		
+		double startTime = GetTime();
+		for( int i = 0; i < ( int )enemies.size(); i++ ) {
+			enemies[ i ]->CheckAggro( player );
+		}
+		for( int i = 0; i < ( int )enemies.size(); i++ ) {
+			enemies[ i ]->Update();
+		}
+		enemyTime += GetTime() - startTime;
+		
+		PATHFINDER->ProcessPathRequests();
+	}
+	
+	chasing = moved = 0;
+	for( int i = 0; i < ( int )enemies.size(); i++ ) {
+		if( enemies[ i ]->GetTargetXYCoords() == player ) {
+			chasing++;
+		}
+		if( enemies[ i ]->GetArrayXYCoords() != starts[ i ] ) {
+			moved++;
+		}
+		delete enemies[ i ];
+	}
+	return enemyTime / BENCHMARK_FRAMES;
+}
+
+
+/*
+========================================================
+BenchmarkStore
+A frame of an EnemyStore - returns milliseconds a frame
+========================================================
+*/
+static double BenchmarkStore( const vector< float > &enemyX, const vector< float > &enemyY, XYCoords player, int &chasing, int &moved ) {
+	GenerateMap();
+	PATHFINDER->SetObjectNode( player, Node::PLAYER );
+	srand( BENCHMARK_ENEMY_SEED );
+	
+	EnemyStore enemyStore;
+	vector< XYCoords > starts;
+	for( int i = 0; i < ( int )enemyX.size(); i++ ) {
+		int index = enemyStore.Add( enemyX[ i ], enemyY[ i ], 1000.0f );
+		starts.push_back( enemyStore.GetArrayXYCoords( index ) );
+	}
+	
+	double enemyTime = 0.0;
+	for( int frame = 0; frame < BENCHMARK_FRAMES; frame++ ) {
+		StartFrame( player );
+		
+		double startTime = GetTime();
+		enemyStore.CheckAggro( player );
+		enemyStore.Update();
+		enemyTime += GetTime() - startTime;
+		
+		PATHFINDER->ProcessPathRequests();
+	}
+	
+	chasing = moved = 0;
+	for( int i = 0; i < enemyStore.GetCount(); i++ ) {
+		if( enemyStore.GetTargetXYCoords( i ) == player ) {
+			chasing++;
+		}
+		if( enemyStore.GetArrayXYCoords( i ) != starts[ i ] ) {
+			moved++;
+		}
+	}
+	return enemyTime / BENCHMARK_FRAMES;
+}
+
+
+/*
+========================================
+main
+Each enemy count on the same map, both
+ways - then the frame times side by side
+========================================
+*/
+int main( void ) {
+	SCREENVIEW->Init( BENCHMARK_WORLD_WIDTH, BENCHMARK_WORLD_HEIGHT, 0, 0 );
+	
+	printf( "%-10s %12s %12s %8s %16s %16s\n", "Enemies", "Objects ms", "Store ms", "Speedup", "Chasing (O/S)", "Moved (O/S)" );
+	for( int count = 0; count < BENCHMARK_COUNTS; count++ ) {
+		/* Player in the middle, on a free node */
+		GenerateMap();
+		XYCoords player( BENCHMARK_WORLD_WIDTH / 2, BENCHMARK_WORLD_HEIGHT / 2 );
+		while( !PATHFINDER->IsNodeFree( player ) ) {
+			player.mX++;
+		}
+		
+		vector< float > enemyX, enemyY;
+		PlaceEnemies( BENCHMARK_ENEMY_COUNTS[ count ], player, enemyX, enemyY );
+		
+		int objectChasing, objectMoved, storeChasing, storeMoved;
+		double objectTime = BenchmarkObjects( enemyX, enemyY, player, objectChasing, objectMoved );
+		double storeTime = BenchmarkStore( enemyX, enemyY, player, storeChasing, storeMoved );
+		
+		printf( "%-10d %12.3f %12.3f %7.2fx %7d/%-8d %7d/%-8d\n", BENCHMARK_ENEMY_COUNTS[ count ], objectTime, storeTime,
+		        ( storeTime > 0.0 ) ? objectTime / storeTime : 0.0, objectChasing, storeChasing, objectMoved, storeMoved );
+	}
+	
+	return 0;
+}
@@ -0,0 +1,569 @@
+#include "EnemyStore.h"
+#include "GameTextureController.h"
+#include "ScreenViewController.h"
+#include "PathController.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/* Enemy Data - the same for every enemy, as Enemy::Enemy sets them */
+static const int ENEMY_SPRITE_SHEET = 51;
+static const int ENEMY_WEAPON_DAMAGE = 6;
+static const int ENEMY_ANIM_COUNT_MAX = 5;
+static const int ENEMY_FRAME_SIZE = 128; // mW and mH
+
+
+/* Per CharacterDirection - the speeds SetSpeedAndSpriteVariables sets */
+static const float ENEMY_SPEED_X[ 8 ] = { 0.0f, 2.0f, 4.0f, 2.0f, 0.0f, -2.0f, -4.0f, -2.0f };
+static const float ENEMY_SPEED_Y[ 8 ] = { -2.0f, -1.0f, 0.0f, 1.0f, 2.0f, 1.0f, 0.0f, -1.0f };
+
+
+/*
+================================================
+Constructor
+Creates the sprites every enemy is drawn with -
+sized and coloured as Character / Enemy set them
+================================================
+*/
+EnemyStore::EnemyStore() {
+	pEnemyHealthBar = new PS2TexQuad( 0.0f, 0.0f, 0.0f, 50.0f, 8.0f, 0, 160, 64, 8 );
+	pEnemySprite = new PS2TexQuad( 0.0f, 0.0f, 0.0f, 128.0f, 128.0f, 0, 0, ENEMY_FRAME_SIZE, ENEMY_FRAME_SIZE );
+	pEnemyShadow = new PS2Polygon( 0.0f, 0.0f, 0.0f, 16.0f, 20 );
+	pEnemyShadow -> SetColour( 0, 40, 0, 0 ); // dark green shadow
+	pEnemyShadow -> ScaleY( 0.5f );           // make it an oval
+	pEnemyShadow -> Scale( 1.2f );            // enemies are slightly bigger
+}
+
+
+/*
+===============================
+Destructor
+Tidies up new and pointer usage
+===============================
+*/
+EnemyStore::~EnemyStore() {
+	Clear();
+	if( pEnemyHealthBar ) {
+		delete pEnemyHealthBar;
+		pEnemyHealthBar = NULL;
+	}
+	if( pEnemySprite ) {
+		delete pEnemySprite;
+		pEnemySprite = NULL;
+	}
+	if( pEnemyShadow ) {
+		delete pEnemyShadow;
+		pEnemyShadow = NULL;
+	}
+}
+
+
+/*
+===================================================================
+Add
+Sets up an enemy's components as Character::Character, Enemy::Enemy
+and Enemy::RandomStart would - z is replaced by its depth straight
+away, as it is there
+===================================================================
+*/
+int EnemyStore::Add( float x, float y, float z ) {
+	TransformComponent newTransform;
+	newTransform.mX = x;
+	newTransform.mY = y - 32.0f;
+	newTransform.mHorizontalSpeed = 0.0f;
+	newTransform.mVerticalSpeed = 0.0f;
+	newTransform.mMoved = false;
+	newTransform.mArrayCoords = SCREENVIEW -> GetArrayXYCoords( x, y, false );
+	newTransform.mZ = float( newTransform.mArrayCoords.mY + 36 );
+	
+	AnimationComponent newAnimation;
+	newAnimation.mState = Character::IDLE;
+	newAnimation.mNextState = Character::IDLE;
+	newAnimation.mSpriteSheetIndex = ENEMY_SPRITE_SHEET;
+	newAnimation.mU = 0;
+	newAnimation.mV = 0;
+	newAnimation.mAnimCounter = 0;
+	
+	AIComponent newAI;
+	newAI.mAIState = Enemy::PATROLLING;
+	newAI.mActionCounter = 0;
+	newAI.mNextCoords = newTransform.mArrayCoords;
+	newAI.mTargetCoords = newTransform.mArrayCoords;
+	newAI.mIsPathfinding = false;
+	newAI.mIsActive = false;
+	newAI.mIsDealingDamage = false;
+	
+	HealthComponent newHealth;
+	newHealth.mHealth = 100;
+	newHealth.mHealthWidth = 50.0f;
+	newHealth.mIsAlive = true;
+	
+	PATHFINDER -> SetObjectNode( newTransform.mArrayCoords, Node::ENEMY );
+	
+	/* Random AITimer and starting direction */
+	newAI.mPatrol.Start( newTransform.mArrayCoords );
+	newAnimation.mDirection = Character::CharacterDirection( rand() % 8 );
+	newAnimation.mNextDirection = newAnimation.mDirection;
+	
+	mTransforms.push_back( newTransform );
+	mAnimations.push_back( newAnimation );
+	mAIs.push_back( newAI );
+	mHealths.push_back( newHealth );
+	mPaths.push_back( PathFollower() );
+	return int( mTransforms.size() ) - 1;
+}
+
+
+/*
+==============================================
+Clear
+Removes every enemy - cancelling queued routes
+as Character::~Character does
+==============================================
+*/
+void EnemyStore::Clear( void ) {
+	for( int i = 0; i < int( mPaths.size() ); i++ ) {
+		mPaths[ i ].CancelRequest();
+	}
+	
+	mTransforms.clear();
+	mAnimations.clear();
+	mAIs.clear();
+	mHealths.clear();
+	mPaths.clear();
+}
+
+
+/*
+=================
+GetCount
+Number of enemies
+=================
+*/
+int EnemyStore::GetCount( void ) const {
+	return int( mTransforms.size() );
+}
+
+
+/*
+=======================================
+Update
+Runs each pass over every enemy in turn
+=======================================
+*/
+void EnemyStore::Update( void ) {
+	UpdateHealth();     // check if still alive, healthbar width and z depth
+	UpdatePatrol();     // random movement
+	UpdateTransforms(); // position within pathfinding array, speed and sprite
+	UpdatePathing();    // finds nextNode, sets direction and updates PATHFINDER
+	UpdateActions();    // change states, move and lockout further actions
+}
+
+
+/*
+========================================================
+CheckAggro
+Every enemy the player is too close to closes in on it -
+Enemy::CheckAggro on each in turn
+========================================================
+*/
+void EnemyStore::CheckAggro( XYCoords playerCoords ) {
+	for( int i = 0; i < int( mTransforms.size() ); i++ ) {
+		if( PATHFINDER -> IsObjectWithin( mTransforms[ i ].mArrayCoords, playerCoords, ENEMY_AGGRO_DISTANCE ) ) {
+			mAIs[ i ].mAIState = Enemy::AGGROED;
+			mAIs[ i ].mTargetCoords = playerCoords;
+		}
+	}
+}
+
+
+/*
+====================================================
+Animate
+Steps each living enemy's frame - Character::Animate
+====================================================
+*/
+void EnemyStore::Animate( void ) {
+	for( int i = 0; i < int( mAnimations.size() ); i++ ) {
+		if( !mHealths[ i ].mIsAlive ) {
+			continue;
+		}
+		
+		AnimationComponent &animation = mAnimations[ i ];
+		
+		/* Animation Speed */
+		if( ( animation.mAnimCounter++ ) % ENEMY_ANIM_COUNT_MAX == 0 ) {
+			animation.mU += ENEMY_FRAME_SIZE;
+			/* 1st and 2nd frame (top row) */
+			if( ( animation.mU > ENEMY_FRAME_SIZE ) && ( animation.mV == 0 ) ) {
+				animation.mU = 0;
+				animation.mV = ENEMY_FRAME_SIZE;
+			}
+			
+			/* 3rd and 4th frame (bottom row) */
+			if( ( animation.mU > ENEMY_FRAME_SIZE ) && ( animation.mV == ENEMY_FRAME_SIZE ) ) {
+				animation.mU = 0;
+				animation.mV = 0;
+			}
+		}
+		
+		/* Counter reset */
+		if( animation.mAnimCounter > 8000 ) {
+			animation.mAnimCounter = 0;
+		}
+	}
+}
+
+
+/*
+==================================================
+Render
+Moves the shared sprites onto an enemy and renders
+them - shadow and healthbar stop once it has died
+==================================================
+*/
+void EnemyStore::Render( int index ) {
+	const TransformComponent &transform = mTransforms[ index ];
+	const AnimationComponent &animation = mAnimations[ index ];
+	const HealthComponent &health = mHealths[ index ];
+	float screenX = transform.mX + SCREENVIEW -> GetX();
+	float screenY = transform.mY + SCREENVIEW -> GetY();
+	
+	/* If alive render shadow */
+	if( ( pEnemyShadow ) && ( health.mIsAlive ) ) {
+		pEnemyShadow -> MoveTo( screenX, screenY + 32.0f, transform.mZ - 1.0f );
+		pEnemyShadow -> Render();
+	}
+	
+	/* Render Enemy Sprite */
+	if( pEnemySprite ) {
+		GAMETEXTURES -> SelectTexture( animation.mSpriteSheetIndex );
+		pEnemySprite -> SetUVCoords( animation.mU, animation.mV );
+		pEnemySprite -> MoveTo( screenX, screenY, transform.mZ );
+		pEnemySprite -> Render();
+	}
+	
+	/* If alive render health bar */
+	if( ( pEnemyHealthBar ) && ( health.mIsAlive ) ) {
+		GAMETEXTURES -> SelectTexture( 91 );
+		pEnemyHealthBar -> MoveTo( screenX, screenY - 36.0f, transform.mZ );
+		pEnemyHealthBar -> SetWidthAndHeight( health.mHealthWidth, 8.0f );
+		pEnemyHealthBar -> Render();
+	}
+}
+
+
+/*
+==========================
+GetZ
+Returns an enemy's z-depth
+==========================
+*/
+float EnemyStore::GetZ( int index ) const {
+	return mTransforms[ index ].mZ;
+}
+
+
+/*
+====================================
+CheckCharacterState
+Confirms an enemy's state externally
+====================================
+*/
+bool EnemyStore::CheckCharacterState( int index, Character::CharacterState testState ) const {
+	return mAnimations[ index ].mState == testState;
+}
+
+
+/*
+======================================================
+GetArrayXYCoords
+Returns an enemy's coords within the pathfinding array
+======================================================
+*/
+XYCoords EnemyStore::GetArrayXYCoords( int index ) const {
+	return mTransforms[ index ].mArrayCoords;
+}
+
+
+/*
+================================
+GetTargetXYCoords
+Returns an enemy's target coords
+================================
+*/
+XYCoords EnemyStore::GetTargetXYCoords( int index ) const {
+	return mAIs[ index ].mTargetCoords;
+}
+
+
+/*
+=============================================
+CheckIfDealingDamage
+Returns if an enemy has hit another character
+=============================================
+*/
+bool EnemyStore::CheckIfDealingDamage( int index ) const {
+	return mAIs[ index ].mIsDealingDamage;
+}
+
+
+/*
+===================================
+WeaponDamage
+Returns every enemy's weapon damage
+===================================
+*/
+int EnemyStore::WeaponDamage( void ) const {
+	return ENEMY_WEAPON_DAMAGE;
+}
+
+
+/*
+=========================
+TakeDamage
+Reduces an enemy's health
+=========================
+*/
+void EnemyStore::TakeDamage( int index, int incomingDamage ) {
+	mHealths[ index ].mHealth -= incomingDamage;
+}
+
+
+/*
+===================================================================
+UpdateHealth
+CheckHealth - a death resets the animation to its first frame and
+locks the enemy into DIEING for one cycle
+UpdateHealthBar and UpdateDepth - the depth from the node it was on
+===================================================================
+*/
+void EnemyStore::UpdateHealth( void ) {
+	for( int i = 0; i < int( mHealths.size() ); i++ ) {
+		HealthComponent &health = mHealths[ i ];
+		if( !health.mIsAlive ) {
+			continue;
+		}
+		
+		/* If health is 0 or less and not active */
+		if( ( health.mHealth <= 0 ) && ( !mAIs[ i ].mIsActive ) ) {
+			mAnimations[ i ].mU = 0;
+			mAnimations[ i ].mV = 0;
+			mAnimations[ i ].mState = Character::DIEING;
+			mAIs[ i ].mIsActive = true;
+		}
+		
+		health.mHealthWidth = ( health.mHealth / 2.0f );
+		if( health.mHealthWidth < 0 ) {
+			health.mHealthWidth = 0;
+		}
+		
+		mTransforms[ i ].mZ = float( mTransforms[ i ].mArrayCoords.mY + 36 );
+	}
+}
+
+
+/*
+================================================
+UpdatePatrol
+Patrolling enemies take turns between a random
+location near their origin and the origin itself
+================================================
+*/
+void EnemyStore::UpdatePatrol( void ) {
+	XYCoords patrolTarget;
+	for( int i = 0; i < int( mAIs.size() ); i++ ) {
+		AIComponent &ai = mAIs[ i ];
+		if( ( !mHealths[ i ].mIsAlive ) || ( ai.mAIState != Enemy::PATROLLING ) ) {
+			continue;
+		}
+		
+		if( ai.mPatrol.Update( mTransforms[ i ].mArrayCoords, patrolTarget ) ) {
+			SetTarget( i, patrolTarget );
+		}
+	}
+}
+
+
+/*
+================================================================
+UpdateTransforms
+SetArrayPosition - 32 pixels added for the sprite's offset, only
+worked out again for enemies that have moved since
+SetSpeedAndSpriteVariables - sheets run direction by direction,
+8 to a state, from ENEMY_SPRITE_SHEET
+================================================================
+*/
+void EnemyStore::UpdateTransforms( void ) {
+	for( int i = 0; i < int( mTransforms.size() ); i++ ) {
+		if( !mHealths[ i ].mIsAlive ) {
+			continue;
+		}
+		
+		TransformComponent &transform = mTransforms[ i ];
+		AnimationComponent &animation = mAnimations[ i ];
+		if( transform.mMoved ) {
+			transform.mArrayCoords = SCREENVIEW -> GetArrayXYCoords( transform.mX, ( transform.mY + 32.0f ), false );
+			transform.mMoved = false;
+		}
+		transform.mHorizontalSpeed = ENEMY_SPEED_X[ animation.mDirection ];
+		transform.mVerticalSpeed = ENEMY_SPEED_Y[ animation.mDirection ];
+		animation.mSpriteSheetIndex = ENEMY_SPRITE_SHEET + animation.mDirection + ( animation.mState * 8 );
+	}
+}
+
+
+/*
+==============================================================
+UpdatePathing
+Picks each enemy's next node and claims it in PATHFINDER - one
+enemy at a time, so two never move onto the same free node
+==============================================================
+*/
+void EnemyStore::UpdatePathing( void ) {
+	for( int i = 0; i < int( mAIs.size() ); i++ ) {
+		if( !mHealths[ i ].mIsAlive ) {
+			continue;
+		}
+		
+		SetDirection( i );
+		
+		/* Only when moving between tiles */
+		AIComponent &ai = mAIs[ i ];
+		XYCoords arrayCoords = mTransforms[ i ].mArrayCoords;
+		if( ( !ai.mIsActive ) && ( arrayCoords != ai.mTargetCoords ) && ( !PATHFINDER -> NodeContainsPlayer( ai.mNextCoords ) ) ) {
+			PATHFINDER -> CleanObjectNode( arrayCoords );
+			PATHFINDER -> SetObjectNode( ai.mNextCoords, Node::ENEMY );
+		}
+	}
+}
+
+
+/*
+==================================================================
+UpdateActions
+CheckState - takes the next state and direction between actions
+MoveCharacter - while MOVING
+PerformAction - each action is counted by 16 ticks, dealing damage
+twice when attacking, healing when an action, and ending the enemy
+after DIEING
+==================================================================
+*/
+void EnemyStore::UpdateActions( void ) {
+	for( int i = 0; i < int( mAIs.size() ); i++ ) {
+		HealthComponent &health = mHealths[ i ];
+		if( !health.mIsAlive ) {
+			continue;
+		}
+		
+		TransformComponent &transform = mTransforms[ i ];
+		AnimationComponent &animation = mAnimations[ i ];
+		AIComponent &ai = mAIs[ i ];
+		
+		/* If not currently in an action - alter direction and state */
+		if( !ai.mIsActive ) {
+			animation.mDirection = animation.mNextDirection;
+			animation.mState = animation.mNextState;
+			if( animation.mState != Character::IDLE ) {
+				ai.mIsActive = true;
+			}
+		}
+		
+		/* Move enemy */
+		if( animation.mState == Character::MOVING ) {
+			transform.mX += transform.mHorizontalSpeed;
+			transform.mY += transform.mVerticalSpeed;
+			transform.mMoved = true;
+		}
+		
+		if( ai.mIsActive ) {
+			ai.mActionCounter++;
+			ai.mIsDealingDamage = false;
+			
+			/* Deal damage condition (2 swings per cycle) */
+			if( ( ai.mActionCounter % 8 == 0 ) && ( animation.mState == Character::ATTACKING ) ) {
+				ai.mIsDealingDamage = true;
+			}
+			
+			/* End action condition */
+			if( ai.mActionCounter == 16 ) {
+				/* If still alive - reset variables for next cycle */
+				if( animation.mState != Character::DIEING ) {
+					if( animation.mState == Character::ACTION ) {
+						health.mHealth += 20;
+						if( health.mHealth > 100 ) {
+							health.mHealth = 100;
+						}
+					}
+					ai.mIsActive = false;
+					animation.mNextState = Character::IDLE;
+					ai.mActionCounter = 0;
+					ai.mIsPathfinding = false;
+				
+				/* Otherwise flag as dead to stop further updates */
+				} else {
+					health.mIsAlive = false;
+					PATHFINDER -> CleanObjectNode( transform.mArrayCoords );
+					transform.mZ -= 0.75f;
+				}
+			}
+		}
+	}
+}
+
+
+/*
+==========================================
+SetTarget
+Enemy receives a free node to move towards
+==========================================
+*/
+void EnemyStore::SetTarget( int index, XYCoords target ) {
+	if( PATHFINDER -> IsNodeFree( target ) ) {
+		mAIs[ index ].mTargetCoords = target;
+	}
+}
+
+
+/*
+=================================================================
+SetDirection
+Gets the next node towards the target, the state it needs and the
+direction to face - Character::SetDirection and Enemy::SetState
+=================================================================
+*/
+void EnemyStore::SetDirection( int index ) {
+	AnimationComponent &animation = mAnimations[ index ];
+	AIComponent &ai = mAIs[ index ];
+	XYCoords arrayCoords = mTransforms[ index ].mArrayCoords;
+	
+	/* Only if not in action and there is a target */
+	if( ( animation.mState == Character::DIEING ) || ( ai.mIsActive ) || ( arrayCoords == ai.mTargetCoords ) || ( ai.mIsPathfinding ) ) {
+		return;
+	}
+	
+	/* Get coords of the next tile */
+	ai.mNextCoords = mPaths[ index ].GetNextNode( arrayCoords, ai.mTargetCoords, Enemy::GetStatePathPriority( ai.mAIState ) );
+	
+	/* Route still queued - stay put and ask again next frame */
+	if( mPaths[ index ].IsWaiting() ) {
+		ai.mNextCoords = arrayCoords;
+		return;
+	}
+	
+	/* Prevent further calls for pathfinding in this cycle */
+	ai.mIsPathfinding = true;
+	
+	/* Determine what state based on what next tile contains */
+	animation.mNextState = Enemy::GetNextState( ai.mNextCoords );
+	
+	/* Determine which direction enemy needs to face */
+	Character::GetStepDirection( arrayCoords, ai.mNextCoords, animation.mNextDirection );
+	
+	/* Saftey Condition */
+	if( ( ai.mNextCoords.mX == -1 ) || ( ai.mNextCoords.mY == -1 ) ) {
+		animation.mNextDirection = animation.mDirection;
+		animation.mNextState = animation.mState;
+		printf( "Illegal Node received! \n" );
+	}
+}
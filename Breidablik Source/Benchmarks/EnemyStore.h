@@ -0,0 +1,128 @@
+#ifndef _ENEMYSTORE_H_
+#define _ENEMYSTORE_H_
+
+
+#include "Enemy.h"
+#include "EnemyPatrol.h"
+#include "PathFollower.h"
+#include "primitives.h"
+#include "XYCoords.h"
+#include <vector>
+
+
+/*
+=========================================================================
+EnemyStore
+Enemies kept as components instead of objects - an array per component,
+element i of each belonging to enemy i, so a pass walks the components
+it reads in order and never loads the rest
+Update runs the logic of Enemy::Update as system passes, each one taking
+every enemy before the next pass starts
+ Health    - CheckHealth, UpdateHealthBar, UpdateDepth
+ Patrol    - Patrol
+ Transform - SetArrayPosition, SetSpeedAndSpriteVariables
+ Pathing   - SetDirection, SetState, UpdatePathfindingPosition
+ Action    - CheckState, MoveCharacter, PerformAction
+Each enemy still goes through them in Enemy::Update's order. Enemies only
+see each other through PATHFINDER, and Pathing claims nodes one enemy at
+a time as before - but a node freed by a death reads as free to the rest
+on the next frame instead of later in the same one
+Animate is its own pass, run before drawing as Character::Render does,
+and every enemy is drawn with one shared set of sprites
+Patrolling, path following and the next state and direction come from
+EnemyPatrol, PathFollower, Enemy and Character - the code Enemy runs
+Enemies here are not Characters, so they are never added to a
+SpatialHash - the game's aggro and hit queries cannot see them, and
+CheckAggro tests every enemy instead
+Only EnemyBenchmark uses it, to measure the layout against Enemy
+objects - the game itself keeps running Enemy
+=========================================================================
+*/
+class EnemyStore {
+public:
+	EnemyStore::EnemyStore();
+	EnemyStore::~EnemyStore();
+	
+	/* Creates an enemy as Enemy::Enemy would - returns its index */
+	int Add( float x, float y, float z );
+	
+	/* Removes every enemy */
+	void Clear( void );
+	int GetCount( void ) const;
+	
+	/* System Passes */
+	void Update( void );
+	void CheckAggro( XYCoords playerCoords );
+	void Animate( void );
+	
+	/* Draws one enemy - for interleaving with other GameObjects by GetZ */
+	void Render( int index );
+	float GetZ( int index ) const;
+	
+	/* Per enemy versions of the Character functions */
+	bool CheckCharacterState( int index, Character::CharacterState testState ) const;
+	XYCoords GetArrayXYCoords( int index ) const;
+	XYCoords GetTargetXYCoords( int index ) const;
+	bool CheckIfDealingDamage( int index ) const;
+	int WeaponDamage( void ) const;
+	void TakeDamage( int index, int incomingDamage );
+
+private:
+	/* Where it is and how it is moving */
+	struct TransformComponent {
+		float mX, mY, mZ;
+		float mHorizontalSpeed, mVerticalSpeed;
+		XYCoords mArrayCoords;
+		bool mMoved; // since mArrayCoords was worked out
+	};
+	
+	/* What it is doing and the frame shown for it */
+	struct AnimationComponent {
+		Character::CharacterState mState, mNextState;
+		Character::CharacterDirection mDirection, mNextDirection;
+		int mSpriteSheetIndex;
+		int mU, mV;
+		int mAnimCounter;
+	};
+	
+	/* Where it is going and why */
+	struct AIComponent {
+		Enemy::EnemyState mAIState;
+		EnemyPatrol mPatrol;
+		int mActionCounter;
+		XYCoords mNextCoords, mTargetCoords;
+		bool mIsPathfinding;
+		bool mIsActive;
+		bool mIsDealingDamage;
+	};
+	
+	struct HealthComponent {
+		int mHealth;
+		float mHealthWidth;
+		bool mIsAlive;
+	};
+	
+	vector< TransformComponent > mTransforms;
+	vector< AnimationComponent > mAnimations;
+	vector< AIComponent > mAIs;
+	vector< HealthComponent > mHealths;
+	vector< PathFollower > mPaths; // cached routes - only read when choosing the next node
+	
+	/* Shared by every enemy when drawing */
+	PS2TexQuad* pEnemyHealthBar;
+	PS2TexQuad* pEnemySprite;
+	PS2Polygon* pEnemyShadow;
+	
+	/* Passes run by Update */
+	void UpdateHealth( void );
+	void UpdatePatrol( void );
+	void UpdateTransforms( void );
+	void UpdatePathing( void );
+	void UpdateActions( void );
+	
+	/* Single enemy helpers */
+	void SetTarget( int index, XYCoords target );
+	void SetDirection( int index );
+};
+
+#endif
@@ -0,0 +1,719 @@
+#include "PathController.h"
+#include "LevelData.h"
+#include "XYCoords.h"
+#include "SpatialHash.h"
+#include "BenchmarkTimer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <queue>
+
+
+/* Benchmark Data */
+static const int BENCHMARK_MAP_COUNT = 3;
+static const int BENCHMARK_WIDTHS[ BENCHMARK_MAP_COUNT ] = { LEVEL_ONE_WIDTH, 64, 128 };
+static const int BENCHMARK_HEIGHTS[ BENCHMARK_MAP_COUNT ] = { LEVEL_ONE_HEIGHT, 256, 512 };
+static const int BENCHMARK_BLOCKED_PERCENT = 25;
+static const int BENCHMARK_SEARCHES = 200;
+static const int BENCHMARK_SEED = 1234;
+static const int BENCHMARK_LARGE_SIZE = 1000;          // nodes each way for the hierarchy
+static const int BENCHMARK_LARGE_SEARCHES = 20;        // whole grid searches are slow at this size
+static const int BENCHMARK_HIERARCHY_SEARCHES = 500;
+static const int BENCHMARK_CHANGED_NODES = 100;
+static const int BENCHMARK_ROOM_WIDTH = 40;           // columns between walls on the rooms map
+static const int BENCHMARK_ROOM_HEIGHT = 80;          // rows between walls on the rooms map
+static const int BENCHMARK_DOOR_WIDTH = 3;
+static const int BENCHMARK_ROOM_BLOCKED_PERCENT = 10;
+static const int BENCHMARK_CHASER_COUNTS[ 3 ] = { 8, 32, 128 };
+static const int BENCHMARK_CHASE_FRAMES = 200;        // the player is on a new node every frame
+static const int BENCHMARK_BURST_REQUESTS = 128;      // enemies all wanting a route on the same frame
+static const int BENCHMARK_ENEMY_COUNTS[ 3 ] = { 100, 1000, 10000 };
+static const int BENCHMARK_RADIUS_QUERIES = 1000;
+static const float BENCHMARK_AGGRO_DISTANCE = 134.0f; // as Enemy::CheckAggro
+
+
+/*
+========================================================================
+PathfindingBenchmark
+Console timing of PATHFINDER->FindPath against the wave expansion and
+traceback search it replaced - kept here as LegacyFindPath, unchanged
+apart from working on the singleton's array from outside the class
+Random maps (a quarter of the nodes blocked) and random free start and
+target pairs - both searches get the same pairs
+Then the cost of walking each route - a FindPath every step as
+characters used to, against one FindFullPath cached for the walk
+Last, path queries per second on 1000 x 1000 maps (random nodes, and
+rooms walled off with one door per wall) searching the whole grid
+against the cluster hierarchy, and the cost of rebuilding it after
+nodes are blocked
+And a frame of enemies chasing the player - a FindFullPath each against
+one flow field built around the player and a step read by each
+And a burst of requests searched in one frame against the request queue
+spreading them over frames within PATH_FRAME_BUDGET
+And "which enemies are near this node" - GetObjectDistance to every
+enemy against the enemy bits of the occupancy grid and a SpatialHash
+Build with "make pathbench"
+========================================================================
+*/
+
+
+/* Legacy search data */
+static Node legacySteps[ 8 ];
+static int legacyStepCounter = 0;
+static int legacyNodesExpanded = 0;
+static int legacyPathCost = 0;
+
+
+/*
+==============================================
+GetStepCost
+Cost of a move between neighbouring nodes -
+only edge moves change row by one
+==============================================
+*/
+static int GetStepCost( Node fromNode, Node toNode ) {
+	if( abs( fromNode.mY - toNode.mY ) == 1 ) {
+		return PATH_EDGE_COST;
+	}
+	return PATH_CORNER_COST;
+}
+
+
+/*
+=================================
+LegacyGetDistance
+Pixel distance between two nodes
+=================================
+*/
+static float LegacyGetDistance( Node currentNode, Node targetNode ) {
+	/* Get current nodes pixel coords */
+	int	currentY = currentNode.mY * 32;
+	int xOffset = 0;
+	if( currentNode.mY % 2 != 0 ) {
+		xOffset = 32;
+	}
+	int currentX = ( currentNode.mX * 64 ) + xOffset;
+	
+	/* Get target nodes pixel coords */
+	int	targetY = targetNode.mY * 32;
+	xOffset = 0;
+	if( targetNode.mY % 2 != 0 ) {
+		xOffset = 32;
+	}
+	int targetX = ( targetNode.mX * 64 ) + xOffset;
+	
+	/* Calculate distance */
+	int dy = currentY - targetY;
+	int dx = currentX - targetX;
+	float distance = float( sqrt( ( dy * dy ) + ( dx * dx ) ) );
+	return distance;
+}
+
+
+/*
+====================================================
+LegacyGenerateMoves
+Fills legacySteps with legal moves from current tile
+====================================================
+*/
+static void LegacyGenerateMoves( vector< vector< Node > > &pathfindingArray, Node activeNode, int worldWidth, int worldHeight ) {
+	/* N, NE, E, SE, S, SW, W, NW */
+	static const int evenRowX[ 8 ] = { 0, 0, 1, 0, 0, -1, -1, -1 };
+	static const int oddRowX[ 8 ]  = { 0, 1, 1, 1, 0, 0, -1, 0 };
+	static const int stepY[ 8 ]    = { -2, -1, 0, 1, 2, 1, 0, -1 };
+	const int* stepX = ( activeNode.mY % 2 != 0 ) ? oddRowX : evenRowX;
+	
+	legacyStepCounter = 0;
+	for( int i = 0; i < 8; i++ ) {
+		int x = activeNode.mX + stepX[ i ];
+		int y = activeNode.mY + stepY[ i ];
+		if( ( x >= 0 ) && ( x < worldWidth ) && ( y >= 0 ) && ( y < worldHeight ) ) {
+			if( pathfindingArray[ y ][ x ].mNodeState != Node::BLOCKED ) {
+				legacySteps[ legacyStepCounter ] = pathfindingArray[ y ][ x ];
+				legacyStepCounter++;
+			}
+		}
+	}
+}
+
+
+/*
+==========================================================
+LegacyFindPath
+The wave expansion and traceback search FindPath used to
+run - best first by distance to the target, then back to
+the start through lower move numbers
+==========================================================
+*/
+static XYCoords LegacyFindPath( XYCoords start, XYCoords target, int worldWidth, int worldHeight ) {
+	vector< vector< Node > > &pathfindingArray = PATHFINDER->mPathfindingArray;
+	priority_queue< Node, vector< Node >, greater< Node > > workingSet;
+	priority_queue< Node, vector< Node >, greater< Node > > tracebackSet;
+	XYCoords nextNode( -1, -1 );
+	Node activeNode;
+	bool targetFound = false;
+	
+	legacyNodesExpanded = 0;
+	legacyPathCost = 0;
+	
+	/* Set start - only if selected node is not blocked */
+	if( pathfindingArray[ start.mY ][ start.mX ].mNodeState != Node::BLOCKED ) {
+		pathfindingArray[ start.mY ][ start.mX ].SetAsStart( 0 );
+		activeNode = pathfindingArray[ start.mY ][ start.mX ];
+		workingSet.push( activeNode );
+		pathfindingArray[ target.mY ][ target.mX ].SetAsTarget();
+	}
+	
+	/* Wave Expansion */
+	while( !workingSet.empty() ) {
+		activeNode = workingSet.top();
+		workingSet.pop();
+		legacyNodesExpanded++;
+		int moveNumber = activeNode.mMoveNumber + 1;
+		LegacyGenerateMoves( pathfindingArray, activeNode, worldWidth, worldHeight );
+		
+		/* Check the legal moves for target */
+		for( int i = 0; i < legacyStepCounter; i++ ) {
+			if( legacySteps[ i ].mIsTargetNode ) {
+				legacySteps[ i ].SetMoveNumber( moveNumber );
+				tracebackSet.push( legacySteps[ i ] );
+				break;
+			}
+		}
+		if( !tracebackSet.empty() ) {
+			break;
+		}
+		
+		/* For legal moves */
+		for( int i = 0; i < legacyStepCounter; i++ ) {
+			if( !pathfindingArray[ legacySteps[ i ].mY ][ legacySteps[ i ].mX ].mUsed ) {
+				pathfindingArray[ legacySteps[ i ].mY ][ legacySteps[ i ].mX ].SetMoveNumber( moveNumber );
+				pathfindingArray[ legacySteps[ i ].mY ][ legacySteps[ i ].mX ].SetDistanceFromTarget( LegacyGetDistance( pathfindingArray[ legacySteps[ i ].mY ][ legacySteps[ i ].mX ], pathfindingArray[ target.mY ][ target.mX ] ) );
+				workingSet.push( pathfindingArray[ legacySteps[ i ].mY ][ legacySteps[ i ].mX ] );
+			}
+		}
+	}
+	
+	/* Traceback - adds up the cost of each step for comparison */
+	Node previousNode;
+	bool firstStep = true;
+	while( !tracebackSet.empty() ) {
+		activeNode = tracebackSet.top();
+		while( !tracebackSet.empty() ) {
+			tracebackSet.pop();
+		}
+		if( !firstStep ) {
+			legacyPathCost += GetStepCost( previousNode, activeNode );
+		}
+		firstStep = false;
+		previousNode = activeNode;
+		
+		pathfindingArray[ activeNode.mY ][ activeNode.mX ].mNodeState = Node::PATH;
+		LegacyGenerateMoves( pathfindingArray, activeNode, worldWidth, worldHeight );
+		
+		/* If the start is one of the next moves */
+		for( int i = 0; i < legacyStepCounter; i++ ) {
+			if( legacySteps[ i ].mIsStartNode ) {
+				targetFound = true;
+				legacyPathCost += GetStepCost( activeNode, legacySteps[ i ] );
+				nextNode.mX = activeNode.mX;
+				nextNode.mY = activeNode.mY;
+				break;
+			}
+		}
+		if( targetFound ) {
+			break;
+		}
+		
+		/* Loop through possibles */
+		for( int i = 0; i < legacyStepCounter; i++ ) {
+			if( ( legacySteps[ i ].mMoveNumber < activeNode.mMoveNumber ) && ( legacySteps[ i ].mUsed ) ) {
+				tracebackSet.push( pathfindingArray[ legacySteps[ i ].mY ][ legacySteps[ i ].mX ] );
+			}
+		}
+	}
+	
+	return nextNode;
+}
+
+
+/*
+==============================================
+LegacyClearPathfindingArray
+The old search marks nodes all over the grid -
+resets every node as ClearPathfindingArray did
+==============================================
+*/
+static void LegacyClearPathfindingArray( int worldWidth, int worldHeight ) {
+	for( int y = 0; y < worldHeight; y++ ) {
+		for( int x = 0; x < worldWidth; x++ ) {
+			PATHFINDER->mPathfindingArray[ y ][ x ].CleanNode();
+		}
+	}
+}
+
+
+/*
+=====================================================
+GenerateMap
+Random blocked nodes into PATHFINDER - with rooms,
+fewer random nodes and walls with a door per room side
+=====================================================
+*/
+static void GenerateMap( int worldWidth, int worldHeight, bool rooms = false ) {
+	int blockedPercent = rooms ? BENCHMARK_ROOM_BLOCKED_PERCENT : BENCHMARK_BLOCKED_PERCENT;
+	vector< vector< int > > arrayVector;
+	for( int y = 0; y < worldHeight; y++ ) {
+		vector< int > tempRow;
+		for( int x = 0; x < worldWidth; x++ ) {
+			tempRow.push_back( ( rand() % 100 < blockedPercent ) ? 1 : 0 );
+		}
+		arrayVector.push_back( tempRow );
+	}
+	
+	if( rooms ) {
+		/* Walls - a column stops E / W moves, two rows stop N / S */
+		for( int y = 0; y < worldHeight; y++ ) {
+			for( int x = BENCHMARK_ROOM_WIDTH; x < worldWidth; x += BENCHMARK_ROOM_WIDTH ) {
+				arrayVector[ y ][ x ] = 1;
+			}
+		}
+		for( int y = BENCHMARK_ROOM_HEIGHT; y + 1 < worldHeight; y += BENCHMARK_ROOM_HEIGHT ) {
+			for( int x = 0; x < worldWidth; x++ ) {
+				arrayVector[ y ][ x ] = 1;
+				arrayVector[ y + 1 ][ x ] = 1;
+			}
+		}
+		
+		/* A door in each side of each room */
+		for( int roomY = 0; roomY < worldHeight; roomY += BENCHMARK_ROOM_HEIGHT ) {
+			for( int roomX = 0; roomX < worldWidth; roomX += BENCHMARK_ROOM_WIDTH ) {
+				int doorY = roomY + 2 + ( rand() % ( BENCHMARK_ROOM_HEIGHT - 4 - BENCHMARK_DOOR_WIDTH * 2 ) );
+				int doorX = roomX + 1 + ( rand() % ( BENCHMARK_ROOM_WIDTH - 2 - BENCHMARK_DOOR_WIDTH ) );
+				for( int i = 0; i < BENCHMARK_DOOR_WIDTH * 2; i++ ) {
+					if( ( roomX + BENCHMARK_ROOM_WIDTH < worldWidth ) && ( doorY + i < worldHeight ) ) {
+						arrayVector[ doorY + i ][ roomX + BENCHMARK_ROOM_WIDTH ] = 0;
+					}
+				}
+				for( int i = 0; i < BENCHMARK_DOOR_WIDTH; i++ ) {
+					if( ( roomY + BENCHMARK_ROOM_HEIGHT + 1 < worldHeight ) && ( doorX + i < worldWidth ) ) {
+						arrayVector[ roomY + BENCHMARK_ROOM_HEIGHT ][ doorX + i ] = 0;
+						arrayVector[ roomY + BENCHMARK_ROOM_HEIGHT + 1 ][ doorX + i ] = 0;
+					}
+				}
+			}
+		}
+	}
+	
+	PATHFINDER->Init( worldWidth, worldHeight );
+	PATHFINDER->LoadPathfindingArray( arrayVector );
+}
+
+
+/*
+===============================
+RandomFreeNode
+Any node that isnt blocked
+===============================
+*/
+static XYCoords RandomFreeNode( int worldWidth, int worldHeight ) {
+	XYCoords position;
+	do {
+		position.mX = rand() % worldWidth;
+		position.mY = rand() % worldHeight;
+	} while( !PATHFINDER->IsNodeFree( position ) );
+	return position;
+}
+
+
+/*
+=========================================================
+BenchmarkLargeMap
+Queries per second searching the whole grid against the
+cluster hierarchy, and the hierarchy's build / rebuild
+=========================================================
+*/
+static void BenchmarkLargeMap( bool rooms ) {
+	GenerateMap( BENCHMARK_LARGE_SIZE, BENCHMARK_LARGE_SIZE, rooms );
+	vector< XYCoords > largeStarts, largeTargets;
+	for( int i = 0; i < BENCHMARK_HIERARCHY_SEARCHES; i++ ) {
+		largeStarts.push_back( RandomFreeNode( BENCHMARK_LARGE_SIZE, BENCHMARK_LARGE_SIZE ) );
+		largeTargets.push_back( RandomFreeNode( BENCHMARK_LARGE_SIZE, BENCHMARK_LARGE_SIZE ) );
+	}
+	
+	/* Build - happens on the first query */
+	vector< XYCoords > path;
+	PATHFINDER->UseHierarchy( true );
+	double startTime = GetTime();
+	PATHFINDER->FindFullPath( largeStarts[ 0 ], largeStarts[ 0 ], path );
+	PATHFINDER->FindFullPath( largeStarts[ 0 ], largeTargets[ 0 ], path );
+	double buildTime = GetTime() - startTime;
+	
+	/* Whole grid */
+	PATHFINDER->UseHierarchy( false );
+	vector< int > flatCosts;
+	double flatTime = 0.0;
+	long flatNodes = 0;
+	for( int i = 0; i < BENCHMARK_LARGE_SEARCHES; i++ ) {
+		startTime = GetTime();
+		PATHFINDER->FindFullPath( largeStarts[ i ], largeTargets[ i ], path );
+		flatTime += GetTime() - startTime;
+		flatNodes += PATHFINDER->GetNodesExpanded();
+		flatCosts.push_back( path.empty() ? 0 : PATHFINDER->GetPathCost() );
+	}
+	
+	/* Hierarchy - cost compared on the searches both ran */
+	PATHFINDER->UseHierarchy( true );
+	double hierarchyTime = 0.0, costRatio = 0.0;
+	long hierarchyNodes = 0;
+	int compared = 0;
+	for( int i = 0; i < BENCHMARK_HIERARCHY_SEARCHES; i++ ) {
+		startTime = GetTime();
+		PATHFINDER->FindFullPath( largeStarts[ i ], largeTargets[ i ], path );
+		hierarchyTime += GetTime() - startTime;
+		hierarchyNodes += PATHFINDER->GetNodesExpanded();
+		if( ( i < BENCHMARK_LARGE_SEARCHES ) && ( flatCosts[ i ] > 0 ) && ( !path.empty() ) ) {
+			costRatio += ( double )PATHFINDER->GetPathCost() / flatCosts[ i ];
+			compared++;
+		}
+	}
+	
+	/* Rebuild after blocking nodes */
+	for( int i = 0; i < BENCHMARK_CHANGED_NODES; i++ ) {
+		PATHFINDER->SetPathfindingNode( RandomFreeNode( BENCHMARK_LARGE_SIZE, BENCHMARK_LARGE_SIZE ), Node::BLOCKED );
+	}
+	startTime = GetTime();
+	PATHFINDER->FindFullPath( largeStarts[ 0 ], largeStarts[ 0 ], path );
+	PATHFINDER->FindFullPath( largeStarts[ 0 ], largeTargets[ 0 ], path );
+	double rebuildTime = GetTime() - startTime;
+	
+	printf( "\n%d x %d %s - %d entrances, built in %.1f ms, %d nodes blocked rebuilt in %.2f ms\n",
+	        BENCHMARK_LARGE_SIZE, BENCHMARK_LARGE_SIZE, rooms ? "rooms" : "random", PATHFINDER->GetHierarchy().GetEntranceCount(),
+	        buildTime, BENCHMARK_CHANGED_NODES, rebuildTime );
+	printf( "%-10s %12s %12s %12s\n", "Search", "Queries/s", "ms", "Nodes" );
+	printf( "%-10s %12.1f %12.3f %12ld\n", "Whole grid", BENCHMARK_LARGE_SEARCHES * 1000.0 / flatTime,
+	        flatTime / BENCHMARK_LARGE_SEARCHES, flatNodes / BENCHMARK_LARGE_SEARCHES );
+	printf( "%-10s %12.1f %12.3f %12ld   (path cost x%.3f)\n", "Hierarchy", BENCHMARK_HIERARCHY_SEARCHES * 1000.0 / hierarchyTime,
+	        hierarchyTime / BENCHMARK_HIERARCHY_SEARCHES, hierarchyNodes / BENCHMARK_HIERARCHY_SEARCHES,
+	        compared ? costRatio / compared : 0.0 );
+}
+
+
+/*
+=============================================================
+BenchmarkChasers
+Pathfinding per frame for enemies within the flow field of a
+player on a different node every frame - the worst case, as
+the field is only built when the player changes node
+=============================================================
+*/
+static void BenchmarkChasers( void ) {
+	int worldWidth = BENCHMARK_WIDTHS[ BENCHMARK_MAP_COUNT - 1 ];
+	int worldHeight = BENCHMARK_HEIGHTS[ BENCHMARK_MAP_COUNT - 1 ];
+	GenerateMap( worldWidth, worldHeight );
+	
+	/* Hierarchy built before timing - as in game after the first query */
+	vector< XYCoords > path;
+	XYCoords anyNode = RandomFreeNode( worldWidth, worldHeight );
+	PATHFINDER->FindFullPath( anyNode, RandomFreeNode( worldWidth, worldHeight ), path );
+	
+	printf( "\n%-10s %12s %12s %12s\n", "Chasers", "Searches ms", "Field ms", "Field nodes" );
+	for( int count = 0; count < 3; count++ ) {
+		int chaserCount = BENCHMARK_CHASER_COUNTS[ count ];
+		double searchTime = 0.0, fieldTime = 0.0;
+		long fieldNodes = 0;
+		vector< XYCoords > chasers;
+		
+		for( int frame = 0; frame < BENCHMARK_CHASE_FRAMES; frame++ ) {
+			/* Player somewhere new, chasers anywhere its field reaches */
+			XYCoords player = RandomFreeNode( worldWidth, worldHeight );
+			PATHFINDER->UpdateFlowField( player );
+			if( PATHFINDER->GetFlowField().GetNodesReached() < 2 ) {
+				continue;
+			}
+			chasers.clear();
+			while( ( int )chasers.size() < chaserCount ) {
+				XYCoords chaser = RandomFreeNode( worldWidth, worldHeight );
+				int chaserIndex = ( chaser.mY * worldWidth ) + chaser.mX;
+				if( ( chaser != player ) && ( PATHFINDER->GetFlowField().GetCost( chaserIndex ) != -1 ) ) {
+					chasers.push_back( chaser );
+				}
+			}
+			
+			/* A search each */
+			double startTime = GetTime();
+			for( int i = 0; i < chaserCount; i++ ) {
+				PATHFINDER->FindFullPath( chasers[ i ], player, path );
+			}
+			searchTime += GetTime() - startTime;
+			
+			/* One field, a step each */
+			PATHFINDER->GetFlowField().InvalidateAll();
+			startTime = GetTime();
+			PATHFINDER->UpdateFlowField( player );
+			for( int i = 0; i < chaserCount; i++ ) {
+				PATHFINDER->GetFlowStep( chasers[ i ] );
+			}
+			fieldTime += GetTime() - startTime;
+			fieldNodes += PATHFINDER->GetFlowField().GetNodesReached();
+		}
+		
+		printf( "%-10d %12.4f %12.4f %12ld\n", chaserCount, searchTime / BENCHMARK_CHASE_FRAMES,
+		        fieldTime / BENCHMARK_CHASE_FRAMES, fieldNodes / BENCHMARK_CHASE_FRAMES );
+	}
+}
+
+
+/*
+=================================================================
+BenchmarkRequestQueue
+A burst of path requests all searched on one frame, against the
+queue working through them a budget of nodes per frame
+=================================================================
+*/
+static void BenchmarkRequestQueue( void ) {
+	int worldWidth = BENCHMARK_WIDTHS[ BENCHMARK_MAP_COUNT - 1 ];
+	int worldHeight = BENCHMARK_HEIGHTS[ BENCHMARK_MAP_COUNT - 1 ];
+	GenerateMap( worldWidth, worldHeight );
+	
+	/* A quarter of the burst asks for a route another already asked for */
+	vector< XYCoords > starts, targets, path;
+	for( int i = 0; i < BENCHMARK_BURST_REQUESTS; i++ ) {
+		if( i % 4 == 3 ) {
+			starts.push_back( starts[ i - 1 ] );
+			targets.push_back( targets[ i - 1 ] );
+		} else {
+			starts.push_back( RandomFreeNode( worldWidth, worldHeight ) );
+			targets.push_back( RandomFreeNode( worldWidth, worldHeight ) );
+		}
+	}
+	PATHFINDER->FindFullPath( starts[ 0 ], targets[ 0 ], path );
+	
+	/* All on one frame */
+	double startTime = GetTime();
+	for( int i = 0; i < BENCHMARK_BURST_REQUESTS; i++ ) {
+		PATHFINDER->FindFullPath( starts[ i ], targets[ i ], path );
+	}
+	double burstTime = GetTime() - startTime;
+	
+	/* Queued - the slowest frame is what shows as a spike */
+	vector< int > requests;
+	for( int i = 0; i < BENCHMARK_BURST_REQUESTS; i++ ) {
+		requests.push_back( PATHFINDER->RequestPath( starts[ i ], targets[ i ], ( i % 2 == 0 ) ? PATH_PRIORITY_NORMAL : PATH_PRIORITY_LOW ) );
+	}
+	double queueTime = 0.0, slowestFrame = 0.0;
+	int frames = 0;
+	while( PATHFINDER->GetQueuedPathCount() > 0 ) {
+		startTime = GetTime();
+		PATHFINDER->ProcessPathRequests();
+		double frameTime = GetTime() - startTime;
+		queueTime += frameTime;
+		if( frameTime > slowestFrame ) {
+			slowestFrame = frameTime;
+		}
+		frames++;
+	}
+	int found = 0;
+	for( int i = 0; i < BENCHMARK_BURST_REQUESTS; i++ ) {
+		if( PATHFINDER->GetPathResult( requests[ i ], path ) == PATH_REQUEST_FOUND ) {
+			found++;
+		}
+	}
+	
+	printf( "\n%d requests at once - %d found\n", BENCHMARK_BURST_REQUESTS, found );
+	printf( "%-10s %12s %12s %12s\n", "Searches", "Total ms", "Worst frame", "Frames" );
+	printf( "%-10s %12.3f %12.3f %12d\n", "One frame", burstTime, burstTime, 1 );
+	printf( "%-10s %12.3f %12.3f %12d\n", "Queued", queueTime, slowestFrame, frames );
+}
+
+
+/*
+================================================================
+BenchmarkOccupancy
+Enemies within the aggro distance of random nodes - a distance
+to every enemy against the occupancy grid's radius query and
+the spatial hash's (which also says which enemies they are)
+================================================================
+*/
+static void BenchmarkOccupancy( void ) {
+	int worldWidth = BENCHMARK_WIDTHS[ BENCHMARK_MAP_COUNT - 1 ];
+	int worldHeight = BENCHMARK_HEIGHTS[ BENCHMARK_MAP_COUNT - 1 ];
+	
+	printf( "\n%-10s %12s %12s %12s %12s\n", "Enemies", "Distance ms", "Bits ms", "Hash ms", "Mismatches" );
+	for( int count = 0; count < 3; count++ ) {
+		GenerateMap( worldWidth, worldHeight );
+		vector< XYCoords > enemies, queries;
+		while( ( int )enemies.size() < BENCHMARK_ENEMY_COUNTS[ count ] ) {
+			XYCoords enemy = RandomFreeNode( worldWidth, worldHeight );
+			if( !PATHFINDER->NodeContainsEnemy( enemy ) ) {
+				PATHFINDER->SetObjectNode( enemy, Node::ENEMY );
+				enemies.push_back( enemy );
+			}
+		}
+		for( int i = 0; i < BENCHMARK_RADIUS_QUERIES; i++ ) {
+			queries.push_back( RandomFreeNode( worldWidth, worldHeight ) );
+		}
+		
+		/* The hash only stores the pointers - stand ins will do */
+		SpatialHash spatialHash;
+		spatialHash.Init( worldWidth, worldHeight );
+		vector< char > standIns( enemies.size() );
+		for( int i = 0; i < ( int )enemies.size(); i++ ) {
+			spatialHash.Insert( ( Character* )&standIns[ i ], enemies[ i ] );
+		}
+		
+		/* Every enemy */
+		vector< int > distanceCounts;
+		double startTime = GetTime();
+		for( int i = 0; i < BENCHMARK_RADIUS_QUERIES; i++ ) {
+			int near = 0;
+			for( int j = 0; j < ( int )enemies.size(); j++ ) {
+				if( PATHFINDER->GetObjectDistance( queries[ i ], enemies[ j ] ) < BENCHMARK_AGGRO_DISTANCE ) {
+					near++;
+				}
+			}
+			distanceCounts.push_back( near );
+		}
+		double distanceTime = GetTime() - startTime;
+		
+		/* Bits */
+		int mismatches = 0;
+		startTime = GetTime();
+		for( int i = 0; i < BENCHMARK_RADIUS_QUERIES; i++ ) {
+			if( PATHFINDER->CountEnemiesWithin( queries[ i ], BENCHMARK_AGGRO_DISTANCE ) != distanceCounts[ i ] ) {
+				mismatches++;
+			}
+		}
+		double bitsTime = GetTime() - startTime;
+		
+		/* Hash */
+		vector< Character* > found;
+		startTime = GetTime();
+		for( int i = 0; i < BENCHMARK_RADIUS_QUERIES; i++ ) {
+			spatialHash.QueryRadius( queries[ i ], BENCHMARK_AGGRO_DISTANCE, found );
+			if( ( int )found.size() != distanceCounts[ i ] ) {
+				mismatches++;
+			}
+		}
+		double hashTime = GetTime() - startTime;
+		
+		printf( "%-10d %12.4f %12.4f %12.4f %12d\n", BENCHMARK_ENEMY_COUNTS[ count ], distanceTime / BENCHMARK_RADIUS_QUERIES,
+		        bitsTime / BENCHMARK_RADIUS_QUERIES, hashTime / BENCHMARK_RADIUS_QUERIES, mismatches );
+	}
+}
+
+
+/*
+=======================
+Main
+The program entry point
+=======================
+*/
+int main( void ) {
+	XYCoords starts[ BENCHMARK_SEARCHES ];
+	XYCoords targets[ BENCHMARK_SEARCHES ];
+	double walkTimes[ BENCHMARK_MAP_COUNT ][ 2 ];
+	long walkSteps[ BENCHMARK_MAP_COUNT ];
+	
+	srand( BENCHMARK_SEED );
+	printf( "%-10s %12s %12s %12s %12s %12s %12s %8s\n", "Map", "Legacy ms", "A* ms", "Legacy nodes", "A* nodes", "Legacy cost", "A* cost", "Found (L/A*/all)" );
+	
+	for( int map = 0; map < BENCHMARK_MAP_COUNT; map++ ) {
+		int worldWidth = BENCHMARK_WIDTHS[ map ];
+		int worldHeight = BENCHMARK_HEIGHTS[ map ];
+		GenerateMap( worldWidth, worldHeight );
+		
+		for( int i = 0; i < BENCHMARK_SEARCHES; i++ ) {
+			starts[ i ] = RandomFreeNode( worldWidth, worldHeight );
+			do {
+				targets[ i ] = RandomFreeNode( worldWidth, worldHeight );
+			} while( targets[ i ] == starts[ i ] );
+		}
+		
+		/* Legacy search */
+		double legacyTime = 0.0;
+		long legacyNodes = 0, legacyCost = 0;
+		int legacyFound = 0;
+		for( int i = 0; i < BENCHMARK_SEARCHES; i++ ) {
+			double startTime = GetTime();
+			XYCoords nextNode = LegacyFindPath( starts[ i ], targets[ i ], worldWidth, worldHeight );
+			legacyTime += GetTime() - startTime;
+			LegacyClearPathfindingArray( worldWidth, worldHeight );
+			
+			legacyNodes += legacyNodesExpanded;
+			if( nextNode.mX != -1 ) {
+				legacyCost += legacyPathCost;
+				legacyFound++;
+			}
+		}
+		
+		/* A* search */
+		double aStarTime = 0.0;
+		long aStarNodes = 0, aStarCost = 0;
+		int found = 0;
+		for( int i = 0; i < BENCHMARK_SEARCHES; i++ ) {
+			double startTime = GetTime();
+			XYCoords nextNode = PATHFINDER->FindPath( starts[ i ], targets[ i ] );
+			aStarTime += GetTime() - startTime;
+			PATHFINDER->ClearPathfindingArray();
+			
+			aStarNodes += PATHFINDER->GetNodesExpanded();
+			if( nextNode.mX != -1 ) {
+				aStarCost += PATHFINDER->GetPathCost();
+				found++;
+			}
+		}
+		
+		printf( "%4d x %-4d %12.3f %12.3f %12ld %12ld %12ld %12ld %4d/%d/%d\n",
+		        worldWidth, worldHeight, legacyTime / BENCHMARK_SEARCHES, aStarTime / BENCHMARK_SEARCHES,
+		        legacyNodes / BENCHMARK_SEARCHES, aStarNodes / BENCHMARK_SEARCHES,
+		        legacyFound ? legacyCost / legacyFound : 0, found ? aStarCost / found : 0, legacyFound, found, BENCHMARK_SEARCHES );
+		
+		/* Walking each route - a FindPath per step against one cached FindFullPath */
+		double stepTime = 0.0, cachedTime = 0.0;
+		long steps = 0;
+		vector< XYCoords > path;
+		for( int i = 0; i < BENCHMARK_SEARCHES; i++ ) {
+			XYCoords position = starts[ i ];
+			double startTime = GetTime();
+			while( position != targets[ i ] ) {
+				XYCoords nextNode = PATHFINDER->FindPath( position, targets[ i ] );
+				PATHFINDER->ClearPathfindingArray();
+				if( nextNode.mX == -1 ) {
+					break;
+				}
+				position = nextNode;
+				steps++;
+			}
+			stepTime += GetTime() - startTime;
+			
+			startTime = GetTime();
+			PATHFINDER->FindFullPath( starts[ i ], targets[ i ], path );
+			cachedTime += GetTime() - startTime;
+		}
+		walkTimes[ map ][ 0 ] = stepTime / BENCHMARK_SEARCHES;
+		walkTimes[ map ][ 1 ] = cachedTime / BENCHMARK_SEARCHES;
+		walkSteps[ map ] = steps / BENCHMARK_SEARCHES;
+	}
+	
+	printf( "\n%-10s %12s %12s %12s\n", "Map", "Per step ms", "Cached ms", "Steps" );
+	for( int map = 0; map < BENCHMARK_MAP_COUNT; map++ ) {
+		printf( "%4d x %-4d %12.3f %12.3f %12ld\n", BENCHMARK_WIDTHS[ map ], BENCHMARK_HEIGHTS[ map ],
+		        walkTimes[ map ][ 0 ], walkTimes[ map ][ 1 ], walkSteps[ map ] );
+	}
+	
+	/* Large maps - whole grid against the hierarchy */
+	BenchmarkLargeMap( false );
+	BenchmarkLargeMap( true );
+	
+	/* Enemies chasing the player */
+	BenchmarkChasers();
+	
+	/* Enemies aggroing at once */
+	BenchmarkRequestQueue();
+	
+	/* Enemies near a node */
+	BenchmarkOccupancy();
+	
+	return 0;
+}
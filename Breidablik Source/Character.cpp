@@ -5,6 +5,13 @@
 #include <stdio.h>
 
 
+/* Per CharacterDirection - the node a step lands on (NE / SE / SW / NW */
+/* differ on odd rows)                                                   */
+static const int CHARACTER_STEP_X_EVEN[ 8 ] = { 0, 0, 1, 0, 0, -1, -1, -1 };
+static const int CHARACTER_STEP_X_ODD[ 8 ] = { 0, 1, 1, 1, 0, 0, -1, 0 };
+static const int CHARACTER_STEP_Y[ 8 ] = { -2, -1, 0, 1, 2, 1, 0, -1 };
+
+
 /*
 ============================================
 Constructor
@@ -22,6 +29,7 @@ Character::Character( float x, float y, float z, int spriteSheetIndex ) :
  mArrayCoords( SCREENVIEW -> GetArrayXYCoords( mX, ( mY + 32.0f ), false ) ),
  mNextCoords( SCREENVIEW -> GetArrayXYCoords( mX, ( mY + 32.0f ), false ) ),
  mTargetCoords( SCREENVIEW -> GetArrayXYCoords( mX, ( mY + 32.0f ), false ) ),
+ pSpatialHash( NULL ),
  mState( IDLE ), mNextState( mState ), mDirection ( SOUTH ), mNextDirection( mDirection ), 
  mIsPathfinding( false ), mIsActive( false ), mIsAlive( true ), mIsDealingDamage( false ) {
 	pCharacterHealthBar = new PS2TexQuad( mX, mY - 36.0f, mZ, mHealthWidth, 8.0f, 0, 160, 64, 8 );
@@ -40,6 +48,13 @@ Abstract class
 ==============
 */
 Character::~Character() {
+	/* Nobody left to collect it */
+	mPathFollower.CancelRequest();
+	
+	/* Nobody left to find */
+	if( pSpatialHash ) {
+		pSpatialHash -> Remove( this, mArrayCoords );
+	}
 }
 
 
@@ -363,10 +378,33 @@ void Character::Animate( void ) {
 SetArrayPosition
 Sets characters position within the pathfinding array
 32 pixels added for character sprites offset
+Moves the character in its spatial hash on a new node
 =====================================================
 */
 void Character::SetArrayPosition( void ) {
-	mArrayCoords = SCREENVIEW -> GetArrayXYCoords( mX, ( mY + 32.0f ), false );
+	XYCoords newCoords = SCREENVIEW -> GetArrayXYCoords( mX, ( mY + 32.0f ), false );
+	if( ( pSpatialHash ) && ( newCoords != mArrayCoords ) ) {
+		pSpatialHash -> Move( this, mArrayCoords, newCoords );
+	}
+	mArrayCoords = newCoords;
+}
+
+
+/*
+================================================
+SetSpatialHash
+Lists the character in spatialHash at its node -
+taking it out of any it was listed in before
+================================================
+*/
+void Character::SetSpatialHash( SpatialHash* spatialHash ) {
+	if( pSpatialHash ) {
+		pSpatialHash -> Remove( this, mArrayCoords );
+	}
+	pSpatialHash = spatialHash;
+	if( pSpatialHash ) {
+		pSpatialHash -> Insert( this, mArrayCoords );
+	}
 }
 
 
@@ -397,6 +435,17 @@ void Character::CheckState( void ) {
 }
 
 
+/*
+==================================================
+GetPathPriority
+Queue priority for this character's path requests
+==================================================
+*/
+int Character::GetPathPriority( void ) {
+	return PATH_PRIORITY_HIGH;
+}
+
+
 /*
 ==========================================================
 SetDirection
@@ -409,8 +458,13 @@ void Character::SetDirection() {
 		/* Only if not in action and there is a target */
 		if( ( ( !mIsActive ) && ( mArrayCoords != mTargetCoords ) && ( !mIsPathfinding ) ) ) {
 			/* Get coords of the next tile */
-			mNextCoords = PATHFINDER -> FindPath( mArrayCoords, mTargetCoords );
-			PATHFINDER -> ClearPathfindingArray();
+			mNextCoords = mPathFollower.GetNextNode( mArrayCoords, mTargetCoords, GetPathPriority() );
+			
+			/* Route still queued - stay put and ask again next frame */
+			if( mPathFollower.IsWaiting() ) {
+				mNextCoords = mArrayCoords;
+				return;
+			}
 			
 			/* Prevent further calls for pathfinding in this cycle */
 			mIsPathfinding = true;
@@ -419,73 +473,7 @@ void Character::SetDirection() {
 			SetState();
 			
 			/* Determine which direction character needs to face */
-			
-			/* Odd condtion - NE/SE/SW/NW are different on odd/even Y rows */
-			bool oddRow = false;
-			if( mArrayCoords.mY % 2 != 0 ) {
-				oddRow = true;
-			} 
-			
-			/* North */
-			if( ( mNextCoords.mX == mArrayCoords.mX ) && ( mNextCoords.mY == ( mArrayCoords.mY - 2 ) ) ) {
-				mNextDirection = NORTH;
-			}
-			/* NorthEast (odd row) */
-			if( oddRow ) {
-				if( ( mNextCoords.mX == ( mArrayCoords.mX + 1 ) ) && ( mNextCoords.mY == ( mArrayCoords.mY - 1 ) ) ) {
-					mNextDirection = NORTH_EAST;
-				}
-			/* NorthEast (even row) */
-			} else {
-				if( ( mNextCoords.mX == mArrayCoords.mX ) && ( mNextCoords.mY == mArrayCoords.mY - 1 ) ) {
-					mNextDirection = NORTH_EAST;
-				}
-			}
-			/* East */
-			if( ( mNextCoords.mX == ( mArrayCoords.mX + 1 ) ) && ( mNextCoords.mY ==  mArrayCoords.mY ) ) {
-				mNextDirection = EAST;
-			}
-			/* SouthEast (odd row) */
-			if( oddRow ) {
-				if( ( mNextCoords.mX == ( mArrayCoords.mX + 1 ) ) && ( mNextCoords.mY == ( mArrayCoords.mY + 1 ) ) ) {
-					mNextDirection = SOUTH_EAST;
-				}
-			/* SouthEast (even row) */
-			} else {
-				if( ( mNextCoords.mX == mArrayCoords.mX ) && ( mNextCoords.mY == mArrayCoords.mY + 1 ) ) {
-					mNextDirection = SOUTH_EAST;
-				}
-			}
-			/* South */
-			if( ( mNextCoords.mX == mArrayCoords.mX ) && ( mNextCoords.mY == ( mArrayCoords.mY + 2 ) ) ) {
-				mNextDirection = SOUTH;
-			}
-			/* SouthWest (odd row) */
-			if( oddRow ) {
-				if( ( mNextCoords.mX == mArrayCoords.mX ) && ( mNextCoords.mY == ( mArrayCoords.mY + 1 ) ) ) {
-					mNextDirection = SOUTH_WEST;
-				}
-			/* SouthWest (even row) */
-			} else {
-				if( ( mNextCoords.mX == ( mArrayCoords.mX - 1 ) ) && ( mNextCoords.mY == mArrayCoords.mY + 1 ) ) {
-					mNextDirection = SOUTH_WEST;
-				}
-			}
-			/* West */
-			if( ( mNextCoords.mX == ( mArrayCoords.mX - 1 ) ) && ( mNextCoords.mY == mArrayCoords.mY ) ) {
-				mNextDirection = WEST;
-			}
-			/* NorthWest (odd row) */
-			if( oddRow ) {
-				if( ( mNextCoords.mX == mArrayCoords.mX ) && ( mNextCoords.mY == ( mArrayCoords.mY - 1 ) ) ) {
-					mNextDirection = NORTH_WEST;
-				}
-			/* NorthWest (even row) */
-			} else {
-				if( ( mNextCoords.mX == ( mArrayCoords.mX - 1 ) ) && ( mNextCoords.mY == mArrayCoords.mY - 1 ) ) {
-					mNextDirection = NORTH_WEST;
-				}
-			}
+			GetStepDirection( mArrayCoords, mNextCoords, mNextDirection );
 			
 			/* Saftey Condition */
 			if( ( mNextCoords.mX == -1 ) || ( mNextCoords.mY == -1 ) ) {
@@ -498,6 +486,26 @@ void Character::SetDirection() {
 }
 
 
+/*
+============================================================
+GetStepDirection
+Sets direction to the step that lands on to from from - odd
+rows move NE / SE / SW / NW differently. Leaves it alone and
+returns false if to isnt one step away
+============================================================
+*/
+bool Character::GetStepDirection( XYCoords from, XYCoords to, CharacterDirection &direction ) {
+	const int* stepX = ( from.mY % 2 != 0 ) ? CHARACTER_STEP_X_ODD : CHARACTER_STEP_X_EVEN;
+	for( int step = 0; step < 8; step++ ) {
+		if( ( to.mX == ( from.mX + stepX[ step ] ) ) && ( to.mY == ( from.mY + CHARACTER_STEP_Y[ step ] ) ) ) {
+			direction = CharacterDirection( step );
+			return true;
+		}
+	}
+	return false;
+}
+
+
 /*
 ===================================================
 PerformAction
@@ -6,6 +6,8 @@
 #include "primitives.h"
 #include "LevelData.h"
 #include "XYCoords.h"
+#include "SpatialHash.h"
+#include "PathFollower.h"
 
 
 /*
@@ -54,11 +56,17 @@ public:
 	/* External Setter for characters target XYCoords */
 	void SetTarget( XYCoords target );
 	
+	/* Adds the character to spatialHash - kept up to date as it moves (NULL to leave) */
+	void SetSpatialHash( SpatialHash* spatialHash );
+	
 	/* External functions for dealing/taking damage */
 	bool CheckIfDealingDamage( void );
 	int WeaponDamage( void ) const;
 	void TakeDamage( int incomingDamage );
 	
+	/* Direction of the single step from one node to the next - false if it isnt one */
+	static bool GetStepDirection( XYCoords from, XYCoords to, CharacterDirection &direction );
+	
 protected:
 	float mHorizontalSpeed, mVerticalSpeed; // movement variables
 	float mHealthWidth;                     // healthbar sprite width
@@ -74,6 +82,10 @@ protected:
 	XYCoords mNextCoords;                   // next node within pathfinding array
 	XYCoords mTargetCoords;                 // target within pathfinding array
 	
+	PathFollower mPathFollower;             // cached route towards mTargetCoords
+	
+	SpatialHash* pSpatialHash;              // grid the character is listed in - NULL if none
+	
 	PS2TexQuad* pCharacterHealthBar;        // health bar sprite
 	PS2TexQuad* pCharacterSprite;           // character sprite
 	PS2Polygon* pCharacterShadow;           // shadow polygon
@@ -89,6 +101,7 @@ protected:
 	bool mIsDealingDamage;                  // flag to signal this character has hit another
 	
 	virtual void SetState( void ) = 0;      // each child class will have a SetState
+	virtual int GetPathPriority( void );    // queue priority of path requests - the player's by default
 	
 	/* Character Logic Functions */
 	void MoveCharacter( void );
@@ -0,0 +1,151 @@
+#include "DisplayList.h"
+#include <algorithm>
+#include <stdio.h>
+
+
+/*
+===========
+Constructor
+Empty list
+===========
+*/
+DisplayList::DisplayList() :
+ mLastShifts( 0 ) {
+}
+
+
+/*
+================
+Destructor
+Tidies up vector
+================
+*/
+DisplayList::~DisplayList() {
+	mEntries.clear();
+}
+
+
+/*
+==============================================
+Clear
+Empties the list - the objects are not deleted
+==============================================
+*/
+void DisplayList::Clear( void ) {
+	mEntries.clear();
+}
+
+
+/*
+=======================================
+Add
+Adds an object to the end of the list -
+the next Sort moves it to its place
+=======================================
+*/
+void DisplayList::Add( GameObject* gameObject ) {
+	if( !gameObject ) {
+		printf( "Illegal DisplayList Object \n" );
+		return;
+	}
+	
+	Entry newEntry;
+	newEntry.mDepth = gameObject -> GetmZ();
+	newEntry.pObject = gameObject;
+	mEntries.push_back( newEntry );
+}
+
+
+/*
+=====================================================================
+Sort
+Reads every depth, then insertion sorts - each entry shifts back past
+the ones now in front of it. Once the shifts average more than
+DISPLAY_SHIFT_LIMIT an entry, the rest is left to a full stable sort
+=====================================================================
+*/
+void DisplayList::Sort( void ) {
+	int entryCount = int( mEntries.size() );
+	for( int i = 0; i < entryCount; i++ ) {
+		mEntries[ i ].mDepth = mEntries[ i ].pObject -> GetmZ();
+	}
+	
+	int shiftLimit = entryCount * DISPLAY_SHIFT_LIMIT;
+	int shifts = 0;
+	for( int i = 1; i < entryCount; i++ ) {
+		Entry entry = mEntries[ i ];
+		int j = i - 1;
+		while( ( j >= 0 ) && ( IsBehind( entry, mEntries[ j ] ) ) ) {
+			mEntries[ j + 1 ] = mEntries[ j ];
+			j--;
+		}
+		mEntries[ j + 1 ] = entry;
+		shifts += ( i - 1 ) - j;
+		
+		/* Too far from last frame's order - not worth carrying on */
+		if( shifts > shiftLimit ) {
+			stable_sort( mEntries.begin(), mEntries.end(), IsBehind );
+			mLastShifts = -1;
+			return;
+		}
+	}
+	mLastShifts = shifts;
+}
+
+
+/*
+============================
+Render
+Renders in order, back first
+============================
+*/
+void DisplayList::Render( void ) {
+	for( int i = 0; i < int( mEntries.size() ); i++ ) {
+		mEntries[ i ].pObject -> Render();
+	}
+}
+
+
+/*
+=============================
+GetCount
+Number of objects in the list
+=============================
+*/
+int DisplayList::GetCount( void ) const {
+	return int( mEntries.size() );
+}
+
+
+/*
+====================================
+GetObject
+Object drawn index-th - after a Sort
+====================================
+*/
+GameObject* DisplayList::GetObject( int index ) const {
+	return mEntries[ index ].pObject;
+}
+
+
+/*
+===========================================
+GetLastShifts
+Entries moved by the last Sort - -1 when it
+fell back to a full sort
+===========================================
+*/
+int DisplayList::GetLastShifts( void ) const {
+	return mLastShifts;
+}
+
+
+/*
+=======================================
+IsBehind
+First is drawn before second - lower mZ
+=======================================
+*/
+bool DisplayList::IsBehind( const Entry &first, const Entry &second ) {
+	return first.mDepth < second.mDepth;
+}
@@ -0,0 +1,60 @@
+#ifndef _DISPLAYLIST_H_
+#define _DISPLAYLIST_H_
+
+
+#include "GameObject.h"
+#include <vector>
+
+
+/* Average entries each object may move past before Sort gives up on */
+/* insertion sort and does a full sort instead                       */
+static const int DISPLAY_SHIFT_LIMIT = 4;
+
+
+/*
+=======================================================================
+DisplayList
+GameObjects in the order they are drawn - back to front, smallest mZ
+first. The list is kept between frames, and characters only change
+depth by a row at a time, so last frame's order is nearly right and
+Sort puts it right with an insertion sort - each object only moves past
+the few it overtook, close to O(N)
+Whole rebuilds, or frames where the order changed a lot, go over
+DISPLAY_SHIFT_LIMIT and are finished with a full sort instead
+Both sorts are stable - objects at the same depth keep their order from
+frame to frame instead of swapping over
+Depths are read once per Sort into the list, beside the pointers
+Objects are not owned - whoever adds them deletes them
+=======================================================================
+*/
+class DisplayList {
+public:
+	DisplayList::DisplayList();
+	DisplayList::~DisplayList();
+	
+	/* Membership - Sort puts new objects in place */
+	void Clear( void );
+	void Add( GameObject* gameObject );
+	
+	void Sort( void );
+	void Render( void );
+	
+	int GetCount( void ) const;
+	GameObject* GetObject( int index ) const;
+	
+	/* Entries moved by the last Sort - -1 if it fell back to a full sort */
+	int GetLastShifts( void ) const;
+
+private:
+	struct Entry {
+		float mDepth;
+		GameObject* pObject;
+	};
+	
+	vector< Entry > mEntries;
+	int mLastShifts;
+	
+	static bool IsBehind( const Entry &first, const Entry &second );
+};
+
+#endif
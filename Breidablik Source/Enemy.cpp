@@ -13,8 +13,7 @@ Generates a random start direction and AITimer
 ===========================================================
 */
 Enemy::Enemy( float x, float y, float z ) :
- Character( x, y, z, 51 ), mAIState( PATROLLING ), mAITimer( 1 ),
- mAtPatrolPosition( false ), mOrigin( mArrayCoords ), mPatrolTarget( mArrayCoords ) {
+ Character( x, y, z, 51 ), mAIState( PATROLLING ) {
 	pCharacterShadow -> Scale( 1.2f );
 	PATHFINDER -> SetObjectNode( mArrayCoords, Node::ENEMY );
 	mWeaponDamage = 6;
@@ -75,7 +74,7 @@ If player gets too close enemies will close in and attack!
 ==========================================================
 */
 void Enemy::CheckAggro( XYCoords playerCoords ) {
-	if( PATHFINDER -> GetObjectDistance( mArrayCoords, playerCoords ) < 134.0f ) {
+	if( PATHFINDER -> IsObjectWithin( mArrayCoords, playerCoords, ENEMY_AGGRO_DISTANCE ) ) {
 		mAIState = AGGROED;
 		mTargetCoords = playerCoords;
 	}
@@ -91,28 +90,9 @@ Then returns to its original location
 */
 void Enemy::Patrol( void ) {
 	if( mAIState == PATROLLING ) {
-		mAITimer++;
-		/* Every small amount of time */
-		if( mAITimer % 300 == 0 ) {
-			/* If at origin - patrol to a random location */
-			if( !mAtPatrolPosition ) {
-				/* Generate a new target (+- 2 tiles) */
-				mPatrolTarget.mX += ( ( rand() % 5 ) - 2 ); 
-				mPatrolTarget.mY += ( ( rand() % 5 ) - 2 ); 
-				/* Only set if its legal */
-				if( PATHFINDER -> IsNodeFree( mPatrolTarget ) ) {
-					SetTarget( mPatrolTarget );
-					mAtPatrolPosition = true;
-				/* Otherwise reset */
-				} else {
-					mPatrolTarget = mArrayCoords;
-				}
-			/* If at a patrol position move back to origin */
-			} else {
-				SetTarget( mOrigin );
-				mAtPatrolPosition = false;
-			}
-			mAITimer = ( ( rand() % 100 ) + 1 ); // reset timer +- ~150
+		XYCoords patrolTarget;
+		if( mPatrol.Update( mArrayCoords, patrolTarget ) ) {
+			SetTarget( patrolTarget );
 		}
 	}
 }
@@ -125,16 +105,51 @@ Determines what state mNextNode requires
 ========================================
 */
 void Enemy::SetState() {
+	mNextState = GetNextState( mNextCoords );
+}
+
+
+/*
+============================================
+GetNextState
+The state an enemy needs to enter nextCoords
+============================================
+*/
+Character::CharacterState Enemy::GetNextState( XYCoords nextCoords ) {
 	/* There is a player - attack! */
-	if ( PATHFINDER -> NodeContainsPlayer( mNextCoords ) ) {
-		mNextState = ATTACKING;
+	if ( PATHFINDER -> NodeContainsPlayer( nextCoords ) ) {
+		return ATTACKING;
 	/* Its free - move! */
-	} else if( PATHFINDER -> IsNodeFree( mNextCoords ) ) {
-		mNextState = MOVING;
+	} else if( PATHFINDER -> IsNodeFree( nextCoords ) ) {
+		return MOVING;
+	}
 	/* Must be blocked/illegal - stay still */
-	} else {
-		mNextState = IDLE;
+	return IDLE;
+}
+
+
+/*
+=================================================
+GetPathPriority
+Chasing the player is searched before patrolling
+=================================================
+*/
+int Enemy::GetPathPriority( void ) {
+	return GetStatePathPriority( mAIState );
+}
+
+
+/*
+==============================================
+GetStatePathPriority
+Queue priority of path requests in an AI state
+==============================================
+*/
+int Enemy::GetStatePathPriority( EnemyState aiState ) {
+	if( aiState == AGGROED ) {
+		return PATH_PRIORITY_NORMAL;
 	}
+	return PATH_PRIORITY_LOW;
 }
 
 
@@ -160,7 +175,7 @@ Creates a random starting direction and AITimer
 */
 void Enemy::RandomStart( void ) {
 	/* Randomise AITimer */
-	mAITimer = ( rand() % 298 + 1);
+	mPatrol.Start( mArrayCoords );
 	
 	/* Randomise initial direction */
 	int randomDirection = rand() % 8;
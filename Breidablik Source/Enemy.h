@@ -4,6 +4,11 @@
 
 #include "Character.h"
 #include "PathController.h"
+#include "EnemyPatrol.h"
+
+
+/* Pixels (as PathController::GetObjectDistance) the player is noticed within */
+static const float ENEMY_AGGRO_DISTANCE = 134.0f;
 
 
 /*
@@ -31,19 +36,19 @@ public:
 	/* External check for becoming aggroed */
 	void CheckAggro( XYCoords playerCoords );
 	
+	/* Enemy rules shared with EnemyStore */
+	static CharacterState GetNextState( XYCoords nextCoords );
+	static int GetStatePathPriority( EnemyState aiState );
+	
 private:
 	EnemyState mAIState;
-	
-	int mAITimer;           // time between patrols
-	bool mAtPatrolPosition; // flag to return to original position
-	
-	XYCoords mOrigin;       // original position
-	XYCoords mPatrolTarget; // patrol position
+	EnemyPatrol mPatrol; // random movement around its starting position
 	
 	/* Enemy Update Fucntions */
 	void Patrol( void );
 	void SetState( void );
 	void UpdatePathfindingPosition( void );  
+	int GetPathPriority( void );
 	
 	void RandomStart( void );
 };
@@ -0,0 +1,78 @@
+#include "EnemyPatrol.h"
+#include "PathController.h"
+#include <stdlib.h>
+
+
+/*
+==========================
+Constructor
+Idle until Start is called
+==========================
+*/
+EnemyPatrol::EnemyPatrol() :
+ mAITimer( 1 ), mAtPatrolPosition( false ), mOrigin( -1, -1 ), mPatrolTarget( -1, -1 ) {
+}
+
+
+/*
+==========
+Destructor
+==========
+*/
+EnemyPatrol::~EnemyPatrol() {
+}
+
+
+/*
+====================================================
+Start
+Sets the origin and a random AITimer so enemies dont
+all patrol on the same frame
+====================================================
+*/
+void EnemyPatrol::Start( XYCoords origin ) {
+	mOrigin = origin;
+	mPatrolTarget = origin;
+	mAtPatrolPosition = false;
+	mAITimer = ( rand() % 298 + 1 );
+}
+
+
+/*
+==================================================
+Update
+Generates a random patrol location and moves to it
+Then returns to its original location
+==================================================
+*/
+bool EnemyPatrol::Update( XYCoords position, XYCoords &newTarget ) {
+	bool moving = false;
+	
+	mAITimer++;
+	/* Every small amount of time */
+	if( mAITimer % 300 == 0 ) {
+		/* If at origin - patrol to a random location */
+		if( !mAtPatrolPosition ) {
+			/* Generate a new target (+- 2 tiles) */
+			mPatrolTarget.mX += ( ( rand() % 5 ) - 2 );
+			mPatrolTarget.mY += ( ( rand() % 5 ) - 2 );
+			/* Only set if its legal */
+			if( PATHFINDER -> IsNodeFree( mPatrolTarget ) ) {
+				newTarget = mPatrolTarget;
+				moving = true;
+				mAtPatrolPosition = true;
+			/* Otherwise reset */
+			} else {
+				mPatrolTarget = position;
+			}
+		/* If at a patrol position move back to origin */
+		} else {
+			newTarget = mOrigin;
+			moving = true;
+			mAtPatrolPosition = false;
+		}
+		mAITimer = ( ( rand() % 100 ) + 1 ); // reset timer +- ~150
+	}
+	
+	return moving;
+}
@@ -0,0 +1,36 @@
+#ifndef _ENEMYPATROL_H_
+#define _ENEMYPATROL_H_
+
+
+#include "XYCoords.h"
+
+
+/*
+==================================================================
+EnemyPatrol
+A patrolling enemy's wander - every so often a random node within
+2 tiles of its origin, then back to the origin again
+Shared by Enemy and EnemyStore so both patrol the same way, drawing
+the same rand() numbers in the same order
+==================================================================
+*/
+class EnemyPatrol {
+public:
+	EnemyPatrol::EnemyPatrol();
+	EnemyPatrol::~EnemyPatrol();
+	
+	/* Patrols around origin - starts the timer at random */
+	void Start( XYCoords origin );
+	
+	/* Steps the timer - true with newTarget set when it is time to move */
+	bool Update( XYCoords position, XYCoords &newTarget );
+
+private:
+	int mAITimer;           // time between patrols
+	bool mAtPatrolPosition; // flag to return to original position
+	
+	XYCoords mOrigin;       // original position
+	XYCoords mPatrolTarget; // patrol position
+};
+
+#endif
@@ -0,0 +1,275 @@
+#include "FlowField.h"
+#include "PathController.h"
+#include <stdio.h>
+
+
+/* Ring of buckets - every move lands within PATH_CORNER_COST of the */
+/* cost being expanded, so no two open costs ever share a bucket     */
+static const int FLOW_BUCKET_COUNT = PATH_CORNER_COST + 1;
+
+
+/*
+==========================
+Constructor
+Empty until Init is called
+==========================
+*/
+FlowField::FlowField() :
+ pPathController( NULL ), mWorldWidth( 0 ), mWorldHeight( 0 ), mFieldId( 0 ), mNodesReached( 0 ), mDirty( true ) {
+}
+
+
+/*
+=================
+Destructor
+Tidies up vectors
+=================
+*/
+FlowField::~FlowField() {
+	mBuckets.clear();
+}
+
+
+/*
+=======================================================
+Init
+Sizes the per node data once so a build never allocates
+=======================================================
+*/
+void FlowField::Init( PathController* pathController, int worldWidth, int worldHeight ) {
+	pPathController = pathController;
+	mWorldWidth = worldWidth;
+	mWorldHeight = worldHeight;
+	
+	int nodeCount = mWorldWidth * mWorldHeight;
+	mFieldStamp.assign( nodeCount, 0 );
+	mFieldId = 0;
+	mCost.resize( nodeCount );
+	mStep.resize( nodeCount );
+	
+	mBuckets.clear();
+	mBuckets.resize( FLOW_BUCKET_COUNT );
+	mGoals.clear();
+	mNodesReached = 0;
+	mDirty = true;
+}
+
+
+/*
+====================================
+InvalidateAll
+New level - build on the next Update
+====================================
+*/
+void FlowField::InvalidateAll( void ) {
+	mDirty = true;
+}
+
+
+/*
+====================================================
+InvalidateNode
+A node was blocked / unblocked - only matters if the
+field reaches it (or its neighbours, when unblocked)
+====================================================
+*/
+void FlowField::InvalidateNode( int nodeIndex ) {
+	if( mDirty ) {
+		return;
+	}
+	
+	/* Blocked inside the field */
+	if( IsInField( nodeIndex ) ) {
+		mDirty = true;
+		return;
+	}
+	
+	/* Unblocked next to it - could be a shorter way through */
+	int neighbours[ 8 ], costs[ 8 ];
+	int neighbourCount = pPathController -> GetNeighbours( nodeIndex, neighbours, costs );
+	for( int i = 0; i < neighbourCount; i++ ) {
+		if( IsInField( neighbours[ i ] ) ) {
+			mDirty = true;
+			return;
+		}
+	}
+}
+
+
+/*
+====================================================
+Update
+Builds from a single goal - nothing to do while the
+goal stays on the same node and nothing has changed
+Otherwise the whole field inside the radius is built
+again
+====================================================
+*/
+bool FlowField::Update( int goalIndex ) {
+	if( ( !mDirty ) && ( mGoals.size() == 1 ) && ( mGoals[ 0 ] == goalIndex ) ) {
+		return false;
+	}
+	
+	mGoals.clear();
+	mGoals.push_back( goalIndex );
+	Build();
+	return true;
+}
+
+
+/*
+===================================================
+Update
+Builds from several goals - each node leads towards
+whichever is cheapest to reach
+===================================================
+*/
+bool FlowField::Update( const vector< int > &goals ) {
+	if( ( !mDirty ) && ( mGoals == goals ) ) {
+		return false;
+	}
+	
+	mGoals = goals;
+	Build();
+	return true;
+}
+
+
+/*
+==============================
+GetCost
+Cost from the node to its goal
+==============================
+*/
+int FlowField::GetCost( int nodeIndex ) const {
+	if( IsInField( nodeIndex ) ) {
+		return mCost[ nodeIndex ];
+	}
+	return -1;
+}
+
+
+/*
+================================
+GetStep
+Next node on the way to the goal
+================================
+*/
+int FlowField::GetStep( int nodeIndex ) const {
+	if( IsInField( nodeIndex ) ) {
+		return mStep[ nodeIndex ];
+	}
+	return -1;
+}
+
+
+/*
+==============================
+GetGoal
+Returns the field's first goal
+==============================
+*/
+int FlowField::GetGoal( void ) const {
+	if( mGoals.empty() ) {
+		return -1;
+	}
+	return mGoals[ 0 ];
+}
+
+
+/*
+====================================
+GetNodesReached
+Nodes given a cost by the last build
+====================================
+*/
+int FlowField::GetNodesReached( void ) const {
+	return mNodesReached;
+}
+
+
+/*
+========================================================================
+Build
+Dijkstra out from every goal at once, stopping at FLOW_FIELD_RADIUS
+Open nodes sit in the bucket for their cost, and the buckets are emptied
+in cost order - a node reached again more cheaply is just added to the
+cheaper bucket, and its old entry skipped when its bucket comes round
+========================================================================
+*/
+void FlowField::Build( void ) {
+	int neighbours[ 8 ], costs[ 8 ];
+	int openCount = 0;
+	
+	/* New build - older stamps now read as outside the field */
+	mFieldId++;
+	if( mFieldId == 0 ) {
+		mFieldStamp.assign( mFieldStamp.size(), 0 );
+		mFieldId = 1;
+	}
+	mNodesReached = 0;
+	mDirty = false;
+	
+	for( int i = 0; i < ( int )mGoals.size(); i++ ) {
+		int goalIndex = mGoals[ i ];
+		if( ( goalIndex < 0 ) || ( goalIndex >= ( int )mFieldStamp.size() ) ) {
+			printf( "Illegal Flow Field Goal \n" );
+			continue;
+		}
+		if( mFieldStamp[ goalIndex ] != mFieldId ) {
+			mFieldStamp[ goalIndex ] = mFieldId;
+			mCost[ goalIndex ] = 0;
+			mStep[ goalIndex ] = -1;
+			mBuckets[ 0 ].push_back( goalIndex );
+			openCount++;
+		}
+	}
+	
+	for( int cost = 0; ( openCount > 0 ) && ( cost <= FLOW_FIELD_RADIUS ); cost++ ) {
+		/* Moves cost more than 0, so nothing is added to this bucket while it is emptied */
+		vector< int > &bucket = mBuckets[ cost % FLOW_BUCKET_COUNT ];
+		for( int i = 0; i < ( int )bucket.size(); i++ ) {
+			int nodeIndex = bucket[ i ];
+			openCount--;
+			
+			/* Reached more cheaply since it was added */
+			if( mCost[ nodeIndex ] != cost ) {
+				continue;
+			}
+			mNodesReached++;
+			
+			int neighbourCount = pPathController -> GetNeighbours( nodeIndex, neighbours, costs );
+			for( int j = 0; j < neighbourCount; j++ ) {
+				int nextIndex = neighbours[ j ];
+				int nextCost = cost + costs[ j ];
+				if( nextCost > FLOW_FIELD_RADIUS ) {
+					continue;
+				}
+				
+				/* Moves are the same both ways, so stepping back to nodeIndex heads for the goal */
+				if( ( mFieldStamp[ nextIndex ] != mFieldId ) || ( nextCost < mCost[ nextIndex ] ) ) {
+					mFieldStamp[ nextIndex ] = mFieldId;
+					mCost[ nextIndex ] = nextCost;
+					mStep[ nextIndex ] = nodeIndex;
+					mBuckets[ nextCost % FLOW_BUCKET_COUNT ].push_back( nextIndex );
+					openCount++;
+				}
+			}
+		}
+		bucket.clear();
+	}
+}
+
+
+/*
+=========================
+IsInField
+Stamped by the last build
+=========================
+*/
+bool FlowField::IsInField( int nodeIndex ) const {
+	if( ( nodeIndex < 0 ) || ( nodeIndex >= ( int )mFieldStamp.size() ) ) {
+		return false;
+	}
+	return ( mFieldStamp[ nodeIndex ] == mFieldId ) && ( mFieldId != 0 );
+}
@@ -0,0 +1,85 @@
+#ifndef _FLOWFIELD_H_
+#define _FLOWFIELD_H_
+
+
+#include "LevelData.h"
+#include <vector>
+
+
+/* Field Data                                                            */
+/* Costs are in the same units as PathController's moves (~pixels) - the */
+/* field reaches further than ENEMY_AGGRO_DISTANCE (134 pixels) so       */
+/* an enemy in range still finds its way around a wall between them      */
+static const int FLOW_FIELD_RADIUS = 512; // eight corner moves
+
+
+class PathController;
+
+
+/*
+=========================================================================
+FlowField
+Shared route to a goal (the player) for every character chasing it -
+owned by PathController
+One Dijkstra outwards from the goal nodes gives each node within
+FLOW_FIELD_RADIUS its cost to the nearest goal and the neighbour one move
+closer, so a chaser reads its next step instead of searching
+Moves only cost PATH_EDGE_COST or PATH_CORNER_COST, so the open set is a
+ring of buckets by cost (Dial's algorithm) rather than a heap
+Like the A* data, each node is stamped with the build it belongs to, so a
+build only touches the nodes inside the radius. It is only built again
+when the goal moves or a node inside it is blocked / unblocked, and then
+the whole field is built again from the goals - there is no incremental
+repair, one blocked node costs as much as the player moving
+=========================================================================
+*/
+class FlowField {
+public:
+	FlowField::FlowField();
+	FlowField::~FlowField();
+	
+	void Init( PathController* pathController, int worldWidth, int worldHeight );
+	
+	/* Build again on the next Update */
+	void InvalidateAll( void );
+	void InvalidateNode( int nodeIndex );
+	
+	/* Builds the field out from goalIndex if it moved or was invalidated */
+	/* Returns true if it was built                                       */
+	bool Update( int goalIndex );
+	bool Update( const vector< int > &goals );
+	
+	/* -1 if the node is outside the field */
+	int GetCost( int nodeIndex ) const;
+	
+	/* Neighbour one move closer to a goal - -1 outside the field or at a goal */
+	int GetStep( int nodeIndex ) const;
+	
+	/* First goal of the last build - -1 before any */
+	int GetGoal( void ) const;
+	
+	/* Nodes reached by the last build */
+	int GetNodesReached( void ) const;
+
+private:
+	PathController* pPathController;
+	
+	int mWorldWidth, mWorldHeight;
+	
+	/* Indexed by node, only valid where mFieldStamp matches mFieldId */
+	vector< unsigned int > mFieldStamp;
+	unsigned int mFieldId;
+	vector< int > mCost;
+	vector< int > mStep;
+	
+	vector< vector< int > > mBuckets; // open nodes by cost % FLOW_BUCKET_COUNT
+	vector< int > mGoals;
+	
+	int mNodesReached;
+	bool mDirty;
+	
+	void Build( void );
+	bool IsInField( int nodeIndex ) const;
+};
+
+#endif
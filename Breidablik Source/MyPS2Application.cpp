@@ -93,6 +93,7 @@ void MyPS2Application::Init() {
 	GAMETEXTURES -> Init(); 
 	SCREENVIEW -> Init();
 	PATHFINDER -> Init();
+	mEnemyHash.Init( LEVEL_ONE_WIDTH, LEVEL_ONE_HEIGHT );
 	
 	/* Setup Level One */
 	pCurrentMap = new Map( LEVEL_ONE_WIDTH, LEVEL_ONE_HEIGHT ); 
@@ -105,6 +106,7 @@ void MyPS2Application::Init() {
 	
 	/* Setup GameObjects */
 	pPlayer = new Player( 0.0f, 0.0f, 1000.0f );
+	mDisplayListChanged = true;
 	SetupEnemies();
 	SetupObjects();
 	CreateGameSprites();
@@ -147,11 +149,8 @@ void MyPS2Application::CleanUp() {
 	}
 	mObjects.clear();
 	
-	/* Priority Queue of pointers */
-	while( !mDisplayVector.empty() ) {
-		delete mDisplayVector.top();
-		mDisplayVector.pop();
-	}
+	/* Display List - only points at the objects deleted above */
+	mDisplayList.Clear();
 	
 	/* PS2 Stuff */
 	pad_cleanup( PAD_0 );
@@ -214,11 +213,14 @@ void MyPS2Application::Update() {
 		UpdateEnemies( pPlayer -> GetArrayXYCoords() ); 
 		CheckEnemyHits();
 		
+		/* Searches queued by the player and enemies - within the frame's budget */
+		PATHFINDER -> ProcessPathRequests();
+		
 		/* UpdateObjects as SCREENVIEW moves */
 		UpdateObjects();
 		
-		/* Fill vector in correct order for rendering */
-		UpdateDisplayVector();
+		/* Sort objects in correct order for rendering */
+		UpdateDisplayList();
 		
 		/* Update Cursor */
 		mCursor.Update( LXAxisVal, LYAxisVal ); 
@@ -256,7 +258,7 @@ void MyPS2Application::Render() {
 		SCREENVIEW -> Draw( pCurrentMap -> mWorldMap );
 		
 		/* Render GameObjects */
-		RenderDisplayVector();
+		RenderDisplayList();
 		
 		/* Render Cursor */
 		mCursor.Render();
@@ -415,6 +417,7 @@ void MyPS2Application::ResetGame( void ) {
 	if( pPlayer ) {
 		delete pPlayer;
 		pPlayer = new Player( 0.0f, 0.0f, 1000.0f );
+		mDisplayListChanged = true;
 	}
 	
 	/* Delete Enemies Vector */
@@ -442,7 +445,7 @@ Adds a new enemy if selected
 ============================
 */
 void MyPS2Application::HardCoreMode( void ) {
-	mEnemies.push_back( new Enemy( 192.0f, -64.0f, 1000.0f ) );
+	AddEnemy( 192.0f, -64.0f, 1000.0f );
 }
 
 
@@ -455,11 +458,10 @@ Check if player has hit any of the enemies
 void MyPS2Application::CheckPlayerHits( void ) {
 	/* If the player is at teh correct attack animation frame */
 	if( pPlayer -> CheckIfDealingDamage() ) {
-		for( int i = 0; i < int( mEnemies.size() ); i++ ) {
-			/* If the players target is the enemies position */
-			if( pPlayer -> GetTargetXYCoords() == mEnemies[ i ] -> GetArrayXYCoords() ) {
-				mEnemies[ i ] -> TakeDamage( pPlayer -> WeaponDamage() );
-			}
+		/* Enemies on the players target */
+		mEnemyHash.QueryNode( pPlayer -> GetTargetXYCoords(), mNearbyEnemies );
+		for( int i = 0; i < int( mNearbyEnemies.size() ); i++ ) {
+			mNearbyEnemies[ i ] -> TakeDamage( pPlayer -> WeaponDamage() );
 		}
 	}
 }
@@ -472,8 +474,22 @@ Creates the level enemies and pushes them to the mEnemies vector
 ================================================================
 */
 void MyPS2Application::SetupEnemies( void ) {
-	mEnemies.push_back( new Enemy( 192.0f, 32.0f, 1000.0f ) );
-	mEnemies.push_back( new Enemy( -192.0f, 0.0f, 1000.0f ) );
+	AddEnemy( 192.0f, 32.0f, 1000.0f );
+	AddEnemy( -192.0f, 0.0f, 1000.0f );
+}
+
+
+/*
+===========================================
+AddEnemy
+Creates an enemy and lists it in mEnemyHash
+===========================================
+*/
+void MyPS2Application::AddEnemy( float x, float y, float z ) {
+	Enemy* newEnemy = new Enemy( x, y, z );
+	newEnemy -> SetSpatialHash( &mEnemyHash );
+	mEnemies.push_back( newEnemy );
+	mDisplayListChanged = true;
 }
 
 
@@ -484,8 +500,18 @@ Updates all the enemies and checks if the player has moved too close
 ====================================================================
 */
 void MyPS2Application::UpdateEnemies( XYCoords playerPosition ) {
+	/* One route to the player for every enemy chasing it - none near, nothing to build */
+	if( PATHFINDER -> AnyEnemyWithin( playerPosition, float( FLOW_FIELD_RADIUS ) ) ) {
+		PATHFINDER -> UpdateFlowField( playerPosition );
+	}
+	
+	/* Only enemies within their aggro distance can notice the player */
+	mEnemyHash.QueryRadius( playerPosition, ENEMY_AGGRO_DISTANCE, mNearbyEnemies );
+	for( int i = 0; i < int( mNearbyEnemies.size() ); i++ ) {
+		static_cast< Enemy* >( mNearbyEnemies[ i ] ) -> CheckAggro( playerPosition );
+	}
+	
 	for( int i = 0; i < int( mEnemies.size() ); i++ ) {
-		mEnemies[ i ] -> CheckAggro( playerPosition );
 		mEnemies[ i ] -> Update();
 	}
 }
@@ -498,12 +524,14 @@ Check if any of the enemies have hit the player
 ===============================================
 */
 void MyPS2Application::CheckEnemyHits( void ) {
-	for( int i = 0; i < int( mEnemies.size() ); i++ ) {
+	/* Enemies only target the player from within their aggro distance */
+	mEnemyHash.QueryRadius( pPlayer -> GetArrayXYCoords(), ENEMY_AGGRO_DISTANCE, mNearbyEnemies );
+	for( int i = 0; i < int( mNearbyEnemies.size() ); i++ ) {
 		/* If the enemy is in the correct attack animation frame */
-		if( mEnemies[ i ] -> CheckIfDealingDamage() ) {
+		if( mNearbyEnemies[ i ] -> CheckIfDealingDamage() ) {
 			/* If the enemies target is the players position */
-			if( mEnemies[ i ] -> GetTargetXYCoords() == pPlayer -> GetArrayXYCoords() ) {
-				pPlayer -> TakeDamage( mEnemies[ i ] -> WeaponDamage() );
+			if( mNearbyEnemies[ i ] -> GetTargetXYCoords() == pPlayer -> GetArrayXYCoords() ) {
+				pPlayer -> TakeDamage( mNearbyEnemies[ i ] -> WeaponDamage() );
 			}
 		}
 	}
@@ -522,6 +550,7 @@ void MyPS2Application::SetupObjects( void ) {
 	mObjects.push_back( new Object( 256.0f, 0.0f, 1000.0f, 128.0f, 192.0f, 128, 64, 128, 192, 64.0f, 10 ) );  // tree2
 	mObjects.push_back( new Object( 196.0f, -160.0f, 1000.0f, 128.0f, 192.0f, 0, 64, 128, 192, 64.0f, 9 ) );  // tree3 
 	mObjects.push_back( new Object( 64.0f, -128.0f, 1000.0f, 128.0f, 192.0f, 128, 64, 128, 192, 64.0f, 9 ) ); // tree4
+	mDisplayListChanged = true;
 }
 
 
@@ -539,38 +568,41 @@ void MyPS2Application::UpdateObjects( void ) {
 
 
 /*
-====================================================================
-UpdateDisplayVector
-Update with all the games sprites to be sorted and rendered by depth
-====================================================================
+======================================================================
+UpdateDisplayList
+Lists all the games sprites again if any were added or replaced, then
+re-sorts them by depth - last frame's order is nearly right already
+======================================================================
 */
-void MyPS2Application::UpdateDisplayVector( void ) {
-	/* Add Player */
-	mDisplayVector.push( pPlayer );
-	
-	/* Add Enemies */
-	for( int i = 0; i < int( mEnemies.size() ); i++ ) {
-		mDisplayVector.push( mEnemies[ i ] );
+void MyPS2Application::UpdateDisplayList( void ) {
+	if( mDisplayListChanged ) {
+		mDisplayList.Clear();
+		
+		/* Add Player */
+		mDisplayList.Add( pPlayer );
+		
+		/* Add Enemies */
+		for( int i = 0; i < int( mEnemies.size() ); i++ ) {
+			mDisplayList.Add( mEnemies[ i ] );
+		}
+		
+		/* Add Objects */
+		for( int i = 0; i < int( mObjects.size() ); i++ ) {
+			mDisplayList.Add( mObjects[ i ] );
+		}
+		mDisplayListChanged = false;
 	}
 	
-	/* Add Objects */
-	for( int i = 0; i < int( mObjects.size() ); i++ ) {
-		mDisplayVector.push( mObjects[ i ] );
-	}
+	mDisplayList.Sort();
 }
 
 
 /* 
-===================================================
-RenderDisplayVector
-Renders the priority queue which is sorted by depth
-===================================================
+===============================================
+RenderDisplayList
+Renders the display list - back to front
+===============================================
 */
-void MyPS2Application::RenderDisplayVector( void ) {
-	while( !mDisplayVector.empty() ) {
-		if( mDisplayVector.top() ) {
-			mDisplayVector.top() -> Render(); // render top
-			mDisplayVector.pop();             // pop it
-		}
-	}
+void MyPS2Application::RenderDisplayList( void ) {
+	mDisplayList.Render();
 }
\ No newline at end of file
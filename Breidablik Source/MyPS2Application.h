@@ -14,24 +14,11 @@
 #include "Menu.h"
 #include "Cursor.h"
 #include "XYCoords.h"
-#include <queue>
+#include "SpatialHash.h"
+#include "DisplayList.h"
 #include <vector>
 
 
-/*
-========================================================================
-Comparator
-DisplayVector wont use regular operator overload as it contains pointers
-========================================================================
-*/
-struct Comparator {
-	/* Comparator for DisplayVector DepthSorting */
-	bool operator () ( GameObject* G1, GameObject* G2) {
-		return G1 -> GetmZ() > G2 -> GetmZ(); 
-	}
-};
-
-	
 /*
 ===========================================================================================
 MyPS2Application - Main Game Class
@@ -90,12 +77,13 @@ private:
 	
 	Player* pPlayer;                             // players character
 	vector< Enemy* > mEnemies;                   // levels enemies
+	SpatialHash mEnemyHash;                      // enemies by node - for aggro / hit checks
+	vector< Character* > mNearbyEnemies;         // mEnemyHash query results
 	vector< Object* > mObjects;                  // level objects
 	vector< PS2TexQuad* > mGameSprites;          // game sprites
 	
-	priority_queue< GameObject*,
-                	vector< GameObject* >, 
-					Comparator > mDisplayVector; // priority vector from depth sorting
+	DisplayList mDisplayList;                    // depth sorted draw order - kept between frames
+	bool mDisplayListChanged;                    // objects added / replaced since it was filled
 	
 	Menu mMenu;                                  // handles menu drawing and options
 	LevelData mLevelData;                        // container for tile and map data
@@ -125,6 +113,7 @@ private:
 	
 	/* Enemy Functions */
 	void SetupEnemies( void );
+	void AddEnemy( float x, float y, float z );
 	void UpdateEnemies( XYCoords playerPosition );
 	void CheckEnemyHits( void );
 	
@@ -133,8 +122,8 @@ private:
 	void UpdateObjects( void );
 	
 	/* Object DepthSorting Functions */
-	void UpdateDisplayVector( void );
-	void RenderDisplayVector( void );
+	void UpdateDisplayList( void );
+	void RenderDisplayList( void );
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,250 @@
+#include "OccupancyGrid.h"
+#include <math.h>
+
+
+/*
+==========================
+Constructor
+Empty until Init is called
+==========================
+*/
+OccupancyGrid::OccupancyGrid() :
+ mWorldWidth( 0 ), mWorldHeight( 0 ), mWordsPerRow( 0 ), mPlaneWords( 0 ) {
+}
+
+
+/*
+================
+Destructor
+Tidies up vector
+================
+*/
+OccupancyGrid::~OccupancyGrid() {
+	mWords.clear();
+}
+
+
+/*
+==========================================
+Init
+Sizes the planes for the level - all empty
+==========================================
+*/
+void OccupancyGrid::Init( int worldWidth, int worldHeight ) {
+	mWorldWidth = worldWidth;
+	mWorldHeight = worldHeight;
+	mWordsPerRow = ( mWorldWidth + 31 ) / 32;
+	mPlaneWords = mWordsPerRow * mWorldHeight;
+	mWords.assign( mPlaneWords * PLANE_COUNT, 0 );
+}
+
+
+/*
+=================
+Set
+Sets a node's bit
+=================
+*/
+void OccupancyGrid::Set( Plane plane, int x, int y ) {
+	mWords[ ( plane * mPlaneWords ) + ( y * mWordsPerRow ) + ( x >> 5 ) ] |= ( 1u << ( x & 31 ) );
+}
+
+
+/*
+===================
+Clear
+Clears a node's bit
+===================
+*/
+void OccupancyGrid::Clear( Plane plane, int x, int y ) {
+	mWords[ ( plane * mPlaneWords ) + ( y * mWordsPerRow ) + ( x >> 5 ) ] &= ~( 1u << ( x & 31 ) );
+}
+
+
+/*
+==================
+Test
+Reads a node's bit
+==================
+*/
+bool OccupancyGrid::Test( Plane plane, int x, int y ) const {
+	return ( mWords[ ( plane * mPlaneWords ) + ( y * mWordsPerRow ) + ( x >> 5 ) ] & ( 1u << ( x & 31 ) ) ) != 0;
+}
+
+
+/*
+=========================================
+TestObject
+Node holds the player / enemy / objective
+=========================================
+*/
+bool OccupancyGrid::TestObject( int x, int y ) const {
+	int word = ( y * mWordsPerRow ) + ( x >> 5 );
+	unsigned int objects = mWords[ ( PLAYER * mPlaneWords ) + word ] | mWords[ ( ENEMY * mPlaneWords ) + word ] |
+	                       mWords[ ( OBJECTIVE * mPlaneWords ) + word ];
+	return ( objects & ( 1u << ( x & 31 ) ) ) != 0;
+}
+
+
+/*
+=============================
+ClearObject
+Node no longer holds anything
+=============================
+*/
+void OccupancyGrid::ClearObject( int x, int y ) {
+	Clear( PLAYER, x, y );
+	Clear( ENEMY, x, y );
+	Clear( OBJECTIVE, x, y );
+}
+
+
+/*
+=======================
+ClearPlane
+Clears every node's bit
+=======================
+*/
+void OccupancyGrid::ClearPlane( Plane plane ) {
+	for( int i = 0; i < mPlaneWords; i++ ) {
+		mWords[ ( plane * mPlaneWords ) + i ] = 0;
+	}
+}
+
+
+/*
+============================================
+AnyWithin
+Stops at the first word with a node in range
+============================================
+*/
+bool OccupancyGrid::AnyWithin( Plane plane, XYCoords position, float distance ) const {
+	return SearchWithin( plane, position, distance, true ) > 0;
+}
+
+
+/*
+==================================
+CountWithin
+Nodes set in plane within distance
+==================================
+*/
+int OccupancyGrid::CountWithin( Plane plane, XYCoords position, float distance ) const {
+	return SearchWithin( plane, position, distance, false );
+}
+
+
+/*
+====================================================================
+SearchWithin
+Masks the run of nodes in range on each row near position and tests
+them a word at a time - counts the bits set, or returns 1 as soon as
+one is found when stopAtFirst
+====================================================================
+*/
+int OccupancyGrid::SearchWithin( Plane plane, XYCoords position, float distance, bool stopAtFirst ) const {
+	if( ( distance <= 0.0f ) || ( position.mX < 0 ) || ( position.mX >= mWorldWidth ) || ( position.mY < 0 ) || ( position.mY >= mWorldHeight ) ) {
+		return 0;
+	}
+	
+	/* Rows are 32 pixels apart */
+	int rowReach = int( distance / 32.0f ) + 1;
+	int minY = ( position.mY - rowReach < 0 ) ? 0 : position.mY - rowReach;
+	int maxY = ( position.mY + rowReach >= mWorldHeight ) ? mWorldHeight - 1 : position.mY + rowReach;
+	float distanceSquared = distance * distance;
+	int found = 0;
+	
+	for( int y = minY; y <= maxY; y++ ) {
+		int minX, maxX;
+		if( !GetRowSpan( position, distanceSquared, y, minX, maxX ) ) {
+			continue;
+		}
+		
+		const unsigned int* row = &mWords[ ( plane * mPlaneWords ) + ( y * mWordsPerRow ) ];
+		int firstWord = minX >> 5;
+		int lastWord = maxX >> 5;
+		for( int i = firstWord; i <= lastWord; i++ ) {
+			/* Only the bits of the run */
+			unsigned int mask = 0xffffffffu;
+			if( i == firstWord ) {
+				mask &= ( 0xffffffffu << ( minX & 31 ) );
+			}
+			if( i == lastWord ) {
+				mask &= ( 0xffffffffu >> ( 31 - ( maxX & 31 ) ) );
+			}
+			
+			unsigned int word = row[ i ] & mask;
+			if( word != 0 ) {
+				if( stopAtFirst ) {
+					return 1;
+				}
+				found += CountBits( word );
+			}
+		}
+	}
+	
+	return found;
+}
+
+
+/*
+====================================================================
+GetRowSpan
+Columns of row y whose squared pixel distance from position is below
+distanceSquared - they are always one run, false if there are none
+The float estimate is corrected with the exact integer test
+====================================================================
+*/
+bool OccupancyGrid::GetRowSpan( XYCoords position, float distanceSquared, int y, int &minX, int &maxX ) const {
+	int centreX = ( position.mX * 64 ) + ( ( position.mY % 2 != 0 ) ? 32 : 0 );
+	int rowOffset = ( y % 2 != 0 ) ? 32 : 0;
+	int dy = ( y - position.mY ) * 32;
+	float remaining = distanceSquared - float( dy * dy );
+	if( remaining <= 0.0f ) {
+		return false;
+	}
+	
+	/* Estimate - |( x * 64 ) + rowOffset - centreX| < reach */
+	float reach = float( sqrt( remaining ) );
+	minX = int( floor( ( centreX - rowOffset - reach ) / 64.0f ) );
+	maxX = int( ceil( ( centreX - rowOffset + reach ) / 64.0f ) );
+	if( minX < 0 ) {
+		minX = 0;
+	}
+	if( maxX >= mWorldWidth ) {
+		maxX = mWorldWidth - 1;
+	}
+	
+	/* Exact - trim the ends that are out of range */
+	while( minX <= maxX ) {
+		int dx = ( minX * 64 ) + rowOffset - centreX;
+		if( float( ( dx * dx ) + ( dy * dy ) ) < distanceSquared ) {
+			break;
+		}
+		minX++;
+	}
+	while( maxX >= minX ) {
+		int dx = ( maxX * 64 ) + rowOffset - centreX;
+		if( float( ( dx * dx ) + ( dy * dy ) ) < distanceSquared ) {
+			break;
+		}
+		maxX--;
+	}
+	
+	return minX <= maxX;
+}
+
+
+/*
+==================================================
+CountBits
+Bits set in a word - adds neighbouring bits in
+pairs, then fours, then bytes, then sums the bytes
+==================================================
+*/
+int OccupancyGrid::CountBits( unsigned int word ) const {
+	word = word - ( ( word >> 1 ) & 0x55555555u );
+	word = ( word & 0x33333333u ) + ( ( word >> 2 ) & 0x33333333u );
+	word = ( word + ( word >> 4 ) ) & 0x0f0f0f0fu;
+	return int( ( word * 0x01010101u ) >> 24 );
+}
@@ -0,0 +1,68 @@
+#ifndef _OCCUPANCYGRID_H_
+#define _OCCUPANCYGRID_H_
+
+
+#include "XYCoords.h"
+#include "LevelData.h"
+#include <vector>
+
+
+/*
+===========================================================================
+OccupancyGrid
+What each node of the level holds, one bit per node per plane - owned by
+PathController, which keeps it matching mPathfindingArray
+Each plane is a row after row of 32 bit words, row y starting at word
+y * mWordsPerRow, so a node is bit ( x % 32 ) of word x / 32 of its row.
+All the planes share one allocation, apart from the search data
+Radius queries test whole words at once - the nodes of a row within the
+distance are one run of bits, so each row costs a word or two however
+many characters there are
+Distances are in pixels as PathController::GetObjectDistance measures
+them - rows 32 apart, columns 64 apart, odd rows 32 to the right
+===========================================================================
+*/
+class OccupancyGrid {
+public:
+	OccupancyGrid::OccupancyGrid();
+	OccupancyGrid::~OccupancyGrid();
+	
+	/* One plane per state */
+	enum Plane {
+		BLOCKED,
+		PLAYER,
+		ENEMY,
+		OBJECTIVE,
+		PLANE_COUNT
+	};
+	
+	/* Every plane empty */
+	void Init( int worldWidth, int worldHeight );
+	
+	/* Single nodes - positions must be in range */
+	void Set( Plane plane, int x, int y );
+	void Clear( Plane plane, int x, int y );
+	bool Test( Plane plane, int x, int y ) const;
+	bool TestObject( int x, int y ) const; // player, enemy or objective
+	void ClearObject( int x, int y );
+	
+	/* Whole planes */
+	void ClearPlane( Plane plane );
+	
+	/* Nodes set in plane less than distance from position */
+	bool AnyWithin( Plane plane, XYCoords position, float distance ) const;
+	int CountWithin( Plane plane, XYCoords position, float distance ) const;
+
+private:
+	int mWorldWidth, mWorldHeight;
+	int mWordsPerRow;
+	int mPlaneWords;
+	vector< unsigned int > mWords; // plane after plane
+	
+	/* Radius Functions */
+	int SearchWithin( Plane plane, XYCoords position, float distance, bool stopAtFirst ) const;
+	bool GetRowSpan( XYCoords position, float distanceSquared, int y, int &minX, int &maxX ) const;
+	int CountBits( unsigned int word ) const;
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include "PathController.h"
 #include "LevelData.h"
 #include <stdio.h>
+#include <math.h>
 
 
 PathController* PathController::instance = NULL;
@@ -13,7 +14,8 @@ Sets level boundary variables
 =============================
 */
 PathController::PathController() :
- mWorldWidth( LEVEL_ONE_WIDTH ), mWorldHeight( LEVEL_ONE_HEIGHT ), mTargetFound( false ) {
+ mWorldWidth( LEVEL_ONE_WIDTH ), mWorldHeight( LEVEL_ONE_HEIGHT ), mSearchId( 0 ), mUseHierarchy( false ),
+ mNextRequestId( 0 ), mPathBudget( PATH_FRAME_BUDGET ), mFrameNodesExpanded( 0 ), mNodesExpanded( 0 ), mPathCost( 0 ), mObstacleStamp( 0 ) {
 }
 
 
@@ -49,6 +51,20 @@ Creates 2D vector
 =================
 */
 void PathController::Init( void ) {
+	Init( LEVEL_ONE_WIDTH, LEVEL_ONE_HEIGHT );
+}
+
+
+/*
+==========================================
+Init
+Creates 2D vector and A* data for any size
+==========================================
+*/
+void PathController::Init( int worldWidth, int worldHeight ) {
+	mWorldWidth = worldWidth;
+	mWorldHeight = worldHeight;
+	
 	/* Setup up 2D vectors */
 	mPathfindingArray.clear(); 
 	for( int y = 0; y < mWorldHeight; y++ ) {
@@ -57,6 +73,29 @@ void PathController::Init( void ) {
 		tempGridRow.resize( mWorldWidth );
 		mPathfindingArray.push_back( tempGridRow );
 	}
+	
+	/* One entry per node - sized once so searches never allocate */
+	int nodeCount = mWorldWidth * mWorldHeight;
+	mCostSoFar.resize( nodeCount );
+	mEstimate.resize( nodeCount );
+	mParent.resize( nodeCount );
+	mHeapIndex.resize( nodeCount );
+	mOpenHeap.clear();
+	mOpenHeap.reserve( nodeCount );
+	mSearchStamp.assign( nodeCount, 0 );
+	mSearchId = 0;
+	mMarkedNodes.clear();
+	mOccupancy.Init( mWorldWidth, mWorldHeight );
+	
+	/* Clusters - only worth searching through on large levels */
+	mHierarchy.Init( this, mWorldWidth, mWorldHeight );
+	mUseHierarchy = ( nodeCount >= PATH_HIERARCHY_MIN_NODES );
+	mFlowField.Init( this, mWorldWidth, mWorldHeight );
+	
+	/* Routes queued for the last level are no use - collecting one now fails */
+	mPathRequests.clear();
+	
+	mObstacleStamp++;
 }
 
 
@@ -76,12 +115,17 @@ void PathController::LoadPathfindingArray( vector< vector< int > > &arrayVector
 			/* 0 == FREE */
 			if( arrayVector[ y ][ x ] == 0 ) {
 				mPathfindingArray[ y ][ x ].mNodeState = Node::FREE;
+				mOccupancy.Clear( OccupancyGrid::BLOCKED, x, y );
 			/* 1 == BLOCKED */
 			} else if( arrayVector[ y ][ x ] == 1 ) {
 				mPathfindingArray[ y ][ x ].mNodeState = Node::BLOCKED;
+				mOccupancy.Set( OccupancyGrid::BLOCKED, x, y );
 			}
 		}
 	}
+	mObstacleStamp++;
+	mHierarchy.InvalidateAll();
+	mFlowField.InvalidateAll();
 }
 
 
@@ -93,7 +137,20 @@ External Setter for NodeState
 */
 void PathController::SetPathfindingNode( XYCoords position, Node::NodeState newState ) {
 	if( CheckIfInRange( position ) ) {
+		/* Blocking / unblocking changes the clusters routes */
+		bool wasBlocked = ( mPathfindingArray[ position.mY ][ position.mX ].mNodeState == Node::BLOCKED );
+		if( wasBlocked != ( newState == Node::BLOCKED ) ) {
+			mHierarchy.InvalidateNode( ( position.mY * mWorldWidth ) + position.mX );
+			mFlowField.InvalidateNode( ( position.mY * mWorldWidth ) + position.mX );
+		}
+		
 		mPathfindingArray[ position.mY ][ position.mX ].mNodeState = newState;
+		if( newState == Node::BLOCKED ) {
+			mOccupancy.Set( OccupancyGrid::BLOCKED, position.mX, position.mY );
+			mObstacleStamp++;
+		} else {
+			mOccupancy.Clear( OccupancyGrid::BLOCKED, position.mX, position.mY );
+		}
 	}
 }
 
@@ -108,6 +165,14 @@ void PathController::SetObjectNode( XYCoords position, Node::NodeContains newObj
 	if( CheckIfInRange( position ) ) {
 		if( mPathfindingArray[ position.mY ][ position.mX ].mNodeContains == Node::NOTHING ) {
 			mPathfindingArray[ position.mY ][ position.mX ].mNodeContains = newObject;
+			if( newObject == Node::PLAYER ) {
+				mOccupancy.Set( OccupancyGrid::PLAYER, position.mX, position.mY );
+			} else if( newObject == Node::ENEMY ) {
+				mOccupancy.Set( OccupancyGrid::ENEMY, position.mX, position.mY );
+			} else if( newObject == Node::OBJECTIVE ) {
+				mOccupancy.Set( OccupancyGrid::OBJECTIVE, position.mX, position.mY );
+			}
+			mObstacleStamp++;
 		}
 	}
 }
@@ -122,22 +187,23 @@ Resets object node
 void PathController::CleanObjectNode( XYCoords position ) {
 	if( CheckIfInRange( position ) ) {
 		mPathfindingArray[ position.mY ][ position.mX ].CleanNodeContainer();
+		mOccupancy.ClearObject( position.mX, position.mY );
 	}
 }
 
 
 /*
-============================
+==================================================
 ClearPathfindingArray
-Resets pathfinding variables
-============================
+Resets the PATH nodes marked by the last FindPath
+The A* data needs no reset - see mSearchStamp
+==================================================
 */
 void PathController::ClearPathfindingArray( void ) {
-	for( int y = 0; y < mWorldHeight; y++ ) {
-		for( int x = 0; x < mWorldWidth; x++ ) {
-			mPathfindingArray[ y ][ x ].CleanNode();
-		}
+	for( int i = 0; i < ( int )mMarkedNodes.size(); i++ ) {
+		mPathfindingArray[ mMarkedNodes[ i ] / mWorldWidth ][ mMarkedNodes[ i ] % mWorldWidth ].CleanNode();
 	}
+	mMarkedNodes.clear();
 }
 
 
@@ -153,120 +219,447 @@ void PathController::ClearObjectArray( void ) {
 			mPathfindingArray[ y ][ x ].CleanNodeContainer();
 		}
 	}
+	mOccupancy.ClearPlane( OccupancyGrid::PLAYER );
+	mOccupancy.ClearPlane( OccupancyGrid::ENEMY );
+	mOccupancy.ClearPlane( OccupancyGrid::OBJECTIVE );
 }
 
 
 /*
-========================
+========================================================
 FindPath
 A* Pathfinding Algorithm
-========================
+Returns the first node along the shortest path - (-1,-1)
+if the target cant be reached
+Nodes along the path are marked PATH for DrawGrid
+========================================================
 */
 XYCoords PathController::FindPath( XYCoords start, XYCoords target ) {
 	XYCoords nextNode( -1, -1 ); // a default value thats illegal - if target cant be reached
 	if( ( CheckIfInRange( start ) ) && ( CheckIfInRange( target ) ) ) {
-		mTargetFound = false;
+		int startIndex = ( start.mY * mWorldWidth ) + start.mX;
+		int targetIndex = ( target.mY * mWorldWidth ) + target.mX;
 		
-		/* Set start - only if selected node is not blocked */
-		if( mPathfindingArray[ start.mY ][ start.mX ].mNodeState != Node::BLOCKED ) {
-			mPathfindingArray[ start.mY ][ start.mX ].SetAsStart( 0 ); // set start node
-			mActiveNode = mPathfindingArray[ start.mY ][ start.mX ];   // set as node of interest                
-			mWorkingSet.push( mActiveNode );                           // push to priority queue
-			mPathfindingArray[ target.mY ][ target.mX ].SetAsTarget(); // mark target node
+		/* Search - only if start and target are different open nodes */
+		if( ( startIndex != targetIndex ) && ( SearchPath( startIndex, targetIndex, false ) ) ) {
+			/* Traceback - follow the parents from the target to the node after the start */
+			int nodeIndex = targetIndex;
+			while( mParent[ nodeIndex ] != startIndex ) {
+				mPathfindingArray[ nodeIndex / mWorldWidth ][ nodeIndex % mWorldWidth ].mNodeState = Node::PATH;
+				mMarkedNodes.push_back( nodeIndex );
+				nodeIndex = mParent[ nodeIndex ];
+			}
+			mPathfindingArray[ nodeIndex / mWorldWidth ][ nodeIndex % mWorldWidth ].mNodeState = Node::PATH;
+			mMarkedNodes.push_back( nodeIndex );
+			
+			/* Set return node */
+			nextNode.mX = nodeIndex % mWorldWidth;
+			nextNode.mY = nodeIndex / mWorldWidth;
 		}
 		
-		/* Wave Expansion */
+		/* Return node */
+		return nextNode;
+	}
+	
+	/* Illegal Condition */
+	printf( "Illegal Pathfinding Call \n" );
+	return nextNode;
+}
+
+
+/*
+==================================================================
+FindFullPath
+A* Pathfinding Algorithm - for characters to cache the route
+Fills path with the nodes after start up to and including target
+Routes around nodes holding other objects where it can, otherwise
+straight through them as FindPath does
+Returns false (path empty) if the target cant be reached
+==================================================================
+*/
+bool PathController::FindFullPath( XYCoords start, XYCoords target, vector< XYCoords > &path ) {
+	path.clear();
+	if( ( CheckIfInRange( start ) ) && ( CheckIfInRange( target ) ) ) {
+		int startIndex = ( start.mY * mWorldWidth ) + start.mX;
+		int targetIndex = ( target.mY * mWorldWidth ) + target.mX;
+		if( startIndex == targetIndex ) {
+			return false;
+		}
 		
-		/* While the working set is NOT empty */
-		while(!mWorkingSet.empty() ) {
-			mActiveNode = mWorkingSet.top();                 // set node of interest as the top
-			mWorkingSet.pop();                               // remove it
-			int moveNumber = mActiveNode.mMoveNumber + 1;    // increase moveNumber
-			GenerateMoves( mPathfindingArray, mActiveNode ); // generate legal moves
-			
-			/* Check the legal moves for target */
-			for( int i = 0; i < mStepCounter; i++ ) {
-				/* If the target is one of the next moves */
-				if( mSteps[ i ].mIsTargetNode ) { 
-					mSteps[ i ].SetMoveNumber( moveNumber ); // set its moveNumber 
-					mTracebackSet.push( mSteps[ i ] );       // add for traceback
-					break;                                  
-				}
+		/* Large level - through the cluster hierarchy */
+		if( mUseHierarchy ) {
+			if( ( mOccupancy.Test( OccupancyGrid::BLOCKED, start.mX, start.mY ) ) ||
+			    ( mOccupancy.Test( OccupancyGrid::BLOCKED, target.mX, target.mY ) ) ) {
+				return false;
 			}
 			
-			/* If target was found */
-			if(!mTracebackSet.empty() ) {
-				break;
+			bool pathFound = mHierarchy.FindPath( startIndex, targetIndex, mHierarchyPath );
+			mNodesExpanded = mHierarchy.GetNodesExpanded();
+			mPathCost = mHierarchy.GetPathCost();
+			for( int i = 0; i < ( int )mHierarchyPath.size(); i++ ) {
+				path.push_back( XYCoords( mHierarchyPath[ i ] % mWorldWidth, mHierarchyPath[ i ] / mWorldWidth ) );
 			}
-			
-			/* For legal moves */
-			for( int i = 0; i < mStepCounter; i++ ) {
-				if( !mPathfindingArray[ mSteps[ i ].mY ][ mSteps[ i ].mX ].mUsed ) {
-					mPathfindingArray[ mSteps[ i ].mY ][ mSteps[ i ].mX ].SetMoveNumber( moveNumber );
-					mPathfindingArray[ mSteps[ i ].mY ][ mSteps[ i ].mX ].SetDistanceFromTarget( GetDistance( mPathfindingArray[ mSteps[ i ].mY ][ mSteps[ i ].mX ], mPathfindingArray[ target.mY ][ target.mX ] ) ); 
-					mWorkingSet.push( mPathfindingArray[ mSteps[ i ].mY ][ mSteps[ i ].mX ] ); // add to priority queue
-				}
+			return pathFound;
+		}
+		
+		/* Search - GetNodesExpanded counts both tries */
+		if( !SearchPath( startIndex, targetIndex, true ) ) {
+			int firstNodes = mNodesExpanded;
+			bool pathFound = SearchPath( startIndex, targetIndex, false );
+			mNodesExpanded += firstNodes;
+			if( !pathFound ) {
+				return false;
 			}
 		}
 		
-		/* Traceback */
+		/* Traceback - target to start, then reversed */
+		for( int nodeIndex = targetIndex; nodeIndex != startIndex; nodeIndex = mParent[ nodeIndex ] ) {
+			path.push_back( XYCoords( nodeIndex % mWorldWidth, nodeIndex / mWorldWidth ) );
+		}
+		for( int i = 0, j = ( int )path.size() - 1; i < j; i++, j-- ) {
+			XYCoords swapNode = path[ i ];
+			path[ i ] = path[ j ];
+			path[ j ] = swapNode;
+		}
+		return true;
+	}
+	
+	/* Illegal Condition */
+	printf( "Illegal Pathfinding Call \n" );
+	return false;
+}
 
-		/* While the traceback set is NOT empty */
-		while( !mTracebackSet.empty() ) {
-			/* Start at target */
-			mActiveNode = mTracebackSet.top();
-			
-			/* Clear traceback set */
-			while( !mTracebackSet.empty() ) {
-				mTracebackSet.pop();
+
+/*
+============================================
+UseHierarchy
+Switches FindFullPath between the cluster
+hierarchy and a search over the whole grid
+============================================
+*/
+void PathController::UseHierarchy( bool useHierarchy ) {
+	mUseHierarchy = useHierarchy;
+}
+
+
+/*
+=================================================
+IsUsingHierarchy
+If FindFullPath goes through the cluster hierarchy
+=================================================
+*/
+bool PathController::IsUsingHierarchy( void ) const {
+	return mUseHierarchy;
+}
+
+
+/*
+============================
+GetHierarchy
+Access for tools / debugging
+============================
+*/
+PathHierarchy& PathController::GetHierarchy( void ) {
+	return mHierarchy;
+}
+
+
+/*
+=================================================
+UpdateFlowField
+Called once a frame with the player's node - only
+builds when that node or the level has changed
+=================================================
+*/
+void PathController::UpdateFlowField( XYCoords goal ) {
+	if( CheckIfInRange( goal ) ) {
+		mFlowField.Update( ( goal.mY * mWorldWidth ) + goal.mX );
+	}
+}
+
+
+/*
+=================================================
+GetFlowFieldGoal
+Node the flow field leads to - (-1,-1) before any
+=================================================
+*/
+XYCoords PathController::GetFlowFieldGoal( void ) const {
+	int goalIndex = mFlowField.GetGoal();
+	if( goalIndex == -1 ) {
+		return XYCoords( -1, -1 );
+	}
+	return XYCoords( goalIndex % mWorldWidth, goalIndex / mWorldWidth );
+}
+
+
+/*
+======================================================================
+GetFlowStep
+Next node from position towards the flow field's goal - (-1,-1) if
+position is outside the field or already there
+If another enemy stands on that node, any free neighbour that is also
+closer to the goal is taken instead so chasers spread round the player
+======================================================================
+*/
+XYCoords PathController::GetFlowStep( XYCoords position ) {
+	if( !CheckIfInRange( position ) ) {
+		return XYCoords( -1, -1 );
+	}
+	
+	int nodeIndex = ( position.mY * mWorldWidth ) + position.mX;
+	int stepIndex = mFlowField.GetStep( nodeIndex );
+	if( stepIndex == -1 ) {
+		return XYCoords( -1, -1 );
+	}
+	
+	/* Step around an enemy in the way */
+	if( mOccupancy.Test( OccupancyGrid::ENEMY, stepIndex % mWorldWidth, stepIndex / mWorldWidth ) ) {
+		int neighbours[ 8 ], costs[ 8 ];
+		int neighbourCount = GetNeighbours( nodeIndex, neighbours, costs );
+		int bestCost = mFlowField.GetCost( nodeIndex );
+		for( int i = 0; i < neighbourCount; i++ ) {
+			int neighbourCost = mFlowField.GetCost( neighbours[ i ] );
+			if( ( neighbourCost != -1 ) && ( neighbourCost < bestCost ) ) {
+				if( !mOccupancy.Test( OccupancyGrid::ENEMY, neighbours[ i ] % mWorldWidth, neighbours[ i ] / mWorldWidth ) ) {
+					bestCost = neighbourCost;
+					stepIndex = neighbours[ i ];
+				}
 			}
-			
-			/* Set as 'path' */
-			mPathfindingArray[ mActiveNode.mY ][ mActiveNode.mX ].mNodeState = Node::PATH; 
-			
-			/* Generate legal moves */
-			GenerateMoves( mPathfindingArray, mActiveNode );
-			
-			/* Check the legal moves for target */
-			for( int i = 0; i < mStepCounter; i++ ) {
-				/* If the start is one of the next moves */
-				if( mSteps[ i ].mIsStartNode ) {
-					mTargetFound = true;
-					/* Set return node */
-					nextNode.mX = mActiveNode.mX;
-					nextNode.mY = mActiveNode.mY;      
-					break;                                  
+		}
+	}
+	
+	return XYCoords( stepIndex % mWorldWidth, stepIndex / mWorldWidth );
+}
+
+
+/*
+============================
+GetFlowField
+Access for tools / debugging
+============================
+*/
+FlowField& PathController::GetFlowField( void ) {
+	return mFlowField;
+}
+
+
+/*
+====================================================================
+RequestPath
+Queues a FindFullPath - returns the id to pass to GetPathResult
+A request for the same start and target that is still queued, or was
+searched since anything last moved, is shared rather than repeated
+====================================================================
+*/
+int PathController::RequestPath( XYCoords start, XYCoords target, int priority ) {
+	for( int i = 0; i < ( int )mPathRequests.size(); i++ ) {
+		PathRequest &request = mPathRequests[ i ];
+		if( ( request.mStart == start ) && ( request.mTarget == target ) ) {
+			if( ( request.mState == PATH_REQUEST_PENDING ) || ( request.mStamp == mObstacleStamp ) ) {
+				if( priority > request.mPriority ) {
+					request.mPriority = priority;
 				}
+				request.mWaiting++;
+				return request.mId;
 			}
-			
-			/* If target was found */
-			if( mTargetFound ) {
-				break;
+		}
+	}
+	
+	PathRequest newRequest;
+	newRequest.mId = mNextRequestId++;
+	newRequest.mStart = start;
+	newRequest.mTarget = target;
+	newRequest.mPriority = priority;
+	newRequest.mState = PATH_REQUEST_PENDING;
+	newRequest.mWaiting = 1;
+	newRequest.mStamp = mObstacleStamp;
+	mPathRequests.push_back( newRequest );
+	return newRequest.mId;
+}
+
+
+/*
+=================================================================
+GetPathResult
+PATH_REQUEST_PENDING until the request has been searched - then
+fills path and returns PATH_REQUEST_FOUND or PATH_REQUEST_FAILED,
+and the id is finished with. Unknown ids (a level reload) fail
+=================================================================
+*/
+int PathController::GetPathResult( int requestId, vector< XYCoords > &path ) {
+	path.clear();
+	for( int i = 0; i < ( int )mPathRequests.size(); i++ ) {
+		PathRequest &request = mPathRequests[ i ];
+		if( request.mId == requestId ) {
+			if( request.mState == PATH_REQUEST_PENDING ) {
+				return PATH_REQUEST_PENDING;
 			}
 			
-			/* Loop through possibles */
-			for( int i = 0; i < mStepCounter; i++ ) {
-				if( ( mSteps[ i ].mMoveNumber < mActiveNode.mMoveNumber ) && ( mSteps[ i ].mUsed ) ) {
-					mTracebackSet.push( mPathfindingArray[ mSteps[ i ].mY ][ mSteps[ i ].mX ] );
+			int requestState = request.mState;
+			path = request.mPath;
+			CancelPathRequest( requestId );
+			return requestState;
+		}
+	}
+	return PATH_REQUEST_FAILED;
+}
+
+
+/*
+==========================================================
+CancelPathRequest
+The caller no longer wants the route - dropped (unsearched
+if still queued) once nobody sharing it is waiting
+==========================================================
+*/
+void PathController::CancelPathRequest( int requestId ) {
+	for( int i = 0; i < ( int )mPathRequests.size(); i++ ) {
+		if( mPathRequests[ i ].mId == requestId ) {
+			mPathRequests[ i ].mWaiting--;
+			if( mPathRequests[ i ].mWaiting <= 0 ) {
+				mPathRequests.erase( mPathRequests.begin() + i );
+			}
+			return;
+		}
+	}
+}
+
+
+/*
+====================================================================
+ProcessPathRequests
+Called once a frame - searches queued requests, highest priority and
+then oldest first, until mPathBudget nodes have been expanded
+At least one is searched every frame so a search bigger than the
+budget still gets done
+====================================================================
+*/
+void PathController::ProcessPathRequests( void ) {
+	mFrameNodesExpanded = 0;
+	while( mFrameNodesExpanded < mPathBudget ) {
+		/* Next request - ids only increase, so lower is older */
+		int nextRequest = -1;
+		for( int i = 0; i < ( int )mPathRequests.size(); i++ ) {
+			if( mPathRequests[ i ].mState == PATH_REQUEST_PENDING ) {
+				if( ( nextRequest == -1 ) || ( mPathRequests[ i ].mPriority > mPathRequests[ nextRequest ].mPriority ) ||
+				    ( ( mPathRequests[ i ].mPriority == mPathRequests[ nextRequest ].mPriority ) &&
+				      ( mPathRequests[ i ].mId < mPathRequests[ nextRequest ].mId ) ) ) {
+					nextRequest = i;
 				}
 			}
 		}
-			
-		/* Clear priority queues */
-		while( !mWorkingSet.empty() ) {
-			mWorkingSet.pop();
+		if( nextRequest == -1 ) {
+			return;
 		}
-		while( !mTracebackSet.empty() ) {
-			mTracebackSet.pop();
+		
+		PathRequest &request = mPathRequests[ nextRequest ];
+		mNodesExpanded = 0;
+		bool pathFound = FindFullPath( request.mStart, request.mTarget, request.mPath );
+		request.mState = pathFound ? PATH_REQUEST_FOUND : PATH_REQUEST_FAILED;
+		request.mStamp = mObstacleStamp;
+		
+		/* Searches that stopped early still cost something */
+		mFrameNodesExpanded += ( mNodesExpanded > 0 ) ? mNodesExpanded : 1;
+	}
+}
+
+
+/*
+=============================================
+SetPathBudget
+Nodes queued requests may expand in one frame
+=============================================
+*/
+void PathController::SetPathBudget( int nodeBudget ) {
+	mPathBudget = nodeBudget;
+}
+
+
+/*
+=====================================
+GetQueuedPathCount
+Requests still waiting to be searched
+=====================================
+*/
+int PathController::GetQueuedPathCount( void ) const {
+	int queuedCount = 0;
+	for( int i = 0; i < ( int )mPathRequests.size(); i++ ) {
+		if( mPathRequests[ i ].mState == PATH_REQUEST_PENDING ) {
+			queuedCount++;
+		}
+	}
+	return queuedCount;
+}
+
+
+/*
+==============================================
+GetFrameNodesExpanded
+Nodes expanded by the last ProcessPathRequests
+==============================================
+*/
+int PathController::GetFrameNodesExpanded( void ) const {
+	return mFrameNodesExpanded;
+}
+
+
+/*
+==============================================================
+IsPathClear
+Checks the nodes of path from firstNode on are still walkable
+and the nodes before its target dont hold an object
+==============================================================
+*/
+bool PathController::IsPathClear( const vector< XYCoords > &path, int firstNode ) {
+	int lastNode = ( int )path.size() - 1;
+	for( int i = firstNode; i <= lastNode; i++ ) {
+		if( !CheckIfInRange( path[ i ] ) ) {
+			return false;
 		}
 		
-		/* Return node */
-		return nextNode;
+		if( mOccupancy.Test( OccupancyGrid::BLOCKED, path[ i ].mX, path[ i ].mY ) ) {
+			return false;
+		}
+		/* The target itself is allowed to hold the player / an enemy */
+		if( ( i != lastNode ) && ( mOccupancy.TestObject( path[ i ].mX, path[ i ].mY ) ) ) {
+			return false;
+		}
 	}
-	
-	/* Illegal Condition */
-	return nextNode;
-	printf( "Illegal Pathfinding Call \n" );
+	return true;
+}
+
+
+/*
+=========================================================
+GetObstacleStamp
+Counts nodes blocked and objects placed since the start
+=========================================================
+*/
+int PathController::GetObstacleStamp( void ) const {
+	return mObstacleStamp;
+}
+
+
+/*
+=====================================
+GetNodesExpanded
+Nodes closed by the last A* search
+=====================================
+*/
+int PathController::GetNodesExpanded( void ) const {
+	return mNodesExpanded;
+}
+
+
+/*
+==========================
+GetPathCost
+Cost of the last path found
+==========================
+*/
+int PathController::GetPathCost( void ) const {
+	return mPathCost;
 }
 
 
@@ -278,7 +671,7 @@ A check for characters to see if node can be moved to
 */
 bool PathController::IsNodeFree( XYCoords position ) {
 	if( CheckIfInRange( position ) ) {
-		if( mPathfindingArray[ position.mY ][ position.mX ].mNodeState != Node::BLOCKED ) {
+		if( !mOccupancy.Test( OccupancyGrid::BLOCKED, position.mX, position.mY ) ) {
 			return true;
 		}
 	}
@@ -294,7 +687,7 @@ A check for the player to see if node has an enemy on it
 */
 bool PathController::NodeContainsEnemy( XYCoords position ) {
 	if( CheckIfInRange( position ) ) {
-		if( mPathfindingArray[ position.mY ][ position.mX ].mNodeContains == Node::ENEMY ) {
+		if( mOccupancy.Test( OccupancyGrid::ENEMY, position.mX, position.mY ) ) {
 			return true;
 		}
 	}
@@ -310,7 +703,7 @@ A check for the enemies to see if node has the player on it
 */
 bool PathController::NodeContainsPlayer( XYCoords position ) {
 	if( CheckIfInRange( position ) ) {
-		if( mPathfindingArray[ position.mY ][ position.mX ].mNodeContains == Node::PLAYER ) {
+		if( mOccupancy.Test( OccupancyGrid::PLAYER, position.mX, position.mY ) ) {
 			return true;
 		}
 	}
@@ -362,152 +755,331 @@ float PathController::GetObjectDistance( XYCoords currentPosition, XYCoords targ
 
 
 /*
-======================================================
-GenerateMoves
-Fills steps array with legal moves from current tile
-Checks if each directions move is within the 2D vector
-Then if that node is 'free' - ie a legal move
-======================================================
+=====================================================
+IsObjectWithin
+True if the objects are less than distance apart - as
+GetObjectDistance, but compared squared with no sqrt
+=====================================================
 */
-void PathController::GenerateMoves( vector< vector< Node > > &mPathfindingArray, Node currentNode ) {
-	mStepCounter = 0;          // reset stepCounter
-	mActiveNode = currentNode; // set reference node
-	bool oddRow = false;       // different diagonal's apply to odd / even row'd nodes
+bool PathController::IsObjectWithin( XYCoords currentPosition, XYCoords targetPosition, float distance ) {
+	if( ( CheckIfInRange( currentPosition ) ) && ( CheckIfInRange( targetPosition ) ) ) {
+		int dy = ( currentPosition.mY - targetPosition.mY ) * 32;
+		int dx = ( ( currentPosition.mX - targetPosition.mX ) * 64 ) + ( ( currentPosition.mY % 2 != 0 ) ? 32 : 0 ) - ( ( targetPosition.mY % 2 != 0 ) ? 32 : 0 );
+		return float( ( dy * dy ) + ( dx * dx ) ) < ( distance * distance );
+	}
 	
-	/* Test if mActiveNode is on an odd row */
-	if( mActiveNode.mY % 2 != 0 ) {
-		oddRow = true;
+	/* Saftey Condition */
+	printf( "Illegal IsObjectWithin Call \n" );
+	return false;
+}
+
+
+/*
+====================================================
+AnyEnemyWithin
+True if an enemy is less than distance from position
+Tests the enemy bits a word at a time - no sqrt
+====================================================
+*/
+bool PathController::AnyEnemyWithin( XYCoords position, float distance ) {
+	return mOccupancy.AnyWithin( OccupancyGrid::ENEMY, position, distance );
+}
+
+
+/*
+========================================
+CountEnemiesWithin
+Enemies less than distance from position
+========================================
+*/
+int PathController::CountEnemiesWithin( XYCoords position, float distance ) {
+	return mOccupancy.CountWithin( OccupancyGrid::ENEMY, position, distance );
+}
+
+
+/*
+============================
+GetOccupancy
+Access for tools / debugging
+============================
+*/
+OccupancyGrid& PathController::GetOccupancy( void ) {
+	return mOccupancy;
+}
+
+
+/*
+=====================================================================
+SearchPath
+A* from startIndex until targetIndex is taken off the open heap
+The heuristic is consistent so a closed node is never reopened - the
+first time the target is closed its route is the shortest
+Leaves each reached node's parent in mParent
+avoidObjects treats nodes holding an object (other than the target)
+as blocked
+=====================================================================
+*/
+bool PathController::SearchPath( int startIndex, int targetIndex, bool avoidObjects ) {
+	int neighbours[ 8 ];
+	int costs[ 8 ];
+	
+	mNodesExpanded = 0;
+	mPathCost = 0;
+	
+	/* Both ends must be walkable */
+	if( ( mOccupancy.Test( OccupancyGrid::BLOCKED, startIndex % mWorldWidth, startIndex / mWorldWidth ) ) ||
+	    ( mOccupancy.Test( OccupancyGrid::BLOCKED, targetIndex % mWorldWidth, targetIndex / mWorldWidth ) ) ) {
+		return false;
 	}
 	
-	/* North */
-	if( ( mActiveNode.mY - 2 ) >= 0 ) {                                                               // if within 2D vector
-		if( mPathfindingArray[ mActiveNode.mY - 2 ][ mActiveNode.mX ].mNodeState != Node::BLOCKED ) { // if node is not blocked
-			mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY - 2 ][ mActiveNode.mX ];       // add to mSteps as a legal move
-			mStepCounter++;                                                                           // increase step counter
-		}
-	}
-	/* NorthEast (odd row) */
-	if( oddRow ) {
-		if( ( ( mActiveNode.mY - 1 ) >= 0 ) && ( ( mActiveNode.mX + 1 ) < mWorldWidth ) ) {  
-			if( mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX + 1 ].mNodeState != Node::BLOCKED ) { 
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX + 1 ];   
-				mStepCounter++;
-			}
-		}
-	/* NorthEast (even row) */
-	} else {
-		if( ( mActiveNode.mY - 1 ) >= 0 ) {  
-			if( mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX ].mNodeState != Node::BLOCKED ) { 
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX ];   
-				mStepCounter++;
-			}
+	/* Forget the last search - a new id makes every node unseen */
+	mSearchId++;
+	if( mSearchId == 0 ) {
+		/* Wrapped - old stamps could match again */
+		for( int i = 0; i < ( int )mSearchStamp.size(); i++ ) {
+			mSearchStamp[ i ] = 0;
 		}
+		mSearchId = 1;
 	}
-	/* East */
-	if( ( mActiveNode.mX + 1 ) < mWorldWidth ) {
-		if( mPathfindingArray[ mActiveNode.mY ][ mActiveNode.mX + 1].mNodeState != Node::BLOCKED ) {
-			mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY ][ mActiveNode.mX + 1 ];   
-			mStepCounter++;
+	mOpenHeap.clear();
+	
+	/* Open the start */
+	mSearchStamp[ startIndex ] = mSearchId;
+	mCostSoFar[ startIndex ] = 0;
+	mEstimate[ startIndex ] = GetHeuristic( startIndex, targetIndex );
+	mParent[ startIndex ] = startIndex;
+	PushOpen( startIndex );
+	
+	/* While the open heap is NOT empty */
+	while( !mOpenHeap.empty() ) {
+		/* Cheapest estimate */
+		int currentIndex = PopOpen();
+		mHeapIndex[ currentIndex ] = PATH_CLOSED;
+		mNodesExpanded++;
+		
+		/* Target reached */
+		if( currentIndex == targetIndex ) {
+			mPathCost = mCostSoFar[ targetIndex ];
+			return true;
 		}
-	}
-	/* South East (odd row) */
-	if( oddRow ) {
-		if( ( ( mActiveNode.mY + 1 ) < mWorldHeight ) && ( ( mActiveNode.mX + 1 ) < mWorldWidth ) ) {
-			if( mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX + 1 ].mNodeState != Node::BLOCKED ) {
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX + 1 ];   
-				mStepCounter++;
+		
+		/* Relax legal moves */
+		int neighbourCount = GetNeighbours( currentIndex, neighbours, costs );
+		for( int i = 0; i < neighbourCount; i++ ) {
+			int nodeIndex = neighbours[ i ];
+			bool seen = ( mSearchStamp[ nodeIndex ] == mSearchId );
+			if( ( seen ) && ( mHeapIndex[ nodeIndex ] == PATH_CLOSED ) ) {
+				continue;
 			}
-		}
-	/* South East (even row) */
-	} else {
-		if( ( mActiveNode.mY + 1 ) < mWorldHeight ) {
-			if( mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX ].mNodeState != Node::BLOCKED ) {
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX ];   
-				mStepCounter++;
+			if( ( avoidObjects ) && ( nodeIndex != targetIndex ) &&
+			    ( mOccupancy.TestObject( nodeIndex % mWorldWidth, nodeIndex / mWorldWidth ) ) ) {
+				continue;
 			}
-		}
-	}
-	/* South */
-	if( ( mActiveNode.mY + 2 ) < mWorldHeight ) {
-		if( mPathfindingArray[ mActiveNode.mY + 2 ][ mActiveNode.mX ].mNodeState != Node::BLOCKED ) {
-			mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY + 2 ][ mActiveNode.mX ];   
-			mStepCounter++;
-		}
-	}
-	/* South West (odd row) */
-	if( oddRow ) {
-		if( ( mActiveNode.mY + 1 ) < mWorldHeight ) {
-			if( mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX ].mNodeState != Node::BLOCKED ) {
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX ];   
-				mStepCounter++;
+			
+			int cost = mCostSoFar[ currentIndex ] + costs[ i ];
+			
+			/* First route to this node */
+			if( !seen ) {
+				mSearchStamp[ nodeIndex ] = mSearchId;
+				mCostSoFar[ nodeIndex ] = cost;
+				mEstimate[ nodeIndex ] = cost + GetHeuristic( nodeIndex, targetIndex );
+				mParent[ nodeIndex ] = currentIndex;
+				PushOpen( nodeIndex );
+			/* Cheaper route to an open node - decrease-key */
+			} else if( cost < mCostSoFar[ nodeIndex ] ) {
+				mEstimate[ nodeIndex ] -= mCostSoFar[ nodeIndex ] - cost;
+				mCostSoFar[ nodeIndex ] = cost;
+				mParent[ nodeIndex ] = currentIndex;
+				SiftUp( mHeapIndex[ nodeIndex ] );
 			}
 		}
-	/* South West (even row) */
-	} else {
-		if( ( ( mActiveNode.mY + 1 ) < mWorldHeight ) && ( ( mActiveNode.mX - 1 ) >= 0 ) ) {
-			if( mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX - 1 ].mNodeState != Node::BLOCKED ) {
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY + 1 ][ mActiveNode.mX - 1 ];   
-				mStepCounter++;
+	}
+	
+	/* Target cant be reached */
+	return false;
+}
+
+
+/*
+=============================================================
+GetNeighbours
+Fills neighbours with the walkable nodes around nodeIndex and
+costs with the cost of each move - returns how many
+NE/SE/SW/NW are different on odd/even Y rows
+=============================================================
+*/
+int PathController::GetNeighbours( int nodeIndex, int* neighbours, int* costs ) {
+	/* N, NE, E, SE, S, SW, W, NW */
+	static const int evenRowX[ 8 ] = { 0, 0, 1, 0, 0, -1, -1, -1 };
+	static const int oddRowX[ 8 ]  = { 0, 1, 1, 1, 0, 0, -1, 0 };
+	static const int stepY[ 8 ]    = { -2, -1, 0, 1, 2, 1, 0, -1 };
+	static const int stepCost[ 8 ] = { PATH_CORNER_COST, PATH_EDGE_COST, PATH_CORNER_COST, PATH_EDGE_COST,
+	                                   PATH_CORNER_COST, PATH_EDGE_COST, PATH_CORNER_COST, PATH_EDGE_COST };
+	
+	int x = nodeIndex % mWorldWidth;
+	int y = nodeIndex / mWorldWidth;
+	const int* stepX = ( y % 2 != 0 ) ? oddRowX : evenRowX;
+	int neighbourCount = 0;
+	
+	for( int i = 0; i < 8; i++ ) {
+		int nextX = x + stepX[ i ];
+		int nextY = y + stepY[ i ];
+		
+		/* If within 2D vector and not blocked */
+		if( ( nextX >= 0 ) && ( nextX < mWorldWidth ) && ( nextY >= 0 ) && ( nextY < mWorldHeight ) ) {
+			if( !mOccupancy.Test( OccupancyGrid::BLOCKED, nextX, nextY ) ) {
+				neighbours[ neighbourCount ] = ( nextY * mWorldWidth ) + nextX;
+				costs[ neighbourCount ] = stepCost[ i ];
+				neighbourCount++;
 			}
 		}
 	}
-	/* West */
-	if( ( mActiveNode.mX - 1 ) >= 0 ) {
-		if( mPathfindingArray[ mActiveNode.mY ][ mActiveNode.mX - 1 ].mNodeState != Node::BLOCKED ) {
-			mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY ][ mActiveNode.mX - 1 ];   
-			mStepCounter++;
-		}
+	
+	return neighbourCount;
+}
+
+
+/*
+==========================================================================
+GetHeuristic
+Octile distance on the diamond lattice under the staggered rows - in half
+tiles a node is at u = ( 2x + odd + y ) / 2, v = ( 2x + odd - y ) / 2, an
+edge move changes one of u / v by 1 and a corner move changes both
+That is the exact cost with nothing blocked, so it never overestimates
+and never drops by more than a move costs (admissible and consistent)
+==========================================================================
+*/
+int PathController::GetHeuristic( int nodeIndex, int targetIndex ) {
+	int x = nodeIndex % mWorldWidth;
+	int y = nodeIndex / mWorldWidth;
+	int targetX = targetIndex % mWorldWidth;
+	int targetY = targetIndex / mWorldWidth;
+	
+	/* Half tile (32 pixel) coords */
+	int halfX = ( 2 * x ) + ( y % 2 );
+	int targetHalfX = ( 2 * targetX ) + ( targetY % 2 );
+	
+	int du = ( ( halfX + y ) - ( targetHalfX + targetY ) ) / 2;
+	int dv = ( ( halfX - y ) - ( targetHalfX - targetY ) ) / 2;
+	du = ( du < 0 ) ? -du : du;
+	dv = ( dv < 0 ) ? -dv : dv;
+	
+	/* Corner moves while both change, edge moves for the rest */
+	if( du < dv ) {
+		return ( du * PATH_CORNER_COST ) + ( ( dv - du ) * PATH_EDGE_COST );
 	}
-	/* North West (odd row) */
-	if( oddRow ) {
-		if( ( mActiveNode.mY - 1 ) >= 0 ) {
-			if( mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX ].mNodeState != Node::BLOCKED ) {
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX ];   
-				mStepCounter++;
-			}
-		}
-	/* North West (even row) */
-	} else {
-		if( ( ( mActiveNode.mY - 1 ) >= 0 ) && ( ( mActiveNode.mX - 1 ) >= 0 ) ) {
-			if( mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX - 1 ].mNodeState != Node::BLOCKED ) {
-				mSteps[ mStepCounter ] = mPathfindingArray[ mActiveNode.mY - 1 ][ mActiveNode.mX - 1 ];   
-				mStepCounter++;
-			}
-		}
+	return ( dv * PATH_CORNER_COST ) + ( ( du - dv ) * PATH_EDGE_COST );
+}
+
+
+/*
+======================================
+PushOpen
+Adds a node to the bottom of the heap
+======================================
+*/
+void PathController::PushOpen( int nodeIndex ) {
+	mOpenHeap.push_back( nodeIndex );
+	mHeapIndex[ nodeIndex ] = ( int )mOpenHeap.size() - 1;
+	SiftUp( mHeapIndex[ nodeIndex ] );
+}
+
+
+/*
+==========================================
+PopOpen
+Removes and returns the cheapest estimate
+==========================================
+*/
+int PathController::PopOpen( void ) {
+	int nodeIndex = mOpenHeap[ 0 ];
+	
+	/* Last node to the top then down to its place */
+	mOpenHeap[ 0 ] = mOpenHeap.back();
+	mHeapIndex[ mOpenHeap[ 0 ] ] = 0;
+	mOpenHeap.pop_back();
+	if( !mOpenHeap.empty() ) {
+		SiftDown( 0 );
 	}
-} 
+	
+	mHeapIndex[ nodeIndex ] = PATH_UNSEEN;
+	return nodeIndex;
+}
 
 
 /*
-=====================================================
-GetDistance
-Gets distance between nodes using pythagoras
-Offsets odd rows by 32 pixels
-As moving North or South is y+-2, y is * by 32 not 16
-=====================================================
+===================================================
+SiftUp
+Moves a node towards the top until its parent is
+cheaper - keeping mHeapIndex up to date
+===================================================
 */
-float PathController::GetDistance( Node currentNode, Node targetNode ) {
-	/* Get current nodes pixel coords */
-	int	currentY = currentNode.mY * 32;
-	int xOffset = 0;
-	if( currentNode.mY % 2 != 0 ) {
-		xOffset = 32;
+void PathController::SiftUp( int heapPosition ) {
+	int nodeIndex = mOpenHeap[ heapPosition ];
+	
+	while( heapPosition > 0 ) {
+		int parentPosition = ( heapPosition - 1 ) / 2;
+		if( !IsCheaper( nodeIndex, mOpenHeap[ parentPosition ] ) ) {
+			break;
+		}
+		
+		mOpenHeap[ heapPosition ] = mOpenHeap[ parentPosition ];
+		mHeapIndex[ mOpenHeap[ heapPosition ] ] = heapPosition;
+		heapPosition = parentPosition;
 	}
-	int currentX = ( currentNode.mX * 64 ) + xOffset;
 	
-	/* Get target nodes pixel coords */
-	int	targetY = targetNode.mY * 32;
-	xOffset = 0;
-	if( targetNode.mY % 2 != 0 ) {
-		xOffset = 32;
+	mOpenHeap[ heapPosition ] = nodeIndex;
+	mHeapIndex[ nodeIndex ] = heapPosition;
+}
+
+
+/*
+===================================================
+SiftDown
+Moves a node towards the bottom until both children
+are dearer - keeping mHeapIndex up to date
+===================================================
+*/
+void PathController::SiftDown( int heapPosition ) {
+	int nodeIndex = mOpenHeap[ heapPosition ];
+	int heapSize = ( int )mOpenHeap.size();
+	
+	while( true ) {
+		int childPosition = ( heapPosition * 2 ) + 1;
+		if( childPosition >= heapSize ) {
+			break;
+		}
+		
+		/* Cheaper of the two children */
+		if( ( childPosition + 1 < heapSize ) && ( IsCheaper( mOpenHeap[ childPosition + 1 ], mOpenHeap[ childPosition ] ) ) ) {
+			childPosition++;
+		}
+		if( !IsCheaper( mOpenHeap[ childPosition ], nodeIndex ) ) {
+			break;
+		}
+		
+		mOpenHeap[ heapPosition ] = mOpenHeap[ childPosition ];
+		mHeapIndex[ mOpenHeap[ heapPosition ] ] = heapPosition;
+		heapPosition = childPosition;
 	}
-	int targetX = ( targetNode.mX * 64 ) + xOffset;
 	
-	/* Calculate distance */
-	int dy = currentY - targetY;
-	int dx = currentX - targetX;
-	float distance = float( sqrt( ( dy * dy ) + ( dx * dx ) ) );
-	return distance;
+	mOpenHeap[ heapPosition ] = nodeIndex;
+	mHeapIndex[ nodeIndex ] = heapPosition;
+}
+
+
+/*
+===========================================================
+IsCheaper
+Heap order - lowest estimate, ties go to the node furthest
+from the start (closest to the target) to expand fewer nodes
+===========================================================
+*/
+bool PathController::IsCheaper( int nodeIndex, int otherIndex ) {
+	if( mEstimate[ nodeIndex ] != mEstimate[ otherIndex ] ) {
+		return mEstimate[ nodeIndex ] < mEstimate[ otherIndex ];
+	}
+	return mCostSoFar[ nodeIndex ] > mCostSoFar[ otherIndex ];
 }
 
 
@@ -4,10 +4,33 @@
 
 #include "XYCoords.h"
 #include "LevelData.h"
-#include <queue>
+#include "PathHierarchy.h"
+#include "FlowField.h"
+#include "OccupancyGrid.h"
 #include <vector>
 
 
+/* Move Costs                                                             */
+/* A tile's edge neighbours (NE / SE / SW / NW) are 32 * sqrt( 2 ) pixels */
+/* away, its corner neighbours (N / E / S / W) 64 pixels                  */
+static const int PATH_EDGE_COST = 45;
+static const int PATH_CORNER_COST = 64;
+
+/* mHeapIndex values for nodes not in the open heap - only read when */
+/* the node's mSearchStamp matches mSearchId, otherwise its unseen    */
+static const int PATH_UNSEEN = -1;
+static const int PATH_CLOSED = -2;
+
+/* Queued path requests - higher priorities are searched first */
+static const int PATH_PRIORITY_LOW = 0;    // patrolling
+static const int PATH_PRIORITY_NORMAL = 1; // chasing
+static const int PATH_PRIORITY_HIGH = 2;   // the player
+static const int PATH_REQUEST_PENDING = 0;
+static const int PATH_REQUEST_FOUND = 1;
+static const int PATH_REQUEST_FAILED = 2;
+static const int PATH_FRAME_BUDGET = 4096; // nodes expanded per frame by queued requests
+
+
 /*
 ===========================================================================
 PathController
@@ -15,6 +38,22 @@ Singleton to control Character pathfinding
 Takes in current position in maps 2D vector and calculates shortest route
 to a target position - returns the first node along the path
 Allows external access to what pathfinding array contains for hit detection
+
+A* over the staggered isometric grid - each node keeps its cost from the
+start and the node it was reached from, the open set is a binary heap of
+node indices ordered by cost + heuristic, and each node knows its place
+in the heap so a cheaper route just moves it up (decrease-key)
+Nothing is reset between searches - each node is stamped with the id of
+the search that last touched it, any other stamp reads as unseen, so a
+search costs only the nodes it reaches
+Levels bigger than a few clusters route FindFullPath through a
+PathHierarchy (HPA*) rather than one search over the whole grid
+Characters chasing the player share one FlowField built around it
+What each node holds is mirrored in an OccupancyGrid of bits - the
+searches and the character checks read that rather than the Nodes
+Characters queue their searches with RequestPath - ProcessPathRequests
+runs once a frame and stops once a budget of nodes has been expanded,
+so many characters wanting routes at once spread over several frames
 ===========================================================================
 */
 
@@ -32,6 +71,7 @@ public:
 	vector< vector< Node > > mPathfindingArray;
 	
 	void Init( void );
+	void Init( int worldWidth, int worldHeight );
 	
 	/* External access to mPathfindingArray */
 	void LoadPathfindingArray( vector< vector< int > > &arrayVector );
@@ -41,34 +81,117 @@ public:
 	void ClearPathfindingArray( void );
 	void ClearObjectArray( void );
 	
-	/* A* (ish) Pathfinding Algorithm */
+	/* A* Pathfinding Algorithm */
 	XYCoords FindPath( XYCoords start, XYCoords target );
 	
+	/* Whole route - fills path with every node after start up to target */
+	bool FindFullPath( XYCoords start, XYCoords target, vector< XYCoords > &path );
+	
+	/* Queued FindFullPath - returns a request id to collect the route with */
+	/* Asking for a start / target already queued shares that request      */
+	int RequestPath( XYCoords start, XYCoords target, int priority );
+	int GetPathResult( int requestId, vector< XYCoords > &path );
+	void CancelPathRequest( int requestId );
+	void ProcessPathRequests( void );
+	void SetPathBudget( int nodeBudget );
+	int GetQueuedPathCount( void ) const;
+	int GetFrameNodesExpanded( void ) const;
+	
+	/* FindFullPath through the cluster hierarchy - on by default for big levels */
+	void UseHierarchy( bool useHierarchy );
+	bool IsUsingHierarchy( void ) const;
+	PathHierarchy& GetHierarchy( void );
+	
+	/* Shared route to the player - built again only when it changes node */
+	void UpdateFlowField( XYCoords goal );
+	XYCoords GetFlowFieldGoal( void ) const;
+	XYCoords GetFlowStep( XYCoords position );
+	FlowField& GetFlowField( void );
+	
+	/* Checks the nodes of a cached path from firstNode on haven't been blocked */
+	bool IsPathClear( const vector< XYCoords > &path, int firstNode );
+	
+	/* Changes each time a node is blocked or gains an object - cached */
+	/* paths only need checking when it differs from their copy        */
+	int GetObstacleStamp( void ) const;
+	
+	/* Nodes taken off the open heap by the last search */
+	int GetNodesExpanded( void ) const;
+	
+	/* Cost of the last path found - PATH_EDGE_COST / PATH_CORNER_COST per move */
+	int GetPathCost( void ) const;
+	
 	/* External checks for character objects */
 	bool IsNodeFree( XYCoords position );
 	bool NodeContainsEnemy( XYCoords position );
 	bool NodeContainsPlayer( XYCoords position );
 	float GetObjectDistance( XYCoords currentPosition, XYCoords targetPosition );
+	bool IsObjectWithin( XYCoords currentPosition, XYCoords targetPosition, float distance );
+	
+	/* Enemies less than distance (in pixels, as GetObjectDistance) from position */
+	bool AnyEnemyWithin( XYCoords position, float distance );
+	int CountEnemiesWithin( XYCoords position, float distance );
+	OccupancyGrid& GetOccupancy( void );
 	
 private:
+	friend class PathHierarchy; // shares GetNeighbours / GetHeuristic / mOccupancy
+	friend class FlowField;     // shares GetNeighbours
+	
 	PathController::PathController();
 	static PathController* instance;
 	
 	int mWorldWidth, mWorldHeight;
 	
-	Node mActiveNode;  // point of reference node
-
-	Node mSteps[8];    // legal moves array
-	int mStepCounter;  // legal moves counter
+	/* A* data - indexed by ( y * mWorldWidth ) + x */
+	vector< int > mCostSoFar; // g - cost of the cheapest route found from the start
+	vector< int > mEstimate;  // f - mCostSoFar + heuristic to the target
+	vector< int > mParent;    // node that route arrived from
+	vector< int > mHeapIndex; // position in mOpenHeap, PATH_UNSEEN or PATH_CLOSED
+	vector< int > mOpenHeap;  // binary min heap of node indices by mEstimate
+	
+	vector< unsigned int > mSearchStamp; // search the node's A* data belongs to
+	unsigned int mSearchId;              // current search - 0 is never used
 	
-	bool mTargetFound; // traceback kill flag
+	vector< int > mMarkedNodes; // nodes FindPath marked PATH - for ClearPathfindingArray
 	
-	priority_queue< Node, vector< Node >, greater< Node > > mWorkingSet;
-	priority_queue< Node, vector< Node >, greater< Node > > mTracebackSet;
+	OccupancyGrid mOccupancy; // blocked / player / enemy / objective bits of mPathfindingArray
+	
+	PathHierarchy mHierarchy;
+	vector< int > mHierarchyPath;
+	bool mUseHierarchy;
+	
+	FlowField mFlowField;
+	
+	/* Queued FindFullPath */
+	struct PathRequest {
+		int mId;
+		XYCoords mStart, mTarget;
+		int mPriority;
+		int mState;                 // PATH_REQUEST_PENDING / FOUND / FAILED
+		int mWaiting;               // characters still to collect it
+		int mStamp;                 // mObstacleStamp when searched
+		vector< XYCoords > mPath;
+	};
+	vector< PathRequest > mPathRequests;
+	int mNextRequestId;
+	int mPathBudget;
+	int mFrameNodesExpanded;
+	
+	int mNodesExpanded;
+	int mPathCost;
+	int mObstacleStamp;
 	
 	/* A* Functions */
-	void GenerateMoves( vector< vector< Node > > &arrayVector, Node currentNode ); 
-	float GetDistance( Node currentNode, Node targetNode );
+	bool SearchPath( int startIndex, int targetIndex, bool avoidObjects );
+	int GetNeighbours( int nodeIndex, int* neighbours, int* costs );
+	int GetHeuristic( int nodeIndex, int targetIndex );
+	
+	/* Open Heap Functions */
+	void PushOpen( int nodeIndex );
+	int PopOpen( void );
+	void SiftUp( int heapPosition );
+	void SiftDown( int heapPosition );
+	bool IsCheaper( int nodeIndex, int otherIndex );
 	
 	/* Saftey Condition */
 	bool CheckIfInRange( XYCoords position );
@@ -0,0 +1,120 @@
+#include "PathFollower.h"
+#include "PathController.h"
+
+
+/*
+=======================
+Constructor
+No route and no request
+=======================
+*/
+PathFollower::PathFollower() :
+ mPathStart( -1, -1 ), mPathTarget( -1, -1 ), mPathIndex( 0 ), mPathStamp( 0 ), mPathRequest( -1 ) {
+}
+
+
+/*
+================
+Destructor
+Tidies up vector
+================
+*/
+PathFollower::~PathFollower() {
+	mPath.clear();
+}
+
+
+/*
+=================================================================
+GetNextNode
+Returns the next node of the cached route towards target - asking
+PATHFINDER for a new one when it no longer leads there from
+position. The new route is collected by a later frame's call
+=================================================================
+*/
+XYCoords PathFollower::GetNextNode( XYCoords position, XYCoords target, int priority ) {
+	/* Chasing the player - read the shared flow field instead */
+	if( target == PATHFINDER -> GetFlowFieldGoal() ) {
+		XYCoords flowStep = PATHFINDER -> GetFlowStep( position );
+		if( flowStep.mX != -1 ) {
+			return flowStep;
+		}
+	}
+	
+	/* Route queued on an earlier frame */
+	if( mPathRequest != -1 ) {
+		if( ( mPathStart != position ) || ( mPathTarget != target ) ) {
+			/* Moved or retargeted since - no use now */
+			CancelRequest();
+		} else {
+			int requestState = PATHFINDER -> GetPathResult( mPathRequest, mPath );
+			if( requestState == PATH_REQUEST_PENDING ) {
+				return XYCoords( -1, -1 );
+			}
+			mPathRequest = -1;
+			mPathIndex = 0;
+			mPathStamp = PATHFINDER -> GetObstacleStamp();
+			if( requestState != PATH_REQUEST_FOUND ) {
+				return XYCoords( -1, -1 );
+			}
+		}
+	}
+	
+	/* Arrived at the node being moved to */
+	if( ( mPathIndex < ( int )mPath.size() ) && ( mPath[ mPathIndex ] == position ) ) {
+		mPathIndex++;
+	}
+	
+	/* Same target and still on the path */
+	bool pathValid = false;
+	if( ( mPathTarget == target ) && ( mPathIndex < ( int )mPath.size() ) ) {
+		if( mPathIndex == 0 ) {
+			pathValid = ( mPathStart == position );
+		} else {
+			pathValid = ( mPath[ mPathIndex - 1 ] == position );
+		}
+	}
+	
+	/* Something was blocked or moved somewhere - check the rest of the path */
+	if( ( pathValid ) && ( mPathStamp != PATHFINDER -> GetObstacleStamp() ) ) {
+		pathValid = PATHFINDER -> IsPathClear( mPath, mPathIndex );
+		mPathStamp = PATHFINDER -> GetObstacleStamp();
+	}
+	
+	/* Repair - queue a search from here */
+	if( !pathValid ) {
+		mPathStart = position;
+		mPathTarget = target;
+		mPathIndex = 0;
+		mPath.clear();
+		mPathRequest = PATHFINDER -> RequestPath( position, target, priority );
+		return XYCoords( -1, -1 );
+	}
+	
+	return mPath[ mPathIndex ];
+}
+
+
+/*
+=====================================
+IsWaiting
+True while a queued search is pending
+=====================================
+*/
+bool PathFollower::IsWaiting( void ) const {
+	return mPathRequest != -1;
+}
+
+
+/*
+=============================
+CancelRequest
+Drops a queued search, if any
+=============================
+*/
+void PathFollower::CancelRequest( void ) {
+	if( mPathRequest != -1 ) {
+		PATHFINDER -> CancelPathRequest( mPathRequest );
+		mPathRequest = -1;
+	}
+}
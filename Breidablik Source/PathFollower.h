@@ -0,0 +1,47 @@
+#ifndef _PATHFOLLOWER_H_
+#define _PATHFOLLOWER_H_
+
+
+#include "XYCoords.h"
+#include <vector>
+
+
+/*
+=====================================================================
+PathFollower
+A cached route to a target and the walk along it - shared by
+Character and EnemyStore so both follow paths the same way
+Only searches again when the target changes, the walker is not where
+the route expects, or a node still to be walked was blocked. The
+search is queued with PATHFINDER and collected on a later frame
+Walkers chasing the player follow the shared flow field instead while
+they are inside it
+Destroying one leaves a queued search alone so it can be copied
+around a vector - call CancelRequest once it is no longer wanted
+=====================================================================
+*/
+class PathFollower {
+public:
+	PathFollower::PathFollower();
+	PathFollower::~PathFollower();
+	
+	/* Next node from position towards target - (-1,-1) while a search is */
+	/* queued or when there is no route                                  */
+	XYCoords GetNextNode( XYCoords position, XYCoords target, int priority );
+	
+	/* A search is queued and not yet collected */
+	bool IsWaiting( void ) const;
+	
+	/* Drops a queued search - nobody left to collect it */
+	void CancelRequest( void );
+
+private:
+	vector< XYCoords > mPath; // cached route - nodes after mPathStart up to mPathTarget
+	XYCoords mPathStart;      // node mPath was searched from
+	XYCoords mPathTarget;     // target mPath leads to
+	int mPathIndex;           // next node of mPath to move to
+	int mPathStamp;           // PATHFINDER obstacle stamp mPath was last checked against
+	int mPathRequest;         // queued PATHFINDER request for mPath - -1 if none
+};
+
+#endif
@@ -0,0 +1,740 @@
+#include "PathHierarchy.h"
+#include "PathController.h"
+#include <stdio.h>
+
+
+/*
+=========================
+Constructor
+Empty until Init is called
+=========================
+*/
+PathHierarchy::PathHierarchy() :
+ pPathController( NULL ), mWorldWidth( 0 ), mWorldHeight( 0 ), mClustersWide( 0 ), mClustersHigh( 0 ),
+ mAbstractId( 0 ), mPathCost( 0 ), mNodesExpanded( 0 ) {
+}
+
+
+/*
+=================
+Destructor
+Tidies up vectors
+=================
+*/
+PathHierarchy::~PathHierarchy() {
+	mClusters.clear();
+}
+
+
+/*
+=========================================
+Priority Queue > overload
+Lower cost is higher priority
+=========================================
+*/
+bool PathHierarchy::SearchEntry::operator > ( const SearchEntry &otherEntry ) const {
+	return mCost > otherEntry.mCost;
+}
+
+
+/*
+===============================================
+Init
+Splits the level into clusters - the graph is
+built on the first query after InvalidateAll
+===============================================
+*/
+void PathHierarchy::Init( PathController* pathController, int worldWidth, int worldHeight ) {
+	pPathController = pathController;
+	mWorldWidth = worldWidth;
+	mWorldHeight = worldHeight;
+	mClustersWide = ( mWorldWidth + PATH_CLUSTER_WIDTH - 1 ) / PATH_CLUSTER_WIDTH;
+	mClustersHigh = ( mWorldHeight + PATH_CLUSTER_HEIGHT - 1 ) / PATH_CLUSTER_HEIGHT;
+	
+	/* Clusters - the last row / column may be smaller */
+	mClusters.clear();
+	mClusters.resize( mClustersWide * mClustersHigh );
+	for( int clusterY = 0; clusterY < mClustersHigh; clusterY++ ) {
+		for( int clusterX = 0; clusterX < mClustersWide; clusterX++ ) {
+			Cluster &cluster = mClusters[ ( clusterY * mClustersWide ) + clusterX ];
+			cluster.mMinX = clusterX * PATH_CLUSTER_WIDTH;
+			cluster.mMinY = clusterY * PATH_CLUSTER_HEIGHT;
+			cluster.mMaxX = cluster.mMinX + PATH_CLUSTER_WIDTH - 1;
+			cluster.mMaxY = cluster.mMinY + PATH_CLUSTER_HEIGHT - 1;
+			if( cluster.mMaxX >= mWorldWidth ) {
+				cluster.mMaxX = mWorldWidth - 1;
+			}
+			if( cluster.mMaxY >= mWorldHeight ) {
+				cluster.mMaxY = mWorldHeight - 1;
+			}
+			cluster.mDirty = false;
+		}
+	}
+	mDirtyClusters.clear();
+	
+	/* Search data */
+	int nodeCount = mWorldWidth * mWorldHeight;
+	mEntranceSlot.assign( nodeCount, -1 );
+	mComponent.assign( nodeCount, -1 );
+	mLocalCost.resize( PATH_CLUSTER_WIDTH * PATH_CLUSTER_HEIGHT );
+	mLocalParent.resize( PATH_CLUSTER_WIDTH * PATH_CLUSTER_HEIGHT );
+	mAbstractStamp.assign( nodeCount, 0 );
+	mAbstractId = 0;
+	mAbstractCost.resize( nodeCount );
+	mAbstractParent.resize( nodeCount );
+	
+	InvalidateAll();
+}
+
+
+/*
+==================================
+InvalidateAll
+Whole graph rebuilt on next query
+==================================
+*/
+void PathHierarchy::InvalidateAll( void ) {
+	for( int i = 0; i < ( int )mClusters.size(); i++ ) {
+		if( !mClusters[ i ].mDirty ) {
+			mClusters[ i ].mDirty = true;
+			mDirtyClusters.push_back( i );
+		}
+	}
+}
+
+
+/*
+=======================================================
+InvalidateNode
+A node was blocked / unblocked - its cluster is rebuilt
+on the next query (and its neighbours' entrances)
+=======================================================
+*/
+void PathHierarchy::InvalidateNode( int nodeIndex ) {
+	int clusterIndex = GetCluster( nodeIndex );
+	if( !mClusters[ clusterIndex ].mDirty ) {
+		mClusters[ clusterIndex ].mDirty = true;
+		mDirtyClusters.push_back( clusterIndex );
+	}
+}
+
+
+/*
+====================================================================
+FindPath
+Refines the route through the entrance graph into nodes - the local
+route instead when start and target share a cluster and one exists
+Routes around nodes holding objects inside each cluster where it can
+====================================================================
+*/
+bool PathHierarchy::FindPath( int startIndex, int targetIndex, vector< int > &path ) {
+	path.clear();
+	mPathCost = 0;
+	mNodesExpanded = 0;
+	if( startIndex == targetIndex ) {
+		return false;
+	}
+	
+	Rebuild();
+	
+	int startCluster = GetCluster( startIndex );
+	int targetCluster = GetCluster( targetIndex );
+	
+	/* Same cluster - the local route if there is one */
+	if( startCluster == targetCluster ) {
+		int cost = SearchCluster( startCluster, startIndex, targetIndex, true );
+		if( cost < 0 ) {
+			cost = SearchCluster( startCluster, startIndex, targetIndex, false );
+		}
+		if( cost >= 0 ) {
+			TraceCluster( startCluster, startIndex, targetIndex, path );
+			mPathCost = cost;
+			return true;
+		}
+	}
+	
+	/* Start to its clusters entrances */
+	const Cluster &start = mClusters[ startCluster ];
+	SearchCluster( startCluster, startIndex, -1, false );
+	mStartCosts.resize( start.mEntrances.size() );
+	for( int i = 0; i < ( int )start.mEntrances.size(); i++ ) {
+		int x = start.mEntrances[ i ] % mWorldWidth;
+		int y = start.mEntrances[ i ] / mWorldWidth;
+		mStartCosts[ i ] = mLocalCost[ ( ( y - start.mMinY ) * PATH_CLUSTER_WIDTH ) + ( x - start.mMinX ) ];
+	}
+	
+	/* Target's cluster entrances to the target - moves cost the same both ways */
+	const Cluster &target = mClusters[ targetCluster ];
+	SearchCluster( targetCluster, targetIndex, -1, false );
+	mTargetCosts.resize( target.mEntrances.size() );
+	for( int i = 0; i < ( int )target.mEntrances.size(); i++ ) {
+		int x = target.mEntrances[ i ] % mWorldWidth;
+		int y = target.mEntrances[ i ] / mWorldWidth;
+		mTargetCosts[ i ] = mLocalCost[ ( ( y - target.mMinY ) * PATH_CLUSTER_WIDTH ) + ( x - target.mMinX ) ];
+	}
+	
+	/* Route through the entrances */
+	if( !SearchEntrances( startIndex, targetIndex ) ) {
+		return false;
+	}
+	mRoute.clear();
+	for( int nodeIndex = targetIndex; nodeIndex != startIndex; nodeIndex = mAbstractParent[ nodeIndex ] ) {
+		mRoute.push_back( nodeIndex );
+	}
+	mRoute.push_back( startIndex );
+	
+	/* Refine - searched through each cluster, a single move between them */
+	for( int i = ( int )mRoute.size() - 1; i > 0; i-- ) {
+		int fromNode = mRoute[ i ];
+		int toNode = mRoute[ i - 1 ];
+		int clusterIndex = GetCluster( fromNode );
+		if( clusterIndex == GetCluster( toNode ) ) {
+			int cost = SearchCluster( clusterIndex, fromNode, toNode, true );
+			if( cost < 0 ) {
+				cost = SearchCluster( clusterIndex, fromNode, toNode, false );
+			}
+			TraceCluster( clusterIndex, fromNode, toNode, path );
+			mPathCost += cost;
+		} else {
+			path.push_back( toNode );
+			mPathCost += mAbstractCost[ toNode ] - mAbstractCost[ fromNode ];
+		}
+	}
+	
+	return true;
+}
+
+
+/*
+==========================
+GetPathCost
+Cost of the last path found
+==========================
+*/
+int PathHierarchy::GetPathCost( void ) const {
+	return mPathCost;
+}
+
+
+/*
+=================================================
+GetNodesExpanded
+Nodes and entrances expanded by the last query
+=================================================
+*/
+int PathHierarchy::GetNodesExpanded( void ) const {
+	return mNodesExpanded;
+}
+
+
+/*
+===================================
+GetEntranceCount
+Size of the entrance graph as built
+===================================
+*/
+int PathHierarchy::GetEntranceCount( void ) const {
+	int entranceCount = 0;
+	for( int i = 0; i < ( int )mClusters.size(); i++ ) {
+		entranceCount += mClusters[ i ].mEntrances.size();
+	}
+	return entranceCount;
+}
+
+
+/*
+=====================================================================
+Rebuild
+Transitions of the dirty clusters are found again, then entrances
+and their costs for them and every cluster next to them (whose
+transitions into the dirty clusters changed)
+=====================================================================
+*/
+void PathHierarchy::Rebuild( void ) {
+	if( mDirtyClusters.empty() ) {
+		return;
+	}
+	
+	vector< bool > affected( mClusters.size(), false );
+	vector< int > affectedClusters;
+	
+	/* Forget transitions out of and into dirty clusters */
+	for( int i = 0; i < ( int )mDirtyClusters.size(); i++ ) {
+		int clusterIndex = mDirtyClusters[ i ];
+		int clusterX = clusterIndex % mClustersWide;
+		int clusterY = clusterIndex / mClustersWide;
+		mClusters[ clusterIndex ].mTransitions.clear();
+		
+		for( int y = clusterY - 1; y <= clusterY + 1; y++ ) {
+			for( int x = clusterX - 1; x <= clusterX + 1; x++ ) {
+				if( ( x < 0 ) || ( x >= mClustersWide ) || ( y < 0 ) || ( y >= mClustersHigh ) ) {
+					continue;
+				}
+				int neighbourIndex = ( y * mClustersWide ) + x;
+				
+				/* Keep the transitions that dont lead into this cluster */
+				vector< Transition > &transitions = mClusters[ neighbourIndex ].mTransitions;
+				int kept = 0;
+				for( int j = 0; j < ( int )transitions.size(); j++ ) {
+					if( GetCluster( transitions[ j ].mTo ) != clusterIndex ) {
+						transitions[ kept ] = transitions[ j ];
+						kept++;
+					}
+				}
+				transitions.resize( kept );
+				
+				if( !affected[ neighbourIndex ] ) {
+					affected[ neighbourIndex ] = true;
+					affectedClusters.push_back( neighbourIndex );
+				}
+			}
+		}
+	}
+	
+	/* New transitions - both ends' groups needed first */
+	for( int i = 0; i < ( int )mDirtyClusters.size(); i++ ) {
+		LabelComponents( mDirtyClusters[ i ] );
+	}
+	for( int i = 0; i < ( int )mDirtyClusters.size(); i++ ) {
+		BuildTransitions( mDirtyClusters[ i ] );
+	}
+	for( int i = 0; i < ( int )mDirtyClusters.size(); i++ ) {
+		mClusters[ mDirtyClusters[ i ] ].mDirty = false;
+	}
+	mDirtyClusters.clear();
+	
+	/* Entrances and the costs between them */
+	for( int i = 0; i < ( int )affectedClusters.size(); i++ ) {
+		BuildEntrances( affectedClusters[ i ] );
+	}
+}
+
+
+/*
+============================================================
+LabelComponents
+Floods each group of free nodes that can reach each other
+without leaving the cluster with its own number
+============================================================
+*/
+void PathHierarchy::LabelComponents( int clusterIndex ) {
+	const Cluster &cluster = mClusters[ clusterIndex ];
+	int neighbours[ 8 ];
+	int costs[ 8 ];
+	
+	for( int y = cluster.mMinY; y <= cluster.mMaxY; y++ ) {
+		for( int x = cluster.mMinX; x <= cluster.mMaxX; x++ ) {
+			mComponent[ ( y * mWorldWidth ) + x ] = -1;
+		}
+	}
+	
+	int componentCount = 0;
+	for( int y = cluster.mMinY; y <= cluster.mMaxY; y++ ) {
+		for( int x = cluster.mMinX; x <= cluster.mMaxX; x++ ) {
+			int nodeIndex = ( y * mWorldWidth ) + x;
+			if( ( mComponent[ nodeIndex ] != -1 ) || ( pPathController->mOccupancy.Test( OccupancyGrid::BLOCKED, x, y ) ) ) {
+				continue;
+			}
+			
+			/* Flood a new group */
+			mComponent[ nodeIndex ] = componentCount;
+			mLocalStack.clear();
+			mLocalStack.push_back( nodeIndex );
+			while( !mLocalStack.empty() ) {
+				int currentNode = mLocalStack.back();
+				mLocalStack.pop_back();
+				
+				int neighbourCount = pPathController->GetNeighbours( currentNode, neighbours, costs );
+				for( int i = 0; i < neighbourCount; i++ ) {
+					int neighbourX = neighbours[ i ] % mWorldWidth;
+					int neighbourY = neighbours[ i ] / mWorldWidth;
+					if( ( neighbourX < cluster.mMinX ) || ( neighbourX > cluster.mMaxX ) ||
+					    ( neighbourY < cluster.mMinY ) || ( neighbourY > cluster.mMaxY ) ) {
+						continue;
+					}
+					if( mComponent[ neighbours[ i ] ] == -1 ) {
+						mComponent[ neighbours[ i ] ] = componentCount;
+						mLocalStack.push_back( neighbours[ i ] );
+					}
+				}
+			}
+			componentCount++;
+		}
+	}
+}
+
+
+/*
+======================================================================
+BuildTransitions
+Finds every move from a node on the clusters border into another
+cluster, then groups them by neighbour and the groups at both ends -
+the middle move of each group (or each PATH_ENTRANCE_LENGTH moves of
+it) becomes a transition
+Moves into a dirty cluster before this one were found from that side
+======================================================================
+*/
+void PathHierarchy::BuildTransitions( int clusterIndex ) {
+	const Cluster &cluster = mClusters[ clusterIndex ];
+	vector< Transition > crossings;
+	vector< int > crossingClusters;
+	int neighbours[ 8 ];
+	int costs[ 8 ];
+	
+	/* Moves out of the cluster - N / S moves cross two rows */
+	for( int y = cluster.mMinY; y <= cluster.mMaxY; y++ ) {
+		for( int x = cluster.mMinX; x <= cluster.mMaxX; x++ ) {
+			if( ( x != cluster.mMinX ) && ( x != cluster.mMaxX ) && ( y > cluster.mMinY + 1 ) && ( y < cluster.mMaxY - 1 ) ) {
+				continue;
+			}
+			if( pPathController->mOccupancy.Test( OccupancyGrid::BLOCKED, x, y ) ) {
+				continue;
+			}
+			
+			int nodeIndex = ( y * mWorldWidth ) + x;
+			int neighbourCount = pPathController->GetNeighbours( nodeIndex, neighbours, costs );
+			for( int i = 0; i < neighbourCount; i++ ) {
+				int neighbourCluster = GetCluster( neighbours[ i ] );
+				if( neighbourCluster == clusterIndex ) {
+					continue;
+				}
+				if( ( mClusters[ neighbourCluster ].mDirty ) && ( neighbourCluster < clusterIndex ) ) {
+					continue;
+				}
+				
+				Transition crossing;
+				crossing.mFrom = nodeIndex;
+				crossing.mTo = neighbours[ i ];
+				crossing.mCost = costs[ i ];
+				crossings.push_back( crossing );
+				crossingClusters.push_back( neighbourCluster );
+			}
+		}
+	}
+	
+	/* Each neighbouring cluster and pair of groups in turn */
+	vector< bool > used( crossings.size(), false );
+	vector< int > run;
+	for( int i = 0; i < ( int )crossings.size(); i++ ) {
+		if( used[ i ] ) {
+			continue;
+		}
+		
+		run.clear();
+		for( int j = i; j < ( int )crossings.size(); j++ ) {
+			if( ( crossingClusters[ j ] != crossingClusters[ i ] ) ||
+			    ( mComponent[ crossings[ j ].mFrom ] != mComponent[ crossings[ i ].mFrom ] ) ||
+			    ( mComponent[ crossings[ j ].mTo ] != mComponent[ crossings[ i ].mTo ] ) ) {
+				continue;
+			}
+			used[ j ] = true;
+			
+			/* Long boundaries get a transition every PATH_ENTRANCE_LENGTH moves */
+			if( ( int )run.size() == PATH_ENTRANCE_LENGTH ) {
+				const Transition &middle = crossings[ run[ run.size() / 2 ] ];
+				AddTransition( middle.mFrom, middle.mTo, middle.mCost );
+				run.clear();
+			}
+			run.push_back( j );
+		}
+		
+		const Transition &middle = crossings[ run[ run.size() / 2 ] ];
+		AddTransition( middle.mFrom, middle.mTo, middle.mCost );
+	}
+}
+
+
+/*
+=================================================
+AddTransition
+Adds the move to both clusters - costs the same
+either way
+=================================================
+*/
+void PathHierarchy::AddTransition( int fromNode, int toNode, int cost ) {
+	Transition transition;
+	transition.mFrom = fromNode;
+	transition.mTo = toNode;
+	transition.mCost = cost;
+	mClusters[ GetCluster( fromNode ) ].mTransitions.push_back( transition );
+	
+	transition.mFrom = toNode;
+	transition.mTo = fromNode;
+	mClusters[ GetCluster( toNode ) ].mTransitions.push_back( transition );
+}
+
+
+/*
+=============================================================
+BuildEntrances
+Entrances are the cluster's ends of its transitions - one
+search from each within the cluster gives the cost to the rest
+=============================================================
+*/
+void PathHierarchy::BuildEntrances( int clusterIndex ) {
+	Cluster &cluster = mClusters[ clusterIndex ];
+	
+	/* Forget the old entrances */
+	for( int i = 0; i < ( int )cluster.mEntrances.size(); i++ ) {
+		mEntranceSlot[ cluster.mEntrances[ i ] ] = -1;
+	}
+	cluster.mEntrances.clear();
+	
+	/* One per node - several transitions can share it */
+	for( int i = 0; i < ( int )cluster.mTransitions.size(); i++ ) {
+		int nodeIndex = cluster.mTransitions[ i ].mFrom;
+		if( mEntranceSlot[ nodeIndex ] == -1 ) {
+			mEntranceSlot[ nodeIndex ] = cluster.mEntrances.size();
+			cluster.mEntrances.push_back( nodeIndex );
+		}
+	}
+	
+	/* Costs between them */
+	int entranceCount = cluster.mEntrances.size();
+	cluster.mEntranceCosts.assign( entranceCount * entranceCount, -1 );
+	for( int i = 0; i < entranceCount; i++ ) {
+		SearchCluster( clusterIndex, cluster.mEntrances[ i ], -1, false );
+		for( int j = 0; j < entranceCount; j++ ) {
+			int x = cluster.mEntrances[ j ] % mWorldWidth;
+			int y = cluster.mEntrances[ j ] / mWorldWidth;
+			cluster.mEntranceCosts[ ( i * entranceCount ) + j ] = mLocalCost[ ( ( y - cluster.mMinY ) * PATH_CLUSTER_WIDTH ) + ( x - cluster.mMinX ) ];
+		}
+	}
+}
+
+
+/*
+==============================
+GetCluster
+Cluster a node index falls in
+==============================
+*/
+int PathHierarchy::GetCluster( int nodeIndex ) const {
+	int x = nodeIndex % mWorldWidth;
+	int y = nodeIndex / mWorldWidth;
+	return ( ( y / PATH_CLUSTER_HEIGHT ) * mClustersWide ) + ( x / PATH_CLUSTER_WIDTH );
+}
+
+
+/*
+=====================================================================
+SearchCluster
+A* from startNode without leaving the cluster - stops at targetNode
+and returns its cost (-1 if it cant be reached), or with targetNode
+-1 (no heuristic - Dijkstra) fills mLocalCost for the whole cluster
+avoidObjects treats nodes holding an object (other than the target)
+as blocked
+=====================================================================
+*/
+int PathHierarchy::SearchCluster( int clusterIndex, int startNode, int targetNode, bool avoidObjects ) {
+	const Cluster &cluster = mClusters[ clusterIndex ];
+	int neighbours[ 8 ];
+	int costs[ 8 ];
+	
+	for( int i = 0; i < ( int )mLocalCost.size(); i++ ) {
+		mLocalCost[ i ] = -1;
+	}
+	while( !mOpenSet.empty() ) {
+		mOpenSet.pop();
+	}
+	
+	/* Open the start */
+	int startLocal = ( ( ( startNode / mWorldWidth ) - cluster.mMinY ) * PATH_CLUSTER_WIDTH ) + ( ( startNode % mWorldWidth ) - cluster.mMinX );
+	mLocalCost[ startLocal ] = 0;
+	mLocalParent[ startLocal ] = startNode;
+	SearchEntry entry;
+	entry.mCost = ( targetNode == -1 ) ? 0 : pPathController->GetHeuristic( startNode, targetNode );
+	entry.mNode = startNode;
+	mOpenSet.push( entry );
+	
+	while( !mOpenSet.empty() ) {
+		entry = mOpenSet.top();
+		mOpenSet.pop();
+		
+		/* Already reached for less */
+		int currentLocal = ( ( ( entry.mNode / mWorldWidth ) - cluster.mMinY ) * PATH_CLUSTER_WIDTH ) + ( ( entry.mNode % mWorldWidth ) - cluster.mMinX );
+		int currentCost = mLocalCost[ currentLocal ];
+		if( ( targetNode != -1 ) && ( entry.mCost > currentCost + pPathController->GetHeuristic( entry.mNode, targetNode ) ) ) {
+			continue;
+		}
+		if( ( targetNode == -1 ) && ( entry.mCost > currentCost ) ) {
+			continue;
+		}
+		mNodesExpanded++;
+		
+		if( entry.mNode == targetNode ) {
+			return currentCost;
+		}
+		
+		int neighbourCount = pPathController->GetNeighbours( entry.mNode, neighbours, costs );
+		for( int i = 0; i < neighbourCount; i++ ) {
+			int x = neighbours[ i ] % mWorldWidth;
+			int y = neighbours[ i ] / mWorldWidth;
+			
+			/* Within the cluster */
+			if( ( x < cluster.mMinX ) || ( x > cluster.mMaxX ) || ( y < cluster.mMinY ) || ( y > cluster.mMaxY ) ) {
+				continue;
+			}
+			if( ( avoidObjects ) && ( neighbours[ i ] != targetNode ) &&
+			    ( pPathController->mOccupancy.TestObject( x, y ) ) ) {
+				continue;
+			}
+			
+			int local = ( ( y - cluster.mMinY ) * PATH_CLUSTER_WIDTH ) + ( x - cluster.mMinX );
+			int cost = currentCost + costs[ i ];
+			if( ( mLocalCost[ local ] == -1 ) || ( cost < mLocalCost[ local ] ) ) {
+				mLocalCost[ local ] = cost;
+				mLocalParent[ local ] = entry.mNode;
+				
+				SearchEntry nextEntry;
+				nextEntry.mCost = ( targetNode == -1 ) ? cost : cost + pPathController->GetHeuristic( neighbours[ i ], targetNode );
+				nextEntry.mNode = neighbours[ i ];
+				mOpenSet.push( nextEntry );
+			}
+		}
+	}
+	
+	if( targetNode == -1 ) {
+		return 0;
+	}
+	return -1;
+}
+
+
+/*
+==========================================================
+TraceCluster
+Appends the nodes after startNode up to targetNode of the
+last SearchCluster to path
+==========================================================
+*/
+void PathHierarchy::TraceCluster( int clusterIndex, int startNode, int targetNode, vector< int > &path ) {
+	const Cluster &cluster = mClusters[ clusterIndex ];
+	int firstNode = path.size();
+	
+	/* Target back to start */
+	for( int nodeIndex = targetNode; nodeIndex != startNode; ) {
+		path.push_back( nodeIndex );
+		nodeIndex = mLocalParent[ ( ( ( nodeIndex / mWorldWidth ) - cluster.mMinY ) * PATH_CLUSTER_WIDTH ) + ( ( nodeIndex % mWorldWidth ) - cluster.mMinX ) ];
+	}
+	
+	/* Then reversed */
+	for( int i = firstNode, j = ( int )path.size() - 1; i < j; i++, j-- ) {
+		int swapNode = path[ i ];
+		path[ i ] = path[ j ];
+		path[ j ] = swapNode;
+	}
+}
+
+
+/*
+====================================================================
+SearchEntrances
+A* over the entrance graph - the start leads to its cluster's
+entrances and the target's cluster's entrances lead to the target
+at the costs FindPath searched. Octile distance is still consistent
+as no edge costs less than the moves it stands for
+====================================================================
+*/
+bool PathHierarchy::SearchEntrances( int startIndex, int targetIndex ) {
+	int startCluster = GetCluster( startIndex );
+	int targetCluster = GetCluster( targetIndex );
+	
+	/* New id - every node unseen */
+	mAbstractId++;
+	if( mAbstractId == 0 ) {
+		for( int i = 0; i < ( int )mAbstractStamp.size(); i++ ) {
+			mAbstractStamp[ i ] = 0;
+		}
+		mAbstractId = 1;
+	}
+	while( !mOpenSet.empty() ) {
+		mOpenSet.pop();
+	}
+	
+	/* Open the start */
+	mAbstractStamp[ startIndex ] = mAbstractId;
+	mAbstractCost[ startIndex ] = 0;
+	mAbstractParent[ startIndex ] = startIndex;
+	SearchEntry entry;
+	entry.mCost = pPathController->GetHeuristic( startIndex, targetIndex );
+	entry.mNode = startIndex;
+	mOpenSet.push( entry );
+	
+	while( !mOpenSet.empty() ) {
+		entry = mOpenSet.top();
+		mOpenSet.pop();
+		
+		/* Already reached for less */
+		int nodeIndex = entry.mNode;
+		if( entry.mCost > mAbstractCost[ nodeIndex ] + pPathController->GetHeuristic( nodeIndex, targetIndex ) ) {
+			continue;
+		}
+		mNodesExpanded++;
+		
+		if( nodeIndex == targetIndex ) {
+			return true;
+		}
+		
+		/* Start to its cluster's entrances */
+		if( nodeIndex == startIndex ) {
+			const Cluster &start = mClusters[ startCluster ];
+			for( int i = 0; i < ( int )start.mEntrances.size(); i++ ) {
+				if( mStartCosts[ i ] >= 0 ) {
+					RelaxEntrance( nodeIndex, start.mEntrances[ i ], mStartCosts[ i ], targetIndex );
+				}
+			}
+		}
+		
+		int slot = mEntranceSlot[ nodeIndex ];
+		if( slot != -1 ) {
+			int clusterIndex = GetCluster( nodeIndex );
+			const Cluster &cluster = mClusters[ clusterIndex ];
+			int entranceCount = cluster.mEntrances.size();
+			
+			/* Across the cluster */
+			for( int i = 0; i < entranceCount; i++ ) {
+				int cost = cluster.mEntranceCosts[ ( slot * entranceCount ) + i ];
+				if( ( i != slot ) && ( cost >= 0 ) ) {
+					RelaxEntrance( nodeIndex, cluster.mEntrances[ i ], cost, targetIndex );
+				}
+			}
+			
+			/* Into the next cluster */
+			for( int i = 0; i < ( int )cluster.mTransitions.size(); i++ ) {
+				if( cluster.mTransitions[ i ].mFrom == nodeIndex ) {
+					RelaxEntrance( nodeIndex, cluster.mTransitions[ i ].mTo, cluster.mTransitions[ i ].mCost, targetIndex );
+				}
+			}
+			
+			/* To the target */
+			if( ( clusterIndex == targetCluster ) && ( mTargetCosts[ slot ] >= 0 ) ) {
+				RelaxEntrance( nodeIndex, targetIndex, mTargetCosts[ slot ], targetIndex );
+			}
+		}
+	}
+	
+	/* Target cant be reached */
+	return false;
+}
+
+
+/*
+==============================================
+RelaxEntrance
+Opens toNode if reached for less than before
+==============================================
+*/
+void PathHierarchy::RelaxEntrance( int fromNode, int toNode, int cost, int targetIndex ) {
+	cost += mAbstractCost[ fromNode ];
+	if( ( mAbstractStamp[ toNode ] != mAbstractId ) || ( cost < mAbstractCost[ toNode ] ) ) {
+		mAbstractStamp[ toNode ] = mAbstractId;
+		mAbstractCost[ toNode ] = cost;
+		mAbstractParent[ toNode ] = fromNode;
+		
+		SearchEntry entry;
+		entry.mCost = cost + pPathController->GetHeuristic( toNode, targetIndex );
+		entry.mNode = toNode;
+		mOpenSet.push( entry );
+	}
+}
@@ -0,0 +1,125 @@
+#ifndef _PATHHIERARCHY_H_
+#define _PATHHIERARCHY_H_
+
+
+#include "LevelData.h"
+#include <queue>
+#include <vector>
+
+
+/* Cluster Data                                                          */
+/* Rows are half a tile apart so clusters are twice as many rows as      */
+/* columns - roughly square on screen                                    */
+static const int PATH_CLUSTER_WIDTH = 16;
+static const int PATH_CLUSTER_HEIGHT = 32;
+static const int PATH_ENTRANCE_LENGTH = 16; // most crossing moves sharing one transition
+static const int PATH_HIERARCHY_MIN_NODES = 32768; // smaller levels search the whole grid faster
+
+
+class PathController;
+
+
+/*
+===========================================================================
+PathHierarchy
+Hierarchical pathfinding (HPA*) for large levels - owned by PathController
+The grid is split into clusters, and the free nodes of each cluster into
+the groups that can reach each other without leaving it. Moves from one
+cluster into the next are grouped by the groups at both ends, and the
+middle move of each (every PATH_ENTRANCE_LENGTH moves along a long one)
+becomes a transition - its two nodes are entrances of their clusters.
+Any move across is then reachable from a transition on both sides, so
+a route exists through the entrances whenever one exists at all
+The cost between every pair of entrances in a cluster is searched once
+and kept, so a query searches the small graph of entrances and then
+refines the route one cluster at a time
+Clusters around nodes blocked / unblocked since the last query are
+rebuilt before the next
+===========================================================================
+*/
+class PathHierarchy {
+public:
+	PathHierarchy::PathHierarchy();
+	PathHierarchy::~PathHierarchy();
+	
+	void Init( PathController* pathController, int worldWidth, int worldHeight );
+	
+	/* Rebuild everything / the clusters around a node on the next query */
+	void InvalidateAll( void );
+	void InvalidateNode( int nodeIndex );
+	
+	/* Fills path with the node indices after startIndex up to targetIndex */
+	bool FindPath( int startIndex, int targetIndex, vector< int > &path );
+	
+	/* Last query */
+	int GetPathCost( void ) const;
+	int GetNodesExpanded( void ) const;
+	
+	/* Entrances in all clusters */
+	int GetEntranceCount( void ) const;
+
+private:
+	/* Move from an entrance of this cluster to one of the next */
+	struct Transition {
+		int mFrom, mTo;
+		int mCost;
+	};
+	
+	struct Cluster {
+		int mMinX, mMinY, mMaxX, mMaxY;    // nodes covered (inclusive)
+		vector< Transition > mTransitions; // out of this cluster
+		vector< int > mEntrances;          // node indices
+		vector< int > mEntranceCosts;      // entrances * entrances - -1 if unreachable within the cluster
+		bool mDirty;
+	};
+	
+	/* Priority queue entry - lowest cost on top */
+	struct SearchEntry {
+		int mCost, mNode;
+		bool operator > ( const SearchEntry &otherEntry ) const;
+	};
+	
+	PathController* pPathController;
+	
+	int mWorldWidth, mWorldHeight;
+	int mClustersWide, mClustersHigh;
+	vector< Cluster > mClusters;
+	vector< int > mDirtyClusters;
+	vector< int > mEntranceSlot; // node's place in its cluster's mEntrances - -1 if not an entrance
+	vector< int > mComponent;    // group of nodes within its cluster that can reach each other
+	
+	priority_queue< SearchEntry, vector< SearchEntry >, greater< SearchEntry > > mOpenSet;
+	
+	/* Cluster search - indexed by node within the cluster */
+	vector< int > mLocalCost;
+	vector< int > mLocalParent;
+	vector< int > mLocalStack;
+	
+	/* Entrance search - indexed by node, only valid where mAbstractStamp matches mAbstractId */
+	vector< unsigned int > mAbstractStamp;
+	unsigned int mAbstractId;
+	vector< int > mAbstractCost;
+	vector< int > mAbstractParent;
+	vector< int > mStartCosts;  // start to each entrance of its cluster
+	vector< int > mTargetCosts; // each entrance of the target's cluster to the target
+	vector< int > mRoute;
+	
+	int mPathCost;
+	int mNodesExpanded;
+	
+	/* Build Functions */
+	void Rebuild( void );
+	void LabelComponents( int clusterIndex );
+	void BuildTransitions( int clusterIndex );
+	void AddTransition( int fromNode, int toNode, int cost );
+	void BuildEntrances( int clusterIndex );
+	
+	/* Search Functions */
+	int GetCluster( int nodeIndex ) const;
+	int SearchCluster( int clusterIndex, int startNode, int targetNode, bool avoidObjects );
+	void TraceCluster( int clusterIndex, int startNode, int targetNode, vector< int > &path );
+	bool SearchEntrances( int startIndex, int targetIndex );
+	void RelaxEntrance( int fromNode, int toNode, int cost, int targetIndex );
+};
+
+#endif
@@ -46,6 +46,17 @@ ScreenViewController::~ScreenViewController() {
 }
 
 
+/*
+=====================
+Init
+Sets up for level one
+=====================
+*/
+void ScreenViewController::Init( void ) {
+	Init( LEVEL_ONE_WIDTH, LEVEL_ONE_HEIGHT, LEVEL_ONE_X_OFFSET, LEVEL_ONE_Y_OFFSET );
+}
+
+
 /*
 ====================================================
 Init
@@ -53,7 +64,7 @@ Sets ScreenViewController variables and creates two
 sprites to be used to render the map and grid
 ====================================================
 */
-void ScreenViewController::Init( void ) {
+void ScreenViewController::Init( int worldWidth, int worldHeight, int xPixelOffset, int yPixelOffset ) {
 	/* Screen Dimensions */
 	SCREENWIDTH = 640.0f;
 	SCREENHEIGHT = 512.0f;
@@ -64,10 +75,10 @@ void ScreenViewController::Init( void ) {
 	
 	/* Initialise Variables */
 	mSpeed = 5.0f;
-	mWorldWidth = LEVEL_ONE_WIDTH; 
-	mWorldHeight = LEVEL_ONE_HEIGHT;
-	mXPixelOffset = LEVEL_ONE_X_OFFSET; 
-	mYPixelOffset = LEVEL_ONE_Y_OFFSET;
+	mWorldWidth = worldWidth; 
+	mWorldHeight = worldHeight;
+	mXPixelOffset = xPixelOffset; 
+	mYPixelOffset = yPixelOffset;
 	mState = Tile::INIT; 
 	
 	/* Create VisualObjects for Rendering */
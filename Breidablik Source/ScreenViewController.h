@@ -32,6 +32,7 @@ public:
 	float SCREENWIDTH, SCREENHEIGHT;
 	
 	void Init( void );
+	void Init( int worldWidth, int worldHeight, int xPixelOffset, int yPixelOffset );
 	void Draw( vector< vector< Tile > > &vectorName );
 	void DrawGrid ( vector< vector< Tile > > &mapVector, vector< vector< Node > > &arrayVector );
 	void Update( float xAxisValue, float yAxisValue );
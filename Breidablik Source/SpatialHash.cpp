@@ -0,0 +1,215 @@
+#include "SpatialHash.h"
+#include <stdio.h>
+
+
+/*
+==========================
+Constructor
+Empty until Init is called
+==========================
+*/
+SpatialHash::SpatialHash() :
+ mWorldWidth( 0 ), mWorldHeight( 0 ), mCellsWide( 0 ), mCellsHigh( 0 ) {
+}
+
+
+/*
+================
+Destructor
+Tidies up vector
+================
+*/
+SpatialHash::~SpatialHash() {
+	mCells.clear();
+}
+
+
+/*
+=================================
+Init
+Creates empty cells for the level
+=================================
+*/
+void SpatialHash::Init( int worldWidth, int worldHeight ) {
+	mWorldWidth = worldWidth;
+	mWorldHeight = worldHeight;
+	mCellsWide = ( mWorldWidth + SPATIAL_CELL_WIDTH - 1 ) / SPATIAL_CELL_WIDTH;
+	mCellsHigh = ( mWorldHeight + SPATIAL_CELL_HEIGHT - 1 ) / SPATIAL_CELL_HEIGHT;
+	
+	mCells.clear();
+	mCells.resize( mCellsWide * mCellsHigh );
+}
+
+
+/*
+==================
+Clear
+Empties every cell
+==================
+*/
+void SpatialHash::Clear( void ) {
+	for( int i = 0; i < ( int )mCells.size(); i++ ) {
+		mCells[ i ].clear();
+	}
+}
+
+
+/*
+============================
+Insert
+Adds a character on position
+============================
+*/
+void SpatialHash::Insert( Character* character, XYCoords position ) {
+	int cellIndex = GetCell( position );
+	if( cellIndex == -1 ) {
+		printf( "Illegal SpatialHash Position \n" );
+		return;
+	}
+	
+	Entry newEntry;
+	newEntry.pCharacter = character;
+	newEntry.mPosition = position;
+	mCells[ cellIndex ].push_back( newEntry );
+}
+
+
+/*
+====================================================
+Remove
+Takes a character off position - order within a cell
+doesnt matter, so the last entry fills the gap
+====================================================
+*/
+void SpatialHash::Remove( Character* character, XYCoords position ) {
+	int cellIndex = GetCell( position );
+	if( cellIndex == -1 ) {
+		return;
+	}
+	
+	vector< Entry > &cell = mCells[ cellIndex ];
+	for( int i = 0; i < ( int )cell.size(); i++ ) {
+		if( cell[ i ].pCharacter == character ) {
+			cell[ i ] = cell.back();
+			cell.pop_back();
+			return;
+		}
+	}
+}
+
+
+/*
+=========================================================
+Move
+A character changed node - only changes cell if it has to
+=========================================================
+*/
+void SpatialHash::Move( Character* character, XYCoords from, XYCoords to ) {
+	int fromCell = GetCell( from );
+	int toCell = GetCell( to );
+	
+	/* Same cell - just update the node */
+	if( ( fromCell == toCell ) && ( fromCell != -1 ) ) {
+		vector< Entry > &cell = mCells[ fromCell ];
+		for( int i = 0; i < ( int )cell.size(); i++ ) {
+			if( cell[ i ].pCharacter == character ) {
+				cell[ i ].mPosition = to;
+				return;
+			}
+		}
+	}
+	
+	Remove( character, from );
+	Insert( character, to );
+}
+
+
+/*
+===============================
+QueryNode
+Characters standing on position
+===============================
+*/
+void SpatialHash::QueryNode( XYCoords position, vector< Character* > &found ) const {
+	found.clear();
+	int cellIndex = GetCell( position );
+	if( cellIndex == -1 ) {
+		return;
+	}
+	
+	const vector< Entry > &cell = mCells[ cellIndex ];
+	for( int i = 0; i < ( int )cell.size(); i++ ) {
+		if( cell[ i ].mPosition == position ) {
+			found.push_back( cell[ i ].pCharacter );
+		}
+	}
+}
+
+
+/*
+====================================================================
+QueryRadius
+Characters less than distance from position - the cells covering the
+square around it, then each entry's squared distance
+====================================================================
+*/
+void SpatialHash::QueryRadius( XYCoords position, float distance, vector< Character* > &found ) const {
+	found.clear();
+	if( ( distance <= 0.0f ) || ( GetCell( position ) == -1 ) ) {
+		return;
+	}
+	
+	/* Nodes that could be in range - columns 64 pixels apart, rows 32 */
+	int centreX = GetPixelX( position );
+	int centreY = position.mY * 32;
+	int reach = int( distance ) + 1;
+	int minX = ( centreX - reach ) / 64 - 1;
+	int maxX = ( centreX + reach ) / 64 + 1;
+	int minY = ( centreY - reach ) / 32 - 1;
+	int maxY = ( centreY + reach ) / 32 + 1;
+	
+	/* Cells covering those nodes */
+	int minCellX = ( minX < 0 ) ? 0 : minX / SPATIAL_CELL_WIDTH;
+	int maxCellX = ( maxX >= mWorldWidth ) ? mCellsWide - 1 : maxX / SPATIAL_CELL_WIDTH;
+	int minCellY = ( minY < 0 ) ? 0 : minY / SPATIAL_CELL_HEIGHT;
+	int maxCellY = ( maxY >= mWorldHeight ) ? mCellsHigh - 1 : maxY / SPATIAL_CELL_HEIGHT;
+	
+	float distanceSquared = distance * distance;
+	for( int cellY = minCellY; cellY <= maxCellY; cellY++ ) {
+		for( int cellX = minCellX; cellX <= maxCellX; cellX++ ) {
+			const vector< Entry > &cell = mCells[ ( cellY * mCellsWide ) + cellX ];
+			for( int i = 0; i < ( int )cell.size(); i++ ) {
+				int dx = GetPixelX( cell[ i ].mPosition ) - centreX;
+				int dy = ( cell[ i ].mPosition.mY * 32 ) - centreY;
+				if( float( ( dx * dx ) + ( dy * dy ) ) < distanceSquared ) {
+					found.push_back( cell[ i ].pCharacter );
+				}
+			}
+		}
+	}
+}
+
+
+/*
+========================================
+GetCell
+Cell holding position - -1 off the level
+========================================
+*/
+int SpatialHash::GetCell( XYCoords position ) const {
+	if( ( position.mX < 0 ) || ( position.mX >= mWorldWidth ) || ( position.mY < 0 ) || ( position.mY >= mWorldHeight ) ) {
+		return -1;
+	}
+	return ( ( position.mY / SPATIAL_CELL_HEIGHT ) * mCellsWide ) + ( position.mX / SPATIAL_CELL_WIDTH );
+}
+
+
+/*
+===================================
+GetPixelX
+Odd rows are 32 pixels to the right
+===================================
+*/
+int SpatialHash::GetPixelX( XYCoords position ) const {
+	return ( position.mX * 64 ) + ( ( position.mY % 2 != 0 ) ? 32 : 0 );
+}
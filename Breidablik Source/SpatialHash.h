@@ -0,0 +1,67 @@
+#ifndef _SPATIALHASH_H_
+#define _SPATIALHASH_H_
+
+
+#include "XYCoords.h"
+#include "LevelData.h"
+#include <vector>
+
+
+/* Cell Data                                                         */
+/* 4 columns and 8 rows are both 256 pixels - an aggro check at 134  */
+/* pixels covers at most 2 x 2 cells                                  */
+static const int SPATIAL_CELL_WIDTH = 4;
+static const int SPATIAL_CELL_HEIGHT = 8;
+
+
+class Character;
+
+
+/*
+===========================================================================
+SpatialHash
+Uniform grid of the characters in a level, keyed on their node - each
+cell lists who stands on its nodes. The level is bounded so the cell's
+place in the grid is its hash, and nothing ever collides
+Characters registered with SetSpatialHash move themselves between cells
+when they change node, so finding who is near a node looks at the few
+cells around it instead of every character
+Distances are in pixels as PathController::GetObjectDistance measures
+them, compared squared - no sqrt
+Only the pointers are stored, never followed
+===========================================================================
+*/
+class SpatialHash {
+public:
+	SpatialHash::SpatialHash();
+	SpatialHash::~SpatialHash();
+	
+	/* Empty cells covering the level */
+	void Init( int worldWidth, int worldHeight );
+	void Clear( void );
+	
+	void Insert( Character* character, XYCoords position );
+	void Remove( Character* character, XYCoords position );
+	void Move( Character* character, XYCoords from, XYCoords to );
+	
+	/* Fills found with the characters on position */
+	void QueryNode( XYCoords position, vector< Character* > &found ) const;
+	
+	/* Fills found with the characters less than distance from position */
+	void QueryRadius( XYCoords position, float distance, vector< Character* > &found ) const;
+
+private:
+	struct Entry {
+		Character* pCharacter;
+		XYCoords mPosition;
+	};
+	
+	int mWorldWidth, mWorldHeight;
+	int mCellsWide, mCellsHigh;
+	vector< vector< Entry > > mCells;
+	
+	int GetCell( XYCoords position ) const;
+	int GetPixelX( XYCoords position ) const;
+};
+
+#endif
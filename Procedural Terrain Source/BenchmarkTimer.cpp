@@ -0,0 +1,11 @@
+#include "BenchmarkTimer.h"
+
+
+// GetMilliseconds //
+double GetMilliseconds( LARGE_INTEGER start, LARGE_INTEGER end ) {
+	LARGE_INTEGER frequency;
+
+	QueryPerformanceFrequency( &frequency );
+
+	return ( double )( end.QuadPart - start.QuadPart ) * 1000.0 / ( double )frequency.QuadPart;
+}
@@ -0,0 +1,17 @@
+#ifndef _BENCHMARKTIMER_H_
+#define _BENCHMARKTIMER_H_
+
+
+// Includes //
+#include <windows.h>
+
+
+// BenchmarkTimer                                                  //
+// Performance counter timing shared by the console benchmarks -   //
+// built with each of them, never with the application             //
+
+// Milliseconds between two QueryPerformanceCounter readings
+double GetMilliseconds( LARGE_INTEGER start, LARGE_INTEGER end );
+
+
+#endif
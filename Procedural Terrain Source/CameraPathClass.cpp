@@ -0,0 +1,230 @@
+#include "CameraPathClass.h"
+
+
+// Path file identifier and version
+static const char CAMERA_PATH_MAGIC[ 4 ] = { 'C', 'P', 'T', 'H' };
+static const int  CAMERA_PATH_VERSION    = 1;
+
+
+// Default Constructor //
+CameraPathClass::CameraPathClass() :
+ mSceneRotation( 0.0f ), mWaterTranslation( 0.0f ), mPlaybackFrame( 0 ), mRecording( false ), mPlaying( false ) {
+}
+
+
+// Constructor //
+CameraPathClass::CameraPathClass( const CameraPathClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+CameraPathClass::~CameraPathClass() {
+}
+
+
+// Shutdown //
+void CameraPathClass::Shutdown() {
+	mPoses.clear();
+	mRecording = mPlaying = false;
+
+	return;
+}
+
+
+// StartRecording                                   //
+// Clears the old path and stores the scene values  //
+void CameraPathClass::StartRecording( float sceneRotation, float waterTranslation ) {
+	mPoses.clear();
+	mSceneRotation    = sceneRotation;
+	mWaterTranslation = waterTranslation;
+
+	mPlaying   = false;
+	mRecording = true;
+
+	return;
+}
+
+
+// RecordPose                   //
+// Adds this frames camera pose //
+void CameraPathClass::RecordPose( D3DXVECTOR3 position, D3DXVECTOR3 rotation ) {
+	if( !mRecording ) {
+		return;
+	}
+
+	PoseType pose;
+	pose.position = position;
+	pose.rotation = rotation;
+	mPoses.push_back( pose );
+
+	return;
+}
+
+
+// StopRecording //
+void CameraPathClass::StopRecording() {
+	mRecording = false;
+
+	return;
+}
+
+
+// IsRecording //
+bool CameraPathClass::IsRecording() {
+	return mRecording;
+}
+
+
+// StartPlayback                                               //
+// Returns the scene values stored when the path was recorded  //
+bool CameraPathClass::StartPlayback( float& sceneRotation, float& waterTranslation ) {
+	if( mPoses.empty() ) {
+		return false;
+	}
+
+	sceneRotation    = mSceneRotation;
+	waterTranslation = mWaterTranslation;
+
+	mPlaybackFrame = 0;
+	mRecording     = false;
+	mPlaying       = true;
+
+	return true;
+}
+
+
+// GetNextPose                                    //
+// Returns false once the end of the path is hit  //
+bool CameraPathClass::GetNextPose( D3DXVECTOR3& position, D3DXVECTOR3& rotation ) {
+	if( ( !mPlaying ) || ( mPlaybackFrame >= ( int )mPoses.size() ) ) {
+		mPlaying = false;
+		return false;
+	}
+
+	position = mPoses[ mPlaybackFrame ].position;
+	rotation = mPoses[ mPlaybackFrame ].rotation;
+	mPlaybackFrame++;
+
+	return true;
+}
+
+
+// StopPlayback //
+void CameraPathClass::StopPlayback() {
+	mPlaying = false;
+
+	return;
+}
+
+
+// IsPlaying //
+bool CameraPathClass::IsPlaying() {
+	return mPlaying;
+}
+
+
+// SavePath                              //
+// Writes header then the raw pose array //
+bool CameraPathClass::SavePath( const char* fileName ) {
+	FILE* filePtr;
+	HeaderType header;
+	unsigned int count;
+	int error;
+
+	// Open the path file in binary
+	error = fopen_s( &filePtr, fileName, "wb" );
+	if( error != 0 ) {
+		return false;
+	}
+
+	// Fill in the header
+	memcpy( header.magic, CAMERA_PATH_MAGIC, sizeof( header.magic ) );
+	header.version          = CAMERA_PATH_VERSION;
+	header.frameCount       = ( int )mPoses.size();
+	header.sceneRotation    = mSceneRotation;
+	header.waterTranslation = mWaterTranslation;
+
+	// Write out the header
+	count = fwrite( &header, sizeof( HeaderType ), 1, filePtr );
+	if( count != 1 ) {
+		fclose( filePtr );
+		return false;
+	}
+
+	// Write out the poses
+	if( header.frameCount > 0 ) {
+		count = fwrite( &mPoses[ 0 ], sizeof( PoseType ), header.frameCount, filePtr );
+		if( count != ( unsigned int )header.frameCount ) {
+			fclose( filePtr );
+			return false;
+		}
+	}
+
+	// Close the file
+	error = fclose( filePtr );
+	if( error != 0 ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// LoadPath                                         //
+// Reads a path written by SavePath - checks header //
+bool CameraPathClass::LoadPath( const char* fileName ) {
+	FILE* filePtr;
+	HeaderType header;
+	unsigned int count;
+	int error;
+
+	// Open the path file in binary
+	error = fopen_s( &filePtr, fileName, "rb" );
+	if( error != 0 ) {
+		return false;
+	}
+
+	// Read in the header
+	count = fread( &header, sizeof( HeaderType ), 1, filePtr );
+	if( count != 1 ) {
+		fclose( filePtr );
+		return false;
+	}
+
+	// Check this is a camera path of the right version
+	if( ( memcmp( header.magic, CAMERA_PATH_MAGIC, sizeof( header.magic ) ) != 0 ) ||
+		( header.version != CAMERA_PATH_VERSION ) ||
+		( header.frameCount < 0 ) ) {
+		fclose( filePtr );
+		return false;
+	}
+
+	// Read in the poses
+	mPoses.resize( header.frameCount );
+	if( header.frameCount > 0 ) {
+		count = fread( &mPoses[ 0 ], sizeof( PoseType ), header.frameCount, filePtr );
+		if( count != ( unsigned int )header.frameCount ) {
+			mPoses.clear();
+			fclose( filePtr );
+			return false;
+		}
+	}
+
+	mSceneRotation    = header.sceneRotation;
+	mWaterTranslation = header.waterTranslation;
+
+	// Close the file
+	error = fclose( filePtr );
+	if( error != 0 ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// GetFrameCount //
+int CameraPathClass::GetFrameCount() {
+	return ( int )mPoses.size();
+}
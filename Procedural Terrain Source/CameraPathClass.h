@@ -0,0 +1,70 @@
+#ifndef _CAMERAPATHCLASS_H_
+#define _CAMERAPATHCLASS_H_
+
+
+// Includes //
+#include <d3dx10math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+
+// CameraPathClass                                               //
+// Records the cameras pose every frame and plays it back        //
+// Poses are saved to a small binary file (header + pose array)  //
+// so the same flight path can be benchmarked between builds     //
+// The scene variables at the start of recording are also stored //
+// so the sun and water are in the same place on replay          //
+class CameraPathClass {
+private:
+	// File header
+	struct HeaderType {
+		char magic[ 4 ];
+		int version;
+		int frameCount;
+		float sceneRotation;
+		float waterTranslation;
+	};
+
+	// Camera pose for one frame
+	struct PoseType {
+		D3DXVECTOR3 position;
+		D3DXVECTOR3 rotation;
+	};
+
+public:
+	CameraPathClass();
+	CameraPathClass( const CameraPathClass& other );
+	~CameraPathClass();
+
+	void Shutdown();
+
+	// Recording functions
+	void StartRecording( float sceneRotation, float waterTranslation );
+	void RecordPose( D3DXVECTOR3 position, D3DXVECTOR3 rotation );
+	void StopRecording();
+	bool IsRecording();
+
+	// Playback functions
+	bool StartPlayback( float& sceneRotation, float& waterTranslation );
+	bool GetNextPose( D3DXVECTOR3& position, D3DXVECTOR3& rotation );
+	void StopPlayback();
+	bool IsPlaying();
+
+	// File functions
+	bool SavePath( const char* fileName );
+	bool LoadPath( const char* fileName );
+
+	int GetFrameCount();
+
+private:
+	std::vector< PoseType > mPoses;
+
+	float mSceneRotation, mWaterTranslation;
+	int mPlaybackFrame;
+
+	bool mRecording, mPlaying;
+};
+
+
+#endif
@@ -0,0 +1,328 @@
+#include "ConstantBufferManagerClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+ConstantBufferManagerClass::ConstantBufferManagerClass() :
+ pPerFrameBuffer( 0 ), pPerPassBuffer( 0 ), pPerObjectBuffer( 0 ), pPerTerrainBuffer( 0 ), pPerShadowBuffer( 0 ),
+ mPerFrameDirty( true ), mPerPassDirty( true ), mPerObjectDirty( true ), mPerTerrainDirty( true ), mPerShadowDirty( true ), mMapCount( 0 ) {
+	memset( &mPerFrameData, 0, sizeof( mPerFrameData ) );
+	memset( &mPerPassData, 0, sizeof( mPerPassData ) );
+	memset( &mPerObjectData, 0, sizeof( mPerObjectData ) );
+	memset( &mPerTerrainData, 0, sizeof( mPerTerrainData ) );
+	memset( &mPerShadowData, 0, sizeof( mPerShadowData ) );
+}
+
+
+// Constructor //
+ConstantBufferManagerClass::ConstantBufferManagerClass( const ConstantBufferManagerClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+ConstantBufferManagerClass::~ConstantBufferManagerClass() {
+}
+
+
+// Initialize                       //
+// Creates the five dynamic buffers  //
+bool ConstantBufferManagerClass::Initialize( ID3D11Device* device ) {
+	bool result;
+
+	result = CreateBuffer( device, sizeof( PerFrameBufferType ), &pPerFrameBuffer );
+	if( !result ) {
+		return false;
+	}
+
+	result = CreateBuffer( device, sizeof( PerPassBufferType ), &pPerPassBuffer );
+	if( !result ) {
+		return false;
+	}
+
+	result = CreateBuffer( device, sizeof( PerObjectBufferType ), &pPerObjectBuffer );
+	if( !result ) {
+		return false;
+	}
+
+	result = CreateBuffer( device, sizeof( PerTerrainBufferType ), &pPerTerrainBuffer );
+	if( !result ) {
+		return false;
+	}
+
+	result = CreateBuffer( device, sizeof( PerShadowBufferType ), &pPerShadowBuffer );
+	if( !result ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// Shutdown //
+void ConstantBufferManagerClass::Shutdown() {
+	// Release the per-shadow buffer
+	if( pPerShadowBuffer ) {
+		pPerShadowBuffer->Release();
+		pPerShadowBuffer = 0;
+	}
+
+	// Release the per-terrain buffer
+	if( pPerTerrainBuffer ) {
+		pPerTerrainBuffer->Release();
+		pPerTerrainBuffer = 0;
+	}
+
+	// Release the per-object buffer
+	if( pPerObjectBuffer ) {
+		pPerObjectBuffer->Release();
+		pPerObjectBuffer = 0;
+	}
+
+	// Release the per-pass buffer
+	if( pPerPassBuffer ) {
+		pPerPassBuffer->Release();
+		pPerPassBuffer = 0;
+	}
+
+	// Release the per-frame buffer
+	if( pPerFrameBuffer ) {
+		pPerFrameBuffer->Release();
+		pPerFrameBuffer = 0;
+	}
+
+	return;
+}
+
+
+// SetPerFrame                          //
+// Light and animation values for b0    //
+void ConstantBufferManagerClass::SetPerFrame( D3DXVECTOR4 ambientColor,
+	                                          D3DXVECTOR4 diffuseColor,
+											  D3DXVECTOR3 lightPosition,
+											  float time,
+											  float waveHeight,
+											  float waterTranslation,
+											  float reflectRefractScale ) {
+	PerFrameBufferType data;
+
+	data.ambientColor        = ambientColor;
+	data.diffuseColor        = diffuseColor;
+	data.lightPosition       = lightPosition;
+	data.time                = time;
+	data.waveHeight          = waveHeight;
+	data.waterTranslation    = waterTranslation;
+	data.reflectRefractScale = reflectRefractScale;
+	data.padding             = 0.0f;
+
+	// Only dirty if something changed
+	if( memcmp( &data, &mPerFrameData, sizeof( data ) ) != 0 ) {
+		mPerFrameData  = data;
+		mPerFrameDirty = true;
+	}
+
+	return;
+}
+
+
+// SetPerPass                                     //
+// Camera matrices and clip plane for b1          //
+void ConstantBufferManagerClass::SetPerPass( D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, D3DXMATRIX reflectionMatrix, D3DXVECTOR4 clipPlane ) {
+	PerPassBufferType data;
+
+	// Transpose the matrices to prepare them for the shader
+	D3DXMatrixTranspose( &data.view, &viewMatrix );
+	D3DXMatrixTranspose( &data.projection, &projectionMatrix );
+	D3DXMatrixTranspose( &data.reflection, &reflectionMatrix );
+	data.clipPlane = clipPlane;
+
+	// Only dirty if something changed
+	if( memcmp( &data, &mPerPassData, sizeof( data ) ) != 0 ) {
+		mPerPassData  = data;
+		mPerPassDirty = true;
+	}
+
+	return;
+}
+
+
+// SetPerObject                                  //
+// World matrix for b2                           //
+// The terrain draws with the same world in each //
+// pass so this rarely needs a map               //
+void ConstantBufferManagerClass::SetPerObject( D3DXMATRIX worldMatrix ) {
+	PerObjectBufferType data;
+
+	// Transpose the matrix to prepare it for the shader
+	D3DXMatrixTranspose( &data.world, &worldMatrix );
+
+	// Only dirty if something changed
+	if( memcmp( &data, &mPerObjectData, sizeof( data ) ) != 0 ) {
+		mPerObjectData  = data;
+		mPerObjectDirty = true;
+	}
+
+	return;
+}
+
+
+// SetPerTerrain                                 //
+// Compact vertex decoding for b3 - only changes //
+// when the terrain is rebuilt                   //
+void ConstantBufferManagerClass::SetPerTerrain( D3DXVECTOR4 vertexDecode ) {
+	PerTerrainBufferType data;
+
+	data.vertexDecode = vertexDecode;
+
+	// Only dirty if something changed
+	if( memcmp( &data, &mPerTerrainData, sizeof( data ) ) != 0 ) {
+		mPerTerrainData  = data;
+		mPerTerrainDirty = true;
+	}
+
+	return;
+}
+
+
+// SetPerShadow                                  //
+// Shadow cascades for b4 - changes as the        //
+// camera or the sun moves                        //
+void ConstantBufferManagerClass::SetPerShadow( const D3DXMATRIX* cascadeMatrices, D3DXVECTOR4 cascadeSplits, D3DXVECTOR4 shadowParameters ) {
+	PerShadowBufferType data;
+
+	// Transpose the matrices to prepare them for the shader
+	for( int i = 0; i < SHADOW_MAX_CASCADES; i++ ) {
+		D3DXMatrixTranspose( &data.cascades[ i ], &cascadeMatrices[ i ] );
+	}
+	data.cascadeSplits    = cascadeSplits;
+	data.shadowParameters = shadowParameters;
+
+	// Only dirty if something changed
+	if( memcmp( &data, &mPerShadowData, sizeof( data ) ) != 0 ) {
+		mPerShadowData  = data;
+		mPerShadowDirty = true;
+	}
+
+	return;
+}
+
+
+// Commit                                     //
+// One map per dirty buffer then bind all five //
+bool ConstantBufferManagerClass::Commit( ID3D11DeviceContext* deviceContext ) {
+	ID3D11Buffer* buffers[ CONSTANT_BUFFER_COUNT ];
+	bool result;
+
+	// Upload whatever changed since the last commit
+	if( mPerFrameDirty ) {
+		result = UploadBuffer( deviceContext, pPerFrameBuffer, &mPerFrameData, sizeof( PerFrameBufferType ) );
+		if( !result ) {
+			return false;
+		}
+		mPerFrameDirty = false;
+	}
+
+	if( mPerPassDirty ) {
+		result = UploadBuffer( deviceContext, pPerPassBuffer, &mPerPassData, sizeof( PerPassBufferType ) );
+		if( !result ) {
+			return false;
+		}
+		mPerPassDirty = false;
+	}
+
+	if( mPerObjectDirty ) {
+		result = UploadBuffer( deviceContext, pPerObjectBuffer, &mPerObjectData, sizeof( PerObjectBufferType ) );
+		if( !result ) {
+			return false;
+		}
+		mPerObjectDirty = false;
+	}
+
+	if( mPerTerrainDirty ) {
+		result = UploadBuffer( deviceContext, pPerTerrainBuffer, &mPerTerrainData, sizeof( PerTerrainBufferType ) );
+		if( !result ) {
+			return false;
+		}
+		mPerTerrainDirty = false;
+	}
+
+	if( mPerShadowDirty ) {
+		result = UploadBuffer( deviceContext, pPerShadowBuffer, &mPerShadowData, sizeof( PerShadowBufferType ) );
+		if( !result ) {
+			return false;
+		}
+		mPerShadowDirty = false;
+	}
+
+	// Bind b0 - b4 to both stages in one call each
+	buffers[ PER_FRAME_BUFFER_SLOT ]   = pPerFrameBuffer;
+	buffers[ PER_PASS_BUFFER_SLOT ]    = pPerPassBuffer;
+	buffers[ PER_OBJECT_BUFFER_SLOT ]  = pPerObjectBuffer;
+	buffers[ PER_TERRAIN_BUFFER_SLOT ] = pPerTerrainBuffer;
+	buffers[ PER_SHADOW_BUFFER_SLOT ]  = pPerShadowBuffer;
+
+	deviceContext->VSSetConstantBuffers( 0, CONSTANT_BUFFER_COUNT, buffers );
+	deviceContext->PSSetConstantBuffers( 0, CONSTANT_BUFFER_COUNT, buffers );
+
+	return true;
+}
+
+
+// GetMapCount //
+int ConstantBufferManagerClass::GetMapCount() {
+	return mMapCount;
+}
+
+
+// ResetMapCount //
+void ConstantBufferManagerClass::ResetMapCount() {
+	mMapCount = 0;
+}
+
+
+// CreateBuffer                           //
+// Dynamic constant buffer the CPU writes //
+bool ConstantBufferManagerClass::CreateBuffer( ID3D11Device* device, unsigned int byteWidth, ID3D11Buffer** buffer ) {
+	D3D11_BUFFER_DESC bufferDesc;
+	HRESULT result;
+
+	// Setup the description of the dynamic constant buffer
+	bufferDesc.Usage               = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth           = byteWidth;
+	bufferDesc.BindFlags           = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags           = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	// Create the constant buffer
+	result = device->CreateBuffer( &bufferDesc, NULL, buffer );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// UploadBuffer                        //
+// Discards and rewrites a whole buffer //
+bool ConstantBufferManagerClass::UploadBuffer( ID3D11DeviceContext* deviceContext, ID3D11Buffer* buffer, void* data, unsigned int byteWidth ) {
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	HRESULT result;
+
+	// Lock the constant buffer so it can be written to
+	result = deviceContext->Map( buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Copy the data into the constant buffer
+	memcpy( mappedResource.pData, data, byteWidth );
+
+	// Unlock the constant buffer
+	deviceContext->Unmap( buffer, 0 );
+
+	mMapCount++;
+
+	return true;
+}
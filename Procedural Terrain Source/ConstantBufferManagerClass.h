@@ -0,0 +1,127 @@
+#ifndef _CONSTANTBUFFERMANAGERCLASS_H_
+#define _CONSTANTBUFFERMANAGERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <string.h>
+
+
+// Application Includes //
+#include "ShadowMapClass.h"
+
+
+// Constant Buffer Slots - must match the register()s in the HLSL
+const int PER_FRAME_BUFFER_SLOT   = 0;
+const int PER_PASS_BUFFER_SLOT    = 1;
+const int PER_OBJECT_BUFFER_SLOT  = 2;
+const int PER_TERRAIN_BUFFER_SLOT = 3;
+const int PER_SHADOW_BUFFER_SLOT  = 4;
+const int CONSTANT_BUFFER_COUNT   = 5;
+
+
+// ConstantBufferManagerClass                                         //
+// Shared constant buffers grouped by how often they change           //
+// Per-frame  (b0) - light and animation values                       //
+// Per-pass   (b1) - view / projection / reflection and clip plane    //
+// Per-object (b2) - world matrix                                     //
+// Per-terrain (b3) - compact terrain vertex decoding, changes only   //
+//                    when the terrain is rebuilt                     //
+// Per-shadow (b4)  - sun shadow cascades, once a frame               //
+// Setters keep a CPU copy and only flag a buffer dirty if the data   //
+// actually changed - Commit maps each dirty buffer once and binds    //
+// all five to the VS and PS                                          //
+class ConstantBufferManagerClass {
+private:
+	// Per-frame data (b0)
+	struct PerFrameBufferType {
+		D3DXVECTOR4 ambientColor;
+		D3DXVECTOR4 diffuseColor;
+		D3DXVECTOR3 lightPosition;
+		float time;
+		float waveHeight;
+		float waterTranslation;
+		float reflectRefractScale;
+		float padding;
+	};
+
+	// Per-pass data (b1)
+	struct PerPassBufferType {
+		D3DXMATRIX view;
+		D3DXMATRIX projection;
+		D3DXMATRIX reflection;
+		D3DXVECTOR4 clipPlane;
+	};
+
+	// Per-object data (b2)
+	struct PerObjectBufferType {
+		D3DXMATRIX world;
+	};
+
+	// Per-terrain data (b3)
+	struct PerTerrainBufferType {
+		D3DXVECTOR4 vertexDecode;
+	};
+
+	// Per-shadow data (b4)
+	struct PerShadowBufferType {
+		D3DXMATRIX cascades[ SHADOW_MAX_CASCADES ];
+		D3DXVECTOR4 cascadeSplits;
+		D3DXVECTOR4 shadowParameters;
+	};
+
+public:
+	ConstantBufferManagerClass();
+	ConstantBufferManagerClass( const ConstantBufferManagerClass& other );
+	~ConstantBufferManagerClass();
+
+	bool Initialize( ID3D11Device* device );
+	void Shutdown();
+
+	// Setters - matrices are transposed here for the HLSL
+	void SetPerFrame( D3DXVECTOR4 ambientColor,
+		              D3DXVECTOR4 diffuseColor,
+					  D3DXVECTOR3 lightPosition,
+					  float time,
+					  float waveHeight,
+					  float waterTranslation,
+					  float reflectRefractScale );
+	void SetPerPass( D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, D3DXMATRIX reflectionMatrix, D3DXVECTOR4 clipPlane );
+	void SetPerObject( D3DXMATRIX worldMatrix );
+	void SetPerTerrain( D3DXVECTOR4 vertexDecode );
+
+	// cascadeMatrices - SHADOW_MAX_CASCADES world to shadow map texture matrices
+	// shadowParameters - x = cascades in use (0 for no shadows), y = compare bias
+	void SetPerShadow( const D3DXMATRIX* cascadeMatrices, D3DXVECTOR4 cascadeSplits, D3DXVECTOR4 shadowParameters );
+
+	// Uploads dirty buffers and binds them
+	bool Commit( ID3D11DeviceContext* deviceContext );
+
+	// Number of Map calls since the last reset (for profiling)
+	int GetMapCount();
+	void ResetMapCount();
+
+private:
+	bool CreateBuffer( ID3D11Device* device, unsigned int byteWidth, ID3D11Buffer** buffer );
+	bool UploadBuffer( ID3D11DeviceContext* deviceContext, ID3D11Buffer* buffer, void* data, unsigned int byteWidth );
+
+private:
+	// GPU buffers
+	ID3D11Buffer *pPerFrameBuffer, *pPerPassBuffer, *pPerObjectBuffer, *pPerTerrainBuffer, *pPerShadowBuffer;
+
+	// CPU copies
+	PerFrameBufferType  mPerFrameData;
+	PerPassBufferType   mPerPassData;
+	PerObjectBufferType mPerObjectData;
+	PerTerrainBufferType mPerTerrainData;
+	PerShadowBufferType  mPerShadowData;
+
+	// Dirty flags
+	bool mPerFrameDirty, mPerPassDirty, mPerObjectDirty, mPerTerrainDirty, mPerShadowDirty;
+
+	int mMapCount;
+};
+
+
+#endif
@@ -0,0 +1,445 @@
+#include "ErosionClass.h"
+
+
+// Smallest water depth treated as wet - avoids huge velocities in puddles
+static const float EROSION_MIN_DEPTH = 0.0001f;
+
+// Diagonal neighbour distance for the thermal talus
+static const float EROSION_DIAGONAL = 1.41421356f;
+
+
+// Default Constructor //
+ErosionClass::ErosionClass()
+: pJobSystem( 0 ), mStep( STEP_FLUX ),
+  mWidth( 0 ), mHeight( 0 ), mCurrent( 0 ), mLastIterations( 0 ), mLastTime( 0.0f ) {
+	ErosionParametersType parameters;
+
+	// Tuned for the 257 x 257 terrain with heights of roughly -5 to 15
+	parameters.maxIterations    = 400;
+	parameters.budgetMs         = 250.0f;
+	parameters.timeStep         = 0.05f;
+	parameters.rainRate         = 0.02f;
+	parameters.evaporationRate  = 0.5f;
+	parameters.pipeConstant     = 9.81f;
+	parameters.sedimentCapacity = 0.5f;
+	parameters.dissolveRate     = 0.3f;
+	parameters.depositRate      = 0.3f;
+	parameters.minimumTilt      = 0.05f;
+	parameters.talusSlope       = 0.8f;
+	parameters.thermalRate      = 0.25f;
+
+	SetParameters( parameters );
+}
+
+
+// Constructor //
+ErosionClass::ErosionClass( const ErosionClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+ErosionClass::~ErosionClass() {
+}
+
+
+// SetJobSystem //
+void ErosionClass::SetJobSystem( JobSystemClass* jobSystem ) {
+	pJobSystem = jobSystem;
+}
+
+
+// Shutdown                       //
+// Releases the simulation fields //
+void ErosionClass::Shutdown() {
+	// Release the fields
+	for( int i = 0; i < 2; i++ ) {
+		std::vector< float >().swap( mTerrain[ i ] );
+		std::vector< float >().swap( mSediment[ i ] );
+	}
+	std::vector< float >().swap( mWater );
+	std::vector< float >().swap( mWaterBefore );
+	std::vector< float >().swap( mFluxLeft );
+	std::vector< float >().swap( mFluxRight );
+	std::vector< float >().swap( mFluxBottom );
+	std::vector< float >().swap( mFluxTop );
+	std::vector< float >().swap( mVelocityX );
+	std::vector< float >().swap( mVelocityZ );
+
+	return;
+}
+
+
+// SetParameters //
+void ErosionClass::SetParameters( const ErosionParametersType& parameters ) {
+	mParameters = parameters;
+}
+
+
+// GetParameters //
+const ErosionClass::ErosionParametersType& ErosionClass::GetParameters() {
+	return mParameters;
+}
+
+
+// Erode                                                 //
+// One iteration = a hydraulic step then a thermal step  //
+// Sediment still in suspension is dropped at the end    //
+int ErosionClass::Erode( float* heights, int width, int height ) {
+	LARGE_INTEGER frequency, startTime, currentTime;
+	int cellCount, iteration;
+	float elapsed;
+
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &startTime );
+
+	mWidth    = width;
+	mHeight   = height;
+	mCurrent  = 0;
+	cellCount = mWidth * mHeight;
+
+	// Start dry with no sediment or flow
+	mTerrain[ 0 ].assign( heights, heights + cellCount );
+	mTerrain[ 1 ].assign( heights, heights + cellCount );
+	mSediment[ 0 ].assign( cellCount, 0.0f );
+	mSediment[ 1 ].assign( cellCount, 0.0f );
+	mWater.assign( cellCount, 0.0f );
+	mWaterBefore.assign( cellCount, 0.0f );
+	mFluxLeft.assign( cellCount, 0.0f );
+	mFluxRight.assign( cellCount, 0.0f );
+	mFluxBottom.assign( cellCount, 0.0f );
+	mFluxTop.assign( cellCount, 0.0f );
+	mVelocityX.assign( cellCount, 0.0f );
+	mVelocityZ.assign( cellCount, 0.0f );
+
+	elapsed = 0.0f;
+
+	for( iteration = 0; iteration < mParameters.maxIterations; iteration++ ) {
+		// Out of time
+		if( elapsed >= mParameters.budgetMs ) {
+			break;
+		}
+
+		// Hydraulic
+		RunStep( STEP_FLUX );
+		RunStep( STEP_WATER );
+		RunStep( STEP_EROSION );
+		mCurrent = 1 - mCurrent;
+		RunStep( STEP_TRANSPORT );
+
+		// Thermal
+		if( mParameters.thermalRate > 0.0f ) {
+			RunStep( STEP_THERMAL );
+			mCurrent = 1 - mCurrent;
+		}
+
+		QueryPerformanceCounter( &currentTime );
+		elapsed = ( float )( ( double )( currentTime.QuadPart - startTime.QuadPart ) * 1000.0 / ( double )frequency.QuadPart );
+	}
+
+	// Settle the suspended sediment and copy back
+	for( int i = 0; i < cellCount; i++ ) {
+		heights[ i ] = mTerrain[ mCurrent ][ i ] + mSediment[ 0 ][ i ];
+	}
+
+	QueryPerformanceCounter( &currentTime );
+	mLastTime       = ( float )( ( double )( currentTime.QuadPart - startTime.QuadPart ) * 1000.0 / ( double )frequency.QuadPart );
+	mLastIterations = iteration;
+
+	return iteration;
+}
+
+
+// GetLastIterations //
+int ErosionClass::GetLastIterations() {
+	return mLastIterations;
+}
+
+
+// GetLastTime                 //
+// Last Erode in milliseconds  //
+float ErosionClass::GetLastTime() {
+	return mLastTime;
+}
+
+
+// WasLastRunComplete //
+bool ErosionClass::WasLastRunComplete() {
+	return mLastIterations >= mParameters.maxIterations;
+}
+
+
+// RunStep                                          //
+// Sweeps every row - ParallelFor only returns once //
+// they are done, so the next sweep sees their data //
+void ErosionClass::RunStep( StepType step ) {
+	mStep = step;
+
+	if( pJobSystem ) {
+		pJobSystem->ParallelFor( 0, mHeight, EROSION_TILE_ROWS, StepRows, this );
+	} else {
+		StepRows( this, 0, mHeight, 0 );
+	}
+
+	return;
+}
+
+
+// StepRows                       //
+// Runs the current sweep's rows  //
+void ErosionClass::StepRows( void* data, int startRow, int endRow, int threadIndex ) {
+	ErosionClass* erosion = ( ErosionClass* )data;
+
+	switch( erosion->mStep ) {
+		case STEP_FLUX:      erosion->FluxRows( startRow, endRow );      break;
+		case STEP_WATER:     erosion->WaterRows( startRow, endRow );     break;
+		case STEP_EROSION:   erosion->ErosionRows( startRow, endRow );   break;
+		case STEP_TRANSPORT: erosion->TransportRows( startRow, endRow ); break;
+		case STEP_THERMAL:   erosion->ThermalRows( startRow, endRow );   break;
+	}
+
+	return;
+}
+
+
+// FluxRows                                              //
+// Outflow to each neighbour grows with the difference   //
+// in surface height (terrain + water + this step's rain) //
+// then is scaled so a cell never sends more than it has  //
+// Only this cell's flux is written                       //
+void ErosionClass::FluxRows( int startRow, int endRow ) {
+	const std::vector< float >& terrain = mTerrain[ mCurrent ];
+	float dt, rain, pipe, water, surface, total, scale;
+	int index;
+
+	dt   = mParameters.timeStep;
+	rain = mParameters.rainRate * dt;
+	pipe = mParameters.pipeConstant * dt;
+
+	for( int j = startRow; j < endRow; j++ ) {
+		for( int i = 0; i < mWidth; i++ ) {
+			index   = ( j * mWidth ) + i;
+			water   = mWater[ index ] + rain;
+			surface = terrain[ index ] + water;
+
+			// Closed boundary - nothing flows off the edge
+			mFluxLeft[ index ]   = ( i > 0 )             ? max( 0.0f, mFluxLeft[ index ]   + pipe * ( surface - terrain[ index - 1 ]      - mWater[ index - 1 ]      - rain ) ) : 0.0f;
+			mFluxRight[ index ]  = ( i < mWidth - 1 )    ? max( 0.0f, mFluxRight[ index ]  + pipe * ( surface - terrain[ index + 1 ]      - mWater[ index + 1 ]      - rain ) ) : 0.0f;
+			mFluxBottom[ index ] = ( j > 0 )             ? max( 0.0f, mFluxBottom[ index ] + pipe * ( surface - terrain[ index - mWidth ] - mWater[ index - mWidth ] - rain ) ) : 0.0f;
+			mFluxTop[ index ]    = ( j < mHeight - 1 )   ? max( 0.0f, mFluxTop[ index ]    + pipe * ( surface - terrain[ index + mWidth ] - mWater[ index + mWidth ] - rain ) ) : 0.0f;
+
+			// Limit the total outflow to the water in the cell
+			total = ( mFluxLeft[ index ] + mFluxRight[ index ] + mFluxBottom[ index ] + mFluxTop[ index ] ) * dt;
+			if( total > water ) {
+				scale = water / total;
+
+				mFluxLeft[ index ]   *= scale;
+				mFluxRight[ index ]  *= scale;
+				mFluxBottom[ index ] *= scale;
+				mFluxTop[ index ]    *= scale;
+			}
+		}
+	}
+
+	return;
+}
+
+
+// WaterRows                                         //
+// New depth from in / out flux, velocity from the   //
+// net flux through the cell over the average depth  //
+void ErosionClass::WaterRows( int startRow, int endRow ) {
+	float dt, rain, inLeft, inRight, inBottom, inTop, outflow, before, after, depth;
+	int index;
+
+	dt   = mParameters.timeStep;
+	rain = mParameters.rainRate * dt;
+
+	for( int j = startRow; j < endRow; j++ ) {
+		for( int i = 0; i < mWidth; i++ ) {
+			index = ( j * mWidth ) + i;
+
+			// Flux arriving from each neighbour
+			inLeft   = ( i > 0 )           ? mFluxRight[ index - 1 ]      : 0.0f;
+			inRight  = ( i < mWidth - 1 )  ? mFluxLeft[ index + 1 ]       : 0.0f;
+			inBottom = ( j > 0 )           ? mFluxTop[ index - mWidth ]   : 0.0f;
+			inTop    = ( j < mHeight - 1 ) ? mFluxBottom[ index + mWidth ] : 0.0f;
+
+			outflow = mFluxLeft[ index ] + mFluxRight[ index ] + mFluxBottom[ index ] + mFluxTop[ index ];
+
+			before = mWater[ index ] + rain;
+			after  = max( 0.0f, before + dt * ( inLeft + inRight + inBottom + inTop - outflow ) );
+
+			// Depth the flux was limited against - used to move the sediment
+			mWaterBefore[ index ] = before;
+			mWater[ index ]       = after;
+
+			// Velocity from the water passing through
+			depth = ( before + after ) * 0.5f;
+			if( depth > EROSION_MIN_DEPTH ) {
+				mVelocityX[ index ] = ( inLeft - mFluxLeft[ index ] + mFluxRight[ index ] - inRight ) * 0.5f / depth;
+				mVelocityZ[ index ] = ( inBottom - mFluxBottom[ index ] + mFluxTop[ index ] - inTop ) * 0.5f / depth;
+			} else {
+				mVelocityX[ index ] = 0.0f;
+				mVelocityZ[ index ] = 0.0f;
+			}
+		}
+	}
+
+	return;
+}
+
+
+// ErosionRows                                        //
+// Capacity = Kc * sin( tilt ) * speed                //
+// Below capacity the water dissolves terrain, above  //
+// it deposits - writes the other terrain buffer and  //
+// the transport sediment buffer                      //
+void ErosionClass::ErosionRows( int startRow, int endRow ) {
+	const std::vector< float >& terrain = mTerrain[ mCurrent ];
+	std::vector< float >& terrainOut = mTerrain[ 1 - mCurrent ];
+	float slopeX, slopeZ, gradient, sinTilt, speed, capacity, sediment, amount, height;
+	int index, left, right, bottom, top;
+
+	for( int j = startRow; j < endRow; j++ ) {
+		for( int i = 0; i < mWidth; i++ ) {
+			index = ( j * mWidth ) + i;
+
+			// Central differences, clamped at the edges
+			left   = ( i > 0 )           ? index - 1      : index;
+			right  = ( i < mWidth - 1 )  ? index + 1      : index;
+			bottom = ( j > 0 )           ? index - mWidth : index;
+			top    = ( j < mHeight - 1 ) ? index + mWidth : index;
+
+			slopeX = ( terrain[ right ] - terrain[ left ] ) * 0.5f;
+			slopeZ = ( terrain[ top ] - terrain[ bottom ] ) * 0.5f;
+
+			gradient = slopeX * slopeX + slopeZ * slopeZ;
+			sinTilt  = sqrtf( gradient / ( 1.0f + gradient ) );
+			sinTilt  = max( sinTilt, mParameters.minimumTilt );
+
+			speed    = sqrtf( mVelocityX[ index ] * mVelocityX[ index ] + mVelocityZ[ index ] * mVelocityZ[ index ] );
+			capacity = mParameters.sedimentCapacity * sinTilt * speed;
+
+			sediment = mSediment[ 0 ][ index ];
+			height   = terrain[ index ];
+
+			if( capacity > sediment ) {
+				// Pick up - never dig below the water
+				amount = mParameters.dissolveRate * ( capacity - sediment );
+				amount = min( amount, mWater[ index ] );
+
+				height   -= amount;
+				sediment += amount;
+			} else {
+				// Drop
+				amount = mParameters.depositRate * ( sediment - capacity );
+
+				height   += amount;
+				sediment -= amount;
+			}
+
+			terrainOut[ index ]    = height;
+			mSediment[ 1 ][ index ] = sediment;
+		}
+	}
+
+	return;
+}
+
+
+// TransportRows                                       //
+// Sediment leaves each cell in the same fraction as    //
+// its water did this step and arrives with the flux    //
+// from the neighbours - so no sediment is lost or made //
+// Evaporation is applied here too                      //
+void ErosionClass::TransportRows( int startRow, int endRow ) {
+	const std::vector< float >& sediment = mSediment[ 1 ];
+	float dt, evaporation, outflow, kept, arriving;
+	int index;
+
+	dt          = mParameters.timeStep;
+	evaporation = max( 0.0f, 1.0f - mParameters.evaporationRate * dt );
+
+	for( int j = startRow; j < endRow; j++ ) {
+		for( int i = 0; i < mWidth; i++ ) {
+			index = ( j * mWidth ) + i;
+
+			// Fraction that stays
+			outflow = ( mFluxLeft[ index ] + mFluxRight[ index ] + mFluxBottom[ index ] + mFluxTop[ index ] ) * dt;
+			kept    = ( mWaterBefore[ index ] > EROSION_MIN_DEPTH ) ? max( 0.0f, 1.0f - outflow / mWaterBefore[ index ] ) : 1.0f;
+
+			// Fractions arriving from each neighbour
+			arriving = 0.0f;
+			if( ( i > 0 ) && ( mWaterBefore[ index - 1 ] > EROSION_MIN_DEPTH ) ) {
+				arriving += sediment[ index - 1 ] * mFluxRight[ index - 1 ] * dt / mWaterBefore[ index - 1 ];
+			}
+			if( ( i < mWidth - 1 ) && ( mWaterBefore[ index + 1 ] > EROSION_MIN_DEPTH ) ) {
+				arriving += sediment[ index + 1 ] * mFluxLeft[ index + 1 ] * dt / mWaterBefore[ index + 1 ];
+			}
+			if( ( j > 0 ) && ( mWaterBefore[ index - mWidth ] > EROSION_MIN_DEPTH ) ) {
+				arriving += sediment[ index - mWidth ] * mFluxTop[ index - mWidth ] * dt / mWaterBefore[ index - mWidth ];
+			}
+			if( ( j < mHeight - 1 ) && ( mWaterBefore[ index + mWidth ] > EROSION_MIN_DEPTH ) ) {
+				arriving += sediment[ index + mWidth ] * mFluxBottom[ index + mWidth ] * dt / mWaterBefore[ index + mWidth ];
+			}
+
+			mSediment[ 0 ][ index ] = sediment[ index ] * kept + arriving;
+
+			mWater[ index ] *= evaporation;
+		}
+	}
+
+	return;
+}
+
+
+// ThermalRows                                          //
+// Material moves between each pair of neighbours by    //
+// the amount their difference exceeds the talus slope  //
+// Both cells of a pair see the same amount so mass is  //
+// kept without any cell writing to its neighbours      //
+void ErosionClass::ThermalRows( int startRow, int endRow ) {
+	static const int offsetX[ 8 ] = { -1, 1,  0, 0, -1,  1, -1, 1 };
+	static const int offsetZ[ 8 ] = {  0, 0, -1, 1, -1, -1,  1, 1 };
+	const std::vector< float >& terrain = mTerrain[ mCurrent ];
+	std::vector< float >& terrainOut = mTerrain[ 1 - mCurrent ];
+	float talus[ 8 ], rate, height, difference, change;
+	int index, ni, nj;
+
+	// Talus per neighbour - diagonals are further away
+	for( int n = 0; n < 8; n++ ) {
+		talus[ n ] = mParameters.talusSlope * ( ( n < 4 ) ? 1.0f : EROSION_DIAGONAL );
+	}
+
+	rate = mParameters.thermalRate / 8.0f;
+
+	for( int j = startRow; j < endRow; j++ ) {
+		for( int i = 0; i < mWidth; i++ ) {
+			index  = ( j * mWidth ) + i;
+			height = terrain[ index ];
+			change = 0.0f;
+
+			for( int n = 0; n < 8; n++ ) {
+				ni = i + offsetX[ n ];
+				nj = j + offsetZ[ n ];
+				if( ( ni < 0 ) || ( ni >= mWidth ) || ( nj < 0 ) || ( nj >= mHeight ) ) {
+					continue;
+				}
+
+				difference = terrain[ ( nj * mWidth ) + ni ] - height;
+
+				// Neighbour slides onto this cell, or this cell slides onto it
+				if( difference > talus[ n ] ) {
+					change += rate * ( difference - talus[ n ] );
+				} else if( -difference > talus[ n ] ) {
+					change -= rate * ( -difference - talus[ n ] );
+				}
+			}
+
+			terrainOut[ index ] = height + change;
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,126 @@
+#ifndef _EROSIONCLASS_H_
+#define _EROSIONCLASS_H_
+
+
+// Includes //
+#include <windows.h>
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+
+// Application Includes //
+#include "JobSystemClass.h"
+
+
+// Erosion Variables
+const int EROSION_TILE_ROWS = 16; // rows per work item - keeps each sweep's reads within a few rows
+
+
+// ErosionClass                                                           //
+// Grid based erosion run on the height map after generation and          //
+// smoothing, before normals are calculated                               //
+// Hydraulic - virtual pipe model: rain, outflow flux, water and velocity //
+// fields, sediment pickup / deposit against a carrying capacity and      //
+// sediment carried along the same flux as the water, then evaporation   //
+// Thermal - material above the talus slope slides to lower neighbours    //
+// Every step is a Jacobi sweep - cells only read last step's neighbour   //
+// values (terrain and sediment are double buffered) - so the grid is     //
+// split into row tiles and shared between the job system's threads      //
+// Iterations stop at the limit or once the millisecond budget is spent  //
+// - the thread count never changes the result, the budget can           //
+class ErosionClass {
+public:
+	// Simulation settings
+	struct ErosionParametersType {
+		int maxIterations;      // upper bound - the budget can end the run first
+		float budgetMs;         // wall clock budget for all iterations - a run it ends is not reproducible
+
+		// Hydraulic
+		float timeStep;         // dt
+		float rainRate;         // water added per cell per second
+		float evaporationRate;  // fraction of water lost per second
+		float pipeConstant;     // pipe area * gravity / pipe length
+		float sedimentCapacity; // sediment carried per unit of tilt * speed
+		float dissolveRate;     // fraction of spare capacity picked up per step
+		float depositRate;      // fraction of excess sediment dropped per step
+		float minimumTilt;      // lets flat ground still carry a little sediment
+
+		// Thermal
+		float talusSlope;       // height difference per cell that stays put
+		float thermalRate;      // fraction of the excess moved per step (0 disables)
+	};
+
+private:
+	// Sweeps handed to the job system
+	enum StepType {
+		STEP_FLUX,
+		STEP_WATER,
+		STEP_EROSION,
+		STEP_TRANSPORT,
+		STEP_THERMAL
+	};
+
+public:
+	ErosionClass();
+	ErosionClass( const ErosionClass& other );
+	~ErosionClass();
+
+	// Job system for the sweeps - NULL runs them serially
+	// The job system is not owned
+	void SetJobSystem( JobSystemClass* jobSystem );
+	void Shutdown();
+
+	void SetParameters( const ErosionParametersType& parameters );
+	const ErosionParametersType& GetParameters();
+
+	// Erode                                          //
+	// Erodes width * height row major heights in     //
+	// place - returns the number of iterations run   //
+	int Erode( float* heights, int width, int height );
+
+	// Last run statistics
+	int GetLastIterations();
+	float GetLastTime();
+
+	// True if the last run reached maxIterations - a run the budget  //
+	// cut short depends on the machine's speed and load, so only a   //
+	// complete run is reproducible                                   //
+	bool WasLastRunComplete();
+
+private:
+	void RunStep( StepType step );
+	static void StepRows( void* data, int startRow, int endRow, int threadIndex );
+
+	void FluxRows( int startRow, int endRow );
+	void WaterRows( int startRow, int endRow );
+	void ErosionRows( int startRow, int endRow );
+	void TransportRows( int startRow, int endRow );
+	void ThermalRows( int startRow, int endRow );
+
+private:
+	ErosionParametersType mParameters;
+
+	JobSystemClass* pJobSystem;
+
+	// Current sweep
+	StepType mStep;
+
+	// Grid
+	int mWidth, mHeight;
+	int mCurrent; // index of the current terrain / sediment buffer
+
+	// Fields
+	std::vector< float > mTerrain[ 2 ];
+	std::vector< float > mSediment[ 2 ];
+	std::vector< float > mWater, mWaterBefore;
+	std::vector< float > mFluxLeft, mFluxRight, mFluxBottom, mFluxTop;
+	std::vector< float > mVelocityX, mVelocityZ;
+
+	// Statistics
+	int mLastIterations;
+	float mLastTime;
+};
+
+
+#endif
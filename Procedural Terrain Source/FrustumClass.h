@@ -0,0 +1,37 @@
+#ifndef _FRUSTUMCLASS_H_
+#define _FRUSTUMCLASS_H_
+
+
+// Includes //
+#include <d3dx10math.h>
+
+
+// FrustumClass - based off rastertek                      //
+// Six view frustum planes rebuilt from the camera each    //
+// frame - used to cull objects on the CPU before drawing  //
+// Added an axis aligned box test for terrain chunks       //
+class FrustumClass {
+public:
+	FrustumClass();
+	FrustumClass( const FrustumClass& other );
+	~FrustumClass();
+
+	void ConstructFrustum( float screenDepth, D3DXMATRIX projectionMatrix, D3DXMATRIX viewMatrix );
+
+	// Planes of view * projection as given - used for the
+	// orthographic shadow cascades
+	void ConstructFrustum( const D3DXMATRIX& viewProjectionMatrix );
+
+	bool CheckPoint( float x, float y, float z );
+	bool CheckSphere( float xCenter, float yCenter, float zCenter, float radius );
+	bool CheckBox( D3DXVECTOR3 minimum, D3DXVECTOR3 maximum );
+
+private:
+	void ExtractPlanes( const D3DXMATRIX& matrix );
+
+private:
+	D3DXPLANE mPlanes[ 6 ];
+};
+
+
+#endif
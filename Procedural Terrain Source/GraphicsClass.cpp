@@ -8,14 +8,21 @@ GraphicsClass::GraphicsClass()
 : pD3D( 0 ), pCamera( 0 ), pLight( 0 ),                                                                            // D3D, Camera and Light pointers
   pTextureShader( 0 ), pTransparentShader( 0 ), pTerrainReflectionShader( 0 ),                                     // Shader pointers
   pTerrainShader( 0 ), pOceanShader( 0 ), pHorizontalBlurShader( 0 ), pVerticalBlurShader( 0 ),
+  pInstanceShader( 0 ), pConstantBuffers( 0 ),                                                                     // Instancing and shared constant buffers
+  pShadowShader( 0 ), pShadowMap( 0 ),                                                                             // Sun shadow cascades
+  pRock( 0 ), pRocks( 0 ), pFrustum( 0 ),                                                                          // Instanced prop pointers
   pRefractionTexture( 0 ), pReflectionTexture( 0 ),                                                                // Ocean render to textures
   pText( 0 ), pCursor( 0 ),                                                                                        // Text and Cursor pointers
+  pCameraPath( 0 ), pProfiler( 0 ),                                                                                // Benchmark pointers
   pPostProcessingTexture( 0 ), pPostProcessingWindow( 0 ), pHorizontalBlurTexture( 0 ), pVerticalBlurTexture( 0 ), // Post-Processing render to textures
   pTerrain( 0 ), pSun( 0 ), pOcean( 0 ),                                                                           // Model pointers
   mRotation( 0.0f ), mWaterHeight( 2.95f ), mWaterTranslation( 0.0f ), mWaveHeight( 0.2f ),                        // Scene variables
   mLightOrbit( D3DXVECTOR3( 0.0f, 1000.0f, 0.0f ) ), mLightPosition( D3DXVECTOR3( 0.0f, 0.0f, 0.0f ) ),            // Light vector3's
   mDisplayingUI( false ), mApplyingBlur( false ),                                                                  // Toggle flags
-  mSmoothingAmount( 5 ), mDisplacementRange( 10.0f ) {                                                             // Terrain variables
+  mSmoothingAmount( 5 ), mDisplacementRange( 10.0f ),
+  pNoise( 0 ), mHeightGenerator( GENERATOR_DIAMOND_SQUARE ), mNoiseSeed( 0 ),
+  pErosion( 0 ), mApplyingErosion( false ), pHeightfieldCache( 0 ), pJobSystem( 0 ), pHorizonMap( 0 ), mSimplifyingMesh( false ),
+  mBrushType( TerrainClass::BRUSH_RAISE ), mSculpting( false ) {                                                             // Terrain variables
 }	
 
 
@@ -32,8 +39,14 @@ GraphicsClass::~GraphicsClass() {
 // Initialize                                        //
 // Initializes object pointers - see comments within //
 bool GraphicsClass::Initialize( int screenWidth, int screenHeight, HWND hwnd ) {
+	LARGE_INTEGER startTime, endTime, frequency;
+	WCHAR startupReport[ 128 ];
 	bool result;
 
+	// Time the whole startup - shader loading is reported separately
+	QueryPerformanceCounter( &startTime );
+	ShaderCacheClass::ResetStatistics();
+
 	// Set screen dimensions
 	mScreenWidth  = screenWidth;
 	mScreenHeight = screenHeight;
@@ -75,29 +88,35 @@ bool GraphicsClass::Initialize( int screenWidth, int screenHeight, HWND hwnd ) {
 	pCamera->SetPosition( 0.0f, 8.0f, -15.0f );
 
 	// TEXT //
-	// Create the text object
-	pText = new TextClass;
+	// Create the text object - all sentences drawn as one batch
+	pText = new TextBatchClass;
 	if( !pText ) {
 		return false;
 	}
 
 	// Initialize the text object
-	result = pText->Initialize( pD3D->GetDevice(), pD3D->GetDeviceContext(), hwnd, screenWidth, screenHeight, baseViewMatrix );
+	result = pText->Initialize( pD3D->GetDevice(), hwnd, screenWidth, screenHeight, baseViewMatrix );
 	if( !result ) {
 		MessageBox( hwnd, L"Could not initialize the text object.", L"Error", MB_OK );
 		return false;
 	}
 
 	// Set performance text
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 0, "Framerate = ", 20, 20, 1.0f, 1.0f, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 1, "CPU Usage = ", 20, 40, 1.0f, 1.0f, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 2, "Mouse Xcoord = ", 20, 60, 1.0f, 1.0f, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 3, "Mouse Ycoord = ", 20, 80, 1.0f, 1.0f, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 4, "Blur Post-Processing", 20, 100, 1.0f, 1.0, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 5, "Refraction Texture", 20, 120, 1.0f, 1.0f, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 6, "Reflection Texture", 20, 270, 1.0f, 1.0f, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 7, "Smoothing Passes = ", 20, 420, 1.0f, 1.0f, 1.0f );
-	pText->CreateSentence( pD3D->GetDevice(), pD3D->GetDeviceContext(), 8, "Displacement Range = ", 20, 440, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 0, "Framerate = ", 20, 20, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 1, "CPU Usage = ", 20, 40, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 2, "Mouse Xcoord = ", 20, 60, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 3, "Mouse Ycoord = ", 20, 80, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 4, "Blur Post-Processing", 20, 100, 1.0f, 1.0, 1.0f );
+	pText->SetSentence( 5, "Refraction Texture", 20, 120, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 6, "Reflection Texture", 20, 270, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 7, "Smoothing Passes = ", 20, 420, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 8, "Displacement Range = ", 20, 440, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 9, "Height Generator = Diamond-Square", 20, 460, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 10, "Erosion = False", 20, 480, 1.0f, 0.0f, 0.0f );
+	pText->SetSentence( 11, "Triangles = ", 20, 500, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 12, "Brush = Raise", 20, 520, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 13, "Shadows = ", 20, 540, 1.0f, 1.0f, 1.0f );
+	pText->SetSentence( 14, "Horizon Bake = ", 20, 560, 1.0f, 1.0f, 1.0f );
 
 	// CURSOR //
 	// Create the cursor object
@@ -128,6 +147,44 @@ bool GraphicsClass::Initialize( int screenWidth, int screenHeight, HWND hwnd ) {
 	pLight->SetSpecularColor( 1.0f, 1.0f, 1.0f, 1.0f );
 
 	// INITIALIZE MODELS //
+	// NOISE
+	// Create the noise height generator (used once selected with G)
+	pNoise = new NoiseGeneratorClass;
+	if( !pNoise ) {
+		return false;
+	}
+
+	// HEIGHTFIELD CACHE
+	// Create the cache used to skip generation for a known seed
+	pHeightfieldCache = new HeightfieldCacheClass;
+	if( !pHeightfieldCache ) {
+		return false;
+	}
+
+	// JOB SYSTEM
+	// Create the job system used for erosion and the terrain's vertex vectors
+	pJobSystem = new JobSystemClass;
+	if( !pJobSystem ) {
+		return false;
+	}
+
+	// Initialize the worker threads - one per core
+	result = pJobSystem->Initialize( 0 );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the job system.", L"Error", MB_OK );
+		return false;
+	}
+
+	// EROSION
+	// Create the erosion object (applied once toggled with H)
+	pErosion = new ErosionClass;
+	if( !pErosion ) {
+		return false;
+	}
+
+	// Sweeps are shared between the job system's threads
+	pErosion->SetJobSystem( pJobSystem );
+
 	// TERRAIN 
 	// Create the terrain object
 	pTerrain = new TerrainClass;
@@ -135,6 +192,13 @@ bool GraphicsClass::Initialize( int screenWidth, int screenHeight, HWND hwnd ) {
 		return false;
 	}
 
+	pTerrain->SetHeightGenerator( SelectHeightGenerator() );
+	pTerrain->SetErosion( mApplyingErosion ? pErosion : 0 );
+	pTerrain->SetSeed( mNoiseSeed );
+	pTerrain->SetHeightfieldCache( pHeightfieldCache, GetTerrainCacheKey() );
+	pTerrain->SetSimplification( mSimplifyingMesh ? TERRAIN_SIMPLIFICATION_ERROR : 0.0f );
+	pTerrain->SetJobSystem( pJobSystem );
+
 	result = pTerrain->Initialize( pD3D->GetDevice(),
 								   257,                  // power2 dimension + 1 (must be odd too)
 								   mSmoothingAmount,
@@ -152,6 +216,25 @@ bool GraphicsClass::Initialize( int screenWidth, int screenHeight, HWND hwnd ) {
 		return false;
 	}
 
+	// HORIZON MAP
+	// Create the baked terrain self shadowing / ambient occlusion
+	pHorizonMap = new HorizonMapClass;
+	if( !pHorizonMap ) {
+		return false;
+	}
+
+	// One texel per terrain grid point
+	result = pHorizonMap->Initialize( pD3D->GetDevice(), pTerrain->GetTerrainWidth(), pTerrain->GetTerrainHeight() );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the horizon map object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// First bake covers every point
+	pHorizonMap->SetJobSystem( pJobSystem );
+	pHorizonMap->Update( pTerrain, 0, 0, pTerrain->GetTerrainWidth() - 1, pTerrain->GetTerrainHeight() - 1 );
+	UpdateHorizonText();
+
 	// SUN 
 	// Create the Sun object
 	pSun = new ModelClass;
@@ -180,7 +263,104 @@ bool GraphicsClass::Initialize( int screenWidth, int screenHeight, HWND hwnd ) {
 		return false;
 	}
 
+	// ROCKS
+	// Create the rock model - one mesh drawn with instancing
+	pRock = new ModelClass;
+	if( !pRock ) {
+		return false;
+	}
+
+	// Initialize the rock model
+	result = pRock->Initialize( pD3D->GetDevice(), "Sphere.obj", L"RockTexture.dds", NULL, NULL, NULL, NULL, NULL, NULL, NULL, true );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the Rock object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// Create the rock instance object
+	pRocks = new InstancedModelClass;
+	if( !pRocks ) {
+		return false;
+	}
+
+	// Initialize the rock instance buffer
+	result = pRocks->Initialize( pD3D->GetDevice(), MAX_ROCK_INSTANCES );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the Rock instances.", L"Error", MB_OK );
+		return false;
+	}
+
+	// Create the frustum object used to cull instances
+	pFrustum = new FrustumClass;
+	if( !pFrustum ) {
+		return false;
+	}
+
+	// Scatter the rocks over the new terrain
+	ScatterProps();
+
+	UpdateMeshText();
+
 	// INITIALIZE SHADERS //
+	// CONSTANTBUFFERS
+	// Create the shared constant buffer object
+	pConstantBuffers = new ConstantBufferManagerClass;
+	if( !pConstantBuffers ) {
+		return false;
+	}
+
+	// Initialize the shared constant buffer object
+	result = pConstantBuffers->Initialize( pD3D->GetDevice() );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the constant buffer object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// INSTANCESHADER
+	// Create the instance shader object
+	pInstanceShader = new InstanceShaderClass;
+	if( !pInstanceShader ) {
+		return false;
+	}
+
+	// Initialize the instance shader object
+	result = pInstanceShader->Initialize( pD3D->GetDevice(), hwnd );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the instance shader object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// SHADOWS
+	// Create the shadow shader object
+	pShadowShader = new ShadowShaderClass;
+	if( !pShadowShader ) {
+		return false;
+	}
+
+	// Initialize the shadow shader object
+	result = pShadowShader->Initialize( pD3D->GetDevice(), hwnd );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the shadow shader object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// Create the shadow map object
+	pShadowMap = new ShadowMapClass;
+	if( !pShadowMap ) {
+		return false;
+	}
+
+	// Initialize the shadow cascades
+	result = pShadowMap->Initialize( pD3D->GetDevice(), SHADOW_MAP_SIZE, SHADOW_CASCADE_COUNT );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the shadow map object.", L"Error", MB_OK );
+		return false;
+	}
+
+	for( int i = 0; i < SHADOW_MAX_CASCADES; i++ ) {
+		mShadowChunks[ i ] = 0;
+	}
+
 	// TEXTURESHADER 
 	// Create the texture shader object
 	pTextureShader = new TextureShaderClass;
@@ -374,12 +554,61 @@ bool GraphicsClass::Initialize( int screenWidth, int screenHeight, HWND hwnd ) {
 		return false;
 	}
 
+	// INITIALIZE BENCHMARKING //
+	// CAMERAPATH
+	// Create the camera path object
+	pCameraPath = new CameraPathClass;
+	if( !pCameraPath ) {
+		return false;
+	}
+
+	// Load a previously recorded path if there is one (not an error if missing)
+	pCameraPath->LoadPath( CAMERA_PATH_FILE );
+
+	// PROFILER
+	// Create the profiler object
+	pProfiler = new ProfilerClass;
+	if( !pProfiler ) {
+		return false;
+	}
+
+	// Initialize the profiler object
+	result = pProfiler->Initialize( pD3D->GetDevice() );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the profiler object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// Report startup time - a cold shader cache shows up as misses
+	QueryPerformanceCounter( &endTime );
+	QueryPerformanceFrequency( &frequency );
+	swprintf_s( startupReport, 128, L"Startup = %.1f ms (shaders %.1f ms, cache hits %d, misses %d)\n",
+		        ( float )( ( double )( endTime.QuadPart - startTime.QuadPart ) * 1000.0 / ( double )frequency.QuadPart ),
+				ShaderCacheClass::GetLoadTime(),
+				ShaderCacheClass::GetHitCount(),
+				ShaderCacheClass::GetMissCount() );
+	OutputDebugString( startupReport );
+
 	return true;
 }
 
 
 // Shutdown //
 void GraphicsClass::Shutdown() {
+	// Release the profiler object
+	if( pProfiler ) {
+		pProfiler->Shutdown();
+		delete pProfiler;
+		pProfiler = 0;
+	}
+
+	// Release the camera path object
+	if( pCameraPath ) {
+		pCameraPath->Shutdown();
+		delete pCameraPath;
+		pCameraPath = 0;
+	}
+
 	// Release the debug window object
 	if( pDebugWindow ) {
 		pDebugWindow->Shutdown();
@@ -429,6 +658,34 @@ void GraphicsClass::Shutdown() {
 		pVerticalBlurTexture = 0;
 	}
 
+	// Release the shadow map object
+	if( pShadowMap ) {
+		pShadowMap->Shutdown();
+		delete pShadowMap;
+		pShadowMap = 0;
+	}
+
+	// Release the shadow shader object
+	if( pShadowShader ) {
+		pShadowShader->Shutdown();
+		delete pShadowShader;
+		pShadowShader = 0;
+	}
+
+	// Release the instance shader object
+	if( pInstanceShader ) {
+		pInstanceShader->Shutdown();
+		delete pInstanceShader;
+		pInstanceShader = 0;
+	}
+
+	// Release the shared constant buffer object
+	if( pConstantBuffers ) {
+		pConstantBuffers->Shutdown();
+		delete pConstantBuffers;
+		pConstantBuffers = 0;
+	}
+
 	// Release the ocean shader object
 	if( pOceanShader ) {
 		pOceanShader->Shutdown();
@@ -492,6 +749,39 @@ void GraphicsClass::Shutdown() {
 		pTerrain = 0;
 	}
 
+	// Release the horizon map object
+	if( pHorizonMap ) {
+		pHorizonMap->Shutdown();
+		delete pHorizonMap;
+		pHorizonMap = 0;
+	}
+
+	// Release the erosion object
+	if( pErosion ) {
+		pErosion->Shutdown();
+		delete pErosion;
+		pErosion = 0;
+	}
+
+	// Release the job system
+	if( pJobSystem ) {
+		pJobSystem->Shutdown();
+		delete pJobSystem;
+		pJobSystem = 0;
+	}
+
+	// Release the heightfield cache
+	if( pHeightfieldCache ) {
+		delete pHeightfieldCache;
+		pHeightfieldCache = 0;
+	}
+
+	// Release the noise generator
+	if( pNoise ) {
+		delete pNoise;
+		pNoise = 0;
+	}
+
 	// Release the sun object
 	if( pSun ) {
 		pSun->Shutdown();
@@ -499,6 +789,26 @@ void GraphicsClass::Shutdown() {
 		pSun = 0;
 	}
 
+	// Release the frustum object
+	if( pFrustum ) {
+		delete pFrustum;
+		pFrustum = 0;
+	}
+
+	// Release the rock instances
+	if( pRocks ) {
+		pRocks->Shutdown();
+		delete pRocks;
+		pRocks = 0;
+	}
+
+	// Release the rock model
+	if( pRock ) {
+		pRock->Shutdown();
+		delete pRock;
+		pRock = 0;
+	}
+
 	// Release the ocean object
 	if( pOcean ) {
 		delete pOcean;
@@ -565,27 +875,51 @@ bool GraphicsClass::Frame( int fps, int cpu ) {
 	}
 
 	// Set system information 
-	pText->SetFpsColour( 0, fps, 20, 20 );
-	pText->SetCpuColour( 1, cpu, 20, 40 );
+	pText->SetFps( 0, fps, 20, 20 );
+	pText->SetCpu( 1, cpu, 20, 40 );
 
 	// Update mouse position and terrain variables
-	pText->SetCursorCoord( 2, "Cursor XCoord = ", InputSingleton::GetInstance()->mMouseX - ( mScreenWidth / 2 ), 20, 60 );
-	pText->SetCursorCoord( 3, "Cursor YCoord = ", InputSingleton::GetInstance()->mMouseY - ( mScreenHeight / 2 ), 20, 80 );
-	pText->SetCursorCoord( 7, "Smoothing Passes = ", mSmoothingAmount, 20, 420 );
-	pText->SetCursorCoord( 8, "Displacement Range = ", ( int )mDisplacementRange, 20, 440 );
+	pText->SetValue( 2, "Cursor XCoord = ", InputSingleton::GetInstance()->mMouseX - ( mScreenWidth / 2 ), 20, 60 );
+	pText->SetValue( 3, "Cursor YCoord = ", InputSingleton::GetInstance()->mMouseY - ( mScreenHeight / 2 ), 20, 80 );
+	pText->SetValue( 7, "Smoothing Passes = ", mSmoothingAmount, 20, 420 );
+	pText->SetValue( 8, "Displacement Range = ", ( int )mDisplacementRange, 20, 440 );
 
 	// Change post processing sentence string and colour based on mApplyingBlur flag
 	if( mApplyingBlur ) {
-		pText->UpdateData( 4, "Blur Post-Processing = True", 20, 100, 0.0f, 1.0f, 0.0f );
+		pText->SetSentence( 4, "Blur Post-Processing = True", 20, 100, 0.0f, 1.0f, 0.0f );
 	} else {
-		pText->UpdateData( 4, "Blur Post-Processing = False", 20, 100, 1.0f, 0.0f, 0.0f );
+		pText->SetSentence( 4, "Blur Post-Processing = False", 20, 100, 1.0f, 0.0f, 0.0f );
 	}
 
-	// Update all sentences
-	pText->UpdateSentences( pD3D->GetDevice(), pD3D->GetDeviceContext() );
+	// Shadow cascade timings from the profiler
+	UpdateShadowText();
+
+	// Sentence geometry is only rebuilt when the UI is drawn and the text has changed
+
+	// Record camera path - F5 toggles
+	if( InputSingleton::GetInstance()->HasKeyBeenPressed( VK_F5 ) ) {
+		ToggleCameraRecording();
+	}
+
+	// Replay camera path as a benchmark - F6
+	if( InputSingleton::GetInstance()->HasKeyBeenPressed( VK_F6 ) ) {
+		StartBenchmark();
+	}
 
 	// Update the camera
-	pCamera->Update();
+	// Replayed poses replace user input, otherwise record what the user did
+	if( pCameraPath->IsPlaying() ) {
+		D3DXVECTOR3 position, rotation;
+		if( pCameraPath->GetNextPose( position, rotation ) ) {
+			pCamera->SetPosition( position.x, position.y, position.z );
+			pCamera->SetRotation( rotation.x, rotation.y, rotation.z );
+		} else {
+			EndBenchmark();
+		}
+	} else {
+		pCamera->Update();
+		pCameraPath->RecordPose( pCamera->GetPosition(), pCamera->GetRotation() );
+	}
 
 	// Update the rotation variable each frame - used for the Light/Sun
 	mRotation += ( float )D3DX_PI * 0.001f;
@@ -593,6 +927,12 @@ bool GraphicsClass::Frame( int fps, int cpu ) {
 		mRotation -= 360.0f;
 	}
 
+	// Orbit the light with the sun - done before rendering so every pass uses the same position
+	D3DXMATRIX rotateMatrix;
+	D3DXMatrixRotationZ( &rotateMatrix, mRotation );
+	D3DXVec3TransformCoord( &mLightPosition, &mLightOrbit, &rotateMatrix );
+	pLight->SetPosition( mLightPosition.x, mLightPosition.y, mLightPosition.z ); 
+
 	// Update the position of the water to simulate motion - passed to Ocean shader
 	mWaterTranslation += 0.001f;
 	if( mWaterTranslation > 1.0f ) {
@@ -611,33 +951,61 @@ bool GraphicsClass::Frame( int fps, int cpu ) {
 	}
 
 	// Generate New Terrain
-	if( InputSingleton::GetInstance()->HasKeyBeenPressed( VK_SPACE ) ) {
-		// Release the terrain object
-		if( pTerrain ) {
-			pTerrain->Shutdown();
-			delete pTerrain;
-			pTerrain = 0;
+	// Cycle the height generator - G
+	bool cycleGenerator = InputSingleton::GetInstance()->HasKeyBeenPressed( 'G' );
+	if( cycleGenerator ) {
+		mHeightGenerator = ( mHeightGenerator + 1 ) % GENERATOR_COUNT;
+	}
+
+	// Toggle erosion - H
+	bool toggleErosion = InputSingleton::GetInstance()->HasKeyBeenPressed( 'H' );
+	if( toggleErosion ) {
+		mApplyingErosion = !mApplyingErosion;
+	}
+
+	// Toggle mesh simplification - M
+	// Only the index buffer changes - the heights, sculpted or not, are kept
+	if( InputSingleton::GetInstance()->HasKeyBeenPressed( 'M' ) ) {
+		mSimplifyingMesh = !mSimplifyingMesh;
+
+		pTerrain->SetSimplification( mSimplifyingMesh ? TERRAIN_SIMPLIFICATION_ERROR : 0.0f );
+		result = pTerrain->UpdateSimplifiedMesh( pD3D->GetDevice() );
+		if( !result ) {
+			return false;
 		}
 
+		UpdateMeshText();
+	}
+
+	if( InputSingleton::GetInstance()->HasKeyBeenPressed( VK_SPACE ) || cycleGenerator || toggleErosion ) {
+		// New layout for the noise generators
+		mNoiseSeed++;
+
 		// TERRAIN //
-		// Create the terrain object
-		pTerrain = new TerrainClass;
-		if( !pTerrain ) {
+		// Regenerate in place - the new heights are streamed into
+		// the existing vertex buffer on the next Render
+		pTerrain->SetHeightGenerator( SelectHeightGenerator() );
+		pTerrain->SetErosion( mApplyingErosion ? pErosion : 0 );
+		pTerrain->SetSeed( mNoiseSeed );
+		pTerrain->SetHeightfieldCache( pHeightfieldCache, GetTerrainCacheKey() );
+		pTerrain->SetSimplification( mSimplifyingMesh ? TERRAIN_SIMPLIFICATION_ERROR : 0.0f );
+
+		result = pTerrain->Regenerate( pD3D->GetDevice(), mSmoothingAmount, mDisplacementRange );
+		if( !result ) {
 			return false;
 		}
 
-		result = pTerrain->Initialize( pD3D->GetDevice(),
-									   257,                  // power2 + 1 (must be odd too)
-									   mSmoothingAmount,
-									   mDisplacementRange,
-									   L"BeachTexture.dds",
-									   L"GroundTexture.dds",
-									   L"RockTexture.dds",
-									   L"SnowTexture.dds",
-									   L"BeachBumpMap.dds",
-									   L"GroundBumpMap.dds",
-									   L"RockBumpMap.dds",
-									   L"SnowBumpMap.dds" );
+		// Re-scatter onto the new surface
+		ScatterProps();
+
+		UpdateErosionText();
+		UpdateMeshText();
+	}
+
+	// Sculpt the terrain under the cursor
+	result = SculptTerrain( fps );
+	if( !result ) {
+		return false;
 	}
 
 	// Render the graphics scene
@@ -650,49 +1018,468 @@ bool GraphicsClass::Frame( int fps, int cpu ) {
 }
 
 
-// Render                                               //
-// Breakdown of the different stages of scene rendering //
+// SelectHeightGenerator                            //
+// Configures the noise generator for the current   //
+// type - NULL selects TerrainClass's Diamond-Square //
+// Amplitude follows the displacement range setting  //
+HeightGeneratorClass* GraphicsClass::SelectHeightGenerator() {
+	NoiseGeneratorClass::NoiseParametersType parameters;
+
+	if( mHeightGenerator == GENERATOR_DIAMOND_SQUARE ) {
+		pText->SetSentence( 9, "Height Generator = Diamond-Square", 20, 460, 1.0f, 1.0f, 1.0f );
+		return 0;
+	}
+
+	parameters = pNoise->GetParameters();
+	parameters.seed      = mNoiseSeed;
+	parameters.amplitude = mDisplacementRange;
+
+	if( mHeightGenerator == GENERATOR_RIDGED ) {
+		parameters.type = NoiseGeneratorClass::NOISE_RIDGED;
+		pText->SetSentence( 9, "Height Generator = Ridged", 20, 460, 1.0f, 1.0f, 1.0f );
+	} else if( mHeightGenerator == GENERATOR_WARPED ) {
+		parameters.type = NoiseGeneratorClass::NOISE_WARPED;
+		pText->SetSentence( 9, "Height Generator = Warped fBm", 20, 460, 1.0f, 1.0f, 1.0f );
+	} else {
+		parameters.type = NoiseGeneratorClass::NOISE_FBM;
+		pText->SetSentence( 9, "Height Generator = fBm", 20, 460, 1.0f, 1.0f, 1.0f );
+	}
+
+	pNoise->Initialize( parameters );
+
+	return pNoise;
+}
+
+
+// UpdateErosionText                          //
+// Shows how much of the budget was used      //
+void GraphicsClass::UpdateErosionText() {
+	char erosionString[ 64 ];
+
+	if( mApplyingErosion && pTerrain->WasLoadedFromCache() ) {
+		pText->SetSentence( 10, "Erosion = Cached", 20, 480, 0.0f, 1.0f, 0.0f );
+	} else if( mApplyingErosion ) {
+		sprintf_s( erosionString, 64, "Erosion = %d Iterations (%d ms)", pErosion->GetLastIterations(), ( int )pErosion->GetLastTime() );
+		pText->SetSentence( 10, erosionString, 20, 480, 0.0f, 1.0f, 0.0f );
+	} else {
+		pText->SetSentence( 10, "Erosion = False", 20, 480, 1.0f, 0.0f, 0.0f );
+	}
+
+	return;
+}
+
+
+// UpdateMeshText                      //
+// Terrain triangle count for the UI   //
+void GraphicsClass::UpdateMeshText() {
+	char meshString[ 64 ];
+
+	if( mSimplifyingMesh ) {
+		sprintf_s( meshString, 64, "Triangles = %d (Simplified)", pTerrain->GetIndexCount() / 3 );
+		pText->SetSentence( 11, meshString, 20, 500, 0.0f, 1.0f, 0.0f );
+	} else {
+		sprintf_s( meshString, 64, "Triangles = %d", pTerrain->GetIndexCount() / 3 );
+		pText->SetSentence( 11, meshString, 20, 500, 1.0f, 1.0f, 1.0f );
+	}
+
+	return;
+}
+
+
+// UpdateShadowText                                //
+// GPU time of each cascade (last resolved frame)  //
+// and the terrain chunks drawn into them          //
+void GraphicsClass::UpdateShadowText() {
+	char shadowString[ 64 ];
+	char passName[ 32 ];
+	float cascadeTimes[ SHADOW_MAX_CASCADES ];
+	int chunkCount;
+
+	if( mLightPosition.y <= 0.0f ) {
+		pText->SetSentence( 13, "Shadows = Off (Sun Set)", 20, 540, 1.0f, 0.0f, 0.0f );
+		return;
+	}
+
+	chunkCount = 0;
+	for( int i = 0; i < SHADOW_MAX_CASCADES; i++ ) {
+		sprintf_s( passName, 32, "Shadow Cascade %d", i );
+		cascadeTimes[ i ] = pProfiler->GetPassTime( passName );
+		chunkCount += mShadowChunks[ i ];
+	}
+
+	sprintf_s( shadowString, 64, "Shadows = %.2f / %.2f / %.2f ms (%d Chunks)", cascadeTimes[ 0 ], cascadeTimes[ 1 ], cascadeTimes[ 2 ], chunkCount );
+	pText->SetSentence( 13, shadowString, 20, 540, 0.0f, 1.0f, 0.0f );
+
+	return;
+}
+
+
+// UpdateHorizonText                        //
+// Points rebaked by the last horizon update //
+void GraphicsClass::UpdateHorizonText() {
+	char horizonString[ 64 ];
+
+	sprintf_s( horizonString, 64, "Horizon Bake = %d Points (%.2f ms)", pHorizonMap->GetLastCount(), pHorizonMap->GetLastTime() );
+	pText->SetSentence( 14, horizonString, 20, 560, 0.0f, 1.0f, 0.0f );
+
+	return;
+}
+
+
+// GetTerrainCacheKey                                 //
+// Hashes the generator and erosion settings in use - //
+// call after SelectHeightGenerator                   //
+// Only complete erosion runs are cached, so the time //
+// budget is left out - it never changes their result //
+unsigned __int64 GraphicsClass::GetTerrainCacheKey() {
+	ErosionClass::ErosionParametersType erosionParameters;
+	unsigned __int64 key;
+
+	key = HeightfieldCacheClass::HashParameters( &mHeightGenerator, sizeof( mHeightGenerator ), HEIGHTFIELD_HASH_BASIS );
+
+	if( mHeightGenerator != GENERATOR_DIAMOND_SQUARE ) {
+		key = HeightfieldCacheClass::HashParameters( &pNoise->GetParameters(), sizeof( NoiseGeneratorClass::NoiseParametersType ), key );
+	}
+
+	if( mApplyingErosion ) {
+		erosionParameters = pErosion->GetParameters();
+		erosionParameters.budgetMs = 0.0f;
+		key = HeightfieldCacheClass::HashParameters( &erosionParameters, sizeof( erosionParameters ), key );
+	}
+
+	return key;
+}
+
+
+// SculptTerrain                                             //
+// Holding the left mouse button applies the brush where the //
+// cursor's ray meets the terrain - the rates are per second //
+// so strokes feel the same at any framerate                 //
+// A finished stroke re-simplifies the mesh and rescatters   //
+bool GraphicsClass::SculptTerrain( int fps ) {
+	D3DXMATRIX viewMatrix, inverseViewMatrix, projectionMatrix;
+	D3DXVECTOR3 origin, direction, position;
+	float pointX, pointY, frameTime, strength;
+	bool result;
+
+	// Cycle the brush - B
+	if( InputSingleton::GetInstance()->HasKeyBeenPressed( 'B' ) ) {
+		mBrushType = ( mBrushType + 1 ) % TerrainClass::BRUSH_COUNT;
+		UpdateBrushText();
+	}
+
+	if( !InputSingleton::GetInstance()->IsKeyDown( VK_LBUTTON ) ) {
+		// Stroke finished - simplify the new surface and move the rocks onto it
+		if( mSculpting ) {
+			mSculpting = false;
+
+			result = pTerrain->UpdateSimplifiedMesh( pD3D->GetDevice() );
+			if( !result ) {
+				return false;
+			}
+			UpdateMeshText();
+
+			ScatterProps();
+		}
+
+		return true;
+	}
+
+	// Cursor position to a view space direction
+	pD3D->GetProjectionMatrix( projectionMatrix );
+
+	pointX = ( ( 2.0f * ( float )InputSingleton::GetInstance()->mMouseX ) / ( float )mScreenWidth ) - 1.0f;
+	pointY = ( ( ( 2.0f * ( float )InputSingleton::GetInstance()->mMouseY ) / ( float )mScreenHeight ) - 1.0f ) * -1.0f;
+
+	pointX = pointX / projectionMatrix._11;
+	pointY = pointY / projectionMatrix._22;
+
+	// Then into world space with the inverse view matrix
+	pCamera->GetViewMatrix( viewMatrix );
+	D3DXMatrixInverse( &inverseViewMatrix, NULL, &viewMatrix );
+
+	direction.x = ( pointX * inverseViewMatrix._11 ) + ( pointY * inverseViewMatrix._21 ) + inverseViewMatrix._31;
+	direction.y = ( pointX * inverseViewMatrix._12 ) + ( pointY * inverseViewMatrix._22 ) + inverseViewMatrix._32;
+	direction.z = ( pointX * inverseViewMatrix._13 ) + ( pointY * inverseViewMatrix._23 ) + inverseViewMatrix._33;
+
+	// Into terrain space
+	origin = pCamera->GetPosition() - TERRAIN_OFFSET;
+
+	if( !pTerrain->PickSurface( origin, direction, position ) ) {
+		return true;
+	}
+
+	frameTime = 1.0f / ( float )( ( fps > 0 ) ? fps : 60 );
+
+	if( mBrushType == TerrainClass::BRUSH_SMOOTH ) {
+		strength = TERRAIN_BRUSH_SMOOTH_RATE * frameTime;
+	} else {
+		strength = TERRAIN_BRUSH_HEIGHT_RATE * frameTime;
+	}
+
+	// Only the brush's rectangle is recalculated and uploaded
+	pTerrain->ApplyBrush( ( TerrainClass::BrushType )mBrushType, position.x, position.z, TERRAIN_BRUSH_RADIUS, strength );
+	mSculpting = true;
+
+	return true;
+}
+
+
+// UpdateBrushText         //
+// Current sculpting brush //
+void GraphicsClass::UpdateBrushText() {
+	if( mBrushType == TerrainClass::BRUSH_LOWER ) {
+		pText->SetSentence( 12, "Brush = Lower", 20, 520, 1.0f, 1.0f, 1.0f );
+	} else if( mBrushType == TerrainClass::BRUSH_SMOOTH ) {
+		pText->SetSentence( 12, "Brush = Smooth", 20, 520, 1.0f, 1.0f, 1.0f );
+	} else {
+		pText->SetSentence( 12, "Brush = Raise", 20, 520, 1.0f, 1.0f, 1.0f );
+	}
+
+	return;
+}
+
+
+// ScatterProps                                          //
+// Places the rock instances using Terrain.ps's bands -   //
+// mid height ground on gentle to moderate slopes         //
+void GraphicsClass::ScatterProps() {
+	std::vector< ScatterClass::ScatterInstanceType > instances;
+	ScatterClass::ScatterLayerType rockLayer;
+
+	rockLayer.minHeight = 0.25f;
+	rockLayer.maxHeight = 0.85f;
+	rockLayer.minSlope  = 0.05f;
+	rockLayer.maxSlope  = 0.5f;
+	rockLayer.density   = 0.03f;
+	rockLayer.minScale  = 0.15f;
+	rockLayer.maxScale  = 0.45f;
+	rockLayer.radius    = 1.0f;
+
+	ScatterClass::Generate( pTerrain, TERRAIN_OFFSET, rockLayer, ROCK_SCATTER_SEED, MAX_ROCK_INSTANCES, instances );
+
+	pRocks->SetInstances( instances );
+
+	return;
+}
+
+
+// Render                                                 //
+// Times the frame's render stages with the profiler      //
+// A stage that fails still has its pass and frame closed //
 bool GraphicsClass::Render() {
 	bool result;
 
+	// Start GPU timing for this frame
+	pProfiler->BeginFrame( pD3D->GetDeviceContext() );
+
+	result = RenderStages();
+
+	// End GPU timing for this frame - closes a pass left open by a failed stage
+	pProfiler->EndPass( pD3D->GetDeviceContext() );
+	pProfiler->EndFrame( pD3D->GetDeviceContext() );
+
+	return result;
+}
+
+
+// RenderStages                                         //
+// Breakdown of the different stages of scene rendering //
+// Each stage is timed by the profiler                  //
+bool GraphicsClass::RenderStages() {
+	int dirtyMinX, dirtyMinZ, dirtyMaxX, dirtyMaxZ;
+	bool result;
+
+	// Per-frame constants - uploaded once by the first pass that commits
+	pConstantBuffers->SetPerFrame( pLight->GetAmbientColor(),
+		                           pLight->GetDiffuseColor(),
+								   pLight->GetPosition(),
+								   mRotation * 10.0f,
+								   mWaveHeight,
+								   mWaterTranslation,
+								   0.005f );
+
+	// Rebake the horizons around changed heights - before the
+	// upload below clears the terrain's dirty rectangle
+	if( pTerrain->GetDirtyRegion( dirtyMinX, dirtyMinZ, dirtyMaxX, dirtyMaxZ ) ) {
+		if( pHorizonMap->Update( pTerrain, dirtyMinX, dirtyMinZ, dirtyMaxX, dirtyMaxZ ) > 0 ) {
+			UpdateHorizonText();
+		}
+	}
+	pHorizonMap->Upload( pD3D->GetDeviceContext() );
+
+	// Stream any edited or regenerated terrain - it can change the height range
+	result = pTerrain->UploadDirtyRegion( pD3D->GetDeviceContext() );
+	if( !result ) {
+		return false;
+	}
+
+	// Terrain vertex decoding - only uploaded after a rebuild
+	D3DXVECTOR4 vertexDecode;
+	pTerrain->GetVertexDecode( vertexDecode );
+	pConstantBuffers->SetPerTerrain( vertexDecode );
+
+	// Render the sun's shadow cascades - one profiler pass each
+	result = RenderShadowMaps();
+	if( !result ) {
+		return false;
+	}
+
 	// Render the refraction of the scene to a texture
+	pProfiler->BeginPass( pD3D->GetDeviceContext(), "Refraction" );
 	result = RenderRefractionToTexture();
 	if( !result ) {
 		return false;
 	}
+	pProfiler->EndPass( pD3D->GetDeviceContext() );
 
 	// Render the reflection of the scene to a texture
+	pProfiler->BeginPass( pD3D->GetDeviceContext(), "Reflection" );
 	result = RenderReflectionToTexture();
 	if( !result ) {
 		return false;
 	}
+	pProfiler->EndPass( pD3D->GetDeviceContext() );
 
 	// Render the scene to a texture
+	pProfiler->BeginPass( pD3D->GetDeviceContext(), "Scene" );
 	result = RenderSceneToTexture();
 	if( !result ) {
 		return false;
 	}
+	pProfiler->EndPass( pD3D->GetDeviceContext() );
 
 	// Post processing
 	if( mApplyingBlur ) {
 		// Render adding horizontal blur
+		pProfiler->BeginPass( pD3D->GetDeviceContext(), "HorizontalBlur" );
 		result = RenderHorizontalBlurToTexture();
 		if( !result ) {
 			return false;
 		}
+		pProfiler->EndPass( pD3D->GetDeviceContext() );
 
 		// Render adding vertical blur
+		pProfiler->BeginPass( pD3D->GetDeviceContext(), "VerticalBlur" );
 		result = RenderVerticalBlurToTexture();
 		if( !result ) {
 			return false;
 		}
+		pProfiler->EndPass( pD3D->GetDeviceContext() );
 	}
 
 	// Render the scene as normal to the back buffer
+	pProfiler->BeginPass( pD3D->GetDeviceContext(), "Composite" );
 	result = RenderScene();
 	if( !result ) {
 		return false;
 	}
+	pProfiler->EndPass( pD3D->GetDeviceContext() );
+
+	return true;
+}
+
+
+// RenderShadowMaps                                          //
+// Fits the cascades to the camera then draws the terrain    //
+// chunks inside each cascade's light box into its slice -   //
+// the sun is far enough away to be a directional light.     //
+// No shadows once it has set                                //
+bool GraphicsClass::RenderShadowMaps() {
+	D3DXMATRIX worldMatrix, viewMatrix, projectionMatrix, cascadeViewMatrix, cascadeProjectionMatrix, cascadeMatrix;
+	D3DXMATRIX textureMatrices[ SHADOW_MAX_CASCADES ];
+	D3DXVECTOR3 lightDirection, terrainMinimum, terrainMaximum, chunkMinimum, chunkMaximum;
+	D3DXVECTOR4 cascadeSplits;
+	D3D11_VIEWPORT viewport;
+	ID3D11RasterizerState* rasterState;
+	unsigned int viewportCount;
+	int cascadeCount, indexStart, indexCount;
+	char passName[ 32 ];
+	bool result;
+
+	for( int i = 0; i < SHADOW_MAX_CASCADES; i++ ) {
+		D3DXMatrixIdentity( &textureMatrices[ i ] );
+		mShadowChunks[ i ] = 0;
+	}
+
+	cascadeSplits = D3DXVECTOR4( 0.0f, 0.0f, 0.0f, 0.0f );
+	cascadeCount  = ( mLightPosition.y > 0.0f ) ? pShadowMap->GetCascadeCount() : 0;
+
+	if( cascadeCount > 0 ) {
+		// Generate the view matrix based on the camera's position
+		pCamera->Render();
+		pCamera->GetViewMatrix( viewMatrix );
+		pD3D->GetProjectionMatrix( projectionMatrix );
+
+		// From the sun towards the origin
+		lightDirection = -mLightPosition;
+		D3DXVec3Normalize( &lightDirection, &lightDirection );
+
+		// Same world offset the terrain is drawn with
+		D3DXMatrixTranslation( &worldMatrix, TERRAIN_OFFSET.x, TERRAIN_OFFSET.y, TERRAIN_OFFSET.z );
+
+		pTerrain->GetBounds( terrainMinimum, terrainMaximum );
+		terrainMinimum += TERRAIN_OFFSET;
+		terrainMaximum += TERRAIN_OFFSET;
+
+		pShadowMap->FitCascades( viewMatrix, projectionMatrix, SCREEN_NEAR, SHADOW_DISTANCE, lightDirection, terrainMinimum, terrainMaximum );
+
+		// Keep the back buffer's viewport and rasterizer state
+		viewportCount = 1;
+		pD3D->GetDeviceContext()->RSGetViewports( &viewportCount, &viewport );
+		pD3D->GetDeviceContext()->RSGetState( &rasterState );
+
+		// Put the terrain model vertex and index buffers on the graphics pipeline
+		pTerrain->Render( pD3D->GetDeviceContext() );
+
+		for( int cascade = 0; cascade < cascadeCount; cascade++ ) {
+			sprintf_s( passName, 32, "Shadow Cascade %d", cascade );
+			pProfiler->BeginPass( pD3D->GetDeviceContext(), passName );
+
+			pShadowMap->SetRenderTarget( pD3D->GetDeviceContext(), cascade );
+			pShadowMap->GetCascadeViewMatrix( cascade, cascadeViewMatrix );
+			pShadowMap->GetCascadeProjectionMatrix( cascade, cascadeProjectionMatrix );
+
+			// Cascade pass constants - the sun replaces the camera
+			pConstantBuffers->SetPerPass( cascadeViewMatrix, cascadeProjectionMatrix, cascadeViewMatrix, D3DXVECTOR4( 0.0f, 0.0f, 0.0f, 0.0f ) );
+			pConstantBuffers->SetPerObject( worldMatrix );
+			result = pConstantBuffers->Commit( pD3D->GetDeviceContext() );
+			if( !result ) {
+				return false;
+			}
+
+			// Only the chunks inside this cascade's light box
+			D3DXMatrixMultiply( &cascadeMatrix, &cascadeViewMatrix, &cascadeProjectionMatrix );
+			pFrustum->ConstructFrustum( cascadeMatrix );
+
+			for( int chunk = 0; chunk < pTerrain->GetChunkCount(); chunk++ ) {
+				pTerrain->GetChunk( chunk, chunkMinimum, chunkMaximum, indexStart, indexCount );
+
+				if( ( indexCount > 0 ) && pFrustum->CheckBox( chunkMinimum + TERRAIN_OFFSET, chunkMaximum + TERRAIN_OFFSET ) ) {
+					pShadowShader->Render( pD3D->GetDeviceContext(), indexCount, indexStart );
+					mShadowChunks[ cascade ]++;
+				}
+			}
+
+			pProfiler->EndPass( pD3D->GetDeviceContext() );
+
+			pShadowMap->GetCascadeTextureMatrix( cascade, textureMatrices[ cascade ] );
+		}
+
+		pShadowMap->GetCascadeSplits( cascadeSplits );
+
+		// Back to the back buffer
+		pD3D->GetDeviceContext()->RSSetViewports( 1, &viewport );
+		pD3D->GetDeviceContext()->RSSetState( rasterState );
+		if( rasterState ) {
+			rasterState->Release();
+		}
+
+		pD3D->SetBackBufferRenderTarget();
+	}
+
+	// Cascades for Terrain.ps - committed with the next pass
+	pConstantBuffers->SetPerShadow( textureMatrices, cascadeSplits, D3DXVECTOR4( ( float )cascadeCount, SHADOW_COMPARE_BIAS, 0.0f, 0.0f ) );
 
 	return true;
 }
@@ -725,22 +1512,21 @@ bool GraphicsClass::RenderRefractionToTexture() {
 	pD3D->GetProjectionMatrix( projectionMatrix );
 
 	// Translate to where the terrain model will be rendered
-	D3DXMatrixTranslation( &worldMatrix, -128.0f, 3.0f, -128.0f );
+	D3DXMatrixTranslation( &worldMatrix, TERRAIN_OFFSET.x, TERRAIN_OFFSET.y, TERRAIN_OFFSET.z );
+
+	// Refraction pass constants
+	pConstantBuffers->SetPerPass( viewMatrix, projectionMatrix, pCamera->GetReflectionViewMatrix(), clipPlane );
+	pConstantBuffers->SetPerObject( worldMatrix );
+	result = pConstantBuffers->Commit( pD3D->GetDeviceContext() );
+	if( !result ) {
+		return false;
+	}
 
 	// Put the terrain model vertex and index buffers on the graphics pipeline to prepare them for drawing
 	pTerrain->Render( pD3D->GetDeviceContext() );
 
 	// Render the terrain refraction with the terrain reflection shader (no actual refraction sadly)
-	result = pTerrainReflectionShader->Render( pD3D->GetDeviceContext(),
-		                                       pTerrain->GetIndexCount(),
-										       worldMatrix,
-										       viewMatrix,
-					                           projectionMatrix,
-					                           pLight->GetAmbientColor(),
-										       pLight->GetDiffuseColor(),
-										       pLight->GetPosition(), 
-										       pTerrain->GetTextureArray(),
-										       clipPlane );
+	result = pTerrainReflectionShader->Render( pD3D->GetDeviceContext(), pTerrain->GetIndexCount(), pTerrain->GetTextureArray() );
 	
 	if( !result ) {
 		return false;
@@ -782,22 +1568,21 @@ bool GraphicsClass::RenderReflectionToTexture() {
 	pD3D->GetProjectionMatrix( projectionMatrix );
 
 	// Translate to where the terrain model will be rendered
-	D3DXMatrixTranslation( &worldMatrix, -128.0f, 3.0f, -128.0f );
+	D3DXMatrixTranslation( &worldMatrix, TERRAIN_OFFSET.x, TERRAIN_OFFSET.y, TERRAIN_OFFSET.z );
+
+	// Reflection pass constants - the reflected view replaces the camera view
+	pConstantBuffers->SetPerPass( reflectionViewMatrix, projectionMatrix, reflectionViewMatrix, clipPlane );
+	pConstantBuffers->SetPerObject( worldMatrix );
+	result = pConstantBuffers->Commit( pD3D->GetDeviceContext() );
+	if( !result ) {
+		return false;
+	}
 
 	// Put the terrain model vertex and index buffers on the graphics pipeline to prepare them for drawing
 	pTerrain->Render( pD3D->GetDeviceContext() );
 
 	// Render the terrain reflection using the terrain reflection shader
-	result = pTerrainReflectionShader->Render( pD3D->GetDeviceContext(),
-		                                       pTerrain->GetIndexCount(),
-										       worldMatrix,
-										       reflectionViewMatrix,
-					                           projectionMatrix,
-					                           pLight->GetAmbientColor(),
-										       pLight->GetDiffuseColor(),
-										       pLight->GetPosition(), 
-										       pTerrain->GetTextureArray(),
-										       clipPlane );
+	result = pTerrainReflectionShader->Render( pD3D->GetDeviceContext(), pTerrain->GetIndexCount(), pTerrain->GetTextureArray() );
 	if( !result ) {
 		return false;
 	}
@@ -841,12 +1626,17 @@ bool GraphicsClass::RenderSceneToTexture() {
 	// Apply rotate * translate matrix to world matrix
 	D3DXMatrixMultiply( &worldMatrix, &translateMatrix, &rotateMatrix );
 
-	// Transform light vector
-	D3DXVec3TransformCoord( &mLightPosition, &mLightOrbit, &rotateMatrix );
+	// Get the camera reflection view matrix
+	reflectionMatrix = pCamera->GetReflectionViewMatrix();
+
+	// Scene pass constants - no clipping
+	pConstantBuffers->SetPerPass( viewMatrix, projectionMatrix, reflectionMatrix, D3DXVECTOR4( 0.0f, 0.0f, 0.0f, 0.0f ) );
+	pConstantBuffers->SetPerObject( worldMatrix );
+	result = pConstantBuffers->Commit( pD3D->GetDeviceContext() );
+	if( !result ) {
+		return false;
+	}
 
-	// Update light position
-	pLight->SetPosition( mLightPosition.x, mLightPosition.y, mLightPosition.z ); 
-					
 	// Put the sun vertex and index buffers on the graphics pipeline to prepare them for drawing
 	pSun->Render( pD3D->GetDeviceContext() );
 
@@ -871,33 +1661,70 @@ bool GraphicsClass::RenderSceneToTexture() {
 	pCamera->GetViewMatrix( viewMatrix );
 
 	// Translate to where the terrain model will be rendered (centered on origin)
-	D3DXMatrixTranslation( &worldMatrix, -128.0f, 3.0f, -128.0f ); 
+	D3DXMatrixTranslation( &worldMatrix, TERRAIN_OFFSET.x, TERRAIN_OFFSET.y, TERRAIN_OFFSET.z );
+
+	// Only the world matrix changes between scene objects
+	pConstantBuffers->SetPerObject( worldMatrix );
+	result = pConstantBuffers->Commit( pD3D->GetDeviceContext() );
+	if( !result ) {
+		return false;
+	}
 
 	// Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing
 	pTerrain->Render( pD3D->GetDeviceContext() );
 
+	// Shadow cascades for Terrain.ps - after the terrain's textures
+	ID3D11ShaderResourceView* shadowMapView = pShadowMap->GetShaderResourceView();
+	ID3D11SamplerState* shadowSampler       = pShadowMap->GetComparisonSampler();
+	pD3D->GetDeviceContext()->PSSetShaderResources( SHADOW_MAP_TEXTURE_SLOT, 1, &shadowMapView );
+	pD3D->GetDeviceContext()->PSSetSamplers( SHADOW_MAP_SAMPLER_SLOT, 1, &shadowSampler );
+
+	// Baked horizons for the soft sun shadows and ambient occlusion
+	ID3D11ShaderResourceView* horizonMapView = pHorizonMap->GetShaderResourceView();
+	pD3D->GetDeviceContext()->PSSetShaderResources( HORIZON_MAP_TEXTURE_SLOT, 1, &horizonMapView );
+
 	// Render the terrain using the terrain shader
-	result = pTerrainShader->Render( pD3D->GetDeviceContext(),
-		                             pTerrain->GetIndexCount(),
-									 worldMatrix,
-								     viewMatrix,
-								     projectionMatrix,
-									 pLight->GetAmbientColor(),
-									 pLight->GetDiffuseColor(),
-									 pLight->GetPosition(),
-									 pTerrain->GetTextureArray() );
+	result = pTerrainShader->Render( pD3D->GetDeviceContext(), pTerrain->GetIndexCount(), pTerrain->GetTextureArray() );
 	if( !result ) {
 		return false;
 	}
 
-	// Get the camera reflection view matrix
-	reflectionMatrix = pCamera->GetReflectionViewMatrix();
+	// Unbind the cascades - next frame draws into them
+	shadowMapView = 0;
+	pD3D->GetDeviceContext()->PSSetShaderResources( SHADOW_MAP_TEXTURE_SLOT, 1, &shadowMapView );
+
+	// Cull the rock instances against the camera frustum
+	pFrustum->ConstructFrustum( SCREEN_DEPTH, projectionMatrix, viewMatrix );
+	result = pRocks->Cull( pD3D->GetDeviceContext(), pFrustum );
+	if( !result ) {
+		return false;
+	}
+
+	// Draw every visible rock in one call - instances carry their own world matrix
+	if( pRocks->GetVisibleCount() > 0 ) {
+		pRocks->Render( pD3D->GetDeviceContext(), pRock );
+
+		result = pInstanceShader->Render( pD3D->GetDeviceContext(),
+			                              pRock->GetIndexCount(),
+										  pRocks->GetVisibleCount(),
+										  pRock->GetTexture() );
+		if( !result ) {
+			return false;
+		}
+	}
 
 	// Reset the world matrix
 	pD3D->GetWorldMatrix( worldMatrix );
 
 	// Translate to where the ocean model will be rendered
-	D3DXMatrixTranslation( &worldMatrix, -128.0f, mWaterHeight, -128.0f ); 
+	D3DXMatrixTranslation( &worldMatrix, TERRAIN_OFFSET.x, mWaterHeight, TERRAIN_OFFSET.z );
+
+	// Only the world matrix changes between scene objects
+	pConstantBuffers->SetPerObject( worldMatrix );
+	result = pConstantBuffers->Commit( pD3D->GetDeviceContext() );
+	if( !result ) {
+		return false;
+	}
 
 	// Put the ocean model vertex and index buffers on the graphics pipeline to prepare them for drawing
 	pOcean->Render( pD3D->GetDeviceContext() );
@@ -906,17 +1733,9 @@ bool GraphicsClass::RenderSceneToTexture() {
 	// Passing the two render to textures to be combined to create the oceans reflection
 	result = pOceanShader->Render( pD3D->GetDeviceContext(),
 		                           pOcean->GetIndexCount(),
-								   worldMatrix,
-								   viewMatrix, 
-				                   projectionMatrix,
-								   reflectionMatrix,
 								   pReflectionTexture->GetShaderResourceView(),
 				                   pRefractionTexture->GetShaderResourceView(),
-								   pOcean->GetTextureArray(), 
-								   mWaterTranslation,
-								   0.005f,
-								   mRotation * 10.0f,
-								   mWaveHeight );
+								   pOcean->GetTextureArray() );
 	if( !result ) {
 		return false;
 	}
@@ -1105,7 +1924,7 @@ bool GraphicsClass::RenderScene() {
 		// Stop text rotating
 		pD3D->GetWorldMatrix( worldMatrix );
 
-		// Render the text strings
+		// Render the text strings - one draw call for every sentence
 		result = pText->Render( pD3D->GetDeviceContext(), worldMatrix, orthoMatrix );
 		if( !result ) { 
 			return false;
@@ -1202,3 +2021,50 @@ void GraphicsClass::TogglePostProcessing() {
 	}
 }
 
+
+// ToggleCameraRecording                          //
+// Starts recording, or stops and saves the path  //
+void GraphicsClass::ToggleCameraRecording() {
+	// No recording during a benchmark
+	if( pCameraPath->IsPlaying() ) {
+		return;
+	}
+
+	if( pCameraPath->IsRecording() ) {
+		pCameraPath->StopRecording();
+		pCameraPath->SavePath( CAMERA_PATH_FILE );
+	} else {
+		pCameraPath->StartRecording( mRotation, mWaterTranslation );
+	}
+}
+
+
+// StartBenchmark                                             //
+// Resets the scene to how it was when the path was recorded  //
+// then replays the path while the profiler captures          //
+void GraphicsClass::StartBenchmark() {
+	if( ( pCameraPath->IsRecording() ) || ( pCameraPath->IsPlaying() ) ) {
+		return;
+	}
+
+	if( pCameraPath->StartPlayback( mRotation, mWaterTranslation ) ) {
+		pProfiler->StartCapture();
+	}
+}
+
+
+// EndBenchmark                        //
+// Stops capturing and writes a report //
+void GraphicsClass::EndBenchmark() {
+	char title[ 128 ];
+
+	pCameraPath->StopPlayback();
+	pProfiler->StopCapture();
+
+	// The path's last frames are still in flight - wait for them
+	pProfiler->ReadBackPending( pD3D->GetDeviceContext() );
+
+	sprintf_s( title, sizeof( title ), "Camera path benchmark - %d frames, blur %s",
+		       pCameraPath->GetFrameCount(), mApplyingBlur ? "on" : "off" );
+	pProfiler->WriteReport( BENCHMARK_REPORT_FILE, title );
+}
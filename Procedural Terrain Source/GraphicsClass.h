@@ -14,8 +14,16 @@
 #include "ModelClass.h"
 #include "TerrainClass.h"
 #include "OceanClass.h"
+#include "InstancedModelClass.h"
+#include "ScatterClass.h"
+#include "FrustumClass.h"
+#include "NoiseGeneratorClass.h"
+#include "ErosionClass.h"
+#include "HeightfieldCacheClass.h"
+#include "JobSystemClass.h"
+#include "HorizonMapClass.h"
 
-#include "TextClass.h"
+#include "TextBatchClass.h"
 
 #include "RenderTextureClass.h"
 
@@ -29,9 +37,19 @@
 #include "HorizontalBlurShaderClass.h"
 #include "VerticalBlurShaderClass.h"
 
+#include "InstanceShaderClass.h"
+
+#include "ShadowMapClass.h"
+#include "ShadowShaderClass.h"
+
 #include "CursorClass.h"
 #include "OrthoWindowClass.h"
 
+#include "CameraPathClass.h"
+#include "ProfilerClass.h"
+#include "ShaderCacheClass.h"
+#include "ConstantBufferManagerClass.h"
+
 
 // Globals //
 const bool  FULL_SCREEN   = false;
@@ -39,6 +57,39 @@ const bool  VSYNC_ENABLED = true;
 const float SCREEN_DEPTH  = 1000.0f;
 const float SCREEN_NEAR   = 0.1f;
 
+// Benchmark Files
+static const char* const CAMERA_PATH_FILE      = "CameraPath.bin";
+static const char* const BENCHMARK_REPORT_FILE = "BenchmarkReport.txt";
+
+// Height Generators - G cycles through them
+enum HeightGeneratorType {
+	GENERATOR_DIAMOND_SQUARE,
+	GENERATOR_FBM,
+	GENERATOR_RIDGED,
+	GENERATOR_WARPED,
+	GENERATOR_COUNT
+};
+
+// Terrain Variables
+const D3DXVECTOR3 TERRAIN_OFFSET( -128.0f, 3.0f, -128.0f ); // world position of the terrain's first vertex, the ocean shares x / z
+
+// Mesh Simplification Variables
+const float TERRAIN_SIMPLIFICATION_ERROR = 0.1f; // world units - applied once toggled with M
+
+// Sculpting Variables - held left mouse button, B cycles the brush
+const float TERRAIN_BRUSH_RADIUS      = 6.0f; // grid cells
+const float TERRAIN_BRUSH_HEIGHT_RATE = 4.0f; // raise / lower - world units per second at the centre
+const float TERRAIN_BRUSH_SMOOTH_RATE = 6.0f; // smooth - blend per second at the centre
+
+// Shadow Variables
+const int   SHADOW_MAP_SIZE      = 2048;
+const int   SHADOW_CASCADE_COUNT = 3;
+const float SHADOW_DISTANCE      = 300.0f; // view depth the last cascade ends at
+
+// Scatter Variables
+const int          MAX_ROCK_INSTANCES = 4096;
+const unsigned int ROCK_SCATTER_SEED  = 1234;
+
 
 // GraphicsClass                                                 // 
 // Contains and manages all of the scenes Graphical elements     //
@@ -59,6 +110,8 @@ public:
 private:
 	// Render Stage Functions //
 	bool Render();
+	bool RenderStages();
+	bool RenderShadowMaps();
 	bool RenderRefractionToTexture();
 	bool RenderReflectionToTexture();
 	bool RenderSceneToTexture();
@@ -70,6 +123,26 @@ private:
 	void ChangeUIDisplayMode();
 	void TogglePostProcessing();
 
+	// Height Generator Functions //
+	HeightGeneratorClass* SelectHeightGenerator();
+	void UpdateErosionText();
+	unsigned __int64 GetTerrainCacheKey();
+	void UpdateMeshText();
+	void UpdateShadowText();
+	void UpdateHorizonText();
+
+	// Sculpting Functions //
+	bool SculptTerrain( int fps );
+	void UpdateBrushText();
+
+	// Scatter Functions //
+	void ScatterProps();
+
+	// Camera Path Functions //
+	void ToggleCameraRecording();
+	void StartBenchmark();
+	void EndBenchmark();
+
 private:
 	// D3D & Camera Objects
 	D3DClass*               pD3D;
@@ -83,24 +156,47 @@ private:
 	OceanShaderClass*             pOceanShader;
 	HorizontalBlurShaderClass*    pHorizontalBlurShader;
 	VerticalBlurShaderClass*      pVerticalBlurShader;
+	InstanceShaderClass*          pInstanceShader;
+	ShadowShaderClass*            pShadowShader;
+
+	// Shared Constant Buffers
+	ConstantBufferManagerClass* pConstantBuffers;
 
 	// Light Object
 	LightClass* pLight;
 
 	// Model Objects
-	TerrainClass* pTerrain;
+	TerrainClass*        pTerrain;
+	NoiseGeneratorClass* pNoise;
+	ErosionClass*        pErosion;
+	HeightfieldCacheClass* pHeightfieldCache;
+	JobSystemClass*        pJobSystem;
+	HorizonMapClass*       pHorizonMap;
 	ModelClass*   pSun;
 	OceanClass*   pOcean;
 
+	// Instanced Props
+	ModelClass*          pRock;
+	InstancedModelClass* pRocks;
+	FrustumClass*        pFrustum;
+
+	// Sun Shadow Cascades
+	ShadowMapClass* pShadowMap;
+	int mShadowChunks[ SHADOW_MAX_CASCADES ];
+
 	// RenderToTexture Objects
 	RenderTextureClass* pRefractionTexture;
 	RenderTextureClass* pReflectionTexture;
 
 	// UI Objects
-	TextClass*        pText;
+	TextBatchClass*   pText;
 	OrthoWindowClass* pDebugWindow;
 	CursorClass*      pCursor;
 
+	// Benchmark Objects
+	CameraPathClass* pCameraPath;
+	ProfilerClass*   pProfiler;
+
 	// Post Processing
 	RenderTextureClass* pPostProcessingTexture;
 	OrthoWindowClass*   pPostProcessingWindow;
@@ -127,6 +223,14 @@ private:
 	// Terrain Variables
 	int mSmoothingAmount;
 	float mDisplacementRange;
+	int mHeightGenerator;
+	unsigned int mNoiseSeed;
+	bool mApplyingErosion;
+	bool mSimplifyingMesh;
+
+	// Sculpting Variables
+	int mBrushType;
+	bool mSculpting;
 };
 
 #endif
@@ -0,0 +1,22 @@
+#ifndef _HEIGHTGENERATORCLASS_H_
+#define _HEIGHTGENERATORCLASS_H_
+
+
+// HeightGeneratorClass                                                //
+// Interface for pluggable terrain height sources                      //
+// TerrainClass falls back to DiamondSquareAlgorithm when none is set  //
+// A generator must be a pure function of world position so any tile   //
+// at any offset can be produced on its own and neighbouring tiles     //
+// line up                                                             //
+class HeightGeneratorClass {
+public:
+	virtual ~HeightGeneratorClass() {}
+
+	// GenerateTile                                                 //
+	// Fills width * height heights, row major, for the tile whose  //
+	// first sample is at (offsetX, offsetZ) with the given spacing //
+	virtual void GenerateTile( float* heights, int width, int height, float offsetX, float offsetZ, float spacing ) = 0;
+};
+
+
+#endif
@@ -0,0 +1,144 @@
+// HeightfieldCacheBenchmark                                       //
+// Console round trip check and load time test for the heightfield //
+// cache - a terrain sized tile is generated (fBm + erosion), saved //
+// and mapped back, then loading is timed against regenerating     //
+// Returns non zero if the round trip check fails                  //
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+#include "NoiseGeneratorClass.h"
+#include "ErosionClass.h"
+#include "JobSystemClass.h"
+#include "HeightfieldCacheClass.h"
+#include "BenchmarkTimer.h"
+
+
+// Benchmark Variables
+const int          BENCHMARK_TILE_SIZE     = 257; // same size as the terrain
+const int          BENCHMARK_REGENERATIONS = 3;
+const int          BENCHMARK_LOADS         = 100;
+const unsigned int BENCHMARK_SEED          = 42;
+
+
+// Regenerate                                           //
+// What a launch does without the cache - heights,      //
+// erosion and central difference normals (xyz per cell) //
+void Regenerate( NoiseGeneratorClass& generator, ErosionClass& erosion, std::vector< float >& heights, std::vector< float >& normals ) {
+	int size = BENCHMARK_TILE_SIZE;
+	float dx, dz, length;
+
+	heights.resize( size * size );
+	normals.resize( size * size * 3 );
+
+	generator.GenerateTile( &heights[ 0 ], size, size, 0.0f, 0.0f, 1.0f );
+	erosion.Erode( &heights[ 0 ], size, size );
+
+	for( int j = 0; j < size; j++ ) {
+		for( int i = 0; i < size; i++ ) {
+			dx = heights[ ( j * size ) + ( i < size - 1 ? i + 1 : i ) ] - heights[ ( j * size ) + ( i > 0 ? i - 1 : i ) ];
+			dz = heights[ ( ( j < size - 1 ? j + 1 : j ) * size ) + i ] - heights[ ( ( j > 0 ? j - 1 : j ) * size ) + i ];
+			length = sqrt( ( dx * dx ) + 4.0f + ( dz * dz ) );
+
+			normals[ ( ( ( j * size ) + i ) * 3 ) ]     = -dx / length;
+			normals[ ( ( ( j * size ) + i ) * 3 ) + 1 ] = 2.0f / length;
+			normals[ ( ( ( j * size ) + i ) * 3 ) + 2 ] = -dz / length;
+		}
+	}
+}
+
+
+int main() {
+	NoiseGeneratorClass generator;
+	NoiseGeneratorClass::NoiseParametersType parameters;
+	ErosionClass erosion;
+	JobSystemClass jobSystem;
+	HeightfieldCacheClass cache;
+	std::vector< float > heights, normals, loadedHeights, loadedNormals;
+	LARGE_INTEGER startTime, endTime;
+	double regenerateTime, loadTime;
+	float heightError, normalError;
+	unsigned __int64 key;
+	bool passed;
+	int planeSize;
+
+	planeSize = BENCHMARK_TILE_SIZE * BENCHMARK_TILE_SIZE;
+
+	parameters = generator.GetParameters();
+	parameters.seed = BENCHMARK_SEED;
+	generator.Initialize( parameters );
+
+	if( !jobSystem.Initialize( 0 ) ) {
+		printf( "Could not start the job system threads\n" );
+		return 1;
+	}
+	erosion.SetJobSystem( &jobSystem );
+
+	key = HeightfieldCacheClass::HashParameters( &parameters, sizeof( parameters ), HEIGHTFIELD_HASH_BASIS );
+	key = HeightfieldCacheClass::HashParameters( &erosion.GetParameters(), sizeof( ErosionClass::ErosionParametersType ), key );
+
+	// Regeneration
+	QueryPerformanceCounter( &startTime );
+	for( int i = 0; i < BENCHMARK_REGENERATIONS; i++ ) {
+		Regenerate( generator, erosion, heights, normals );
+	}
+	QueryPerformanceCounter( &endTime );
+	regenerateTime = GetMilliseconds( startTime, endTime ) / BENCHMARK_REGENERATIONS;
+
+	erosion.Shutdown();
+	jobSystem.Shutdown();
+
+	// Save
+	if( !HeightfieldCacheClass::Save( BENCHMARK_SEED, key, BENCHMARK_TILE_SIZE, BENCHMARK_TILE_SIZE, &heights[ 0 ], &normals[ 0 ] ) ) {
+		printf( "Could not write the cache file\n" );
+		return 1;
+	}
+
+	// Load - map, unpack into floats (as TerrainClass does) and unmap
+	loadedHeights.resize( planeSize );
+	loadedNormals.resize( planeSize * 3 );
+
+	QueryPerformanceCounter( &startTime );
+	for( int i = 0; i < BENCHMARK_LOADS; i++ ) {
+		if( !cache.Open( BENCHMARK_SEED, key ) ) {
+			printf( "Could not map the cache file\n" );
+			return 1;
+		}
+
+		for( int index = 0; index < planeSize; index++ ) {
+			loadedHeights[ index ] = cache.GetHeight( index );
+			cache.GetNormal( index, loadedNormals[ ( index * 3 ) ], loadedNormals[ ( index * 3 ) + 1 ], loadedNormals[ ( index * 3 ) + 2 ] );
+		}
+
+		cache.Close();
+	}
+	QueryPerformanceCounter( &endTime );
+	loadTime = GetMilliseconds( startTime, endTime ) / BENCHMARK_LOADS;
+
+	// Round trip - heights within half a quantization step, normals within 0.01 degrees
+	cache.Open( BENCHMARK_SEED, key );
+	heightError = normalError = 0.0f;
+	for( int index = 0; index < planeSize; index++ ) {
+		heightError = max( heightError, fabs( loadedHeights[ index ] - heights[ index ] ) );
+
+		for( int k = 0; k < 3; k++ ) {
+			normalError = max( normalError, fabs( loadedNormals[ ( index * 3 ) + k ] - normals[ ( index * 3 ) + k ] ) );
+		}
+	}
+
+	passed = ( heightError <= ( cache.GetHeader()->heightScale * 0.5f ) + 1.0e-5f ) && ( normalError < 2.0e-4f );
+	cache.Close();
+
+	// A different seed or key must miss
+	if( cache.Open( BENCHMARK_SEED + 1, key ) || cache.Open( BENCHMARK_SEED, key + 1 ) ) {
+		printf( "Cache file matched the wrong seed / key\n" );
+		passed = false;
+	}
+	cache.Close();
+
+	printf( "Round trip       %s (height error %.6f, normal error %.6f)\n", passed ? "passed" : "FAILED", heightError, normalError );
+	printf( "Regenerate       %10.3f ms\n", regenerateTime );
+	printf( "Load from cache  %10.3f ms\n", loadTime );
+	printf( "Speedup          %10.1fx\n", regenerateTime / loadTime );
+
+	return passed ? 0 : 1;
+}
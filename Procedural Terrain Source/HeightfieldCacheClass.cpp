@@ -0,0 +1,307 @@
+#include "HeightfieldCacheClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+HeightfieldCacheClass::HeightfieldCacheClass() :
+ mFile( INVALID_HANDLE_VALUE ), mMapping( 0 ), pView( 0 ) {
+}
+
+
+// Constructor //
+HeightfieldCacheClass::HeightfieldCacheClass( const HeightfieldCacheClass& other ) {
+}
+
+
+// Destructor                 //
+// Unmaps any open cache file //
+HeightfieldCacheClass::~HeightfieldCacheClass() {
+	Close();
+}
+
+
+// Open                                          //
+// Maps the whole file and checks the header     //
+// describes planes that fit inside it           //
+bool HeightfieldCacheClass::Open( unsigned int seed, unsigned __int64 parametersKey ) {
+	WCHAR cacheFileName[ MAX_PATH ];
+	LARGE_INTEGER fileSize;
+	const HeaderType* header;
+	unsigned int planeSize;
+
+	Close();
+
+	GetCacheFileName( seed, parametersKey, cacheFileName, MAX_PATH );
+
+	// Open the cache file - a missing file is just a miss
+	mFile = CreateFile( cacheFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if( mFile == INVALID_HANDLE_VALUE ) {
+		return false;
+	}
+
+	// Too small (or too big) to be a cache file
+	if( !GetFileSizeEx( mFile, &fileSize ) || fileSize.QuadPart < sizeof( HeaderType ) || fileSize.HighPart != 0 ) {
+		Close();
+		return false;
+	}
+
+	// Map the file read only
+	mMapping = CreateFileMapping( mFile, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( !mMapping ) {
+		Close();
+		return false;
+	}
+
+	pView = ( const unsigned char* )MapViewOfFile( mMapping, FILE_MAP_READ, 0, 0, 0 );
+	if( !pView ) {
+		Close();
+		return false;
+	}
+
+	// Check the header matches what was asked for
+	header = ( const HeaderType* )pView;
+	if( header->magic != HEIGHTFIELD_MAGIC ||
+		header->version != HEIGHTFIELD_VERSION ||
+		header->seed != seed ||
+		header->parametersKey != parametersKey ||
+		header->fileSize != fileSize.LowPart ||
+		header->width <= 0 || header->height <= 0 ||
+		header->width > 0x4000 || header->height > 0x4000 ) {
+		Close();
+		return false;
+	}
+
+	// Check the planes are inside the file
+	planeSize = header->width * header->height;
+	if( header->heightsOffset < sizeof( HeaderType ) ||
+		header->heightsOffset + ( planeSize * sizeof( unsigned short ) ) > header->fileSize ) {
+		Close();
+		return false;
+	}
+
+	if( header->flags & HEIGHTFIELD_HAS_NORMALS ) {
+		if( header->normalsOffset < sizeof( HeaderType ) ||
+			header->normalsOffset + ( planeSize * sizeof( PackedNormalType ) ) > header->fileSize ) {
+			Close();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Close                           //
+// Unmaps the view and closes both //
+// the mapping and the file        //
+void HeightfieldCacheClass::Close() {
+	if( pView ) {
+		UnmapViewOfFile( pView );
+		pView = 0;
+	}
+
+	if( mMapping ) {
+		CloseHandle( mMapping );
+		mMapping = 0;
+	}
+
+	if( mFile != INVALID_HANDLE_VALUE ) {
+		CloseHandle( mFile );
+		mFile = INVALID_HANDLE_VALUE;
+	}
+
+	return;
+}
+
+
+// IsOpen //
+bool HeightfieldCacheClass::IsOpen() {
+	return ( pView != 0 );
+}
+
+
+// GetHeader //
+const HeightfieldCacheClass::HeaderType* HeightfieldCacheClass::GetHeader() {
+	return ( const HeaderType* )pView;
+}
+
+
+// GetHeights //
+const unsigned short* HeightfieldCacheClass::GetHeights() {
+	return ( const unsigned short* )( pView + GetHeader()->heightsOffset );
+}
+
+
+// GetNormals                        //
+// NULL if the file has no normals   //
+const HeightfieldCacheClass::PackedNormalType* HeightfieldCacheClass::GetNormals() {
+	if( !( GetHeader()->flags & HEIGHTFIELD_HAS_NORMALS ) ) {
+		return 0;
+	}
+
+	return ( const PackedNormalType* )( pView + GetHeader()->normalsOffset );
+}
+
+
+// GetHeight                      //
+// Dequantizes one height sample  //
+float HeightfieldCacheClass::GetHeight( int index ) {
+	const HeaderType* header = GetHeader();
+
+	return header->minHeight + ( ( float )GetHeights()[ index ] * header->heightScale );
+}
+
+
+// GetNormal                                    //
+// Unpacks one normal - y is rebuilt from x / z //
+void HeightfieldCacheClass::GetNormal( int index, float& x, float& y, float& z ) {
+	const PackedNormalType& normal = GetNormals()[ index ];
+	float lengthSquared;
+
+	x = ( float )normal.x / 32767.0f;
+	z = ( float )normal.z / 32767.0f;
+
+	lengthSquared = ( x * x ) + ( z * z );
+	y = ( lengthSquared < 1.0f ) ? sqrt( 1.0f - lengthSquared ) : 0.0f;
+
+	return;
+}
+
+
+// Save                                               //
+// Heights are quantized over their own min-max range //
+bool HeightfieldCacheClass::Save( unsigned int seed,
+	                              unsigned __int64 parametersKey,
+								  int width,
+								  int height,
+								  const float* heights,
+								  const float* normals ) {
+	WCHAR cacheFileName[ MAX_PATH ];
+	HeaderType header;
+	unsigned short* quantizedHeights;
+	PackedNormalType* packedNormals;
+	float maxHeight, value;
+	int planeSize, error;
+	unsigned int count;
+	bool result;
+	FILE* filePtr;
+	static const unsigned char zeros[ HEIGHTFIELD_ALIGNMENT ] = { 0 };
+
+	planeSize = width * height;
+
+	// Find the height range
+	header.minHeight = maxHeight = heights[ 0 ];
+	for( int i = 1; i < planeSize; i++ ) {
+		if( heights[ i ] < header.minHeight ) {
+			header.minHeight = heights[ i ];
+		}
+		if( heights[ i ] > maxHeight ) {
+			maxHeight = heights[ i ];
+		}
+	}
+
+	// Fill in the header
+	header.magic         = HEIGHTFIELD_MAGIC;
+	header.version       = HEIGHTFIELD_VERSION;
+	header.seed          = seed;
+	header.flags         = normals ? HEIGHTFIELD_HAS_NORMALS : 0;
+	header.parametersKey = parametersKey;
+	header.width         = width;
+	header.height        = height;
+	header.heightScale   = ( maxHeight > header.minHeight ) ? ( ( maxHeight - header.minHeight ) / 65535.0f ) : 1.0f;
+	header.heightsOffset = AlignOffset( sizeof( HeaderType ) );
+	header.normalsOffset = normals ? AlignOffset( header.heightsOffset + ( planeSize * sizeof( unsigned short ) ) ) : 0;
+	header.fileSize      = normals ? ( header.normalsOffset + ( planeSize * sizeof( PackedNormalType ) ) ) : ( header.heightsOffset + ( planeSize * sizeof( unsigned short ) ) );
+	header.padding[ 0 ]  = header.padding[ 1 ] = header.padding[ 2 ] = 0;
+
+	// Quantize the heights (rounded to nearest)
+	quantizedHeights = new unsigned short[ planeSize ];
+	if( !quantizedHeights ) {
+		return false;
+	}
+
+	for( int i = 0; i < planeSize; i++ ) {
+		value = ( ( heights[ i ] - header.minHeight ) / header.heightScale ) + 0.5f;
+		quantizedHeights[ i ] = ( unsigned short )( ( value > 65535.0f ) ? 65535.0f : value );
+	}
+
+	// Pack the normals
+	packedNormals = 0;
+	if( normals ) {
+		packedNormals = new PackedNormalType[ planeSize ];
+		if( !packedNormals ) {
+			delete [] quantizedHeights;
+			return false;
+		}
+
+		for( int i = 0; i < planeSize; i++ ) {
+			packedNormals[ i ].x = ( short )floor( ( normals[ ( i * 3 ) ]     * 32767.0f ) + 0.5f );
+			packedNormals[ i ].z = ( short )floor( ( normals[ ( i * 3 ) + 2 ] * 32767.0f ) + 0.5f );
+		}
+	}
+
+	// Fine if it already exists
+	CreateDirectory( HEIGHTFIELD_CACHE_DIRECTORY, NULL );
+
+	GetCacheFileName( seed, parametersKey, cacheFileName, MAX_PATH );
+
+	// Open the cache file in binary
+	result = false;
+	error = _wfopen_s( &filePtr, cacheFileName, L"wb" );
+	if( error == 0 ) {
+		// Header, padding, heights, padding, normals
+		count  = fwrite( &header, sizeof( HeaderType ), 1, filePtr ) * sizeof( HeaderType );
+		count += fwrite( zeros, 1, header.heightsOffset - sizeof( HeaderType ), filePtr );
+		count += fwrite( quantizedHeights, sizeof( unsigned short ), planeSize, filePtr ) * sizeof( unsigned short );
+		if( packedNormals ) {
+			count += fwrite( zeros, 1, header.normalsOffset - ( header.heightsOffset + ( planeSize * sizeof( unsigned short ) ) ), filePtr );
+			count += fwrite( packedNormals, sizeof( PackedNormalType ), planeSize, filePtr ) * sizeof( PackedNormalType );
+		}
+		fclose( filePtr );
+
+		// Dont leave a truncated file behind
+		result = ( count == header.fileSize );
+		if( !result ) {
+			_wremove( cacheFileName );
+		}
+	}
+
+	// Release the packed planes
+	delete [] quantizedHeights;
+	quantizedHeights = 0;
+
+	if( packedNormals ) {
+		delete [] packedNormals;
+		packedNormals = 0;
+	}
+
+	return result;
+}
+
+
+// HashParameters                     //
+// 64bit FNV-1a over the given bytes  //
+unsigned __int64 HeightfieldCacheClass::HashParameters( const void* data, unsigned int size, unsigned __int64 hash ) {
+	const unsigned __int64 prime = 1099511628211ULL;
+	const unsigned char* bytes = ( const unsigned char* )data;
+
+	for( unsigned int i = 0; i < size; i++ ) {
+		hash = ( hash ^ bytes[ i ] ) * prime;
+	}
+
+	return hash;
+}
+
+
+// GetCacheFileName                                //
+// TerrainCache\<8 hex digit seed>_<16 hex key>.hfc //
+void HeightfieldCacheClass::GetCacheFileName( unsigned int seed, unsigned __int64 parametersKey, WCHAR* cacheFileName, int length ) {
+	swprintf_s( cacheFileName, length, L"%s\\%08x_%016I64x.hfc", HEIGHTFIELD_CACHE_DIRECTORY, seed, parametersKey );
+}
+
+
+// AlignOffset                                  //
+// Rounds up to the next HEIGHTFIELD_ALIGNMENT  //
+unsigned int HeightfieldCacheClass::AlignOffset( unsigned int offset ) {
+	return ( offset + ( HEIGHTFIELD_ALIGNMENT - 1 ) ) & ~( HEIGHTFIELD_ALIGNMENT - 1 );
+}
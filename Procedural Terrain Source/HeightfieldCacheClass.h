@@ -0,0 +1,102 @@
+#ifndef _HEIGHTFIELDCACHECLASS_H_
+#define _HEIGHTFIELDCACHECLASS_H_
+
+
+// Includes //
+#include <windows.h>
+#include <stdio.h>
+#include <math.h>
+
+
+// Cache Directory
+const WCHAR HEIGHTFIELD_CACHE_DIRECTORY[] = L"TerrainCache";
+
+// File Format Variables
+const unsigned int HEIGHTFIELD_MAGIC       = 0x31434648; // "HFC1"
+const unsigned int HEIGHTFIELD_VERSION     = 1;
+const unsigned int HEIGHTFIELD_HAS_NORMALS = 0x1;
+const unsigned int HEIGHTFIELD_ALIGNMENT   = 16;         // planes start on 16 byte boundaries
+
+// Starting value for HashParameters
+const unsigned __int64 HEIGHTFIELD_HASH_BASIS = 14695981039346656037ULL;
+
+
+// HeightfieldCacheClass                                                  //
+// Binary cache of generated height maps so a known seed starts without  //
+// running the generator, smoothing, erosion or normal calculation       //
+// File layout - header, 16 bit quantized height plane, optional normal  //
+// plane (x / z as 16 bit snorm, y rebuilt as it is always positive)     //
+// Open memory maps the file and hands out pointers straight into the    //
+// view - nothing is parsed or copied beyond checking the header         //
+// Files are named from the seed and a key hashed from every setting     //
+// that changes the heights, so a changed setting simply misses         //
+class HeightfieldCacheClass {
+public:
+	// File header - planes are found from the offsets
+	struct HeaderType {
+		unsigned int magic;
+		unsigned int version;
+		unsigned int seed;
+		unsigned int flags;
+		unsigned __int64 parametersKey;
+		int width, height;
+		float minHeight;   // height = minHeight + quantized * heightScale
+		float heightScale;
+		unsigned int heightsOffset;
+		unsigned int normalsOffset; // 0 if no normals were stored
+		unsigned int fileSize;
+		unsigned int padding[ 3 ];
+	};
+
+	// Packed normal - snorm x / z
+	struct PackedNormalType {
+		short x, z;
+	};
+
+public:
+	HeightfieldCacheClass();
+	HeightfieldCacheClass( const HeightfieldCacheClass& other );
+	~HeightfieldCacheClass();
+
+	// Open                                                   //
+	// Maps the cache file for the seed / key read only and   //
+	// validates the header - false on a miss or a bad file   //
+	bool Open( unsigned int seed, unsigned __int64 parametersKey );
+	void Close();
+	bool IsOpen();
+
+	// Views into the mapped file - valid until Close
+	const HeaderType* GetHeader();
+	const unsigned short* GetHeights();
+	const PackedNormalType* GetNormals(); // NULL if not stored
+
+	// Unpacked values
+	float GetHeight( int index );
+	void GetNormal( int index, float& x, float& y, float& z );
+
+	// Save                                                    //
+	// Quantizes width * height row major heights and (if not  //
+	// NULL) xyz normals and writes the cache file              //
+	static bool Save( unsigned int seed,
+		              unsigned __int64 parametersKey,
+					  int width,
+					  int height,
+					  const float* heights,
+					  const float* normals );
+
+	// HashParameters                                           //
+	// 64bit FNV-1a - chain calls to fold several settings in   //
+	// (pass HEIGHTFIELD_HASH_BASIS to start a new key)         //
+	static unsigned __int64 HashParameters( const void* data, unsigned int size, unsigned __int64 hash );
+
+private:
+	static void GetCacheFileName( unsigned int seed, unsigned __int64 parametersKey, WCHAR* cacheFileName, int length );
+	static unsigned int AlignOffset( unsigned int offset );
+
+private:
+	HANDLE mFile, mMapping;
+	const unsigned char* pView;
+};
+
+
+#endif
@@ -0,0 +1,102 @@
+// HorizonBakeBenchmark                                             //
+// Console timing of HorizonMapClass - for each terrain size the    //
+// full bake on 1 thread and on one per core, then the incremental  //
+// rebake after a brush stroke and after a regeneration that left   //
+// the heights alone. Only the CPU half of both classes is used     //
+#include <stdio.h>
+#include "JobSystemClass.h"
+#include "TerrainClass.h"
+#include "HorizonMapClass.h"
+
+
+// Benchmark Variables
+const int   BENCHMARK_SIZE_COUNT = 3;
+const int   BENCHMARK_SIZES[ BENCHMARK_SIZE_COUNT ] = { 257, 513, 1025 }; // (2^n) + 1 for Diamond-Square
+const int   BENCHMARK_PASSES     = 5;
+const float BENCHMARK_RADIUS     = 32.0f;
+const int   BENCHMARK_STROKES    = 20;
+
+
+// BakeAll //
+float BakeAll( HorizonMapClass& horizonMap, TerrainClass& terrain, int pointsWide ) {
+	float time = 0.0f;
+
+	for( int pass = 0; pass < BENCHMARK_PASSES; pass++ ) {
+		// Forget the heights so every point is baked again
+		horizonMap.InitializeMap( pointsWide, pointsWide );
+		horizonMap.Update( &terrain, 0, 0, pointsWide - 1, pointsWide - 1 );
+		time += horizonMap.GetLastTime();
+	}
+
+	return time / BENCHMARK_PASSES;
+}
+
+
+int main() {
+	JobSystemClass jobSystem;
+	TerrainClass terrain;
+	HorizonMapClass horizonMap;
+	float singleThreadTime, allThreadTime, strokeTime, unchangedTime;
+	int pointsWide, minX, minZ, maxX, maxZ, strokePoints;
+	float x, z;
+
+	printf( "%-11s %12s %12s %9s %14s %14s\n", "Terrain", "1 thread", "All threads", "Speedup", "Stroke rebake", "Unchanged" );
+
+	for( int size = 0; size < BENCHMARK_SIZE_COUNT; size++ ) {
+		pointsWide = BENCHMARK_SIZES[ size ];
+
+		if( !terrain.InitializeHeightMap( pointsWide, 5, 10.0f ) ) {
+			printf( "Could not build a %d terrain\n", pointsWide );
+			return 1;
+		}
+
+		// Full bake - serial
+		horizonMap.SetJobSystem( 0 );
+		singleThreadTime = BakeAll( horizonMap, terrain, pointsWide );
+
+		// Full bake - one thread per core
+		if( !jobSystem.Initialize( 0 ) ) {
+			printf( "Could not start the job system\n" );
+			return 1;
+		}
+
+		terrain.SetJobSystem( &jobSystem );
+		horizonMap.SetJobSystem( &jobSystem );
+		allThreadTime = BakeAll( horizonMap, terrain, pointsWide );
+
+		// Brush strokes - only the points around each dab are rebaked
+		strokeTime   = 0.0f;
+		strokePoints = 0;
+		for( int stroke = 0; stroke < BENCHMARK_STROKES; stroke++ ) {
+			x = ( float )( pointsWide / 4 ) + ( stroke * BENCHMARK_RADIUS * 0.25f );
+			z = ( float )( pointsWide / 4 ) + ( stroke * BENCHMARK_RADIUS * 0.125f );
+
+			terrain.ApplyBrush( TerrainClass::BRUSH_RAISE, x, z, BENCHMARK_RADIUS, 0.05f );
+
+			// Around the brush - the terrain's own dirty rectangle is
+			// only cleared by an upload
+			minX = ( int )( x - BENCHMARK_RADIUS ) - 1;
+			minZ = ( int )( z - BENCHMARK_RADIUS ) - 1;
+			maxX = ( int )( x + BENCHMARK_RADIUS ) + 1;
+			maxZ = ( int )( z + BENCHMARK_RADIUS ) + 1;
+			strokePoints += horizonMap.Update( &terrain, minX, minZ, maxX, maxZ );
+			strokeTime   += horizonMap.GetLastTime();
+		}
+
+		// Same heights again - compared, nothing baked
+		horizonMap.Update( &terrain, 0, 0, pointsWide - 1, pointsWide - 1 );
+		unchangedTime = horizonMap.GetLastTime();
+
+		printf( "%4d x %-5d %9.2f ms %9.2f ms %8.2fx %11.3f ms %11.3f ms  (%d points / stroke)\n",
+			    pointsWide, pointsWide, singleThreadTime, allThreadTime, singleThreadTime / allThreadTime,
+				strokeTime / BENCHMARK_STROKES, unchangedTime, strokePoints / BENCHMARK_STROKES );
+
+		terrain.SetJobSystem( 0 );
+		horizonMap.SetJobSystem( 0 );
+		jobSystem.Shutdown();
+		horizonMap.Shutdown();
+		terrain.Shutdown();
+	}
+
+	return 0;
+}
@@ -0,0 +1,343 @@
+#include "HorizonMapClass.h"
+
+
+// Azimuth Directions
+// Grid steps of azimuth a, at a * 45 degrees from +x towards +z
+const int HORIZON_DIRECTION_X[ HORIZON_AZIMUTHS ] = { 1, 1, 0, -1, -1, -1,  0,  1 };
+const int HORIZON_DIRECTION_Z[ HORIZON_AZIMUTHS ] = { 0, 1, 1,  1,  0, -1, -1, -1 };
+
+
+// Default Constructor  //
+// NULL object pointers //
+HorizonMapClass::HorizonMapClass()
+: pTexture( 0 ), pShaderResourceView( 0 ), pJobSystem( 0 ),
+  mPointsWide( 0 ), mPointsHigh( 0 ), mPaddedWide( 0 ), mLastTime( 0.0f ), mLastCount( 0 ) {
+	mBakeRegion.minX  = mBakeRegion.minZ  = 0;
+	mBakeRegion.maxX  = mBakeRegion.maxZ  = -1;
+	mDirtyRegion.minX = mDirtyRegion.minZ = 0;
+	mDirtyRegion.maxX = mDirtyRegion.maxZ = -1;
+}
+
+
+// Constructor //
+HorizonMapClass::HorizonMapClass( const HorizonMapClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+HorizonMapClass::~HorizonMapClass() {
+}
+
+
+// Initialize                                       //
+// Creates the two slice texture and its view - the //
+// first Update bakes every point                   //
+bool HorizonMapClass::Initialize( ID3D11Device* device, int pointsWide, int pointsHigh ) {
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+	HRESULT result;
+
+	if( !InitializeMap( pointsWide, pointsHigh ) ) {
+		return false;
+	}
+
+	// Set up the description of the horizon texture
+	textureDesc.Width              = pointsWide;
+	textureDesc.Height             = pointsHigh;
+	textureDesc.MipLevels          = 1;
+	textureDesc.ArraySize          = HORIZON_AZIMUTHS / 4;
+	textureDesc.Format             = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count   = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage              = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags          = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags     = 0;
+	textureDesc.MiscFlags          = 0;
+
+	result = device->CreateTexture2D( &textureDesc, NULL, &pTexture );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Set up the description of the shader resource view
+	viewDesc.Format                         = textureDesc.Format;
+	viewDesc.ViewDimension                  = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+	viewDesc.Texture2DArray.MostDetailedMip = 0;
+	viewDesc.Texture2DArray.MipLevels       = 1;
+	viewDesc.Texture2DArray.FirstArraySlice = 0;
+	viewDesc.Texture2DArray.ArraySize       = textureDesc.ArraySize;
+
+	result = device->CreateShaderResourceView( pTexture, &viewDesc, &pShaderResourceView );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// InitializeMap                                       //
+// Heights start off the terrain so the first Update   //
+// sees every point as changed                         //
+bool HorizonMapClass::InitializeMap( int pointsWide, int pointsHigh ) {
+	if( pointsWide < 2 || pointsHigh < 2 ) {
+		return false;
+	}
+
+	mPointsWide = pointsWide;
+	mPointsHigh = pointsHigh;
+	mPaddedWide = pointsWide + ( 2 * HORIZON_PADDING );
+
+	mHeights.assign( mPaddedWide * mPointsHigh, HORIZON_PAD_HEIGHT );
+	mRow.resize( mPointsWide );
+
+	for( int i = 0; i < HORIZON_AZIMUTHS / 4; i++ ) {
+		mHorizons[ i ].assign( mPointsWide * mPointsHigh * 4, 0 );
+	}
+
+	mDirtyRegion.minX = mDirtyRegion.minZ = 0;
+	mDirtyRegion.maxX = mDirtyRegion.maxZ = -1;
+	mLastTime  = 0.0f;
+	mLastCount = 0;
+
+	return true;
+}
+
+
+// Shutdown //
+void HorizonMapClass::Shutdown() {
+	// Release the shader resource view
+	if( pShaderResourceView ) {
+		pShaderResourceView->Release();
+		pShaderResourceView = 0;
+	}
+
+	// Release the texture
+	if( pTexture ) {
+		pTexture->Release();
+		pTexture = 0;
+	}
+
+	std::vector< float >().swap( mHeights );
+	std::vector< float >().swap( mRow );
+
+	for( int i = 0; i < HORIZON_AZIMUTHS / 4; i++ ) {
+		std::vector< unsigned char >().swap( mHorizons[ i ] );
+	}
+
+	mPointsWide = mPointsHigh = mPaddedWide = 0;
+
+	return;
+}
+
+
+// SetJobSystem //
+void HorizonMapClass::SetJobSystem( JobSystemClass* jobSystem ) {
+	pJobSystem = jobSystem;
+}
+
+
+// Update                                                    //
+// A point's horizon only reaches HORIZON_SEARCH_CELLS, so   //
+// the points to rebake are the changed heights grown by it  //
+int HorizonMapClass::Update( TerrainClass* terrain, int minX, int minZ, int maxX, int maxZ ) {
+	LARGE_INTEGER frequency, startTime, endTime;
+	RegionType changed;
+	float* heights;
+
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &startTime );
+
+	// Clamp to the grid
+	minX = ( minX < 0 ) ? 0 : minX;
+	minZ = ( minZ < 0 ) ? 0 : minZ;
+	maxX = ( maxX > mPointsWide - 1 ) ? mPointsWide - 1 : maxX;
+	maxZ = ( maxZ > mPointsHigh - 1 ) ? mPointsHigh - 1 : maxZ;
+
+	changed.minX = mPointsWide;
+	changed.minZ = mPointsHigh;
+	changed.maxX = changed.maxZ = -1;
+
+	// Copy the terrain's heights in, noting the ones that differ
+	for( int j = minZ; j <= maxZ; j++ ) {
+		terrain->GetHeights( minX, j, maxX, j, &mRow[ 0 ], mPointsWide );
+		heights = &mHeights[ ( mPaddedWide * j ) + HORIZON_PADDING ];
+
+		for( int i = minX; i <= maxX; i++ ) {
+			if( heights[ i ] != mRow[ i - minX ] ) {
+				heights[ i ] = mRow[ i - minX ];
+
+				changed.minX = ( i < changed.minX ) ? i : changed.minX;
+				changed.minZ = ( j < changed.minZ ) ? j : changed.minZ;
+				changed.maxX = ( i > changed.maxX ) ? i : changed.maxX;
+				changed.maxZ = ( j > changed.maxZ ) ? j : changed.maxZ;
+			}
+		}
+	}
+
+	mLastCount = 0;
+
+	if( changed.maxX >= changed.minX ) {
+		changed.minX = ( changed.minX - HORIZON_SEARCH_CELLS < 0 ) ? 0 : changed.minX - HORIZON_SEARCH_CELLS;
+		changed.minZ = ( changed.minZ - HORIZON_SEARCH_CELLS < 0 ) ? 0 : changed.minZ - HORIZON_SEARCH_CELLS;
+		changed.maxX = ( changed.maxX + HORIZON_SEARCH_CELLS > mPointsWide - 1 ) ? mPointsWide - 1 : changed.maxX + HORIZON_SEARCH_CELLS;
+		changed.maxZ = ( changed.maxZ + HORIZON_SEARCH_CELLS > mPointsHigh - 1 ) ? mPointsHigh - 1 : changed.maxZ + HORIZON_SEARCH_CELLS;
+
+		Bake( changed );
+
+		mLastCount = ( changed.maxX - changed.minX + 1 ) * ( changed.maxZ - changed.minZ + 1 );
+	}
+
+	QueryPerformanceCounter( &endTime );
+	mLastTime = ( float )( ( double )( endTime.QuadPart - startTime.QuadPart ) * 1000.0 / ( double )frequency.QuadPart );
+
+	return mLastCount;
+}
+
+
+// Upload                                               //
+// Only the rebaked rectangle of each slice is copied  //
+void HorizonMapClass::Upload( ID3D11DeviceContext* deviceContext ) {
+	D3D11_BOX box;
+
+	if( !pTexture || mDirtyRegion.maxX < mDirtyRegion.minX ) {
+		return;
+	}
+
+	box.left   = mDirtyRegion.minX;
+	box.right  = mDirtyRegion.maxX + 1;
+	box.top    = mDirtyRegion.minZ;
+	box.bottom = mDirtyRegion.maxZ + 1;
+	box.front  = 0;
+	box.back   = 1;
+
+	for( int slice = 0; slice < HORIZON_AZIMUTHS / 4; slice++ ) {
+		deviceContext->UpdateSubresource( pTexture,
+			                              D3D11CalcSubresource( 0, slice, 1 ),
+										  &box,
+										  &mHorizons[ slice ][ ( ( mPointsWide * mDirtyRegion.minZ ) + mDirtyRegion.minX ) * 4 ],
+										  mPointsWide * 4,
+										  0 );
+	}
+
+	mDirtyRegion.minX = mDirtyRegion.minZ = 0;
+	mDirtyRegion.maxX = mDirtyRegion.maxZ = -1;
+
+	return;
+}
+
+
+// GetShaderResourceView //
+ID3D11ShaderResourceView* HorizonMapClass::GetShaderResourceView() {
+	return pShaderResourceView;
+}
+
+
+// GetHorizon //
+unsigned char HorizonMapClass::GetHorizon( int x, int z, int azimuth ) {
+	return mHorizons[ azimuth / 4 ][ ( ( ( mPointsWide * z ) + x ) * 4 ) + ( azimuth % 4 ) ];
+}
+
+
+// GetLastTime                     //
+// Milliseconds of the last Update //
+float HorizonMapClass::GetLastTime() {
+	return mLastTime;
+}
+
+
+// GetLastCount                    //
+// Points baked by the last Update //
+int HorizonMapClass::GetLastCount() {
+	return mLastCount;
+}
+
+
+// Bake                                            //
+// Rebakes the points' rows on the job system and  //
+// grows the rectangle waiting to be uploaded      //
+void HorizonMapClass::Bake( const RegionType& points ) {
+	mBakeRegion = points;
+
+	if( pJobSystem ) {
+		pJobSystem->ParallelFor( points.minZ, points.maxZ + 1, HORIZON_JOB_ROWS, BakeRows, this );
+	} else {
+		BakeRows( this, points.minZ, points.maxZ + 1, 0 );
+	}
+
+	if( mDirtyRegion.maxX < mDirtyRegion.minX ) {
+		mDirtyRegion = points;
+	} else {
+		mDirtyRegion.minX = ( points.minX < mDirtyRegion.minX ) ? points.minX : mDirtyRegion.minX;
+		mDirtyRegion.minZ = ( points.minZ < mDirtyRegion.minZ ) ? points.minZ : mDirtyRegion.minZ;
+		mDirtyRegion.maxX = ( points.maxX > mDirtyRegion.maxX ) ? points.maxX : mDirtyRegion.maxX;
+		mDirtyRegion.maxZ = ( points.maxZ > mDirtyRegion.maxZ ) ? points.maxZ : mDirtyRegion.maxZ;
+	}
+
+	return;
+}
+
+
+// BakeRows                                                  //
+// Four points of a row at a time - along each azimuth the   //
+// steepest rise (height over distance) to the points at     //
+// HORIZON_STEPS is kept, then stored as the sine of its     //
+// angle. Steps are whole grid points so the four loads are  //
+// one unaligned read, and the padding columns mean the row  //
+// ends need no special case. Steps off the top or bottom    //
+// row are skipped                                           //
+void HorizonMapClass::BakeRows( void* data, int startRow, int endRow, int threadIndex ) {
+	HorizonMapClass* map = ( HorizonMapClass* )data;
+	__m128 centre, sample, slope, steepest, distanceScale, sine;
+	__m128 one   = _mm_set1_ps( 1.0f );
+	__m128 scale = _mm_set1_ps( 255.0f );
+	__m128 half  = _mm_set1_ps( 0.5f );
+	int encoded[ 4 ];
+	const float* row;
+	const float* sampleRow;
+	unsigned char* horizons;
+	float length;
+	int sampleZ, count, channel;
+
+	for( int j = startRow; j < endRow; j++ ) {
+		row = &map->mHeights[ ( map->mPaddedWide * j ) + HORIZON_PADDING ];
+
+		for( int i = map->mBakeRegion.minX; i <= map->mBakeRegion.maxX; i += 4 ) {
+			centre = _mm_loadu_ps( &row[ i ] );
+			count  = ( map->mBakeRegion.maxX - i + 1 < 4 ) ? map->mBakeRegion.maxX - i + 1 : 4;
+
+			for( int azimuth = 0; azimuth < HORIZON_AZIMUTHS; azimuth++ ) {
+				length   = sqrtf( ( float )( ( HORIZON_DIRECTION_X[ azimuth ] * HORIZON_DIRECTION_X[ azimuth ] ) + ( HORIZON_DIRECTION_Z[ azimuth ] * HORIZON_DIRECTION_Z[ azimuth ] ) ) );
+				steepest = _mm_setzero_ps();
+
+				for( int step = 0; step < HORIZON_STEP_COUNT; step++ ) {
+					sampleZ = j + ( HORIZON_STEPS[ step ] * HORIZON_DIRECTION_Z[ azimuth ] );
+					if( sampleZ < 0 || sampleZ >= map->mPointsHigh ) {
+						break;
+					}
+
+					sampleRow = &map->mHeights[ ( map->mPaddedWide * sampleZ ) + HORIZON_PADDING ];
+					sample    = _mm_loadu_ps( &sampleRow[ i + ( HORIZON_STEPS[ step ] * HORIZON_DIRECTION_X[ azimuth ] ) ] );
+
+					distanceScale = _mm_set1_ps( 1.0f / ( ( float )HORIZON_STEPS[ step ] * length ) );
+					slope    = _mm_mul_ps( _mm_sub_ps( sample, centre ), distanceScale );
+					steepest = _mm_max_ps( steepest, slope );
+				}
+
+				// sin( atan( slope ) ) = slope / sqrt( 1 + slope^2 )
+				sine = _mm_div_ps( steepest, _mm_sqrt_ps( _mm_add_ps( one, _mm_mul_ps( steepest, steepest ) ) ) );
+				_mm_storeu_si128( ( __m128i* )encoded, _mm_cvttps_epi32( _mm_add_ps( _mm_mul_ps( sine, scale ), half ) ) );
+
+				horizons = &map->mHorizons[ azimuth / 4 ][ ( ( map->mPointsWide * j ) + i ) * 4 ];
+				channel  = azimuth % 4;
+
+				for( int k = 0; k < count; k++ ) {
+					horizons[ ( k * 4 ) + channel ] = ( unsigned char )encoded[ k ];
+				}
+			}
+		}
+	}
+
+	return;
+}
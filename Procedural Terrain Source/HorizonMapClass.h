@@ -0,0 +1,111 @@
+#ifndef _HORIZONMAPCLASS_H_
+#define _HORIZONMAPCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#include <math.h>
+#include <vector>
+
+
+// Application Includes //
+#include "JobSystemClass.h"
+#include "TerrainClass.h"
+
+
+// Horizon Map Variables
+const int   HORIZON_AZIMUTHS     = 8;  // grid directions 45 degrees apart, two RGBA slices
+const int   HORIZON_SEARCH_CELLS = 64; // furthest point that can raise a horizon
+const int   HORIZON_STEP_COUNT   = 12;
+const int   HORIZON_STEPS[ HORIZON_STEP_COUNT ] = { 1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 48, 64 }; // cells along each azimuth
+const int   HORIZON_JOB_ROWS     = 8;
+const int   HORIZON_PADDING      = HORIZON_SEARCH_CELLS + 4; // columns either side - the last group of four reads past the edge
+const float HORIZON_PAD_HEIGHT   = -1.0e6f; // off the terrain - never raises a horizon
+
+// Slot - must match the register() in Terrain.ps
+const int HORIZON_MAP_TEXTURE_SLOT = 9;
+
+
+// HorizonMapClass                                                       //
+// Baked terrain self shadowing and ambient occlusion - for each grid    //
+// point the sine of the horizon's elevation along eight azimuths, so    //
+// Terrain.ps can compare the sun's elevation against it (soft shadows   //
+// from two samples) and use the open sky as ambient occlusion. Only     //
+// the heights are needed so the bake runs on the CPU: four points of a  //
+// row at once with SSE, rows shared out on the job system               //
+// The heights last baked are kept - Update only rebakes the points      //
+// within HORIZON_SEARCH_CELLS of heights that actually changed          //
+class HorizonMapClass {
+private:
+	// Rectangle of grid points (inclusive)
+	struct RegionType {
+		int minX, minZ, maxX, maxZ;
+	};
+
+public:
+	HorizonMapClass();
+	HorizonMapClass( const HorizonMapClass& other );
+	~HorizonMapClass();
+
+	// pointsWide / pointsHigh are the terrain's grid points
+	bool Initialize( ID3D11Device* device, int pointsWide, int pointsHigh );
+
+	// CPU half of Initialize - no texture, so tools can time the bake
+	bool InitializeMap( int pointsWide, int pointsHigh );
+
+	void Shutdown();
+
+	// Job system for the bake - NULL runs it serially
+	// The job system is not owned
+	void SetJobSystem( JobSystemClass* jobSystem );
+
+	// Update                                                    //
+	// Reads the terrain's heights for the points minX - maxX,   //
+	// minZ - maxZ and rebakes around the ones that changed -    //
+	// returns the number of points baked (0 if none changed)    //
+	int Update( TerrainClass* terrain, int minX, int minZ, int maxX, int maxZ );
+
+	// Copies the rebaked points to the texture - once a frame before drawing
+	void Upload( ID3D11DeviceContext* deviceContext );
+
+	ID3D11ShaderResourceView* GetShaderResourceView();
+
+	// Horizon of a point - sine of the elevation, 0 - 255
+	unsigned char GetHorizon( int x, int z, int azimuth );
+
+	// Last bake
+	float GetLastTime();
+	int GetLastCount();
+
+private:
+	void Bake( const RegionType& points );
+	static void BakeRows( void* data, int startRow, int endRow, int threadIndex );
+
+private:
+	// Texture - slice 0 holds azimuths 0 - 3, slice 1 azimuths 4 - 7
+	ID3D11Texture2D*          pTexture;
+	ID3D11ShaderResourceView* pShaderResourceView;
+	JobSystemClass*           pJobSystem;
+
+	int mPointsWide, mPointsHigh;
+	int mPaddedWide;
+
+	// Heights last baked, HORIZON_PADDING columns either side of each row
+	std::vector< float > mHeights;
+	std::vector< float > mRow;
+
+	// RGBA8 texels of each slice
+	std::vector< unsigned char > mHorizons[ HORIZON_AZIMUTHS / 4 ];
+
+	// Points being baked, and the points not yet uploaded (empty when max < min)
+	RegionType mBakeRegion;
+	RegionType mDirtyRegion;
+
+	float mLastTime;
+	int mLastCount;
+};
+
+
+#endif
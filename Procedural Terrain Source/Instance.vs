@@ -0,0 +1,54 @@
+// Per-Pass Data - buffer 1
+cbuffer PerPassBuffer : register(b1) {
+	matrix viewMatrix;
+	matrix projectionMatrix;
+	matrix reflectionMatrix;
+	float4 clipPlane;
+};
+
+// Vertex Data - slot 0 mesh, slot 1 per-instance world matrix
+struct VertexInputType {
+    float4 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+	float4 world0 : INSTANCEWORLD0;
+	float4 world1 : INSTANCEWORLD1;
+	float4 world2 : INSTANCEWORLD2;
+	float4 world3 : INSTANCEWORLD3;
+};
+
+// Pixel Data
+struct PixelInputType {
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+	float3 position3D : TEXCOORD1;
+};
+
+// InstanceVS
+PixelInputType InstanceVertexShader( VertexInputType input ) {
+    PixelInputType output;
+	float4x4 worldMatrix;
+
+	// Rebuild the instance world matrix from its rows
+	worldMatrix = float4x4( input.world0, input.world1, input.world2, input.world3 );
+
+    // Change the position vector to be 4 units for proper matrix calculations
+    input.position.w = 1.0f;
+
+	// 3D position of the vertex
+	output.position3D = mul( input.position, worldMatrix ).xyz;
+
+    // Calculate the position of the vertex against the view and projection matrices
+    output.position = mul( float4( output.position3D, 1.0f ), viewMatrix );
+    output.position = mul( output.position, projectionMatrix );
+
+    // Store the texture coordinates for the pixel shader
+    output.tex = input.tex;
+
+    // Calculate the normal vector against the world matrix only (uniform scale)
+	output.normal = mul( input.normal, ( float3x3 )worldMatrix );
+	output.normal = normalize( output.normal );
+
+    return output;
+}
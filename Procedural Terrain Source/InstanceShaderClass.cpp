@@ -0,0 +1,288 @@
+#include "InstanceShaderClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+InstanceShaderClass::InstanceShaderClass()
+: pVertexShader( 0 ), pPixelShader( 0 ), pLayout( 0 ), pSampleState( 0 ) {
+}
+
+
+// Constructor //
+InstanceShaderClass::InstanceShaderClass( const InstanceShaderClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+InstanceShaderClass::~InstanceShaderClass() {
+}
+
+
+// Initialize //
+bool InstanceShaderClass::Initialize( ID3D11Device* device, HWND hwnd ) {
+	bool result;
+
+	// Initialize the vertex and pixel shaders
+	result = InitializeShader( device, hwnd, L"Instance.vs", L"Instance.ps" );
+	if( !result ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// Shutdown //
+void InstanceShaderClass::Shutdown() {
+	// Shutdown the vertex and pixel shaders as well as the related objects
+	ShutdownShader();
+
+	return;
+}
+
+
+// Render                                           //
+// Per-frame / per-pass buffers must be committed   //
+bool InstanceShaderClass::Render( ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount, ID3D11ShaderResourceView* texture ) {
+	bool result;
+
+	// Set the shader parameters that it will use for rendering
+	result = SetShaderParameters( deviceContext, texture );
+	if( !result ) {
+		return false;
+	}
+
+	// Now render the prepared buffers with the shader
+	RenderShader( deviceContext, indexCount, instanceCount );
+
+	return true;
+}
+
+
+// InitializeShader                                  //
+// Mesh data is per-vertex in slot 0, the world      //
+// matrix rows are per-instance data in slot 1       //
+bool InstanceShaderClass::InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename ) {
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* vertexShaderBuffer;
+	ID3D10Blob* pixelShaderBuffer;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[ 7 ];
+	unsigned int numElements;
+	D3D11_SAMPLER_DESC samplerDesc;
+
+	// Initialize the pointers this function will use to null
+	errorMessage       = 0;
+	vertexShaderBuffer = 0;
+	pixelShaderBuffer  = 0;
+
+	// Load the vertex shader code (compiled on a cache miss)
+	if( !ShaderCacheClass::LoadShader( vsFilename, "InstanceVertexShader", "vs_5_0", NULL, &vertexShaderBuffer, &errorMessage ) ) {
+		// If the shader failed to compile it should have writen something to the error message
+		if( errorMessage ) {
+			OutputShaderErrorMessage( errorMessage, hwnd, vsFilename );
+		// If there was nothing in the error message then it simply could not find the shader file itself
+		} else {
+			MessageBox( hwnd, vsFilename, L"Missing Shader File", MB_OK );
+		}
+
+		return false;
+	}
+
+	// Load the pixel shader code (compiled on a cache miss)
+	if( !ShaderCacheClass::LoadShader( psFilename, "InstancePixelShader", "ps_5_0", NULL, &pixelShaderBuffer, &errorMessage ) ) {
+		// If the shader failed to compile it should have writen something to the error message
+		if( errorMessage ) {
+			OutputShaderErrorMessage( errorMessage, hwnd, psFilename );
+		// If there was nothing in the error message then it simply could not find the file itself
+		} else {
+			MessageBox( hwnd, psFilename, L"Missing Shader File", MB_OK );
+		}
+
+		return false;
+	}
+
+	// Create the vertex shader from the buffer
+	result = device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &pVertexShader );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Create the pixel shader from the buffer
+	result = device->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pPixelShader );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Create the vertex input layout description
+	// Slot 0 matches the start of the ModelClass vertex
+	polygonLayout[ 0 ].SemanticName         = "POSITION";
+	polygonLayout[ 0 ].SemanticIndex        = 0;
+	polygonLayout[ 0 ].Format               = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[ 0 ].InputSlot            = 0;
+	polygonLayout[ 0 ].AlignedByteOffset    = 0;
+	polygonLayout[ 0 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 0 ].InstanceDataStepRate = 0;
+
+	polygonLayout[ 1 ].SemanticName         = "TEXCOORD";
+	polygonLayout[ 1 ].SemanticIndex        = 0;
+	polygonLayout[ 1 ].Format               = DXGI_FORMAT_R32G32_FLOAT;
+	polygonLayout[ 1 ].InputSlot            = 0;
+	polygonLayout[ 1 ].AlignedByteOffset    = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[ 1 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 1 ].InstanceDataStepRate = 0;
+
+	polygonLayout[ 2 ].SemanticName         = "NORMAL";
+	polygonLayout[ 2 ].SemanticIndex        = 0;
+	polygonLayout[ 2 ].Format               = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[ 2 ].InputSlot            = 0;
+	polygonLayout[ 2 ].AlignedByteOffset    = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[ 2 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 2 ].InstanceDataStepRate = 0;
+
+	// Slot 1 - one world matrix row per element, stepped once per instance
+	for( int i = 0; i < 4; i++ ) {
+		polygonLayout[ 3 + i ].SemanticName         = "INSTANCEWORLD";
+		polygonLayout[ 3 + i ].SemanticIndex        = i;
+		polygonLayout[ 3 + i ].Format               = DXGI_FORMAT_R32G32B32A32_FLOAT;
+		polygonLayout[ 3 + i ].InputSlot            = 1;
+		polygonLayout[ 3 + i ].AlignedByteOffset    = ( i == 0 ) ? 0 : D3D11_APPEND_ALIGNED_ELEMENT;
+		polygonLayout[ 3 + i ].InputSlotClass       = D3D11_INPUT_PER_INSTANCE_DATA;
+		polygonLayout[ 3 + i ].InstanceDataStepRate = 1;
+	}
+
+	// Get a count of the elements in the layout
+    numElements = sizeof( polygonLayout ) / sizeof( polygonLayout[ 0 ] );
+
+	// Create the vertex input layout
+	result = device->CreateInputLayout( polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &pLayout );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Release the vertex shader buffer and pixel shader buffer since they are no longer needed
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
+	pixelShaderBuffer->Release();
+	pixelShaderBuffer = 0;
+
+	// Create a texture sampler state description
+    samplerDesc.Filter         = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressV       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressW       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.MipLODBias     = 0.0f;
+    samplerDesc.MaxAnisotropy  = 1;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+    samplerDesc.BorderColor[0] = 0;
+	samplerDesc.BorderColor[1] = 0;
+	samplerDesc.BorderColor[2] = 0;
+	samplerDesc.BorderColor[3] = 0;
+    samplerDesc.MinLOD         = 0;
+    samplerDesc.MaxLOD         = D3D11_FLOAT32_MAX;
+
+	// Create the texture sampler state
+    result = device->CreateSamplerState( &samplerDesc, &pSampleState );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// ShutdownShader //
+void InstanceShaderClass::ShutdownShader() {
+	// Release the sampler state
+	if( pSampleState ) {
+		pSampleState->Release();
+		pSampleState = 0;
+	}
+
+	// Release the layout
+	if( pLayout ) {
+		pLayout->Release();
+		pLayout = 0;
+	}
+
+	// Release the pixel shader
+	if( pPixelShader ) {
+		pPixelShader->Release();
+		pPixelShader = 0;
+	}
+
+	// Release the vertex shader
+	if( pVertexShader ) {
+		pVertexShader->Release();
+		pVertexShader = 0;
+	}
+
+	return;
+}
+
+
+// OutputShaderErrorMessage                   //
+// Writes compiler output to shader-error.txt //
+void InstanceShaderClass::OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename ) {
+	char* compileErrors;
+	unsigned long bufferSize, i;
+	ofstream fout;
+
+	// Get a pointer to the error message text buffer
+	compileErrors = ( char* )( errorMessage->GetBufferPointer() );
+
+	// Get the length of the message
+	bufferSize = errorMessage->GetBufferSize();
+
+	// Open a file to write the error message to
+	fout.open( "shader-error.txt" );
+
+	// Write out the error message
+	for( i = 0; i < bufferSize; i++ ) {
+		fout << compileErrors[ i ];
+	}
+
+	// Close the file
+	fout.close();
+
+	// Release the error message
+	errorMessage->Release();
+	errorMessage = 0;
+
+	// Pop a message up on the screen to notify the user to check the text file for compile errors
+	MessageBox( hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK );
+
+	return;
+}
+
+
+// SetShaderParameters                              //
+// Only the texture - constants are shared buffers  //
+bool InstanceShaderClass::SetShaderParameters( ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* texture ) {
+	// Set shader texture resource in the pixel shader
+	deviceContext->PSSetShaderResources( 0, 1, &texture );
+
+	return true;
+}
+
+
+// RenderShader                            //
+// One draw call for all visible instances //
+void InstanceShaderClass::RenderShader( ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount ) {
+	// Set the vertex input layout
+	deviceContext->IASetInputLayout( pLayout );
+
+	// Set the vertex and pixel shaders that will be used to render
+	deviceContext->VSSetShader( pVertexShader, NULL, 0 );
+	deviceContext->PSSetShader( pPixelShader, NULL, 0 );
+
+	// Set the sampler state in the pixel shader
+	deviceContext->PSSetSamplers( 0, 1, &pSampleState );
+
+	// Render the instances
+	deviceContext->DrawIndexedInstanced( indexCount, instanceCount, 0, 0, 0 );
+
+	return;
+}
@@ -0,0 +1,47 @@
+#ifndef _INSTANCESHADERCLASS_H_
+#define _INSTANCESHADERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <fstream>
+using namespace std;
+
+
+// Application Includes //
+#include "ShaderCacheClass.h"
+
+
+// InstanceShaderClass                                               //
+// Lit, textured shader for InstancedModelClass                      //
+// Matrices and light come from the shared per-frame / per-pass      //
+// constant buffers (ConstantBufferManagerClass) - commit them first //
+// The world matrix is per-instance vertex data in slot 1            //
+class InstanceShaderClass {
+public:
+	InstanceShaderClass();
+	InstanceShaderClass( const InstanceShaderClass& other );
+	~InstanceShaderClass();
+
+	bool Initialize( ID3D11Device* device, HWND hwnd );
+	void Shutdown();
+	bool Render( ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount, ID3D11ShaderResourceView* texture );
+
+private:
+	bool InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename );
+	void ShutdownShader();
+	void OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename );
+
+	bool SetShaderParameters( ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* texture );
+	void RenderShader( ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount );
+
+private:
+	ID3D11VertexShader* pVertexShader;
+	ID3D11PixelShader*  pPixelShader;
+	ID3D11InputLayout*  pLayout;
+	ID3D11SamplerState* pSampleState;
+};
+
+
+#endif
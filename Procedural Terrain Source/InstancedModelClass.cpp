@@ -0,0 +1,180 @@
+#include "InstancedModelClass.h"
+
+
+// Default Constructor //
+InstancedModelClass::InstancedModelClass()
+: pInstanceBuffer( 0 ), mMaxInstances( 0 ), mVisibleCount( 0 ) {
+}
+
+
+// Constructor //
+InstancedModelClass::InstancedModelClass( const InstancedModelClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+InstancedModelClass::~InstancedModelClass() {
+}
+
+
+// Initialize                                         //
+// Creates a dynamic instance buffer for maxInstances //
+bool InstancedModelClass::Initialize( ID3D11Device* device, int maxInstances ) {
+	D3D11_BUFFER_DESC instanceBufferDesc;
+	HRESULT result;
+
+	mMaxInstances = maxInstances;
+
+	// Set up the description of the dynamic instance buffer
+	instanceBufferDesc.Usage               = D3D11_USAGE_DYNAMIC;
+	instanceBufferDesc.ByteWidth           = sizeof( InstanceBufferType ) * mMaxInstances;
+	instanceBufferDesc.BindFlags           = D3D11_BIND_VERTEX_BUFFER;
+	instanceBufferDesc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+	instanceBufferDesc.MiscFlags           = 0;
+	instanceBufferDesc.StructureByteStride = 0;
+
+	// Create the instance buffer
+	result = device->CreateBuffer( &instanceBufferDesc, NULL, &pInstanceBuffer );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	mInstances.reserve( mMaxInstances );
+	mBounds.reserve( mMaxInstances );
+
+	return true;
+}
+
+
+// Shutdown //
+void InstancedModelClass::Shutdown() {
+	// Release the instance buffer
+	if( pInstanceBuffer ) {
+		pInstanceBuffer->Release();
+		pInstanceBuffer = 0;
+	}
+
+	mInstances.clear();
+	mBounds.clear();
+
+	return;
+}
+
+
+// SetInstances                                      //
+// Builds scale * rotate * translate for each one    //
+// Anything past mMaxInstances is dropped            //
+void InstancedModelClass::SetInstances( const std::vector< ScatterClass::ScatterInstanceType >& instances ) {
+	D3DXMATRIX scaleMatrix, rotateMatrix, translateMatrix;
+	InstanceBufferType instance;
+	InstanceBoundsType bounds;
+	int count;
+
+	mInstances.clear();
+	mBounds.clear();
+	mVisibleCount = 0;
+
+	count = ( int )instances.size();
+	if( count > mMaxInstances ) {
+		count = mMaxInstances;
+	}
+
+	for( int i = 0; i < count; i++ ) {
+		const ScatterClass::ScatterInstanceType& scatter = instances[ i ];
+
+		D3DXMatrixScaling( &scaleMatrix, scatter.scale, scatter.scale, scatter.scale );
+		D3DXMatrixRotationY( &rotateMatrix, scatter.rotation );
+		D3DXMatrixTranslation( &translateMatrix, scatter.position.x, scatter.position.y, scatter.position.z );
+
+		// Row vectors - matches mul( position, world ) in Instance.vs
+		instance.world = scaleMatrix * rotateMatrix * translateMatrix;
+		mInstances.push_back( instance );
+
+		bounds.center = scatter.position;
+		bounds.radius = scatter.radius;
+		mBounds.push_back( bounds );
+	}
+
+	return;
+}
+
+
+// Cull                                                //
+// Writes the visible instances to the buffer in one  //
+// WRITE_DISCARD map - nothing is drawn if none pass  //
+bool InstancedModelClass::Cull( ID3D11DeviceContext* deviceContext, FrustumClass* frustum ) {
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	InstanceBufferType* dataPtr;
+	HRESULT result;
+	int count;
+
+	mVisibleCount = 0;
+
+	count = ( int )mInstances.size();
+	if( count == 0 ) {
+		return true;
+	}
+
+	// Lock the instance buffer so it can be written to
+	result = deviceContext->Map( pInstanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	dataPtr = ( InstanceBufferType* )mappedResource.pData;
+
+	// Copy only the transforms that survive the frustum test
+	for( int i = 0; i < count; i++ ) {
+		if( frustum->CheckSphere( mBounds[ i ].center.x, mBounds[ i ].center.y, mBounds[ i ].center.z, mBounds[ i ].radius ) ) {
+			dataPtr[ mVisibleCount ] = mInstances[ i ];
+			mVisibleCount++;
+		}
+	}
+
+	// Unlock the instance buffer
+	deviceContext->Unmap( pInstanceBuffer, 0 );
+
+	return true;
+}
+
+
+// Render                                         //
+// ModelClass sets slot 0, index buffer and       //
+// topology - the transforms are added in slot 1  //
+void InstancedModelClass::Render( ID3D11DeviceContext* deviceContext, ModelClass* model ) {
+	unsigned int stride;
+	unsigned int offset;
+
+	// Put the model vertex and index buffers on the graphics pipeline
+	model->Render( deviceContext );
+
+	// Set the instance buffer stride and offset
+	stride = sizeof( InstanceBufferType ); 
+	offset = 0;
+
+	// Set the instance buffer to active in the input assembler so it can be rendered
+	deviceContext->IASetVertexBuffers( 1, 1, &pInstanceBuffer, &stride, &offset );
+
+	return;
+}
+
+
+// GetMaxInstances //
+int InstancedModelClass::GetMaxInstances() {
+	return mMaxInstances;
+}
+
+
+// GetInstanceCount                   //
+// Total instances before culling     //
+int InstancedModelClass::GetInstanceCount() {
+	return ( int )mInstances.size();
+}
+
+
+// GetVisibleCount                    //
+// Instances written by the last Cull //
+int InstancedModelClass::GetVisibleCount() {
+	return mVisibleCount;
+}
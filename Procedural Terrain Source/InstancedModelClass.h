@@ -0,0 +1,69 @@
+#ifndef _INSTANCEDMODELCLASS_H_
+#define _INSTANCEDMODELCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <vector>
+
+
+// Application Includes //
+#include "ModelClass.h"
+#include "FrustumClass.h"
+#include "ScatterClass.h"
+
+
+// InstancedModelClass                                                   //
+// Draws many copies of one ModelClass mesh with a single               //
+// DrawIndexedInstanced call                                             //
+// World matrices are built once when the instances are set - each      //
+// frame Cull tests every bounding sphere against the frustum and       //
+// writes only the visible matrices into the dynamic instance buffer    //
+// The mesh is bound to slot 0 by ModelClass, transforms go in slot 1   //
+class InstancedModelClass {
+private:
+	// Per-instance vertex data (slot 1)
+	struct InstanceBufferType {
+		D3DXMATRIX world;
+	};
+
+	// CPU side bounds for culling
+	struct InstanceBoundsType {
+		D3DXVECTOR3 center;
+		float radius;
+	};
+
+public:
+	InstancedModelClass();
+	InstancedModelClass( const InstancedModelClass& other );
+	~InstancedModelClass();
+
+	bool Initialize( ID3D11Device* device, int maxInstances );
+	void Shutdown();
+
+	// Replaces the instance list (after scattering or regenerating terrain)
+	void SetInstances( const std::vector< ScatterClass::ScatterInstanceType >& instances );
+
+	// Frustum test then upload of the visible transforms
+	bool Cull( ID3D11DeviceContext* deviceContext, FrustumClass* frustum );
+
+	// Binds the model and instance buffers
+	void Render( ID3D11DeviceContext* deviceContext, ModelClass* model );
+
+	int GetMaxInstances();
+	int GetInstanceCount();
+	int GetVisibleCount();
+
+private:
+	ID3D11Buffer* pInstanceBuffer;
+
+	std::vector< InstanceBufferType > mInstances;
+	std::vector< InstanceBoundsType > mBounds;
+
+	int mMaxInstances;
+	int mVisibleCount;
+};
+
+
+#endif
@@ -0,0 +1,266 @@
+#include "JobSystemClass.h"
+
+
+// Default Constructor //
+JobSystemClass::JobSystemClass()
+: mThreadCount( 0 ), mQuit( false ), pFunction( 0 ), pData( 0 ), mGrainRows( 1 ), mRemainingRows( 0 ) {
+	memset( mWorkers, 0, sizeof( mWorkers ) );
+}
+
+
+// Constructor //
+JobSystemClass::JobSystemClass( const JobSystemClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+JobSystemClass::~JobSystemClass() {
+}
+
+
+// Initialize                                  //
+// Sets up a deque per thread and starts the   //
+// workers - they sleep on their start event   //
+// between loops                               //
+bool JobSystemClass::Initialize( int threadCount ) {
+	SYSTEM_INFO systemInfo;
+
+	// One thread per core, the calling thread works too
+	if( threadCount <= 0 ) {
+		GetSystemInfo( &systemInfo );
+		threadCount = ( int )systemInfo.dwNumberOfProcessors;
+	}
+
+	if( threadCount > JOB_MAX_THREADS ) {
+		threadCount = JOB_MAX_THREADS;
+	}
+
+	mQuit = false;
+	mThreadCount = threadCount;
+
+	for( int i = 0; i < mThreadCount; i++ ) {
+		InitializeCriticalSection( &mDeques[ i ].lock );
+		mDeques[ i ].top = mDeques[ i ].bottom = 0;
+
+		mWorkers[ i ].pOwner      = this;
+		mWorkers[ i ].threadIndex = i;
+	}
+
+	// Thread 0 is the caller
+	for( int i = 1; i < mThreadCount; i++ ) {
+		mWorkers[ i ].startEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
+		mWorkers[ i ].doneEvent  = CreateEvent( NULL, FALSE, FALSE, NULL );
+		if( !mWorkers[ i ].startEvent || !mWorkers[ i ].doneEvent ) {
+			return false;
+		}
+
+		mWorkers[ i ].thread = CreateThread( NULL, 0, WorkerThread, &mWorkers[ i ], 0, NULL );
+		if( !mWorkers[ i ].thread ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+// Shutdown                        //
+// Wakes each worker to let it exit //
+void JobSystemClass::Shutdown() {
+	mQuit = true;
+
+	for( int i = 0; i < JOB_MAX_THREADS; i++ ) {
+		if( mWorkers[ i ].thread ) {
+			SetEvent( mWorkers[ i ].startEvent );
+			WaitForSingleObject( mWorkers[ i ].thread, INFINITE );
+			CloseHandle( mWorkers[ i ].thread );
+			mWorkers[ i ].thread = 0;
+		}
+
+		if( mWorkers[ i ].startEvent ) {
+			CloseHandle( mWorkers[ i ].startEvent );
+			mWorkers[ i ].startEvent = 0;
+		}
+
+		if( mWorkers[ i ].doneEvent ) {
+			CloseHandle( mWorkers[ i ].doneEvent );
+			mWorkers[ i ].doneEvent = 0;
+		}
+	}
+
+	for( int i = 0; i < mThreadCount; i++ ) {
+		DeleteCriticalSection( &mDeques[ i ].lock );
+	}
+
+	mThreadCount = 0;
+
+	return;
+}
+
+
+// GetThreadCount                    //
+// Workers plus the calling thread   //
+int JobSystemClass::GetThreadCount() {
+	return ( mThreadCount > 0 ) ? mThreadCount : 1;
+}
+
+
+// ParallelFor                                        //
+// Small loops (or no workers) run on the caller      //
+void JobSystemClass::ParallelFor( int startRow, int endRow, int grainRows, RangeFunction function, void* data ) {
+	HANDLE doneEvents[ JOB_MAX_THREADS ];
+	RangeType range;
+
+	if( endRow <= startRow ) {
+		return;
+	}
+
+	if( grainRows < 1 ) {
+		grainRows = 1;
+	}
+
+	if( mThreadCount <= 1 || ( endRow - startRow ) <= grainRows ) {
+		function( data, startRow, endRow, 0 );
+		return;
+	}
+
+	// Every deque is empty between loops
+	for( int i = 0; i < mThreadCount; i++ ) {
+		mDeques[ i ].top = mDeques[ i ].bottom = 0;
+	}
+
+	pFunction      = function;
+	pData          = data;
+	mGrainRows     = grainRows;
+	mRemainingRows = endRow - startRow;
+
+	// The whole loop starts on the caller's deque
+	range.startRow = startRow;
+	range.endRow   = endRow;
+	PushRange( 0, range );
+
+	for( int i = 1; i < mThreadCount; i++ ) {
+		SetEvent( mWorkers[ i ].startEvent );
+		doneEvents[ i - 1 ] = mWorkers[ i ].doneEvent;
+	}
+
+	RunRanges( 0 );
+
+	// Workers may still be between their last range and their done event
+	WaitForMultipleObjects( mThreadCount - 1, doneEvents, TRUE, INFINITE );
+
+	return;
+}
+
+
+// RunRanges                                         //
+// Takes ranges until every row of the loop is done  //
+void JobSystemClass::RunRanges( int threadIndex ) {
+	RangeType range, upperHalf;
+
+	while( mRemainingRows > 0 ) {
+		if( !PopRange( threadIndex, range ) && !StealRange( threadIndex, range ) ) {
+			// Nothing left to take - the last ranges are still running
+			SwitchToThread();
+			continue;
+		}
+
+		// Split down to the grain, leaving the top halves to be stolen
+		while( ( range.endRow - range.startRow ) > mGrainRows ) {
+			upperHalf.startRow = ( range.startRow + range.endRow ) / 2;
+			upperHalf.endRow   = range.endRow;
+
+			// Full - just run the rest here
+			if( !PushRange( threadIndex, upperHalf ) ) {
+				break;
+			}
+
+			range.endRow = upperHalf.startRow;
+		}
+
+		pFunction( pData, range.startRow, range.endRow, threadIndex );
+
+		InterlockedExchangeAdd( &mRemainingRows, -( range.endRow - range.startRow ) );
+	}
+
+	return;
+}
+
+
+// PushRange                          //
+// Onto the bottom of our own deque   //
+bool JobSystemClass::PushRange( int threadIndex, const RangeType& range ) {
+	DequeType& deque = mDeques[ threadIndex ];
+	bool result = false;
+
+	EnterCriticalSection( &deque.lock );
+	if( ( deque.bottom - deque.top ) < JOB_DEQUE_SIZE ) {
+		deque.ranges[ deque.bottom % JOB_DEQUE_SIZE ] = range;
+		deque.bottom++;
+		result = true;
+	}
+	LeaveCriticalSection( &deque.lock );
+
+	return result;
+}
+
+
+// PopRange                                   //
+// Newest (smallest) range from our own deque //
+bool JobSystemClass::PopRange( int threadIndex, RangeType& range ) {
+	DequeType& deque = mDeques[ threadIndex ];
+	bool result = false;
+
+	EnterCriticalSection( &deque.lock );
+	if( deque.bottom > deque.top ) {
+		deque.bottom--;
+		range = deque.ranges[ deque.bottom % JOB_DEQUE_SIZE ];
+		result = true;
+	}
+	LeaveCriticalSection( &deque.lock );
+
+	return result;
+}
+
+
+// StealRange                                      //
+// Oldest (largest) range from the next thread on  //
+// that has one                                    //
+bool JobSystemClass::StealRange( int threadIndex, RangeType& range ) {
+	bool result = false;
+
+	for( int i = 1; i < mThreadCount && !result; i++ ) {
+		DequeType& deque = mDeques[ ( threadIndex + i ) % mThreadCount ];
+
+		EnterCriticalSection( &deque.lock );
+		if( deque.bottom > deque.top ) {
+			range = deque.ranges[ deque.top % JOB_DEQUE_SIZE ];
+			deque.top++;
+			result = true;
+		}
+		LeaveCriticalSection( &deque.lock );
+	}
+
+	return result;
+}
+
+
+// WorkerThread                 //
+// Sleeps until a loop starts   //
+DWORD WINAPI JobSystemClass::WorkerThread( LPVOID parameter ) {
+	WorkerType* worker = ( WorkerType* )parameter;
+
+	while( true ) {
+		WaitForSingleObject( worker->startEvent, INFINITE );
+		if( worker->pOwner->mQuit ) {
+			break;
+		}
+
+		worker->pOwner->RunRanges( worker->threadIndex );
+
+		SetEvent( worker->doneEvent );
+	}
+
+	return 0;
+}
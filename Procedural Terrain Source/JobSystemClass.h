@@ -0,0 +1,89 @@
+#ifndef _JOBSYSTEMCLASS_H_
+#define _JOBSYSTEMCLASS_H_
+
+
+// Includes //
+#include <windows.h>
+#include <string.h>
+
+
+// Job Variables
+const int JOB_MAX_THREADS = 16;
+const int JOB_DEQUE_SIZE  = 64; // ranges are halved as they are split so a deque only ever holds a few
+
+
+// JobSystemClass                                                          //
+// Small work-stealing pool for loops over rows                            //
+// ParallelFor puts the whole row range on the calling thread's deque -    //
+// whichever thread takes a range bigger than the grain splits it, pushes  //
+// the top half back and keeps going with the bottom half. Each thread     //
+// pops from the bottom of its own deque and, once that is empty, steals   //
+// from the top of the others (the largest ranges left)                    //
+// The caller works as thread 0 and one loop runs at a time               //
+class JobSystemClass {
+public:
+	// Loop body - threadIndex (0 to GetThreadCount() - 1) //
+	// lets the caller keep per-thread scratch buffers     //
+	typedef void ( *RangeFunction )( void* data, int startRow, int endRow, int threadIndex );
+
+private:
+	// Rows [startRow, endRow)
+	struct RangeType {
+		int startRow, endRow;
+	};
+
+	// Work-stealing deque - owner uses the bottom, thieves the top
+	struct DequeType {
+		CRITICAL_SECTION lock;
+		RangeType ranges[ JOB_DEQUE_SIZE ];
+		int top, bottom;
+	};
+
+	// Worker thread data
+	struct WorkerType {
+		JobSystemClass* pOwner;
+		int threadIndex;
+		HANDLE thread;
+		HANDLE startEvent;
+		HANDLE doneEvent;
+	};
+
+public:
+	JobSystemClass();
+	JobSystemClass( const JobSystemClass& other );
+	~JobSystemClass();
+
+	// threadCount 0 uses one thread per core (the caller counts as one)
+	bool Initialize( int threadCount );
+	void Shutdown();
+
+	int GetThreadCount();
+
+	// ParallelFor                                              //
+	// Calls function over [startRow, endRow) in ranges of      //
+	// at most grainRows and returns once every row is done     //
+	void ParallelFor( int startRow, int endRow, int grainRows, RangeFunction function, void* data );
+
+private:
+	void RunRanges( int threadIndex );
+	bool PushRange( int threadIndex, const RangeType& range );
+	bool PopRange( int threadIndex, RangeType& range );
+	bool StealRange( int threadIndex, RangeType& range );
+	static DWORD WINAPI WorkerThread( LPVOID parameter );
+
+private:
+	// Thread pool (mWorkers[ 0 ] is the caller and has no thread)
+	WorkerType mWorkers[ JOB_MAX_THREADS ];
+	DequeType  mDeques[ JOB_MAX_THREADS ];
+	int mThreadCount;
+	volatile bool mQuit;
+
+	// Current loop
+	RangeFunction pFunction;
+	void* pData;
+	int mGrainRows;
+	volatile LONG mRemainingRows;
+};
+
+
+#endif
@@ -0,0 +1,511 @@
+#include "NoiseGeneratorClass.h"
+
+
+// Simplex skew / unskew factors for 2D
+static const float SIMPLEX_F2    = 0.366025403f; // ( sqrt( 3 ) - 1 ) / 2
+static const float SIMPLEX_G2    = 0.211324865f; // ( 3 - sqrt( 3 ) ) / 6
+static const float SIMPLEX_G2M1  = 2.0f * SIMPLEX_G2 - 1.0f;
+static const float SIMPLEX_SCALE = 70.0f;        // brings the sum to roughly -1 to 1
+
+// Eight gradient directions - indexed by the low 3 bits of the hash
+static const float GRADIENT_X[ 8 ] = { 1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 0.0f,  0.0f };
+static const float GRADIENT_Z[ 8 ] = { 1.0f,  1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 1.0f, -1.0f };
+
+// Domain warp sample offset for the second warp axis
+static const float WARP_OFFSET_X = 5.2f;
+static const float WARP_OFFSET_Z = 1.3f;
+
+
+// Default Constructor //
+NoiseGeneratorClass::NoiseGeneratorClass()
+: mUseSIMD( false ) {
+	NoiseParametersType parameters;
+
+	// Sensible default - gentle rolling fBm
+	parameters.type         = NOISE_FBM;
+	parameters.seed         = 0;
+	parameters.octaves      = 6;
+	parameters.frequency    = 1.0f / 96.0f;
+	parameters.lacunarity   = 2.0f;
+	parameters.gain         = 0.5f;
+	parameters.warpStrength = 40.0f;
+	parameters.baseHeight   = 5.0f;
+	parameters.amplitude    = 10.0f;
+
+	Initialize( parameters );
+}
+
+
+// Constructor //
+NoiseGeneratorClass::NoiseGeneratorClass( const NoiseGeneratorClass& other ) {
+}
+
+
+// Destructor //
+NoiseGeneratorClass::~NoiseGeneratorClass() {
+}
+
+
+// Initialize                                   //
+// Seeds the permutation table and octave offsets //
+void NoiseGeneratorClass::Initialize( const NoiseParametersType& parameters ) {
+	unsigned int state;
+	int swapIndex, temp;
+
+	mParameters = parameters;
+
+	if( mParameters.octaves < 1 ) {
+		mParameters.octaves = 1;
+	} else if( mParameters.octaves > NOISE_MAX_OCTAVES ) {
+		mParameters.octaves = NOISE_MAX_OCTAVES;
+	}
+
+	// Shuffle 0 - 255 with a seeded LCG (Fisher-Yates)
+	for( int i = 0; i < 256; i++ ) {
+		mPermutation[ i ] = i;
+	}
+
+	state = mParameters.seed * 747796405u + 2891336453u;
+	for( int i = 255; i > 0; i-- ) {
+		state = state * 1664525u + 1013904223u;
+		swapIndex = ( int )( ( state >> 8 ) % ( unsigned int )( i + 1 ) );
+
+		temp                      = mPermutation[ i ];
+		mPermutation[ i ]         = mPermutation[ swapIndex ];
+		mPermutation[ swapIndex ] = temp;
+	}
+
+	// Double the table so lookups never need to wrap
+	for( int i = 0; i < 256; i++ ) {
+		mPermutation[ 256 + i ] = mPermutation[ i ];
+	}
+
+	// Move each octave away from the lattice origin to hide repeating features
+	for( int i = 0; i < NOISE_MAX_OCTAVES; i++ ) {
+		state = state * 1664525u + 1013904223u;
+		mOctaveOffsetX[ i ] = ( float )( state >> 8 ) / 65536.0f;
+		state = state * 1664525u + 1013904223u;
+		mOctaveOffsetZ[ i ] = ( float )( state >> 8 ) / 65536.0f;
+	}
+
+	mUseSIMD = IsSIMDSupported();
+
+	return;
+}
+
+
+// GenerateTile                                     //
+// Full groups of 8 use AVX2, the row tail is scalar //
+void NoiseGeneratorClass::GenerateTile( float* heights, int width, int height, float offsetX, float offsetZ, float spacing ) {
+	const __m256i laneIndex = _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 );
+	__m256 x, z, value;
+	float* row;
+	float rowZ;
+	int i, simdWidth;
+
+	// Number of columns the SIMD path can take
+	simdWidth = mUseSIMD ? ( width - ( width % NOISE_SIMD_WIDTH ) ) : 0;
+
+	for( int j = 0; j < height; j++ ) {
+		row  = heights + ( j * width );
+		rowZ = offsetZ + ( float )j * spacing;
+
+		// 8 samples at a time
+		for( i = 0; i < simdWidth; i += NOISE_SIMD_WIDTH ) {
+			x = _mm256_add_ps( _mm256_set1_ps( offsetX ),
+				               _mm256_mul_ps( _mm256_cvtepi32_ps( _mm256_add_epi32( _mm256_set1_epi32( i ), laneIndex ) ), _mm256_set1_ps( spacing ) ) );
+			z = _mm256_set1_ps( rowZ );
+
+			value = Sample8( x, z );
+			value = _mm256_add_ps( _mm256_set1_ps( mParameters.baseHeight ), _mm256_mul_ps( _mm256_set1_ps( mParameters.amplitude ), value ) );
+
+			_mm256_storeu_ps( row + i, value );
+		}
+
+		// Remainder (or everything without AVX2)
+		for( ; i < width; i++ ) {
+			row[ i ] = mParameters.baseHeight + mParameters.amplitude * Sample( offsetX + ( float )i * spacing, rowZ );
+		}
+	}
+
+	return;
+}
+
+
+// Sample                          //
+// Scalar path for a single point  //
+float NoiseGeneratorClass::Sample( float x, float z ) {
+	float warpX, warpZ;
+
+	switch( mParameters.type ) {
+		case NOISE_RIDGED:
+			return Ridged( x, z );
+
+		case NOISE_WARPED:
+			// Offset the lookup by two decorrelated fBm fields
+			warpX = FBM( x, z );
+			warpZ = FBM( x + WARP_OFFSET_X, z + WARP_OFFSET_Z );
+			return FBM( x + mParameters.warpStrength * warpX, z + mParameters.warpStrength * warpZ );
+
+		default:
+			return FBM( x, z );
+	}
+}
+
+
+// SetSIMDEnabled                         //
+// Ignored if the CPU cannot run AVX2     //
+void NoiseGeneratorClass::SetSIMDEnabled( bool enabled ) {
+	mUseSIMD = enabled && IsSIMDSupported();
+}
+
+
+// IsSIMDEnabled //
+bool NoiseGeneratorClass::IsSIMDEnabled() {
+	return mUseSIMD;
+}
+
+
+// IsSIMDSupported                            //
+// AVX2 on the CPU and YMM state saved by OS  //
+bool NoiseGeneratorClass::IsSIMDSupported() {
+	int info[ 4 ];
+
+	__cpuid( info, 0 );
+	if( info[ 0 ] < 7 ) {
+		return false;
+	}
+
+	// OSXSAVE and AVX
+	__cpuid( info, 1 );
+	if( ( ( info[ 2 ] & ( 1 << 27 ) ) == 0 ) || ( ( info[ 2 ] & ( 1 << 28 ) ) == 0 ) ) {
+		return false;
+	}
+
+	// OS saves XMM and YMM registers
+	if( ( _xgetbv( 0 ) & 6 ) != 6 ) {
+		return false;
+	}
+
+	// AVX2
+	__cpuidex( info, 7, 0 );
+
+	return ( info[ 1 ] & ( 1 << 5 ) ) != 0;
+}
+
+
+// MeasureThroughput                                //
+// Walks tiles across the plane so no tile repeats  //
+double NoiseGeneratorClass::MeasureThroughput( int tileSize, float seconds ) {
+	LARGE_INTEGER frequency, startTime, currentTime;
+	double elapsed;
+	__int64 samples;
+	float* heights;
+	int tile;
+
+	heights = new float[ tileSize * tileSize ];
+	if( !heights ) {
+		return 0.0;
+	}
+
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &startTime );
+
+	samples = 0;
+	tile    = 0;
+	elapsed = 0.0;
+
+	while( elapsed < ( double )seconds ) {
+		GenerateTile( heights, tileSize, tileSize, ( float )( tile * tileSize ), 0.0f, 1.0f );
+		samples += tileSize * tileSize;
+		tile++;
+
+		QueryPerformanceCounter( &currentTime );
+		elapsed = ( double )( currentTime.QuadPart - startTime.QuadPart ) / ( double )frequency.QuadPart;
+	}
+
+	delete [] heights;
+	heights = 0;
+
+	return ( double )samples / elapsed;
+}
+
+
+// GetParameters //
+const NoiseGeneratorClass::NoiseParametersType& NoiseGeneratorClass::GetParameters() {
+	return mParameters;
+}
+
+
+// Simplex                            //
+// 2D simplex noise, roughly -1 to 1  //
+float NoiseGeneratorClass::Simplex( float x, float z ) {
+	float s, t, fi, fj, i1, j1;
+	float x0, z0, x1, z1, x2, z2;
+	float n0, n1, n2;
+	int ii, jj, i1i, j1i, h0, h1, h2;
+
+	// Skew into simplex space to find the cell
+	s  = ( x + z ) * SIMPLEX_F2;
+	fi = floorf( x + s );
+	fj = floorf( z + s );
+
+	// Unskew the cell origin back and get the distance to it
+	t  = ( fi + fj ) * SIMPLEX_G2;
+	x0 = x - ( fi - t );
+	z0 = z - ( fj - t );
+
+	// Which of the two triangles the point is in
+	i1 = ( x0 > z0 ) ? 1.0f : 0.0f;
+	j1 = 1.0f - i1;
+
+	// Offsets to the middle and far corners
+	x1 = x0 - i1 + SIMPLEX_G2;
+	z1 = z0 - j1 + SIMPLEX_G2;
+	x2 = x0 + SIMPLEX_G2M1;
+	z2 = z0 + SIMPLEX_G2M1;
+
+	// Hash each corner into a gradient
+	ii  = ( int )fi & 255;
+	jj  = ( int )fj & 255;
+	i1i = ( int )i1;
+	j1i = ( int )j1;
+
+	h0 = mPermutation[ ii + mPermutation[ jj ] ] & 7;
+	h1 = mPermutation[ ii + i1i + mPermutation[ jj + j1i ] ] & 7;
+	h2 = mPermutation[ ii + 1 + mPermutation[ jj + 1 ] ] & 7;
+
+	// Corner contributions - ( 0.5 - r^2 )^4 * ( gradient . offset )
+	t = 0.5f - x0 * x0 - z0 * z0;
+	if( t < 0.0f ) { t = 0.0f; }
+	t = t * t;
+	n0 = t * t * ( GRADIENT_X[ h0 ] * x0 + GRADIENT_Z[ h0 ] * z0 );
+
+	t = 0.5f - x1 * x1 - z1 * z1;
+	if( t < 0.0f ) { t = 0.0f; }
+	t = t * t;
+	n1 = t * t * ( GRADIENT_X[ h1 ] * x1 + GRADIENT_Z[ h1 ] * z1 );
+
+	t = 0.5f - x2 * x2 - z2 * z2;
+	if( t < 0.0f ) { t = 0.0f; }
+	t = t * t;
+	n2 = t * t * ( GRADIENT_X[ h2 ] * x2 + GRADIENT_Z[ h2 ] * z2 );
+
+	return ( n0 + n1 + n2 ) * SIMPLEX_SCALE;
+}
+
+
+// FBM                                  //
+// Octaves of simplex, normalised sum   //
+float NoiseGeneratorClass::FBM( float x, float z ) {
+	float sum, amplitude, frequency, total;
+
+	sum       = 0.0f;
+	total     = 0.0f;
+	amplitude = 1.0f;
+	frequency = mParameters.frequency;
+
+	for( int i = 0; i < mParameters.octaves; i++ ) {
+		sum   += Simplex( x * frequency + mOctaveOffsetX[ i ], z * frequency + mOctaveOffsetZ[ i ] ) * amplitude;
+		total += amplitude;
+
+		amplitude *= mParameters.gain;
+		frequency *= mParameters.lacunarity;
+	}
+
+	return sum / total;
+}
+
+
+// Ridged                                           //
+// Ridged multifractal - sharp crests from 1 - |n|   //
+// Each octave is weighted by the previous one so    //
+// detail gathers on the ridges rather than valleys  //
+float NoiseGeneratorClass::Ridged( float x, float z ) {
+	float sum, amplitude, frequency, total, signal, weight;
+
+	sum       = 0.0f;
+	total     = 0.0f;
+	amplitude = 1.0f;
+	weight    = 1.0f;
+	frequency = mParameters.frequency;
+
+	for( int i = 0; i < mParameters.octaves; i++ ) {
+		signal = 1.0f - fabsf( Simplex( x * frequency + mOctaveOffsetX[ i ], z * frequency + mOctaveOffsetZ[ i ] ) );
+		signal = signal * signal;
+		signal = signal * weight;
+
+		weight = signal * 2.0f;
+		if( weight < 0.0f ) { weight = 0.0f; }
+		if( weight > 1.0f ) { weight = 1.0f; }
+
+		sum   += signal * amplitude;
+		total += amplitude;
+
+		amplitude *= mParameters.gain;
+		frequency *= mParameters.lacunarity;
+	}
+
+	// 0 - 1 back to -1 - 1 to match fBm
+	return ( sum / total ) * 2.0f - 1.0f;
+}
+
+
+// Simplex8                                      //
+// Simplex above for 8 points - gathers replace  //
+// the permutation and gradient table lookups    //
+__m256 NoiseGeneratorClass::Simplex8( __m256 x, __m256 z ) {
+	const __m256 zero  = _mm256_setzero_ps();
+	const __m256 one   = _mm256_set1_ps( 1.0f );
+	const __m256 half  = _mm256_set1_ps( 0.5f );
+	const __m256 g2    = _mm256_set1_ps( SIMPLEX_G2 );
+	const __m256 g2m1  = _mm256_set1_ps( SIMPLEX_G2M1 );
+	const __m256i mask = _mm256_set1_epi32( 255 );
+	const __m256i mask7 = _mm256_set1_epi32( 7 );
+	const __m256i oneI = _mm256_set1_epi32( 1 );
+	const __m256 gradientX = _mm256_loadu_ps( GRADIENT_X );
+	const __m256 gradientZ = _mm256_loadu_ps( GRADIENT_Z );
+	__m256 s, t, fi, fj, i1, j1, x0, z0, x1, z1, x2, z2, n0, n1, n2;
+	__m256i ii, jj, i1i, j1i, h0, h1, h2;
+
+	// Skew into simplex space to find the cell
+	s  = _mm256_mul_ps( _mm256_add_ps( x, z ), _mm256_set1_ps( SIMPLEX_F2 ) );
+	fi = _mm256_floor_ps( _mm256_add_ps( x, s ) );
+	fj = _mm256_floor_ps( _mm256_add_ps( z, s ) );
+
+	// Unskew the cell origin back and get the distance to it
+	t  = _mm256_mul_ps( _mm256_add_ps( fi, fj ), g2 );
+	x0 = _mm256_sub_ps( x, _mm256_sub_ps( fi, t ) );
+	z0 = _mm256_sub_ps( z, _mm256_sub_ps( fj, t ) );
+
+	// Which of the two triangles the point is in
+	i1 = _mm256_and_ps( _mm256_cmp_ps( x0, z0, _CMP_GT_OQ ), one );
+	j1 = _mm256_sub_ps( one, i1 );
+
+	// Offsets to the middle and far corners
+	x1 = _mm256_add_ps( _mm256_sub_ps( x0, i1 ), g2 );
+	z1 = _mm256_add_ps( _mm256_sub_ps( z0, j1 ), g2 );
+	x2 = _mm256_add_ps( x0, g2m1 );
+	z2 = _mm256_add_ps( z0, g2m1 );
+
+	// Hash each corner into a gradient
+	ii  = _mm256_and_si256( _mm256_cvttps_epi32( fi ), mask );
+	jj  = _mm256_and_si256( _mm256_cvttps_epi32( fj ), mask );
+	i1i = _mm256_cvttps_epi32( i1 );
+	j1i = _mm256_cvttps_epi32( j1 );
+
+	h0 = _mm256_i32gather_epi32( mPermutation, jj, 4 );
+	h0 = _mm256_i32gather_epi32( mPermutation, _mm256_add_epi32( ii, h0 ), 4 );
+	h0 = _mm256_and_si256( h0, mask7 );
+
+	h1 = _mm256_i32gather_epi32( mPermutation, _mm256_add_epi32( jj, j1i ), 4 );
+	h1 = _mm256_i32gather_epi32( mPermutation, _mm256_add_epi32( _mm256_add_epi32( ii, i1i ), h1 ), 4 );
+	h1 = _mm256_and_si256( h1, mask7 );
+
+	h2 = _mm256_i32gather_epi32( mPermutation, _mm256_add_epi32( jj, oneI ), 4 );
+	h2 = _mm256_i32gather_epi32( mPermutation, _mm256_add_epi32( _mm256_add_epi32( ii, oneI ), h2 ), 4 );
+	h2 = _mm256_and_si256( h2, mask7 );
+
+	// Corner contributions - ( 0.5 - r^2 )^4 * ( gradient . offset )
+	t  = _mm256_max_ps( _mm256_sub_ps( _mm256_sub_ps( half, _mm256_mul_ps( x0, x0 ) ), _mm256_mul_ps( z0, z0 ) ), zero );
+	t  = _mm256_mul_ps( t, t );
+	n0 = _mm256_mul_ps( _mm256_mul_ps( t, t ),
+		                _mm256_add_ps( _mm256_mul_ps( _mm256_permutevar8x32_ps( gradientX, h0 ), x0 ),
+						               _mm256_mul_ps( _mm256_permutevar8x32_ps( gradientZ, h0 ), z0 ) ) );
+
+	t  = _mm256_max_ps( _mm256_sub_ps( _mm256_sub_ps( half, _mm256_mul_ps( x1, x1 ) ), _mm256_mul_ps( z1, z1 ) ), zero );
+	t  = _mm256_mul_ps( t, t );
+	n1 = _mm256_mul_ps( _mm256_mul_ps( t, t ),
+		                _mm256_add_ps( _mm256_mul_ps( _mm256_permutevar8x32_ps( gradientX, h1 ), x1 ),
+						               _mm256_mul_ps( _mm256_permutevar8x32_ps( gradientZ, h1 ), z1 ) ) );
+
+	t  = _mm256_max_ps( _mm256_sub_ps( _mm256_sub_ps( half, _mm256_mul_ps( x2, x2 ) ), _mm256_mul_ps( z2, z2 ) ), zero );
+	t  = _mm256_mul_ps( t, t );
+	n2 = _mm256_mul_ps( _mm256_mul_ps( t, t ),
+		                _mm256_add_ps( _mm256_mul_ps( _mm256_permutevar8x32_ps( gradientX, h2 ), x2 ),
+						               _mm256_mul_ps( _mm256_permutevar8x32_ps( gradientZ, h2 ), z2 ) ) );
+
+	return _mm256_mul_ps( _mm256_add_ps( _mm256_add_ps( n0, n1 ), n2 ), _mm256_set1_ps( SIMPLEX_SCALE ) );
+}
+
+
+// FBM8 //
+__m256 NoiseGeneratorClass::FBM8( __m256 x, __m256 z ) {
+	__m256 sum, octaveX, octaveZ;
+	float amplitude, frequency, total;
+
+	sum       = _mm256_setzero_ps();
+	total     = 0.0f;
+	amplitude = 1.0f;
+	frequency = mParameters.frequency;
+
+	for( int i = 0; i < mParameters.octaves; i++ ) {
+		octaveX = _mm256_add_ps( _mm256_mul_ps( x, _mm256_set1_ps( frequency ) ), _mm256_set1_ps( mOctaveOffsetX[ i ] ) );
+		octaveZ = _mm256_add_ps( _mm256_mul_ps( z, _mm256_set1_ps( frequency ) ), _mm256_set1_ps( mOctaveOffsetZ[ i ] ) );
+
+		sum    = _mm256_add_ps( sum, _mm256_mul_ps( Simplex8( octaveX, octaveZ ), _mm256_set1_ps( amplitude ) ) );
+		total += amplitude;
+
+		amplitude *= mParameters.gain;
+		frequency *= mParameters.lacunarity;
+	}
+
+	return _mm256_div_ps( sum, _mm256_set1_ps( total ) );
+}
+
+
+// Ridged8 //
+__m256 NoiseGeneratorClass::Ridged8( __m256 x, __m256 z ) {
+	const __m256 signMask = _mm256_set1_ps( -0.0f );
+	const __m256 zero     = _mm256_setzero_ps();
+	const __m256 one      = _mm256_set1_ps( 1.0f );
+	__m256 sum, weight, signal, octaveX, octaveZ;
+	float amplitude, frequency, total;
+
+	sum       = _mm256_setzero_ps();
+	weight    = one;
+	total     = 0.0f;
+	amplitude = 1.0f;
+	frequency = mParameters.frequency;
+
+	for( int i = 0; i < mParameters.octaves; i++ ) {
+		octaveX = _mm256_add_ps( _mm256_mul_ps( x, _mm256_set1_ps( frequency ) ), _mm256_set1_ps( mOctaveOffsetX[ i ] ) );
+		octaveZ = _mm256_add_ps( _mm256_mul_ps( z, _mm256_set1_ps( frequency ) ), _mm256_set1_ps( mOctaveOffsetZ[ i ] ) );
+
+		// 1 - |n| (abs by clearing the sign bit)
+		signal = _mm256_sub_ps( one, _mm256_andnot_ps( signMask, Simplex8( octaveX, octaveZ ) ) );
+		signal = _mm256_mul_ps( signal, signal );
+		signal = _mm256_mul_ps( signal, weight );
+
+		weight = _mm256_min_ps( _mm256_max_ps( _mm256_mul_ps( signal, _mm256_set1_ps( 2.0f ) ), zero ), one );
+
+		sum    = _mm256_add_ps( sum, _mm256_mul_ps( signal, _mm256_set1_ps( amplitude ) ) );
+		total += amplitude;
+
+		amplitude *= mParameters.gain;
+		frequency *= mParameters.lacunarity;
+	}
+
+	return _mm256_sub_ps( _mm256_mul_ps( _mm256_div_ps( sum, _mm256_set1_ps( total ) ), _mm256_set1_ps( 2.0f ) ), one );
+}
+
+
+// Sample8                              //
+// Sample above for 8 points at a time  //
+__m256 NoiseGeneratorClass::Sample8( __m256 x, __m256 z ) {
+	__m256 warpX, warpZ, strength;
+
+	switch( mParameters.type ) {
+		case NOISE_RIDGED:
+			return Ridged8( x, z );
+
+		case NOISE_WARPED:
+			warpX    = FBM8( x, z );
+			warpZ    = FBM8( _mm256_add_ps( x, _mm256_set1_ps( WARP_OFFSET_X ) ), _mm256_add_ps( z, _mm256_set1_ps( WARP_OFFSET_Z ) ) );
+			strength = _mm256_set1_ps( mParameters.warpStrength );
+			return FBM8( _mm256_add_ps( x, _mm256_mul_ps( strength, warpX ) ), _mm256_add_ps( z, _mm256_mul_ps( strength, warpZ ) ) );
+
+		default:
+			return FBM8( x, z );
+	}
+}
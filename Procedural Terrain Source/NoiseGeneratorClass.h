@@ -0,0 +1,101 @@
+#ifndef _NOISEGENERATORCLASS_H_
+#define _NOISEGENERATORCLASS_H_
+
+
+// Includes //
+#include <windows.h>
+#include <intrin.h>
+#include <immintrin.h>
+#include <math.h>
+
+
+// Application Includes //
+#include "HeightGeneratorClass.h"
+
+
+// Noise Variables
+const int NOISE_MAX_OCTAVES = 12;
+const int NOISE_SIMD_WIDTH  = 8; // samples per AVX register
+
+
+// NoiseGeneratorClass                                                   //
+// Gradient noise height generator - 2D simplex noise combined as fBm,   //
+// ridged multifractal or domain warped fBm                              //
+// The permutation table is built per instance from the seed so there is //
+// no global state and generators can run side by side on any thread     //
+// Rows are evaluated 8 samples at a time with AVX2 (gathers into the    //
+// permutation table) when the CPU supports it - the scalar path does    //
+// the same operations in the same order so both paths give matching    //
+// heights                                                               //
+class NoiseGeneratorClass : public HeightGeneratorClass {
+public:
+	// Noise combinations
+	enum NoiseType {
+		NOISE_FBM,
+		NOISE_RIDGED,
+		NOISE_WARPED
+	};
+
+	// Generator settings
+	struct NoiseParametersType {
+		NoiseType type;
+		unsigned int seed;
+		int octaves;
+		float frequency;    // first octave frequency (1 / world units)
+		float lacunarity;   // frequency multiplier per octave
+		float gain;         // amplitude multiplier per octave
+		float warpStrength; // domain warp offset in world units
+		float baseHeight;   // output = baseHeight + amplitude * noise
+		float amplitude;
+	};
+
+public:
+	NoiseGeneratorClass();
+	NoiseGeneratorClass( const NoiseGeneratorClass& other );
+	~NoiseGeneratorClass();
+
+	void Initialize( const NoiseParametersType& parameters );
+
+	// HeightGeneratorClass
+	void GenerateTile( float* heights, int width, int height, float offsetX, float offsetZ, float spacing );
+
+	// Single sample (scalar path) - -1 to 1 before height scaling
+	float Sample( float x, float z );
+
+	// SIMD control - off forces the scalar path (for comparison)
+	void SetSIMDEnabled( bool enabled );
+	bool IsSIMDEnabled();
+	static bool IsSIMDSupported();
+
+	// MeasureThroughput                             //
+	// Generates tiles for at least 'seconds' and    //
+	// returns samples per second                    //
+	double MeasureThroughput( int tileSize, float seconds );
+
+	const NoiseParametersType& GetParameters();
+
+private:
+	// Scalar path
+	float Simplex( float x, float z );
+	float FBM( float x, float z );
+	float Ridged( float x, float z );
+
+	// AVX2 path - 8 samples
+	__m256 Simplex8( __m256 x, __m256 z );
+	__m256 FBM8( __m256 x, __m256 z );
+	__m256 Ridged8( __m256 x, __m256 z );
+	__m256 Sample8( __m256 x, __m256 z );
+
+private:
+	NoiseParametersType mParameters;
+
+	// Permutation table (doubled to avoid wrapping) and per-octave offsets
+	int mPermutation[ 512 ];
+	float mOctaveOffsetX[ NOISE_MAX_OCTAVES ];
+	float mOctaveOffsetZ[ NOISE_MAX_OCTAVES ];
+
+	bool mUseSIMD;
+};
+
+
+#endif
@@ -0,0 +1,287 @@
+#include "OceanShaderClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+OceanShaderClass::OceanShaderClass()
+: pVertexShader( 0 ), pPixelShader( 0 ), pLayout( 0 ), pSampleState( 0 ) {
+}
+
+
+// Constructor //
+OceanShaderClass::OceanShaderClass( const OceanShaderClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+OceanShaderClass::~OceanShaderClass() {
+}
+
+
+// Initialize //
+bool OceanShaderClass::Initialize( ID3D11Device* device, HWND hwnd ) {
+	bool result;
+
+	// Initialize the vertex and pixel shaders
+	result = InitializeShader( device, hwnd, L"Ocean.vs", L"Ocean.ps" );
+	if( !result ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// Shutdown //
+void OceanShaderClass::Shutdown() {
+	// Shutdown the vertex and pixel shaders as well as the related objects
+	ShutdownShader();
+
+	return;
+}
+
+
+// Render                                                         //
+// Per-frame / per-pass / per-object buffers must be committed   //
+// and the ocean's buffers set (OceanClass::Render)              //
+bool OceanShaderClass::Render( ID3D11DeviceContext* deviceContext,
+	                           int indexCount,
+							   ID3D11ShaderResourceView* reflectionTexture,
+							   ID3D11ShaderResourceView* refractionTexture,
+							   ID3D11ShaderResourceView** textureArray ) {
+	bool result;
+
+	// Set the shader parameters that it will use for rendering
+	result = SetShaderParameters( deviceContext, reflectionTexture, refractionTexture, textureArray );
+	if( !result ) {
+		return false;
+	}
+
+	// Now render the prepared buffers with the shader
+	RenderShader( deviceContext, indexCount );
+
+	return true;
+}
+
+
+// InitializeShader //
+bool OceanShaderClass::InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename ) {
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* vertexShaderBuffer;
+	ID3D10Blob* pixelShaderBuffer;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[ 3 ];
+	unsigned int numElements;
+	D3D11_SAMPLER_DESC samplerDesc;
+
+	// Initialize the pointers this function will use to null
+	errorMessage       = 0;
+	vertexShaderBuffer = 0;
+	pixelShaderBuffer  = 0;
+
+	// Load the vertex shader code (compiled on a cache miss)
+	if( !ShaderCacheClass::LoadShader( vsFilename, "OceanVertexShader", "vs_5_0", NULL, &vertexShaderBuffer, &errorMessage ) ) {
+		// If the shader failed to compile it should have writen something to the error message
+		if( errorMessage ) {
+			OutputShaderErrorMessage( errorMessage, hwnd, vsFilename );
+		// If there was nothing in the error message then it simply could not find the shader file itself
+		} else {
+			MessageBox( hwnd, vsFilename, L"Missing Shader File", MB_OK );
+		}
+
+		return false;
+	}
+
+	// Load the pixel shader code (compiled on a cache miss)
+	if( !ShaderCacheClass::LoadShader( psFilename, "OceanPixelShader", "ps_5_0", NULL, &pixelShaderBuffer, &errorMessage ) ) {
+		// If the shader failed to compile it should have writen something to the error message
+		if( errorMessage ) {
+			OutputShaderErrorMessage( errorMessage, hwnd, psFilename );
+		// If there was nothing in the error message then it simply could not find the file itself
+		} else {
+			MessageBox( hwnd, psFilename, L"Missing Shader File", MB_OK );
+		}
+
+		return false;
+	}
+
+	// Create the vertex shader from the buffer
+	result = device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &pVertexShader );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Create the pixel shader from the buffer
+	result = device->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pPixelShader );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Create the vertex input layout description
+	// Matches the OceanClass vertex - position, texture and normal
+	polygonLayout[ 0 ].SemanticName         = "POSITION";
+	polygonLayout[ 0 ].SemanticIndex        = 0;
+	polygonLayout[ 0 ].Format               = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[ 0 ].InputSlot            = 0;
+	polygonLayout[ 0 ].AlignedByteOffset    = 0;
+	polygonLayout[ 0 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 0 ].InstanceDataStepRate = 0;
+
+	polygonLayout[ 1 ].SemanticName         = "TEXCOORD";
+	polygonLayout[ 1 ].SemanticIndex        = 0;
+	polygonLayout[ 1 ].Format               = DXGI_FORMAT_R32G32_FLOAT;
+	polygonLayout[ 1 ].InputSlot            = 0;
+	polygonLayout[ 1 ].AlignedByteOffset    = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[ 1 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 1 ].InstanceDataStepRate = 0;
+
+	polygonLayout[ 2 ].SemanticName         = "NORMAL";
+	polygonLayout[ 2 ].SemanticIndex        = 0;
+	polygonLayout[ 2 ].Format               = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[ 2 ].InputSlot            = 0;
+	polygonLayout[ 2 ].AlignedByteOffset    = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[ 2 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 2 ].InstanceDataStepRate = 0;
+
+	// Get a count of the elements in the layout
+    numElements = sizeof( polygonLayout ) / sizeof( polygonLayout[ 0 ] );
+
+	// Create the vertex input layout
+	result = device->CreateInputLayout( polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &pLayout );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Release the vertex shader buffer and pixel shader buffer since they are no longer needed
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
+	pixelShaderBuffer->Release();
+	pixelShaderBuffer = 0;
+
+	// Create a texture sampler state description
+    samplerDesc.Filter         = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressV       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressW       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.MipLODBias     = 0.0f;
+    samplerDesc.MaxAnisotropy  = 1;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+    samplerDesc.BorderColor[0] = 0;
+	samplerDesc.BorderColor[1] = 0;
+	samplerDesc.BorderColor[2] = 0;
+	samplerDesc.BorderColor[3] = 0;
+    samplerDesc.MinLOD         = 0;
+    samplerDesc.MaxLOD         = D3D11_FLOAT32_MAX;
+
+	// Create the texture sampler state
+    result = device->CreateSamplerState( &samplerDesc, &pSampleState );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// ShutdownShader //
+void OceanShaderClass::ShutdownShader() {
+	// Release the sampler state
+	if( pSampleState ) {
+		pSampleState->Release();
+		pSampleState = 0;
+	}
+
+	// Release the layout
+	if( pLayout ) {
+		pLayout->Release();
+		pLayout = 0;
+	}
+
+	// Release the pixel shader
+	if( pPixelShader ) {
+		pPixelShader->Release();
+		pPixelShader = 0;
+	}
+
+	// Release the vertex shader
+	if( pVertexShader ) {
+		pVertexShader->Release();
+		pVertexShader = 0;
+	}
+
+	return;
+}
+
+
+// OutputShaderErrorMessage                   //
+// Writes compiler output to shader-error.txt //
+void OceanShaderClass::OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename ) {
+	char* compileErrors;
+	unsigned long bufferSize, i;
+	ofstream fout;
+
+	// Get a pointer to the error message text buffer
+	compileErrors = ( char* )( errorMessage->GetBufferPointer() );
+
+	// Get the length of the message
+	bufferSize = errorMessage->GetBufferSize();
+
+	// Open a file to write the error message to
+	fout.open( "shader-error.txt" );
+
+	// Write out the error message
+	for( i = 0; i < bufferSize; i++ ) {
+		fout << compileErrors[ i ];
+	}
+
+	// Close the file
+	fout.close();
+
+	// Release the error message
+	errorMessage->Release();
+	errorMessage = 0;
+
+	// Pop a message up on the screen to notify the user to check the text file for compile errors
+	MessageBox( hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK );
+
+	return;
+}
+
+
+// SetShaderParameters                              //
+// Only the textures - constants are shared buffers //
+bool OceanShaderClass::SetShaderParameters( ID3D11DeviceContext* deviceContext,
+	                                        ID3D11ShaderResourceView* reflectionTexture,
+											ID3D11ShaderResourceView* refractionTexture,
+											ID3D11ShaderResourceView** textureArray ) {
+	// Set the reflection and refraction textures in the pixel shader (t0 / t1)
+	deviceContext->PSSetShaderResources( 0, 1, &reflectionTexture );
+	deviceContext->PSSetShaderResources( 1, 1, &refractionTexture );
+
+	// Then the normal map and ocean colour (t2 / t3)
+	deviceContext->PSSetShaderResources( 2, OCEAN_SHADER_TEXTURE_COUNT, textureArray );
+
+	return true;
+}
+
+
+// RenderShader                    //
+// Draws the ocean's index buffer  //
+void OceanShaderClass::RenderShader( ID3D11DeviceContext* deviceContext, int indexCount ) {
+	// Set the vertex input layout
+	deviceContext->IASetInputLayout( pLayout );
+
+	// Set the vertex and pixel shaders that will be used to render
+	deviceContext->VSSetShader( pVertexShader, NULL, 0 );
+	deviceContext->PSSetShader( pPixelShader, NULL, 0 );
+
+	// Set the sampler state in the pixel shader
+	deviceContext->PSSetSamplers( 0, 1, &pSampleState );
+
+	// Render the ocean
+	deviceContext->DrawIndexed( indexCount, 0, 0 );
+
+	return;
+}
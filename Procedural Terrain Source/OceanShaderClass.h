@@ -0,0 +1,56 @@
+#ifndef _OCEANSHADERCLASS_H_
+#define _OCEANSHADERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <fstream>
+using namespace std;
+
+
+// Application Includes //
+#include "ShaderCacheClass.h"
+
+
+// Ocean Shader Variables
+const int OCEAN_SHADER_TEXTURE_COUNT = 2; // normal map then the ocean colour
+
+
+// OceanShaderClass                                                  //
+// Waves, and the reflection and refraction textures rippled by the   //
+// ocean's normal map (Ocean.vs / .ps)                                //
+// Matrices, wave time and height and the water translation come     //
+// from the shared per-frame / per-pass / per-object buffers          //
+// (ConstantBufferManagerClass) - commit them first                   //
+class OceanShaderClass {
+public:
+	OceanShaderClass();
+	OceanShaderClass( const OceanShaderClass& other );
+	~OceanShaderClass();
+
+	bool Initialize( ID3D11Device* device, HWND hwnd );
+	void Shutdown();
+	bool Render( ID3D11DeviceContext* deviceContext,
+		         int indexCount,
+				 ID3D11ShaderResourceView* reflectionTexture,
+				 ID3D11ShaderResourceView* refractionTexture,
+				 ID3D11ShaderResourceView** textureArray );
+
+private:
+	bool InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename );
+	void ShutdownShader();
+	void OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename );
+
+	bool SetShaderParameters( ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* reflectionTexture, ID3D11ShaderResourceView* refractionTexture, ID3D11ShaderResourceView** textureArray );
+	void RenderShader( ID3D11DeviceContext* deviceContext, int indexCount );
+
+private:
+	ID3D11VertexShader* pVertexShader;
+	ID3D11PixelShader*  pPixelShader;
+	ID3D11InputLayout*  pLayout;
+	ID3D11SamplerState* pSampleState;
+};
+
+
+#endif
@@ -0,0 +1,409 @@
+#include "ProfilerClass.h"
+
+
+// Default Constructor  //
+// NULL query pointers  //
+ProfilerClass::ProfilerClass() :
+ mCurrentFrame( 0 ), mActivePass( -1 ), mPassCount( 0 ), mLastFrameTime( 0.0f ), mCapturing( false ), mDroppedFrames( 0 ) {
+	memset( mFrames, 0, sizeof( mFrames ) );
+}
+
+
+// Constructor //
+ProfilerClass::ProfilerClass( const ProfilerClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+ProfilerClass::~ProfilerClass() {
+}
+
+
+// Initialize                                      //
+// Creates the query ring for every frame in flight //
+bool ProfilerClass::Initialize( ID3D11Device* device ) {
+	D3D11_QUERY_DESC disjointDesc, timestampDesc;
+	HRESULT result;
+
+	// Setup the query descriptions
+	disjointDesc.Query      = D3D11_QUERY_TIMESTAMP_DISJOINT;
+	disjointDesc.MiscFlags  = 0;
+	timestampDesc.Query     = D3D11_QUERY_TIMESTAMP;
+	timestampDesc.MiscFlags = 0;
+
+	for( int i = 0; i < PROFILER_FRAME_LATENCY; i++ ) {
+		// Disjoint query - gives the timestamp frequency for this frame
+		result = device->CreateQuery( &disjointDesc, &mFrames[ i ].pDisjoint );
+		if( FAILED( result ) ) {
+			return false;
+		}
+
+		// Whole frame timestamps
+		result = device->CreateQuery( &timestampDesc, &mFrames[ i ].pFrameBegin );
+		if( FAILED( result ) ) {
+			return false;
+		}
+
+		result = device->CreateQuery( &timestampDesc, &mFrames[ i ].pFrameEnd );
+		if( FAILED( result ) ) {
+			return false;
+		}
+
+		// Per pass timestamps
+		for( int j = 0; j < PROFILER_MAX_PASSES; j++ ) {
+			result = device->CreateQuery( &timestampDesc, &mFrames[ i ].pPassBegin[ j ] );
+			if( FAILED( result ) ) {
+				return false;
+			}
+
+			result = device->CreateQuery( &timestampDesc, &mFrames[ i ].pPassEnd[ j ] );
+			if( FAILED( result ) ) {
+				return false;
+			}
+
+			mFrames[ i ].passUsed[ j ] = false;
+		}
+
+		mFrames[ i ].issued = false;
+		mFrames[ i ].captured = false;
+	}
+
+	return true;
+}
+
+
+// Shutdown         //
+// Release queries  //
+void ProfilerClass::Shutdown() {
+	for( int i = 0; i < PROFILER_FRAME_LATENCY; i++ ) {
+		for( int j = 0; j < PROFILER_MAX_PASSES; j++ ) {
+			if( mFrames[ i ].pPassBegin[ j ] ) {
+				mFrames[ i ].pPassBegin[ j ]->Release();
+				mFrames[ i ].pPassBegin[ j ] = 0;
+			}
+
+			if( mFrames[ i ].pPassEnd[ j ] ) {
+				mFrames[ i ].pPassEnd[ j ]->Release();
+				mFrames[ i ].pPassEnd[ j ] = 0;
+			}
+		}
+
+		if( mFrames[ i ].pFrameEnd ) {
+			mFrames[ i ].pFrameEnd->Release();
+			mFrames[ i ].pFrameEnd = 0;
+		}
+
+		if( mFrames[ i ].pFrameBegin ) {
+			mFrames[ i ].pFrameBegin->Release();
+			mFrames[ i ].pFrameBegin = 0;
+		}
+
+		if( mFrames[ i ].pDisjoint ) {
+			mFrames[ i ].pDisjoint->Release();
+			mFrames[ i ].pDisjoint = 0;
+		}
+	}
+
+	// Release sample storage
+	for( int i = 0; i < PROFILER_MAX_PASSES; i++ ) {
+		mPasses[ i ].samples.clear();
+	}
+	mFrameSamples.clear();
+
+	return;
+}
+
+
+// BeginFrame                                       //
+// Reads back the oldest frame then starts this one //
+void ProfilerClass::BeginFrame( ID3D11DeviceContext* deviceContext ) {
+	FrameQueryType& frame = mFrames[ mCurrentFrame ];
+
+	// This slot was last used PROFILER_FRAME_LATENCY frames ago - collect it
+	// if the GPU has finished with it, otherwise drop it rather than wait
+	if( frame.issued ) {
+		ReadBackFrame( deviceContext, mCurrentFrame, false );
+	}
+
+	// Tag the frame so its samples are only stored if it was drawn while capturing
+	frame.captured = mCapturing;
+
+	// Reset pass flags for this frame
+	for( int i = 0; i < PROFILER_MAX_PASSES; i++ ) {
+		frame.passUsed[ i ] = false;
+	}
+
+	deviceContext->Begin( frame.pDisjoint );
+	deviceContext->End( frame.pFrameBegin );
+
+	mActivePass = -1;
+
+	return;
+}
+
+
+// EndFrame                                       //
+// Closes this frame and moves on to the next slot //
+void ProfilerClass::EndFrame( ID3D11DeviceContext* deviceContext ) {
+	FrameQueryType& frame = mFrames[ mCurrentFrame ];
+
+	deviceContext->End( frame.pFrameEnd );
+	deviceContext->End( frame.pDisjoint );
+	frame.issued = true;
+
+	// Move to next slot in the ring
+	mCurrentFrame = ( mCurrentFrame + 1 ) % PROFILER_FRAME_LATENCY;
+
+	return;
+}
+
+
+// BeginPass                                  //
+// Timestamps the start of the named pass      //
+// Passes are registered the first time seen   //
+void ProfilerClass::BeginPass( ID3D11DeviceContext* deviceContext, const char* passName ) {
+	int passIndex = FindPass( passName, true );
+	if( passIndex < 0 ) {
+		return;
+	}
+
+	deviceContext->End( mFrames[ mCurrentFrame ].pPassBegin[ passIndex ] );
+	mFrames[ mCurrentFrame ].passUsed[ passIndex ] = true;
+	mActivePass = passIndex;
+
+	return;
+}
+
+
+// EndPass                             //
+// Timestamps the end of the open pass //
+void ProfilerClass::EndPass( ID3D11DeviceContext* deviceContext ) {
+	if( mActivePass < 0 ) {
+		return;
+	}
+
+	deviceContext->End( mFrames[ mCurrentFrame ].pPassEnd[ mActivePass ] );
+	mActivePass = -1;
+
+	return;
+}
+
+
+// StartCapture                          //
+// Clears old samples and begins storing //
+void ProfilerClass::StartCapture() {
+	for( int i = 0; i < mPassCount; i++ ) {
+		mPasses[ i ].samples.clear();
+	}
+	mFrameSamples.clear();
+	mDroppedFrames = 0;
+
+	mCapturing = true;
+
+	return;
+}
+
+
+// StopCapture                                 //
+// Frames already issued while capturing still //
+// store their samples when read back          //
+void ProfilerClass::StopCapture() {
+	mCapturing = false;
+
+	return;
+}
+
+
+// IsCapturing //
+bool ProfilerClass::IsCapturing() {
+	return mCapturing;
+}
+
+
+// ReadBackPending                                  //
+// Waits for and reads every frame still in flight, //
+// oldest first - for the end of a capture          //
+void ProfilerClass::ReadBackPending( ID3D11DeviceContext* deviceContext ) {
+	int frameIndex;
+
+	for( int i = 0; i < PROFILER_FRAME_LATENCY; i++ ) {
+		frameIndex = ( mCurrentFrame + i ) % PROFILER_FRAME_LATENCY;
+		if( mFrames[ frameIndex ].issued ) {
+			ReadBackFrame( deviceContext, frameIndex, true );
+		}
+	}
+
+	return;
+}
+
+
+// WriteReport                                            //
+// Writes frame and per pass percentiles (ms) to a file  //
+bool ProfilerClass::WriteReport( const char* fileName, const char* title ) {
+	FILE* filePtr;
+	int error;
+
+	// Open the report file
+	error = fopen_s( &filePtr, fileName, "w" );
+	if( error != 0 ) {
+		return false;
+	}
+
+	fprintf( filePtr, "%s\n", title );
+	fprintf( filePtr, "Frames captured = %d\n", ( int )mFrameSamples.size() );
+	fprintf( filePtr, "Frames dropped (not ready in time) = %d\n\n", mDroppedFrames );
+	fprintf( filePtr, "%-24s %8s %8s %8s %8s %8s %8s\n", "Pass (ms)", "mean", "p50", "p90", "p95", "p99", "max" );
+
+	// Whole frame then each pass
+	WritePercentiles( filePtr, "Frame", mFrameSamples );
+	for( int i = 0; i < mPassCount; i++ ) {
+		WritePercentiles( filePtr, mPasses[ i ].name, mPasses[ i ].samples );
+	}
+
+	// Close the file
+	error = fclose( filePtr );
+	if( error != 0 ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// GetFrameTime                   //
+// Last resolved GPU frame in ms  //
+float ProfilerClass::GetFrameTime() {
+	return mLastFrameTime;
+}
+
+
+// GetPassTime                           //
+// Last resolved GPU time of a pass (ms) //
+float ProfilerClass::GetPassTime( const char* passName ) {
+	int passIndex = FindPass( passName, false );
+	if( passIndex < 0 ) {
+		return 0.0f;
+	}
+
+	return mPasses[ passIndex ].lastTime;
+}
+
+
+// FindPass                                     //
+// Returns a passes index - optionally adds it  //
+int ProfilerClass::FindPass( const char* passName, bool create ) {
+	for( int i = 0; i < mPassCount; i++ ) {
+		if( strcmp( mPasses[ i ].name, passName ) == 0 ) {
+			return i;
+		}
+	}
+
+	// Not found
+	if( ( !create ) || ( mPassCount >= PROFILER_MAX_PASSES ) ) {
+		return -1;
+	}
+
+	strncpy_s( mPasses[ mPassCount ].name, sizeof( mPasses[ mPassCount ].name ), passName, _TRUNCATE );
+	mPasses[ mPassCount ].lastTime = 0.0f;
+	mPassCount++;
+
+	return mPassCount - 1;
+}
+
+
+// ReadBackFrame                                                 //
+// Resolves a frames timestamps into milliseconds                //
+// Without wait a frame the GPU hasnt finished is dropped - the  //
+// slot is about to be reused. Returns false if nothing was read //
+bool ProfilerClass::ReadBackFrame( ID3D11DeviceContext* deviceContext, int frameIndex, bool wait ) {
+	FrameQueryType& frame = mFrames[ frameIndex ];
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjointData;
+	UINT64 begin, end;
+	float frequency;
+	HRESULT result;
+
+	// Check for the disjoint data - it ends after every timestamp in the frame
+	if( wait ) {
+		do {
+			result = deviceContext->GetData( frame.pDisjoint, &disjointData, sizeof( disjointData ), 0 );
+		} while( result == S_FALSE );
+	} else {
+		result = deviceContext->GetData( frame.pDisjoint, &disjointData, sizeof( disjointData ), D3D11_ASYNC_GETDATA_DONOTFLUSH );
+	}
+
+	frame.issued = false;
+
+	// Not ready in time or failed - drop it
+	if( result != S_OK ) {
+		if( frame.captured ) {
+			mDroppedFrames++;
+		}
+		return false;
+	}
+
+	// The clock changed frequency mid frame - throw it away
+	if( disjointData.Disjoint ) {
+		return false;
+	}
+
+	frequency = ( float )disjointData.Frequency / 1000.0f;
+
+	// Whole frame
+	deviceContext->GetData( frame.pFrameBegin, &begin, sizeof( UINT64 ), D3D11_ASYNC_GETDATA_DONOTFLUSH );
+	deviceContext->GetData( frame.pFrameEnd, &end, sizeof( UINT64 ), D3D11_ASYNC_GETDATA_DONOTFLUSH );
+	mLastFrameTime = ( float )( end - begin ) / frequency;
+	if( frame.captured ) {
+		mFrameSamples.push_back( mLastFrameTime );
+	}
+
+	// Each pass used this frame
+	for( int i = 0; i < mPassCount; i++ ) {
+		if( !frame.passUsed[ i ] ) {
+			continue;
+		}
+
+		deviceContext->GetData( frame.pPassBegin[ i ], &begin, sizeof( UINT64 ), D3D11_ASYNC_GETDATA_DONOTFLUSH );
+		deviceContext->GetData( frame.pPassEnd[ i ], &end, sizeof( UINT64 ), D3D11_ASYNC_GETDATA_DONOTFLUSH );
+		mPasses[ i ].lastTime = ( float )( end - begin ) / frequency;
+
+		if( frame.captured ) {
+			mPasses[ i ].samples.push_back( mPasses[ i ].lastTime );
+		}
+	}
+
+	return true;
+}
+
+
+// WritePercentiles                      //
+// Sorts a copy of the samples and writes //
+// mean / p50 / p90 / p95 / p99 / max     //
+void ProfilerClass::WritePercentiles( FILE* filePtr, const char* name, std::vector< float >& samples ) {
+	if( samples.empty() ) {
+		fprintf( filePtr, "%-24s %8s\n", name, "-" );
+		return;
+	}
+
+	std::vector< float > sorted( samples );
+	std::sort( sorted.begin(), sorted.end() );
+
+	// Mean
+	double total = 0.0;
+	for( int i = 0; i < ( int )sorted.size(); i++ ) {
+		total += sorted[ i ];
+	}
+
+	// Nearest rank percentiles
+	int last = ( int )sorted.size() - 1;
+	fprintf( filePtr, "%-24s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n",
+		     name,
+			 ( float )( total / sorted.size() ),
+			 sorted[ ( last * 50 ) / 100 ],
+			 sorted[ ( last * 90 ) / 100 ],
+			 sorted[ ( last * 95 ) / 100 ],
+			 sorted[ ( last * 99 ) / 100 ],
+			 sorted[ last ] );
+
+	return;
+}
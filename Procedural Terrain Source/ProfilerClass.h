@@ -0,0 +1,99 @@
+#ifndef _PROFILERCLASS_H_
+#define _PROFILERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+
+// Profiler Variables
+const int PROFILER_MAX_PASSES    = 16; // maximum number of named passes per frame
+const int PROFILER_FRAME_LATENCY = 3;  // frames in flight before query data is read back
+
+
+// ProfilerClass                                                    //
+// GPU frame profiler using D3D11 timestamp queries                 //
+// Each named pass is bracketed with BeginPass / EndPass            //
+// Results are read back PROFILER_FRAME_LATENCY frames later so the //
+// CPU never stalls on the GPU - a frame still not ready by then is //
+// dropped                                                          //
+// Frames issued while capturing are tagged, and only their pass    //
+// times are stored and written out as a percentile report          //
+class ProfilerClass {
+private:
+	// Per frame query data
+	struct FrameQueryType {
+		ID3D11Query* pDisjoint;
+		ID3D11Query* pFrameBegin;
+		ID3D11Query* pFrameEnd;
+		ID3D11Query* pPassBegin[ PROFILER_MAX_PASSES ];
+		ID3D11Query* pPassEnd[ PROFILER_MAX_PASSES ];
+		bool passUsed[ PROFILER_MAX_PASSES ];
+		bool issued;
+		bool captured; // issued while capturing - samples are stored
+	};
+
+	// Per pass data
+	struct PassType {
+		char name[ 32 ];
+		float lastTime;
+		std::vector< float > samples;
+	};
+
+public:
+	ProfilerClass();
+	ProfilerClass( const ProfilerClass& other );
+	~ProfilerClass();
+
+	bool Initialize( ID3D11Device* device );
+	void Shutdown();
+
+	// Frame functions
+	void BeginFrame( ID3D11DeviceContext* deviceContext );
+	void EndFrame( ID3D11DeviceContext* deviceContext );
+
+	// Pass functions
+	void BeginPass( ID3D11DeviceContext* deviceContext, const char* passName );
+	void EndPass( ID3D11DeviceContext* deviceContext );
+
+	// Capture functions
+	void StartCapture();
+	void StopCapture();
+	bool IsCapturing();
+	void ReadBackPending( ID3D11DeviceContext* deviceContext );
+	bool WriteReport( const char* fileName, const char* title );
+
+	// Getters for the last resolved frame
+	float GetFrameTime();
+	float GetPassTime( const char* passName );
+
+private:
+	int  FindPass( const char* passName, bool create );
+	bool ReadBackFrame( ID3D11DeviceContext* deviceContext, int frameIndex, bool wait );
+	void WritePercentiles( FILE* filePtr, const char* name, std::vector< float >& samples );
+
+private:
+	// Query ring
+	FrameQueryType mFrames[ PROFILER_FRAME_LATENCY ];
+	int mCurrentFrame;
+	int mActivePass;
+
+	// Pass data
+	PassType mPasses[ PROFILER_MAX_PASSES ];
+	int mPassCount;
+
+	// Whole frame data
+	float mLastFrameTime;
+	std::vector< float > mFrameSamples;
+
+	// Capture data
+	bool mCapturing;
+	int mDroppedFrames;
+};
+
+
+#endif
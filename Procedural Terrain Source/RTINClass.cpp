@@ -0,0 +1,301 @@
+#include "RTINClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+RTINClass::RTINClass() :
+ mGridSize( 0 ), mTriangleCount( 0 ), mParentTriangleCount( 0 ), mMaxError( 0.0f ), pVertices( 0 ), pIndices( 0 ) {
+}
+
+
+// Constructor //
+RTINClass::RTINClass( const RTINClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+RTINClass::~RTINClass() {
+}
+
+
+// Initialize                                            //
+// Precomputes the hypotenuse of every triangle in the   //
+// hierarchy - triangle i has id i + 2, the low bit of   //
+// each id picks the left or right child of its parent   //
+bool RTINClass::Initialize( int gridSize ) {
+	int tileSize, id, ax, ay, bx, by, cx, cy, mx, my;
+
+	// Must be (2^n) + 1
+	tileSize = gridSize - 1;
+	if( tileSize < 2 || ( tileSize & ( tileSize - 1 ) ) != 0 || gridSize > 0xFFFF ) {
+		return false;
+	}
+
+	mGridSize            = gridSize;
+	mTriangleCount       = ( tileSize * tileSize * 2 ) - 2;
+	mParentTriangleCount = mTriangleCount - ( tileSize * tileSize );
+
+	mCoordinates.resize( mTriangleCount * 4 );
+	mErrors.resize( gridSize * gridSize );
+	mVertexMap.resize( gridSize * gridSize );
+
+	for( int i = 0; i < mTriangleCount; i++ ) {
+		id = i + 2;
+		ax = ay = bx = by = cx = cy = 0;
+
+		// The two root triangles split the square along its diagonal
+		if( id & 1 ) {
+			bx = by = cx = tileSize;
+		} else {
+			ax = ay = cy = tileSize;
+		}
+
+		// Walk down to this triangle
+		while( ( id >>= 1 ) > 1 ) {
+			mx = ( ax + bx ) >> 1;
+			my = ( ay + by ) >> 1;
+
+			if( id & 1 ) {
+				// Left child
+				bx = ax;
+				by = ay;
+				ax = cx;
+				ay = cy;
+			} else {
+				// Right child
+				ax = bx;
+				ay = by;
+				bx = cx;
+				by = cy;
+			}
+
+			cx = mx;
+			cy = my;
+		}
+
+		mCoordinates[ ( i * 4 ) ]     = ( unsigned short )ax;
+		mCoordinates[ ( i * 4 ) + 1 ] = ( unsigned short )ay;
+		mCoordinates[ ( i * 4 ) + 2 ] = ( unsigned short )bx;
+		mCoordinates[ ( i * 4 ) + 3 ] = ( unsigned short )by;
+	}
+
+	return true;
+}
+
+
+// Shutdown //
+void RTINClass::Shutdown() {
+	mCoordinates.clear();
+	mErrors.clear();
+	mVertexMap.clear();
+
+	return;
+}
+
+
+// ComputeErrors                                         //
+// Smallest triangles first so a parent can take the     //
+// larger of its own error and its childrens' - the two  //
+// triangles sharing a hypotenuse share its split point  //
+// so they always split together and the mesh has no     //
+// T-junctions                                           //
+void RTINClass::ComputeErrors( const float* heights ) {
+	int ax, ay, bx, by, cx, cy, mx, my, middleIndex, leftIndex, rightIndex;
+	float triangleError;
+
+	for( int i = 0; i < ( int )mErrors.size(); i++ ) {
+		mErrors[ i ] = 0.0f;
+	}
+
+	for( int i = mTriangleCount - 1; i >= 0; i-- ) {
+		ax = mCoordinates[ ( i * 4 ) ];
+		ay = mCoordinates[ ( i * 4 ) + 1 ];
+		bx = mCoordinates[ ( i * 4 ) + 2 ];
+		by = mCoordinates[ ( i * 4 ) + 3 ];
+
+		// Split point and right angle corner
+		mx = ( ax + bx ) >> 1;
+		my = ( ay + by ) >> 1;
+		cx = mx + my - ay;
+		cy = my + ax - mx;
+
+		// Error of drawing this triangle unsplit - every sample it covers,
+		// not just the split point, so a leaf is always within the limit
+		triangleError = GetTriangleError( heights, ax, ay, bx, by, cx, cy );
+		middleIndex = ( my * mGridSize ) + mx;
+
+		if( triangleError > mErrors[ middleIndex ] ) {
+			mErrors[ middleIndex ] = triangleError;
+		}
+
+		// Fold in the children (their split points are the mid points of the legs)
+		if( i < mParentTriangleCount ) {
+			leftIndex  = ( ( ( ay + cy ) >> 1 ) * mGridSize ) + ( ( ax + cx ) >> 1 );
+			rightIndex = ( ( ( by + cy ) >> 1 ) * mGridSize ) + ( ( bx + cx ) >> 1 );
+
+			if( mErrors[ leftIndex ] > mErrors[ middleIndex ] ) {
+				mErrors[ middleIndex ] = mErrors[ leftIndex ];
+			}
+			if( mErrors[ rightIndex ] > mErrors[ middleIndex ] ) {
+				mErrors[ middleIndex ] = mErrors[ rightIndex ];
+			}
+		}
+	}
+
+	return;
+}
+
+
+// BuildMesh                                      //
+// Starts from the two root triangles - vertices  //
+// are shared between every triangle using them   //
+void RTINClass::BuildMesh( float maxError, std::vector< unsigned long >& vertices, std::vector< unsigned long >& indices ) {
+	int tileSize = mGridSize - 1;
+
+	vertices.clear();
+	indices.clear();
+
+	for( int i = 0; i < ( int )mVertexMap.size(); i++ ) {
+		mVertexMap[ i ] = -1;
+	}
+
+	mMaxError = maxError;
+	pVertices = &vertices;
+	pIndices  = &indices;
+
+	BuildTriangle( 0, 0, tileSize, tileSize, tileSize, 0 );
+	BuildTriangle( tileSize, tileSize, 0, 0, 0, tileSize );
+
+	pVertices = 0;
+	pIndices  = 0;
+
+	return;
+}
+
+
+// MeasureError                       //
+// Largest error over every triangle  //
+float RTINClass::MeasureError( const float* heights, const std::vector< unsigned long >& vertices, const std::vector< unsigned long >& indices ) {
+	int x[ 3 ], y[ 3 ];
+	float error, maxError;
+
+	maxError = 0.0f;
+
+	for( int t = 0; t < ( int )indices.size(); t += 3 ) {
+		for( int k = 0; k < 3; k++ ) {
+			x[ k ] = vertices[ indices[ t + k ] ] % mGridSize;
+			y[ k ] = vertices[ indices[ t + k ] ] / mGridSize;
+		}
+
+		error = GetTriangleError( heights, x[ 0 ], y[ 0 ], x[ 1 ], y[ 1 ], x[ 2 ], y[ 2 ] );
+		if( error > maxError ) {
+			maxError = error;
+		}
+	}
+
+	return maxError;
+}
+
+
+// GetTriangleError                                      //
+// Interpolates the triangle over the samples it covers  //
+// and returns the largest difference                    //
+float RTINClass::GetTriangleError( const float* heights, int ax, int ay, int bx, int by, int cx, int cy ) {
+	int minX, maxX, minY, maxY;
+	float ha, hb, hc, area, wa, wb, wc, error, maxError;
+
+	ha = heights[ ( ay * mGridSize ) + ax ];
+	hb = heights[ ( by * mGridSize ) + bx ];
+	hc = heights[ ( cy * mGridSize ) + cx ];
+
+	// Bounding box
+	minX = ( ax < bx ) ? ax : bx;
+	minX = ( cx < minX ) ? cx : minX;
+	maxX = ( ax > bx ) ? ax : bx;
+	maxX = ( cx > maxX ) ? cx : maxX;
+	minY = ( ay < by ) ? ay : by;
+	minY = ( cy < minY ) ? cy : minY;
+	maxY = ( ay > by ) ? ay : by;
+	maxY = ( cy > maxY ) ? cy : maxY;
+
+	area = ( float )( ( ( bx - ax ) * ( cy - ay ) ) - ( ( cx - ax ) * ( by - ay ) ) );
+	maxError = 0.0f;
+
+	// Barycentric weights of each sample - skip those outside
+	for( int j = minY; j <= maxY; j++ ) {
+		for( int i = minX; i <= maxX; i++ ) {
+			wa = ( float )( ( ( bx - i ) * ( cy - j ) ) - ( ( cx - i ) * ( by - j ) ) ) / area;
+			wb = ( float )( ( ( cx - i ) * ( ay - j ) ) - ( ( ax - i ) * ( cy - j ) ) ) / area;
+			wc = 1.0f - wa - wb;
+
+			if( wa < 0.0f || wb < 0.0f || wc < -1.0e-6f ) {
+				continue;
+			}
+
+			error = fabs( ( ( wa * ha ) + ( wb * hb ) + ( wc * hc ) ) - heights[ ( j * mGridSize ) + i ] );
+			if( error > maxError ) {
+				maxError = error;
+			}
+		}
+	}
+
+	return maxError;
+}
+
+
+// BuildTriangle                                        //
+// (a, b) is the hypotenuse and c the right angle       //
+// Splits while the triangle is bigger than one cell    //
+// and dropping its split point would exceed the limit  //
+void RTINClass::BuildTriangle( int ax, int ay, int bx, int by, int cx, int cy ) {
+	int mx, my;
+
+	mx = ( ax + bx ) >> 1;
+	my = ( ay + by ) >> 1;
+
+	if( ( abs( ax - cx ) + abs( ay - cy ) ) > 1 && mErrors[ ( my * mGridSize ) + mx ] > mMaxError ) {
+		BuildTriangle( cx, cy, ax, ay, mx, my );
+		BuildTriangle( bx, by, cx, cy, mx, my );
+	} else {
+		AddTriangle( ax, ay, bx, by, cx, cy );
+	}
+
+	return;
+}
+
+
+// AddTriangle                                              //
+// The uniform grid's triangles have a negative x / z cross //
+// product - swap two corners of any that dont match        //
+void RTINClass::AddTriangle( int ax, int ay, int bx, int by, int cx, int cy ) {
+	int cross;
+
+	cross = ( ( bx - ax ) * ( cy - ay ) ) - ( ( by - ay ) * ( cx - ax ) );
+
+	pIndices->push_back( AddVertex( ax, ay ) );
+	if( cross > 0 ) {
+		pIndices->push_back( AddVertex( cx, cy ) );
+		pIndices->push_back( AddVertex( bx, by ) );
+	} else {
+		pIndices->push_back( AddVertex( bx, by ) );
+		pIndices->push_back( AddVertex( cx, cy ) );
+	}
+
+	return;
+}
+
+
+// AddVertex                          //
+// Returns the vertex for a grid point //
+// adding it the first time it is used //
+unsigned long RTINClass::AddVertex( int x, int y ) {
+	int gridIndex = ( y * mGridSize ) + x;
+
+	if( mVertexMap[ gridIndex ] < 0 ) {
+		mVertexMap[ gridIndex ] = ( long )pVertices->size();
+		pVertices->push_back( ( unsigned long )gridIndex );
+	}
+
+	return ( unsigned long )mVertexMap[ gridIndex ];
+}
@@ -0,0 +1,71 @@
+#ifndef _RTINCLASS_H_
+#define _RTINCLASS_H_
+
+
+// Includes //
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+
+// RTINClass                                                              //
+// Right-triangulated irregular network over a (2^n) + 1 square height    //
+// map (the Martini approach)                                             //
+// Every triangle in the hierarchy is a right isosceles triangle split    //
+// at the midpoint of its hypotenuse - ComputeErrors walks the hierarchy  //
+// bottom up storing, at each split point, the largest height error of   //
+// that triangle (over every sample it covers) and all its children      //
+// BuildMesh then only splits a triangle whose error is above the limit,  //
+// so flat ground collapses to a few large triangles while the mesh stays //
+// within maxError of every height sample and has no cracks               //
+class RTINClass {
+public:
+	RTINClass();
+	RTINClass( const RTINClass& other );
+	~RTINClass();
+
+	// gridSize must be (2^n) + 1 - the terrain uses 257
+	bool Initialize( int gridSize );
+	void Shutdown();
+
+	// ComputeErrors                                 //
+	// Builds the error hierarchy for gridSize *      //
+	// gridSize row major heights (index = z * size + x) //
+	void ComputeErrors( const float* heights );
+
+	// BuildMesh                                                  //
+	// vertices - grid index of each vertex used by the mesh       //
+	// indices  - triangle list into vertices, wound like the      //
+	//            terrain's uniform grid                           //
+	void BuildMesh( float maxError, std::vector< unsigned long >& vertices, std::vector< unsigned long >& indices );
+
+	// MeasureError                                              //
+	// Largest difference between a height sample and the mesh   //
+	// surface above it - checks BuildMesh kept to maxError       //
+	float MeasureError( const float* heights, const std::vector< unsigned long >& vertices, const std::vector< unsigned long >& indices );
+
+private:
+	float GetTriangleError( const float* heights, int ax, int ay, int bx, int by, int cx, int cy );
+	void BuildTriangle( int ax, int ay, int bx, int by, int cx, int cy );
+	void AddTriangle( int ax, int ay, int bx, int by, int cx, int cy );
+	unsigned long AddVertex( int x, int y );
+
+private:
+	int mGridSize;
+	int mTriangleCount, mParentTriangleCount;
+
+	// Hypotenuse end points (ax, ay, bx, by) of every triangle in the hierarchy
+	std::vector< unsigned short > mCoordinates;
+
+	// Error stored at each triangle's split point
+	std::vector< float > mErrors;
+
+	// BuildMesh state
+	float mMaxError;
+	std::vector< long > mVertexMap;
+	std::vector< unsigned long >* pVertices;
+	std::vector< unsigned long >* pIndices;
+};
+
+
+#endif
@@ -0,0 +1,93 @@
+#include "ScatterClass.h"
+
+
+// Default Constructor //
+ScatterClass::ScatterClass() {
+}
+
+
+// Constructor //
+ScatterClass::ScatterClass( const ScatterClass& other ) {
+}
+
+
+// Destructor //
+ScatterClass::~ScatterClass() {
+}
+
+
+// Generate                                             //
+// Returns the number of instances added for this layer //
+int ScatterClass::Generate( TerrainClass* terrain,
+	                        D3DXVECTOR3 terrainOffset,
+							const ScatterLayerType& layer,
+							unsigned int seed,
+							int maxInstances,
+							std::vector< ScatterInstanceType >& instances ) {
+	ScatterInstanceType instance;
+	D3DXVECTOR3 normal;
+	float x, z, y, height, slope;
+	int width, depth, added;
+	unsigned int state;
+
+	// Grid size in points - one fewer cell each way
+	width = terrain->GetTerrainWidth();
+	depth = terrain->GetTerrainHeight();
+
+	state = seed;
+	added = 0;
+
+	for( int j = 0; j < ( depth - 1 ); j++ ) {
+		for( int i = 0; i < ( width - 1 ); i++ ) {
+			// Roll against the density first - most cells are empty
+			if( RandomFloat( state ) >= layer.density ) {
+				continue;
+			}
+
+			// Jitter inside the cell
+			x = ( float )i + RandomFloat( state );
+			z = ( float )j + RandomFloat( state );
+
+			// Height and slope as Terrain.ps sees them
+			y = terrain->GetHeightAt( x, z );
+			terrain->GetNormalAt( x, z, normal );
+
+			height = ( y + terrainOffset.y ) / SCATTER_WORLD_HEIGHT;
+			slope  = 1.0f - normal.y;
+
+			// Keep the remaining rolls in step whether or not the cell is used
+			instance.scale    = layer.minScale + ( layer.maxScale - layer.minScale ) * RandomFloat( state );
+			instance.rotation = ( float )D3DX_PI * 2.0f * RandomFloat( state );
+
+			if( ( height < layer.minHeight ) || ( height > layer.maxHeight ) ) {
+				continue;
+			}
+
+			if( ( slope < layer.minSlope ) || ( slope > layer.maxSlope ) ) {
+				continue;
+			}
+
+			// Stop once the instance buffer is full
+			if( ( int )instances.size() >= maxInstances ) {
+				return added;
+			}
+
+			instance.position = D3DXVECTOR3( x, y, z ) + terrainOffset;
+			instance.radius   = layer.radius * instance.scale;
+
+			instances.push_back( instance );
+			added++;
+		}
+	}
+
+	return added;
+}
+
+
+// RandomFloat                          //
+// LCG returning a float from 0 to < 1  //
+float ScatterClass::RandomFloat( unsigned int& state ) {
+	state = state * 1664525u + 1013904223u;
+
+	return ( float )( state >> 8 ) / 16777216.0f;
+}
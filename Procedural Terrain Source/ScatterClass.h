@@ -0,0 +1,64 @@
+#ifndef _SCATTERCLASS_H_
+#define _SCATTERCLASS_H_
+
+
+// Includes //
+#include <d3dx10math.h>
+#include <vector>
+
+
+// Application Includes //
+#include "TerrainClass.h"
+
+
+// Scatter Variables
+const float SCATTER_WORLD_HEIGHT = 16.0f; // same height normalisation as Terrain.ps
+
+
+// ScatterClass                                                         //
+// Places instances over the terrain using the same height and slope   //
+// bands as Terrain.ps - height is world y / 16 and slope is 1 - ny     //
+// Each grid cell rolls once against the layer density and the instance //
+// is jittered inside the cell then dropped onto the surface            //
+// Uses its own seeded generator so layouts are repeatable and do not   //
+// disturb the rand() sequence used by the terrain                      //
+class ScatterClass {
+public:
+	// Placement rules for one kind of prop
+	struct ScatterLayerType {
+		float minHeight, maxHeight; // normalised height band (0 - 1)
+		float minSlope, maxSlope;   // slope band (0 flat - 1 vertical)
+		float density;              // chance of an instance per grid cell
+		float minScale, maxScale;   // uniform scale range
+		float radius;               // model bounding radius at scale 1
+	};
+
+	// One placed instance
+	struct ScatterInstanceType {
+		D3DXVECTOR3 position;
+		float scale;
+		float rotation;
+		float radius;
+	};
+
+public:
+	ScatterClass();
+	ScatterClass( const ScatterClass& other );
+	~ScatterClass();
+
+	// Generate                                                       //
+	// Appends instances for one layer - positions are in world space //
+	// using the terrain's world translation                          //
+	static int Generate( TerrainClass* terrain,
+		                 D3DXVECTOR3 terrainOffset,
+						 const ScatterLayerType& layer,
+						 unsigned int seed,
+						 int maxInstances,
+						 std::vector< ScatterInstanceType >& instances );
+
+private:
+	static float RandomFloat( unsigned int& state );
+};
+
+
+#endif
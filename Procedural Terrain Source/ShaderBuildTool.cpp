@@ -0,0 +1,27 @@
+// ShaderBuildTool                                                //
+// Offline shader build step - run as a post build event from the //
+// directory holding the HLSL files so the game starts with a     //
+// warm ShaderCache                                               //
+#include "ShaderCacheClass.h"
+
+
+int main() {
+	int builtCount, failedCount;
+	bool result;
+
+	// Compile every shader in the project list into the cache
+	result = ShaderCacheClass::BuildAll( builtCount, failedCount );
+
+	printf( "Shaders cached = %d, failed = %d (%d already up to date, %.1f ms)\n",
+		    builtCount,
+			failedCount,
+			ShaderCacheClass::GetHitCount(),
+			ShaderCacheClass::GetLoadTime() );
+
+	// Non zero exit fails the build
+	if( !result ) {
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,405 @@
+#include "ShaderCacheClass.h"
+
+
+// Compile flags used by every shader class
+static const UINT SHADER_COMPILE_FLAGS = D3D10_SHADER_ENABLE_STRICTNESS;
+
+// Version of the cache key - bump to invalidate every cached blob
+static const unsigned int SHADER_CACHE_VERSION = 2;
+
+// Every shader the project loads - compiled by the offline build step
+// The blur shaders' classes are not in this tree and still compile their own
+static ShaderCacheClass::ShaderEntryType SHADER_LIST[] = {
+	{ L"Terrain.vs",           "TerrainVertexShader",           "vs_5_0" },
+	{ L"Terrain.ps",           "TerrainPixelShader",            "ps_5_0" },
+	{ L"TerrainReflection.vs", "TerrainReflectionVertexShader", "vs_5_0" },
+	{ L"TerrainReflection.ps", "TerrainReflectionPixelShader",  "ps_5_0" },
+	{ L"Ocean.vs",             "OceanVertexShader",             "vs_5_0" },
+	{ L"Ocean.ps",             "OceanPixelShader",              "ps_5_0" },
+	{ L"HorizontalBlur.vs",    "HorizontalBlurVertexShader",    "vs_5_0" },
+	{ L"HorizontalBlur.ps",    "HorizontalBlurPixelShader",     "ps_5_0" },
+	{ L"VerticalBlur.vs",      "VerticalBlurVertexShader",      "vs_5_0" },
+	{ L"VerticalBlur.ps",      "VerticalBlurPixelShader",       "ps_5_0" },
+	{ L"Instance.vs",          "InstanceVertexShader",          "vs_5_0" },
+	{ L"Instance.ps",          "InstancePixelShader",           "ps_5_0" },
+	{ L"TextBatch.vs",         "TextBatchVertexShader",         "vs_5_0" },
+	{ L"TextBatch.ps",         "TextBatchPixelShader",          "ps_5_0" },
+	{ L"Shadow.vs",            "ShadowVertexShader",            "vs_5_0" },
+};
+
+
+// Statistics
+int ShaderCacheClass::mHitCount   = 0;
+int ShaderCacheClass::mMissCount  = 0;
+LONGLONG ShaderCacheClass::mLoadTicks = 0;
+
+
+// LoadShader                                              //
+// Preprocesses the source (expanding its includes), hashes //
+// that and looks for a matching cache file                 //
+// Falls back to compiling (and caching) on a miss          //
+bool ShaderCacheClass::LoadShader( WCHAR* fileName,
+	                               char* entryPoint,
+								   char* profile,
+								   const D3D10_SHADER_MACRO* defines,
+								   ID3D10Blob** shaderBuffer,
+								   ID3D10Blob** errorMessage ) {
+	LARGE_INTEGER startTime, endTime;
+	WCHAR cacheFileName[ MAX_PATH ];
+	char sourceName[ MAX_PATH ];
+	char* source;
+	unsigned int sourceSize;
+	ID3D10Blob* preprocessed;
+	unsigned __int64 key;
+	HRESULT result;
+	bool cached;
+
+	QueryPerformanceCounter( &startTime );
+
+	*shaderBuffer = 0;
+	if( errorMessage ) {
+		*errorMessage = 0;
+	}
+
+	// Read in the HLSL source - needed for the key even on a hit
+	if( !ReadSource( fileName, &source, sourceSize ) ) {
+		return false;
+	}
+
+	// Name used in compiler messages
+	WideCharToMultiByte( CP_ACP, 0, fileName, -1, sourceName, MAX_PATH, NULL, NULL );
+
+	// Expand the includes and defines - the key covers everything compiled
+	ShaderIncludeClass include( fileName );
+	result = D3DPreprocess( source, sourceSize, sourceName, defines, &include, &preprocessed, errorMessage );
+
+	// Release the source
+	delete [] source;
+	source = 0;
+
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Build the cache file name from the key
+	key = HashShader( ( char* )preprocessed->GetBufferPointer(), ( unsigned int )preprocessed->GetBufferSize(), entryPoint, profile, defines );
+	GetCacheFileName( key, cacheFileName, MAX_PATH );
+
+	// Try the cache first
+	cached = ReadCache( cacheFileName, shaderBuffer );
+	if( cached ) {
+		mHitCount++;
+	} else {
+		mMissCount++;
+
+		// Cache miss - compile the preprocessed source already in memory
+		result = D3DCompile( preprocessed->GetBufferPointer(), preprocessed->GetBufferSize(), sourceName, NULL, NULL, entryPoint, profile, SHADER_COMPILE_FLAGS, 0, shaderBuffer, errorMessage );
+		if( FAILED( result ) ) {
+			preprocessed->Release();
+			preprocessed = 0;
+			return false;
+		}
+
+		// Store for next time - failing to write only costs a recompile
+		WriteCache( cacheFileName, *shaderBuffer );
+	}
+
+	// Release the preprocessed source
+	preprocessed->Release();
+	preprocessed = 0;
+
+	QueryPerformanceCounter( &endTime );
+	mLoadTicks += ( endTime.QuadPart - startTime.QuadPart );
+
+	return true;
+}
+
+
+// BuildAll                                         //
+// Offline step - compiles and caches SHADER_LIST   //
+bool ShaderCacheClass::BuildAll( int& builtCount, int& failedCount ) {
+	ID3D10Blob* shaderBuffer;
+	ID3D10Blob* errorMessage;
+	int shaderCount;
+
+	builtCount = failedCount = 0;
+	shaderCount = sizeof( SHADER_LIST ) / sizeof( SHADER_LIST[ 0 ] );
+
+	for( int i = 0; i < shaderCount; i++ ) {
+		if( LoadShader( SHADER_LIST[ i ].fileName, SHADER_LIST[ i ].entryPoint, SHADER_LIST[ i ].profile, NULL, &shaderBuffer, &errorMessage ) ) {
+			shaderBuffer->Release();
+			shaderBuffer = 0;
+			builtCount++;
+		} else {
+			// Print the compiler output
+			if( errorMessage ) {
+				printf( "%S (%s):\n%s\n", SHADER_LIST[ i ].fileName, SHADER_LIST[ i ].entryPoint, ( char* )errorMessage->GetBufferPointer() );
+			} else {
+				printf( "%S: missing shader file\n", SHADER_LIST[ i ].fileName );
+			}
+			failedCount++;
+		}
+
+		if( errorMessage ) {
+			errorMessage->Release();
+			errorMessage = 0;
+		}
+	}
+
+	return ( failedCount == 0 );
+}
+
+
+// GetHitCount //
+int ShaderCacheClass::GetHitCount() {
+	return mHitCount;
+}
+
+
+// GetMissCount //
+int ShaderCacheClass::GetMissCount() {
+	return mMissCount;
+}
+
+
+// GetLoadTime                                   //
+// Total time spent in LoadShader (milliseconds) //
+float ShaderCacheClass::GetLoadTime() {
+	LARGE_INTEGER frequency;
+
+	QueryPerformanceFrequency( &frequency );
+
+	return ( float )( ( double )mLoadTicks * 1000.0 / ( double )frequency.QuadPart );
+}
+
+
+// ResetStatistics //
+void ShaderCacheClass::ResetStatistics() {
+	mHitCount = mMissCount = 0;
+	mLoadTicks = 0;
+}
+
+
+// ReadSource                        //
+// Loads a whole HLSL file to memory //
+bool ShaderCacheClass::ReadSource( WCHAR* fileName, char** source, unsigned int& sourceSize ) {
+	FILE* filePtr;
+	unsigned int count;
+	int error;
+	long size;
+
+	// Open the shader file in binary
+	error = _wfopen_s( &filePtr, fileName, L"rb" );
+	if( error != 0 ) {
+		return false;
+	}
+
+	// Get the file size
+	fseek( filePtr, 0, SEEK_END );
+	size = ftell( filePtr );
+	fseek( filePtr, 0, SEEK_SET );
+	if( size <= 0 ) {
+		fclose( filePtr );
+		return false;
+	}
+
+	// Read in the source
+	*source = new char[ size ];
+	if( !*source ) {
+		fclose( filePtr );
+		return false;
+	}
+
+	count = fread( *source, 1, size, filePtr );
+	fclose( filePtr );
+	if( count != ( unsigned int )size ) {
+		delete [] *source;
+		*source = 0;
+		return false;
+	}
+
+	sourceSize = ( unsigned int )size;
+
+	return true;
+}
+
+
+// HashShader                                                 //
+// 64bit FNV-1a over everything that changes the bytecode     //
+unsigned __int64 ShaderCacheClass::HashShader( const char* source,
+	                                           unsigned int sourceSize,
+											   const char* entryPoint,
+											   const char* profile,
+											   const D3D10_SHADER_MACRO* defines ) {
+	const unsigned __int64 prime = 1099511628211ULL;
+	unsigned __int64 hash = 14695981039346656037ULL;
+	unsigned int i;
+
+	// Source
+	for( i = 0; i < sourceSize; i++ ) {
+		hash = ( hash ^ ( unsigned char )source[ i ] ) * prime;
+	}
+
+	// Entry point and profile (including terminators as separators)
+	for( i = 0; i <= strlen( entryPoint ); i++ ) {
+		hash = ( hash ^ ( unsigned char )entryPoint[ i ] ) * prime;
+	}
+	for( i = 0; i <= strlen( profile ); i++ ) {
+		hash = ( hash ^ ( unsigned char )profile[ i ] ) * prime;
+	}
+
+	// Defines - list is terminated by a NULL name
+	if( defines ) {
+		for( ; defines->Name; defines++ ) {
+			for( i = 0; i <= strlen( defines->Name ); i++ ) {
+				hash = ( hash ^ ( unsigned char )defines->Name[ i ] ) * prime;
+			}
+			if( defines->Definition ) {
+				for( i = 0; i <= strlen( defines->Definition ); i++ ) {
+					hash = ( hash ^ ( unsigned char )defines->Definition[ i ] ) * prime;
+				}
+			}
+		}
+	}
+
+	// Flags and cache version
+	hash = ( hash ^ SHADER_COMPILE_FLAGS ) * prime;
+	hash = ( hash ^ SHADER_CACHE_VERSION ) * prime;
+
+	return hash;
+}
+
+
+// GetCacheFileName                      //
+// ShaderCache\<16 hex digit key>.cso     //
+void ShaderCacheClass::GetCacheFileName( unsigned __int64 key, WCHAR* cacheFileName, int length ) {
+	swprintf_s( cacheFileName, length, L"%s\\%016I64x.cso", SHADER_CACHE_DIRECTORY, key );
+}
+
+
+// ReadCache                                     //
+// Loads a cached blob - false if it isnt there  //
+bool ShaderCacheClass::ReadCache( WCHAR* cacheFileName, ID3D10Blob** shaderBuffer ) {
+	FILE* filePtr;
+	unsigned int count;
+	long size;
+	HRESULT result;
+	int error;
+
+	// Open the cache file in binary
+	error = _wfopen_s( &filePtr, cacheFileName, L"rb" );
+	if( error != 0 ) {
+		return false;
+	}
+
+	// Get the file size
+	fseek( filePtr, 0, SEEK_END );
+	size = ftell( filePtr );
+	fseek( filePtr, 0, SEEK_SET );
+	if( size <= 0 ) {
+		fclose( filePtr );
+		return false;
+	}
+
+	// Create a blob to hold the bytecode
+	result = D3DCreateBlob( size, shaderBuffer );
+	if( FAILED( result ) ) {
+		fclose( filePtr );
+		return false;
+	}
+
+	// Read in the bytecode
+	count = fread( ( *shaderBuffer )->GetBufferPointer(), 1, size, filePtr );
+	fclose( filePtr );
+	if( count != ( unsigned int )size ) {
+		( *shaderBuffer )->Release();
+		*shaderBuffer = 0;
+		return false;
+	}
+
+	return true;
+}
+
+
+// WriteCache                                       //
+// Stores a blob, creating the directory if needed  //
+bool ShaderCacheClass::WriteCache( WCHAR* cacheFileName, ID3D10Blob* shaderBuffer ) {
+	FILE* filePtr;
+	unsigned int count;
+	int error;
+
+	// Fine if it already exists
+	CreateDirectory( SHADER_CACHE_DIRECTORY, NULL );
+
+	// Open the cache file in binary
+	error = _wfopen_s( &filePtr, cacheFileName, L"wb" );
+	if( error != 0 ) {
+		return false;
+	}
+
+	// Write out the bytecode
+	count = fwrite( shaderBuffer->GetBufferPointer(), 1, shaderBuffer->GetBufferSize(), filePtr );
+	fclose( filePtr );
+	if( count != shaderBuffer->GetBufferSize() ) {
+		// Dont leave a truncated blob behind
+		_wremove( cacheFileName );
+		return false;
+	}
+
+	return true;
+}
+
+
+// ShaderIncludeClass                          //
+// Keeps the directory of the shader file name //
+ShaderCacheClass::ShaderIncludeClass::ShaderIncludeClass( WCHAR* shaderFileName ) {
+	WCHAR* separator;
+
+	wcscpy_s( mDirectory, MAX_PATH, shaderFileName );
+
+	// Cut after the last separator - empty for the working directory
+	separator = wcsrchr( mDirectory, L'\\' );
+	if( !separator ) {
+		separator = wcsrchr( mDirectory, L'/' );
+	}
+
+	if( separator ) {
+		separator[ 1 ] = 0;
+	} else {
+		mDirectory[ 0 ] = 0;
+	}
+}
+
+
+// Open                                          //
+// Reads an included file next to the shader -   //
+// the compiler frees it again with Close        //
+HRESULT STDMETHODCALLTYPE ShaderCacheClass::ShaderIncludeClass::Open( D3D_INCLUDE_TYPE includeType, LPCSTR fileName, LPCVOID parentData, LPCVOID* data, UINT* bytes ) {
+	WCHAR includeName[ MAX_PATH ];
+	WCHAR includePath[ MAX_PATH ];
+	char* source;
+	unsigned int sourceSize;
+
+	if( !MultiByteToWideChar( CP_ACP, 0, fileName, -1, includeName, MAX_PATH ) ) {
+		return E_FAIL;
+	}
+
+	swprintf_s( includePath, MAX_PATH, L"%s%s", mDirectory, includeName );
+
+	if( !ReadSource( includePath, &source, sourceSize ) ) {
+		return E_FAIL;
+	}
+
+	*data  = source;
+	*bytes = sourceSize;
+
+	return S_OK;
+}
+
+
+// Close //
+HRESULT STDMETHODCALLTYPE ShaderCacheClass::ShaderIncludeClass::Close( LPCVOID data ) {
+	delete [] ( char* )data;
+
+	return S_OK;
+}
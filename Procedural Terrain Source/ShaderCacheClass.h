@@ -0,0 +1,86 @@
+#ifndef _SHADERCACHECLASS_H_
+#define _SHADERCACHECLASS_H_
+
+
+// Includes //
+#include <windows.h>
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#include <stdio.h>
+
+
+// Cache Directory
+const WCHAR SHADER_CACHE_DIRECTORY[] = L"ShaderCache";
+
+
+// ShaderCacheClass                                                          //
+// On-disk bytecode cache used by the shader classes in this tree            //
+// (Terrain, TerrainReflection, Ocean, Instance, TextBatch and Shadow) in    //
+// place of D3DX11CompileFromFile                                            //
+// Cache files are keyed by a hash of the preprocessed HLSL - #includes      //
+// expanded, so editing an included file misses too - plus the entry point, //
+// profile, compile flags and defines                                        //
+// The offline build step (ShaderBuildTool) calls BuildAll to fill the cache //
+// so those classes never compile at startup                                 //
+class ShaderCacheClass {
+public:
+	// Entry in the projects shader list
+	struct ShaderEntryType {
+		WCHAR* fileName;
+		char* entryPoint;
+		char* profile;
+	};
+
+private:
+	// Include handler for D3DPreprocess                //
+	// #include "file" and <file> are both read from    //
+	// the directory of the shader being loaded         //
+	class ShaderIncludeClass : public ID3DInclude {
+	public:
+		ShaderIncludeClass( WCHAR* shaderFileName );
+
+		STDMETHOD( Open )( D3D_INCLUDE_TYPE includeType, LPCSTR fileName, LPCVOID parentData, LPCVOID* data, UINT* bytes );
+		STDMETHOD( Close )( LPCVOID data );
+
+	private:
+		WCHAR mDirectory[ MAX_PATH ];
+	};
+
+public:
+	// LoadShader                                                  //
+	// Drop in replacement for D3DX11CompileFromFile in Initialize //
+	// Returns cached bytecode, or compiles and stores it on a miss //
+	static bool LoadShader( WCHAR* fileName,
+		                    char* entryPoint,
+							char* profile,
+							const D3D10_SHADER_MACRO* defines,
+							ID3D10Blob** shaderBuffer,
+							ID3D10Blob** errorMessage );
+
+	// Offline build - compiles every shader in the project list
+	static bool BuildAll( int& builtCount, int& failedCount );
+
+	// Startup statistics
+	static int GetHitCount();
+	static int GetMissCount();
+	static float GetLoadTime();
+	static void ResetStatistics();
+
+private:
+	static bool ReadSource( WCHAR* fileName, char** source, unsigned int& sourceSize );
+	static unsigned __int64 HashShader( const char* source,
+		                                unsigned int sourceSize,
+										const char* entryPoint,
+										const char* profile,
+										const D3D10_SHADER_MACRO* defines );
+	static void GetCacheFileName( unsigned __int64 key, WCHAR* cacheFileName, int length );
+	static bool ReadCache( WCHAR* cacheFileName, ID3D10Blob** shaderBuffer );
+	static bool WriteCache( WCHAR* cacheFileName, ID3D10Blob* shaderBuffer );
+
+private:
+	static int mHitCount, mMissCount;
+	static LONGLONG mLoadTicks;
+};
+
+
+#endif
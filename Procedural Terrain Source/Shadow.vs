@@ -0,0 +1,51 @@
+// Per-Pass Data - buffer 1
+// The cascade's light view and projection
+cbuffer PerPassBuffer : register(b1) {
+	matrix viewMatrix;
+	matrix projectionMatrix;
+	matrix reflectionMatrix;
+	float4 clipPlane;
+};
+
+// Per-Object Data - buffer 2
+cbuffer PerObjectBuffer : register(b2) {
+	matrix worldMatrix;
+};
+
+// Per-Terrain Data - buffer 3
+// x = grid width, y = minimum height, z = height range, w = texture coordinate step
+cbuffer PerTerrainBuffer : register(b3) {
+	float4 vertexDecode;
+};
+
+// Compact Vertex Data - only the height is used
+struct VertexInputType {
+	float height : POSITION;
+	uint vertexID : SV_VertexID;
+};
+
+// Pixel Data - depth only, there is no pixel shader
+struct PixelInputType {
+    float4 position : SV_POSITION;
+};
+
+// ShadowVS
+PixelInputType ShadowVertexShader( VertexInputType input ) {
+    PixelInputType output;
+	float4 position;
+	float gridWidth;
+
+	// Rebuild the grid position from the vertex index (as Terrain.vs)
+	gridWidth = vertexDecode.x;
+	position.x = ( float )( input.vertexID % ( uint )gridWidth );
+	position.z = ( float )( input.vertexID / ( uint )gridWidth );
+	position.y = vertexDecode.y + input.height * vertexDecode.z;
+	position.w = 1.0f;
+
+    // Into the cascade's light space
+    output.position = mul( position, worldMatrix );
+    output.position = mul( output.position, viewMatrix );
+    output.position = mul( output.position, projectionMatrix );
+
+    return output;
+}
@@ -0,0 +1,346 @@
+#include "ShadowMapClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+ShadowMapClass::ShadowMapClass()
+: pDepthTexture( 0 ), pShaderResourceView( 0 ), pComparisonSampler( 0 ), pRasterState( 0 ), mMapSize( 0 ), mCascadeCount( 0 ) {
+	for( int i = 0; i < SHADOW_MAX_CASCADES; i++ ) {
+		pDepthViews[ i ] = 0;
+		D3DXMatrixIdentity( &mViewMatrices[ i ] );
+		D3DXMatrixIdentity( &mProjectionMatrices[ i ] );
+		mSplits[ i ] = 0.0f;
+	}
+}
+
+
+// Constructor //
+ShadowMapClass::ShadowMapClass( const ShadowMapClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+ShadowMapClass::~ShadowMapClass() {
+}
+
+
+// Initialize                                        //
+// Typeless depth array so the same slices can be a  //
+// depth target and a shader resource                //
+bool ShadowMapClass::Initialize( ID3D11Device* device, int mapSize, int cascadeCount ) {
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_DEPTH_STENCIL_VIEW_DESC depthViewDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
+	D3D11_SAMPLER_DESC samplerDesc;
+	D3D11_RASTERIZER_DESC rasterDesc;
+	HRESULT result;
+
+	mMapSize      = mapSize;
+	mCascadeCount = ( cascadeCount < SHADOW_MAX_CASCADES ) ? cascadeCount : SHADOW_MAX_CASCADES;
+
+	// One slice per cascade
+	textureDesc.Width              = mMapSize;
+	textureDesc.Height             = mMapSize;
+	textureDesc.MipLevels          = 1;
+	textureDesc.ArraySize          = mCascadeCount;
+	textureDesc.Format             = DXGI_FORMAT_R32_TYPELESS;
+	textureDesc.SampleDesc.Count   = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage              = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags          = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags     = 0;
+	textureDesc.MiscFlags          = 0;
+
+	result = device->CreateTexture2D( &textureDesc, NULL, &pDepthTexture );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// A depth view for each slice
+	for( int i = 0; i < mCascadeCount; i++ ) {
+		depthViewDesc.Format                         = DXGI_FORMAT_D32_FLOAT;
+		depthViewDesc.ViewDimension                  = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+		depthViewDesc.Flags                          = 0;
+		depthViewDesc.Texture2DArray.MipSlice        = 0;
+		depthViewDesc.Texture2DArray.FirstArraySlice = i;
+		depthViewDesc.Texture2DArray.ArraySize       = 1;
+
+		result = device->CreateDepthStencilView( pDepthTexture, &depthViewDesc, &pDepthViews[ i ] );
+		if( FAILED( result ) ) {
+			return false;
+		}
+	}
+
+	// Every slice is read through one view
+	shaderResourceViewDesc.Format                         = DXGI_FORMAT_R32_FLOAT;
+	shaderResourceViewDesc.ViewDimension                  = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+	shaderResourceViewDesc.Texture2DArray.MostDetailedMip = 0;
+	shaderResourceViewDesc.Texture2DArray.MipLevels       = 1;
+	shaderResourceViewDesc.Texture2DArray.FirstArraySlice = 0;
+	shaderResourceViewDesc.Texture2DArray.ArraySize       = mCascadeCount;
+
+	result = device->CreateShaderResourceView( pDepthTexture, &shaderResourceViewDesc, &pShaderResourceView );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Bilinear comparison - each tap is already a 2x2 PCF, outside the map is lit
+	samplerDesc.Filter         = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+	samplerDesc.AddressU       = D3D11_TEXTURE_ADDRESS_BORDER;
+	samplerDesc.AddressV       = D3D11_TEXTURE_ADDRESS_BORDER;
+	samplerDesc.AddressW       = D3D11_TEXTURE_ADDRESS_BORDER;
+	samplerDesc.MipLODBias     = 0.0f;
+	samplerDesc.MaxAnisotropy  = 1;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+	samplerDesc.BorderColor[0] = 1.0f;
+	samplerDesc.BorderColor[1] = 1.0f;
+	samplerDesc.BorderColor[2] = 1.0f;
+	samplerDesc.BorderColor[3] = 1.0f;
+	samplerDesc.MinLOD         = 0;
+	samplerDesc.MaxLOD         = D3D11_FLOAT32_MAX;
+
+	result = device->CreateSamplerState( &samplerDesc, &pComparisonSampler );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Casters are drawn with a slope scaled bias against acne
+	// Both faces so thin ridges still cast
+	rasterDesc.AntialiasedLineEnable = false;
+	rasterDesc.CullMode              = D3D11_CULL_NONE;
+	rasterDesc.DepthBias             = SHADOW_DEPTH_BIAS;
+	rasterDesc.DepthBiasClamp        = 0.0f;
+	rasterDesc.DepthClipEnable       = true;
+	rasterDesc.FillMode              = D3D11_FILL_SOLID;
+	rasterDesc.FrontCounterClockwise = false;
+	rasterDesc.MultisampleEnable     = false;
+	rasterDesc.ScissorEnable         = false;
+	rasterDesc.SlopeScaledDepthBias  = SHADOW_SLOPE_BIAS;
+
+	result = device->CreateRasterizerState( &rasterDesc, &pRasterState );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Whole slice
+	mViewport.TopLeftX = 0.0f;
+	mViewport.TopLeftY = 0.0f;
+	mViewport.Width    = ( float )mMapSize;
+	mViewport.Height   = ( float )mMapSize;
+	mViewport.MinDepth = 0.0f;
+	mViewport.MaxDepth = 1.0f;
+
+	return true;
+}
+
+
+// Shutdown //
+void ShadowMapClass::Shutdown() {
+	// Release the rasterizer state
+	if( pRasterState ) {
+		pRasterState->Release();
+		pRasterState = 0;
+	}
+
+	// Release the comparison sampler
+	if( pComparisonSampler ) {
+		pComparisonSampler->Release();
+		pComparisonSampler = 0;
+	}
+
+	// Release the shader resource view
+	if( pShaderResourceView ) {
+		pShaderResourceView->Release();
+		pShaderResourceView = 0;
+	}
+
+	// Release the depth views
+	for( int i = 0; i < SHADOW_MAX_CASCADES; i++ ) {
+		if( pDepthViews[ i ] ) {
+			pDepthViews[ i ]->Release();
+			pDepthViews[ i ] = 0;
+		}
+	}
+
+	// Release the depth texture
+	if( pDepthTexture ) {
+		pDepthTexture->Release();
+		pDepthTexture = 0;
+	}
+
+	return;
+}
+
+
+// FitCascades                                                   //
+// Splits are a blend of logarithmic and uniform (practical      //
+// split scheme). Every cascade shares one light rotation, the   //
+// orthographic box moves with the slice's bounding sphere       //
+void ShadowMapClass::FitCascades( const D3DXMATRIX& viewMatrix,
+	                              const D3DXMATRIX& projectionMatrix,
+								  float nearDepth,
+								  float shadowDistance,
+								  const D3DXVECTOR3& lightDirection,
+								  const D3DXVECTOR3& sceneMinimum,
+								  const D3DXVECTOR3& sceneMaximum ) {
+	D3DXMATRIX inverseViewMatrix, lightViewMatrix;
+	D3DXVECTOR3 corners[ 8 ], corner, center, eye, up, lightCenter;
+	float tanX, tanY, sliceNear, sliceFar, depth, logSplit, uniformSplit;
+	float radius, distance, texelSize, lightNear, lightFar;
+
+	// Half extents of the view frustum at depth 1
+	tanX = 1.0f / projectionMatrix._11;
+	tanY = 1.0f / projectionMatrix._22;
+
+	D3DXMatrixInverse( &inverseViewMatrix, NULL, &viewMatrix );
+
+	// Light rotation - looks along the light from the origin
+	eye = D3DXVECTOR3( 0.0f, 0.0f, 0.0f );
+	up  = ( fabs( lightDirection.y ) < 0.99f ) ? D3DXVECTOR3( 0.0f, 1.0f, 0.0f ) : D3DXVECTOR3( 0.0f, 0.0f, 1.0f );
+	D3DXMatrixLookAtLH( &lightViewMatrix, &eye, &lightDirection, &up );
+
+	// Light depth range that holds every caster
+	lightNear = 1.0e30f;
+	lightFar  = -1.0e30f;
+	for( int i = 0; i < 8; i++ ) {
+		corner.x = ( i & 1 ) ? sceneMaximum.x : sceneMinimum.x;
+		corner.y = ( i & 2 ) ? sceneMaximum.y : sceneMinimum.y;
+		corner.z = ( i & 4 ) ? sceneMaximum.z : sceneMinimum.z;
+		D3DXVec3TransformCoord( &corner, &corner, &lightViewMatrix );
+
+		lightNear = ( corner.z < lightNear ) ? corner.z : lightNear;
+		lightFar  = ( corner.z > lightFar ) ? corner.z : lightFar;
+	}
+
+	lightNear -= 1.0f;
+	lightFar  += 1.0f;
+
+	sliceNear = nearDepth;
+
+	for( int cascade = 0; cascade < mCascadeCount; cascade++ ) {
+		// Practical split
+		logSplit     = nearDepth * powf( shadowDistance / nearDepth, ( float )( cascade + 1 ) / ( float )mCascadeCount );
+		uniformSplit = nearDepth + ( ( shadowDistance - nearDepth ) * ( float )( cascade + 1 ) / ( float )mCascadeCount );
+		sliceFar     = ( SHADOW_SPLIT_LAMBDA * logSplit ) + ( ( 1.0f - SHADOW_SPLIT_LAMBDA ) * uniformSplit );
+
+		mSplits[ cascade ] = sliceFar;
+
+		// Corners of the slice in world space
+		center = D3DXVECTOR3( 0.0f, 0.0f, 0.0f );
+		for( int i = 0; i < 8; i++ ) {
+			depth = ( i & 4 ) ? sliceFar : sliceNear;
+
+			corners[ i ].x = ( ( i & 1 ) ? 1.0f : -1.0f ) * tanX * depth;
+			corners[ i ].y = ( ( i & 2 ) ? 1.0f : -1.0f ) * tanY * depth;
+			corners[ i ].z = depth;
+			D3DXVec3TransformCoord( &corners[ i ], &corners[ i ], &inverseViewMatrix );
+
+			center += corners[ i ];
+		}
+		center /= 8.0f;
+
+		// Bounding sphere - the slice only moves rigidly with the
+		// camera so the radius (and texel size) never changes
+		radius = 0.0f;
+		for( int i = 0; i < 8; i++ ) {
+			corner   = corners[ i ] - center;
+			distance = D3DXVec3Length( &corner );
+			radius   = ( distance > radius ) ? distance : radius;
+		}
+		radius = ceil( radius * 16.0f ) / 16.0f;
+
+		// Move the box in whole texels
+		texelSize = ( radius * 2.0f ) / ( float )mMapSize;
+		D3DXVec3TransformCoord( &lightCenter, &center, &lightViewMatrix );
+		lightCenter.x = floor( lightCenter.x / texelSize ) * texelSize;
+		lightCenter.y = floor( lightCenter.y / texelSize ) * texelSize;
+
+		mViewMatrices[ cascade ] = lightViewMatrix;
+		D3DXMatrixOrthoOffCenterLH( &mProjectionMatrices[ cascade ],
+			                        lightCenter.x - radius,
+									lightCenter.x + radius,
+									lightCenter.y - radius,
+									lightCenter.y + radius,
+									lightNear,
+									lightFar );
+
+		sliceNear = sliceFar;
+	}
+
+	return;
+}
+
+
+// SetRenderTarget //
+void ShadowMapClass::SetRenderTarget( ID3D11DeviceContext* deviceContext, int cascade ) {
+	// No colour target - depth only
+	deviceContext->OMSetRenderTargets( 0, NULL, pDepthViews[ cascade ] );
+	deviceContext->ClearDepthStencilView( pDepthViews[ cascade ], D3D11_CLEAR_DEPTH, 1.0f, 0 );
+
+	deviceContext->RSSetViewports( 1, &mViewport );
+	deviceContext->RSSetState( pRasterState );
+
+	return;
+}
+
+
+// GetCascadeCount //
+int ShadowMapClass::GetCascadeCount() {
+	return mCascadeCount;
+}
+
+
+// GetCascadeViewMatrix //
+void ShadowMapClass::GetCascadeViewMatrix( int cascade, D3DXMATRIX& viewMatrix ) {
+	viewMatrix = mViewMatrices[ cascade ];
+	return;
+}
+
+
+// GetCascadeProjectionMatrix //
+void ShadowMapClass::GetCascadeProjectionMatrix( int cascade, D3DXMATRIX& projectionMatrix ) {
+	projectionMatrix = mProjectionMatrices[ cascade ];
+	return;
+}
+
+
+// GetCascadeTextureMatrix                           //
+// View * projection then clip space to texture space //
+void ShadowMapClass::GetCascadeTextureMatrix( int cascade, D3DXMATRIX& textureMatrix ) {
+	D3DXMATRIX scaleBiasMatrix;
+
+	D3DXMatrixIdentity( &scaleBiasMatrix );
+	scaleBiasMatrix._11 = 0.5f;
+	scaleBiasMatrix._22 = -0.5f;
+	scaleBiasMatrix._41 = 0.5f;
+	scaleBiasMatrix._42 = 0.5f;
+
+	D3DXMatrixMultiply( &textureMatrix, &mViewMatrices[ cascade ], &mProjectionMatrices[ cascade ] );
+	D3DXMatrixMultiply( &textureMatrix, &textureMatrix, &scaleBiasMatrix );
+
+	return;
+}
+
+
+// GetCascadeSplits //
+void ShadowMapClass::GetCascadeSplits( D3DXVECTOR4& splits ) {
+	splits.x = mSplits[ 0 ];
+	splits.y = mSplits[ 1 ];
+	splits.z = mSplits[ 2 ];
+	splits.w = mSplits[ 3 ];
+
+	return;
+}
+
+
+// GetShaderResourceView //
+ID3D11ShaderResourceView* ShadowMapClass::GetShaderResourceView() {
+	return pShaderResourceView;
+}
+
+
+// GetComparisonSampler //
+ID3D11SamplerState* ShadowMapClass::GetComparisonSampler() {
+	return pComparisonSampler;
+}
@@ -0,0 +1,88 @@
+#ifndef _SHADOWMAPCLASS_H_
+#define _SHADOWMAPCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <math.h>
+
+
+// Shadow Map Variables
+const int   SHADOW_MAX_CASCADES      = 4;     // size of the cascade arrays in Terrain.ps
+const float SHADOW_SPLIT_LAMBDA      = 0.75f; // 0 uniform splits, 1 logarithmic
+const int   SHADOW_DEPTH_BIAS        = 1000;  // rasterizer bias while drawing casters
+const float SHADOW_SLOPE_BIAS        = 2.0f;
+const float SHADOW_COMPARE_BIAS      = 0.0005f; // subtracted in Terrain.ps before comparing
+
+// Slots - must match the register()s in Terrain.ps
+const int SHADOW_MAP_TEXTURE_SLOT = 8;
+const int SHADOW_MAP_SAMPLER_SLOT = 1;
+
+
+// ShadowMapClass                                                       //
+// Cascaded shadow maps for the sun - one depth slice per cascade in    //
+// a texture array, read in Terrain.ps through a comparison sampler     //
+// for PCF. FitCascades splits the camera frustum between the near      //
+// plane and the shadow distance and fits an orthographic light view    //
+// around each slice - a bounding sphere snapped to whole texels, so    //
+// the shadows do not shimmer as the camera moves or turns. Each light  //
+// view's depth range covers the whole scene so casters outside the     //
+// slice are kept                                                       //
+class ShadowMapClass {
+public:
+	ShadowMapClass();
+	ShadowMapClass( const ShadowMapClass& other );
+	~ShadowMapClass();
+
+	bool Initialize( ID3D11Device* device, int mapSize, int cascadeCount );
+	void Shutdown();
+
+	// Fits every cascade - lightDirection points from the sun, the
+	// scene box bounds the casters (world space)
+	void FitCascades( const D3DXMATRIX& viewMatrix,
+		              const D3DXMATRIX& projectionMatrix,
+					  float nearDepth,
+					  float shadowDistance,
+					  const D3DXVECTOR3& lightDirection,
+					  const D3DXVECTOR3& sceneMinimum,
+					  const D3DXVECTOR3& sceneMaximum );
+
+	// SetRenderTarget                                          //
+	// Depth only - binds and clears the cascade's slice, sets  //
+	// its viewport and the biased rasterizer state             //
+	void SetRenderTarget( ID3D11DeviceContext* deviceContext, int cascade );
+
+	int GetCascadeCount();
+	void GetCascadeViewMatrix( int cascade, D3DXMATRIX& viewMatrix );
+	void GetCascadeProjectionMatrix( int cascade, D3DXMATRIX& projectionMatrix );
+
+	// World to shadow map texture space (x / y 0 - 1, z depth)
+	void GetCascadeTextureMatrix( int cascade, D3DXMATRIX& textureMatrix );
+
+	// View space depth each cascade ends at (unused cascades are
+	// never reached)
+	void GetCascadeSplits( D3DXVECTOR4& splits );
+
+	ID3D11ShaderResourceView* GetShaderResourceView();
+	ID3D11SamplerState* GetComparisonSampler();
+
+private:
+	// Shadow map resources
+	ID3D11Texture2D*          pDepthTexture;
+	ID3D11DepthStencilView*   pDepthViews[ SHADOW_MAX_CASCADES ];
+	ID3D11ShaderResourceView* pShaderResourceView;
+	ID3D11SamplerState*       pComparisonSampler;
+	ID3D11RasterizerState*    pRasterState;
+	D3D11_VIEWPORT mViewport;
+
+	int mMapSize, mCascadeCount;
+
+	// Current fit
+	D3DXMATRIX mViewMatrices[ SHADOW_MAX_CASCADES ];
+	D3DXMATRIX mProjectionMatrices[ SHADOW_MAX_CASCADES ];
+	float mSplits[ SHADOW_MAX_CASCADES ];
+};
+
+
+#endif
@@ -0,0 +1,162 @@
+#include "ShadowShaderClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+ShadowShaderClass::ShadowShaderClass()
+: pVertexShader( 0 ), pLayout( 0 ) {
+}
+
+
+// Constructor //
+ShadowShaderClass::ShadowShaderClass( const ShadowShaderClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+ShadowShaderClass::~ShadowShaderClass() {
+}
+
+
+// Initialize //
+bool ShadowShaderClass::Initialize( ID3D11Device* device, HWND hwnd ) {
+	bool result;
+
+	// Initialize the vertex shader
+	result = InitializeShader( device, hwnd, L"Shadow.vs" );
+	if( !result ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// Shutdown //
+void ShadowShaderClass::Shutdown() {
+	// Shutdown the vertex shader as well as the related objects
+	ShutdownShader();
+
+	return;
+}
+
+
+// Render                                                      //
+// Per-pass / per-object / per-terrain buffers must be         //
+// committed and the terrain's buffers set (TerrainClass::Render) //
+void ShadowShaderClass::Render( ID3D11DeviceContext* deviceContext, int indexCount, int indexStart ) {
+	// Set the vertex input layout
+	deviceContext->IASetInputLayout( pLayout );
+
+	// Depth only - no pixel shader
+	deviceContext->VSSetShader( pVertexShader, NULL, 0 );
+	deviceContext->PSSetShader( NULL, NULL, 0 );
+
+	// Render this range of the terrain
+	deviceContext->DrawIndexed( indexCount, indexStart, 0 );
+
+	return;
+}
+
+
+// InitializeShader                           //
+// Uses the terrain's compact vertex layout   //
+bool ShadowShaderClass::InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename ) {
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* vertexShaderBuffer;
+	const D3D11_INPUT_ELEMENT_DESC* polygonLayout;
+	unsigned int numElements;
+
+	// Initialize the pointers this function will use to null
+	errorMessage       = 0;
+	vertexShaderBuffer = 0;
+
+	// Load the vertex shader code (compiled on a cache miss)
+	if( !ShaderCacheClass::LoadShader( vsFilename, "ShadowVertexShader", "vs_5_0", NULL, &vertexShaderBuffer, &errorMessage ) ) {
+		// If the shader failed to compile it should have writen something to the error message
+		if( errorMessage ) {
+			OutputShaderErrorMessage( errorMessage, hwnd, vsFilename );
+		// If there was nothing in the error message then it simply could not find the shader file itself
+		} else {
+			MessageBox( hwnd, vsFilename, L"Missing Shader File", MB_OK );
+		}
+
+		return false;
+	}
+
+	// Create the vertex shader from the buffer
+	result = device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &pVertexShader );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Same layout as the terrain shaders - only the height is read
+	polygonLayout = TerrainClass::GetVertexLayout( numElements );
+
+	// Create the vertex input layout
+	result = device->CreateInputLayout( polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &pLayout );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Release the vertex shader buffer since it is no longer needed
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
+	return true;
+}
+
+
+// ShutdownShader //
+void ShadowShaderClass::ShutdownShader() {
+	// Release the layout
+	if( pLayout ) {
+		pLayout->Release();
+		pLayout = 0;
+	}
+
+	// Release the vertex shader
+	if( pVertexShader ) {
+		pVertexShader->Release();
+		pVertexShader = 0;
+	}
+
+	return;
+}
+
+
+// OutputShaderErrorMessage                   //
+// Writes compiler output to shader-error.txt //
+void ShadowShaderClass::OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename ) {
+	char* compileErrors;
+	unsigned long bufferSize, i;
+	ofstream fout;
+
+	// Get a pointer to the error message text buffer
+	compileErrors = ( char* )( errorMessage->GetBufferPointer() );
+
+	// Get the length of the message
+	bufferSize = errorMessage->GetBufferSize();
+
+	// Open a file to write the error message to
+	fout.open( "shader-error.txt" );
+
+	// Write out the error message
+	for( i = 0; i < bufferSize; i++ ) {
+		fout << compileErrors[ i ];
+	}
+
+	// Close the file
+	fout.close();
+
+	// Release the error message
+	errorMessage->Release();
+	errorMessage = 0;
+
+	// Pop a message up on the screen to notify the user to check the text file for compile errors
+	MessageBox( hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK );
+
+	return;
+}
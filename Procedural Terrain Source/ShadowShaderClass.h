@@ -0,0 +1,46 @@
+#ifndef _SHADOWSHADERCLASS_H_
+#define _SHADOWSHADERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <fstream>
+using namespace std;
+
+
+// Application Includes //
+#include "ShaderCacheClass.h"
+#include "TerrainClass.h"
+
+
+// ShadowShaderClass                                                  //
+// Depth only shader for drawing the terrain into a shadow cascade -  //
+// no pixel shader. The cascade's light matrices go in the per-pass   //
+// buffer and the vertex decoding in the per-terrain buffer           //
+// (ConstantBufferManagerClass) - commit them first                   //
+// Draws a range of the index buffer so culled chunks can be skipped  //
+class ShadowShaderClass {
+public:
+	ShadowShaderClass();
+	ShadowShaderClass( const ShadowShaderClass& other );
+	~ShadowShaderClass();
+
+	bool Initialize( ID3D11Device* device, HWND hwnd );
+	void Shutdown();
+
+	// Sets the shader then draws indexCount indices from indexStart
+	void Render( ID3D11DeviceContext* deviceContext, int indexCount, int indexStart );
+
+private:
+	bool InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename );
+	void ShutdownShader();
+	void OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename );
+
+private:
+	ID3D11VertexShader* pVertexShader;
+	ID3D11InputLayout*  pLayout;
+};
+
+
+#endif
@@ -0,0 +1,156 @@
+#include "StagingRingClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+StagingRingClass::StagingRingClass()
+: mBufferCount( 0 ), mNextBuffer( 0 ), mCurrentBuffer( 0 ), mBufferSize( 0 ), mStallCount( 0 ) {
+	for( int i = 0; i < STAGING_RING_MAX_BUFFERS; i++ ) {
+		pBuffers[ i ] = 0;
+	}
+}
+
+
+// Constructor //
+StagingRingClass::StagingRingClass( const StagingRingClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+StagingRingClass::~StagingRingClass() {
+}
+
+
+// Initialize                       //
+// Creates the staging buffers once //
+bool StagingRingClass::Initialize( ID3D11Device* device, int bufferCount, unsigned int bufferSize ) {
+	D3D11_BUFFER_DESC bufferDesc;
+	HRESULT result;
+
+	if( bufferCount < 1 || bufferCount > STAGING_RING_MAX_BUFFERS ) {
+		return false;
+	}
+
+	// Set up the description of the staging buffers
+	bufferDesc.Usage               = D3D11_USAGE_STAGING;
+	bufferDesc.ByteWidth           = bufferSize;
+	bufferDesc.BindFlags           = 0;
+	bufferDesc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags           = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	for( int i = 0; i < bufferCount; i++ ) {
+		result = device->CreateBuffer( &bufferDesc, NULL, &pBuffers[ i ] );
+		if( FAILED( result ) ) {
+			return false;
+		}
+
+		mBufferCount++;
+	}
+
+	mBufferSize    = bufferSize;
+	mNextBuffer    = 0;
+	mCurrentBuffer = 0;
+	mStallCount    = 0;
+
+	return true;
+}
+
+
+// Shutdown //
+void StagingRingClass::Shutdown() {
+	// Release the staging buffers
+	for( int i = 0; i < STAGING_RING_MAX_BUFFERS; i++ ) {
+		if( pBuffers[ i ] ) {
+			pBuffers[ i ]->Release();
+			pBuffers[ i ] = 0;
+		}
+	}
+
+	mBufferCount = 0;
+
+	return;
+}
+
+
+// Map                                                  //
+// Tries each buffer from the oldest without waiting -  //
+// a buffer the GPU is still copying from is skipped -  //
+// and only waits if every buffer is busy               //
+void* StagingRingClass::Map( ID3D11DeviceContext* deviceContext ) {
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	HRESULT result;
+	int buffer;
+
+	for( int i = 0; i < mBufferCount; i++ ) {
+		buffer = ( mNextBuffer + i ) % mBufferCount;
+
+		result = deviceContext->Map( pBuffers[ buffer ], 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource );
+		if( SUCCEEDED( result ) ) {
+			mCurrentBuffer = buffer;
+			mNextBuffer    = ( buffer + 1 ) % mBufferCount;
+			return mappedResource.pData;
+		}
+
+		if( result != DXGI_ERROR_WAS_STILL_DRAWING ) {
+			return 0;
+		}
+	}
+
+	// All in flight - wait for the oldest
+	mStallCount++;
+
+	result = deviceContext->Map( pBuffers[ mNextBuffer ], 0, D3D11_MAP_WRITE, 0, &mappedResource );
+	if( FAILED( result ) ) {
+		return 0;
+	}
+
+	mCurrentBuffer = mNextBuffer;
+	mNextBuffer    = ( mNextBuffer + 1 ) % mBufferCount;
+
+	return mappedResource.pData;
+}
+
+
+// Unmap //
+void StagingRingClass::Unmap( ID3D11DeviceContext* deviceContext ) {
+	deviceContext->Unmap( pBuffers[ mCurrentBuffer ], 0 );
+
+	return;
+}
+
+
+// CopyTo                                  //
+// Buffers are one texel high and deep so  //
+// only left / right of the box are used   //
+void StagingRingClass::CopyTo( ID3D11DeviceContext* deviceContext,
+	                           ID3D11Buffer* destination,
+							   unsigned int destinationOffset,
+							   unsigned int sourceOffset,
+							   unsigned int size ) {
+	D3D11_BOX sourceBox;
+
+	sourceBox.left   = sourceOffset;
+	sourceBox.right  = sourceOffset + size;
+	sourceBox.top    = 0;
+	sourceBox.bottom = 1;
+	sourceBox.front  = 0;
+	sourceBox.back   = 1;
+
+	deviceContext->CopySubresourceRegion( destination, 0, destinationOffset, 0, 0, pBuffers[ mCurrentBuffer ], 0, &sourceBox );
+
+	return;
+}
+
+
+// GetBufferSize //
+unsigned int StagingRingClass::GetBufferSize() {
+	return mBufferSize;
+}
+
+
+// GetStallCount //
+int StagingRingClass::GetStallCount() {
+	return mStallCount;
+}
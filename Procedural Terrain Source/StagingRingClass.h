@@ -0,0 +1,58 @@
+#ifndef _STAGINGRINGCLASS_H_
+#define _STAGINGRINGCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+
+
+// Staging Ring Variables
+const int STAGING_RING_MAX_BUFFERS = 8;
+
+
+// StagingRingClass                                                     //
+// Persistent CPU writable staging buffers used in turn to stream data  //
+// into DEFAULT usage buffers - Map fills the next buffer the GPU has   //
+// finished copying from (without waiting if it can), then CopyTo       //
+// copies byte ranges of it into the destination with                   //
+// CopySubresourceRegion. Nothing is created or released per upload     //
+class StagingRingClass {
+public:
+	StagingRingClass();
+	StagingRingClass( const StagingRingClass& other );
+	~StagingRingClass();
+
+	// bufferSize is the largest single upload
+	bool Initialize( ID3D11Device* device, int bufferCount, unsigned int bufferSize );
+	void Shutdown();
+
+	// Map                                              //
+	// Pointer to write up to bufferSize bytes to, or   //
+	// NULL if the map failed                           //
+	void* Map( ID3D11DeviceContext* deviceContext );
+	void Unmap( ID3D11DeviceContext* deviceContext );
+
+	// CopyTo                                                //
+	// Copies size bytes at sourceOffset of the buffer last  //
+	// mapped to destinationOffset - call after Unmap        //
+	void CopyTo( ID3D11DeviceContext* deviceContext,
+		         ID3D11Buffer* destination,
+				 unsigned int destinationOffset,
+				 unsigned int sourceOffset,
+				 unsigned int size );
+
+	unsigned int GetBufferSize();
+
+	// Maps that had to wait for the GPU (every buffer was still in use)
+	int GetStallCount();
+
+private:
+	ID3D11Buffer* pBuffers[ STAGING_RING_MAX_BUFFERS ];
+	int mBufferCount;
+	int mNextBuffer, mCurrentBuffer;
+	unsigned int mBufferSize;
+	int mStallCount;
+};
+
+
+#endif
@@ -0,0 +1,78 @@
+// TerrainBrushBenchmark                                            //
+// Console timing of TerrainClass::ApplyBrush on a 4097 x 4097      //
+// height map - each brush is dragged across the terrain at a few   //
+// radii and the time per stroke (heights, normals, tangents and    //
+// biNormals of the brush's rectangle) is compared with a 60 Hz     //
+// frame. Only the height map half of TerrainClass is used          //
+#include <stdio.h>
+#include "JobSystemClass.h"
+#include "TerrainClass.h"
+#include "BenchmarkTimer.h"
+
+
+// Benchmark Variables
+const int   BENCHMARK_TERRAIN_SIZE = 4097; // (2^n) + 1 for Diamond-Square
+const int   BENCHMARK_STROKES      = 120;  // two seconds of brushing at 60 Hz
+const int   BENCHMARK_RADIUS_COUNT = 3;
+const float BENCHMARK_RADII[ BENCHMARK_RADIUS_COUNT ] = { 8.0f, 32.0f, 64.0f };
+const float BENCHMARK_FRAME_MS     = 1000.0f / 60.0f;
+
+
+int main() {
+	JobSystemClass jobSystem;
+	TerrainClass terrain;
+	LARGE_INTEGER startTime, endTime;
+	char* brushNames[ TerrainClass::BRUSH_COUNT ] = { "Raise", "Lower", "Smooth" };
+	double strokeTime;
+	float x, z, strength;
+	bool withinBudget;
+
+	if( !jobSystem.Initialize( 0 ) ) {
+		printf( "Could not start the job system\n" );
+		return 1;
+	}
+
+	terrain.SetJobSystem( &jobSystem );
+
+	printf( "Building a %d x %d terrain on %d threads\n", BENCHMARK_TERRAIN_SIZE, BENCHMARK_TERRAIN_SIZE, jobSystem.GetThreadCount() );
+
+	if( !terrain.InitializeHeightMap( BENCHMARK_TERRAIN_SIZE, 5, 10.0f ) ) {
+		printf( "Could not build the terrain\n" );
+		return 1;
+	}
+
+	withinBudget = true;
+
+	printf( "%-8s %8s %14s %14s\n", "Brush", "Radius", "ms / stroke", "% of 60 Hz" );
+
+	for( int brush = 0; brush < TerrainClass::BRUSH_COUNT; brush++ ) {
+		for( int r = 0; r < BENCHMARK_RADIUS_COUNT; r++ ) {
+			strength = ( brush == TerrainClass::BRUSH_SMOOTH ) ? 0.1f : 0.05f;
+
+			QueryPerformanceCounter( &startTime );
+			for( int stroke = 0; stroke < BENCHMARK_STROKES; stroke++ ) {
+				// Diagonal drag across the middle of the terrain
+				x = ( float )( BENCHMARK_TERRAIN_SIZE / 4 ) + ( stroke * BENCHMARK_RADII[ r ] * 0.25f );
+				z = ( float )( BENCHMARK_TERRAIN_SIZE / 4 ) + ( stroke * BENCHMARK_RADII[ r ] * 0.125f );
+
+				terrain.ApplyBrush( ( TerrainClass::BrushType )brush, x, z, BENCHMARK_RADII[ r ], strength );
+			}
+			QueryPerformanceCounter( &endTime );
+
+			strokeTime = GetMilliseconds( startTime, endTime ) / BENCHMARK_STROKES;
+			if( strokeTime > BENCHMARK_FRAME_MS ) {
+				withinBudget = false;
+			}
+
+			printf( "%-8s %8.0f %14.3f %13.1f%%\n", brushNames[ brush ], BENCHMARK_RADII[ r ], strokeTime, strokeTime * 100.0 / BENCHMARK_FRAME_MS );
+		}
+	}
+
+	printf( "Strokes %s the 60 Hz frame\n", withinBudget ? "fit" : "EXCEED" );
+
+	terrain.SetJobSystem( 0 );
+	terrain.Shutdown();
+	jobSystem.Shutdown();
+
+	return withinBudget ? 0 : 1;
+}
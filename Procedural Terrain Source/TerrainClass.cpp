@@ -8,6 +8,31 @@ TerrainClass::TerrainClass() {
 	pIndexBuffer  = 0;
 	pTextureArray = 0;
 	pHeightMap    = 0;
+
+	pHeightGenerator = 0;
+	pErosion         = 0;
+	pJobSystem       = 0;
+
+	// rand() behaves as if seeded with 1 until srand is called
+	mSeed               = 1;
+	pHeightfieldCache   = 0;
+	mCacheParametersKey = 0;
+	mLoadedFromCache    = false;
+
+	mMaxError = 0.0f;
+
+	mMinHeight   = 0.0f;
+	mHeightRange = 1.0f;
+
+	pStagingRing     = 0;
+	mIndexMaxError   = 0.0f;
+	mLastUploadCount = 0;
+
+	mChunksWide = mChunksHigh = 0;
+
+	// Nothing dirty
+	mDirtyMinX = mDirtyMinZ = 0;
+	mDirtyMaxX = mDirtyMaxZ = -1;
 }
 
 
@@ -49,6 +74,44 @@ bool TerrainClass::Initialize( ID3D11Device* device,
 	NormalizeHeightMap();
 	*/
 
+	// Generate (or load) the height map and its vertex vectors
+	result = InitializeHeightMap( terrainDimension, smoothingPasses, displacementValue );
+	if( !result ) {
+		return false;
+	}
+
+	// Load the texture
+	result = LoadTextures( device,
+		                   textureFileName1,
+						   textureFileName2,
+						   textureFileName3,
+						   textureFileName4,
+						   textureFileName5,
+						   textureFileName6,
+						   textureFileName7,
+						   textureFileName8 );
+
+	if( !result ) {		   
+		return false;	   
+	}
+
+	// Initialize the vertex and index buffer that hold the geometry for the terrain
+	result = InitializeBuffers( device );
+	if( !result ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// InitializeHeightMap                              //
+// Everything that does not need the device - the   //
+// height map, its normals and the vertex vectors   //
+bool TerrainClass::InitializeHeightMap( int terrainDimension, int smoothingPasses, float displacementValue ) {
+	unsigned __int64 cacheKey;
+	bool result, reproducible;
+
 	// Initialize Terrain //
 
 	// Set terrain height & width
@@ -72,45 +135,52 @@ bool TerrainClass::Initialize( ID3D11Device* device,
 		}
 	}
 
-	// Generate new terrain
-	DiamondSquareAlgorithm( 10.0f, displacementValue, 2.0f );
-
-	// Smooth (5 passes)
-	SmoothHeights( smoothingPasses );
-
-	// Calculate the normals for the terrain data
-	result = CalculateNormals();
-	if( !result ) {
-		return false;
+	// Try the heightfield cache first - a hit replaces
+	// generation, smoothing, erosion and normals
+	mLoadedFromCache = false;
+	cacheKey = 0;
+	if( pHeightfieldCache ) {
+		cacheKey = GetCacheKey( terrainDimension, smoothingPasses, displacementValue );
+		mLoadedFromCache = LoadCachedHeights( cacheKey );
 	}
 
-	// Calculate the texture coordinates
-	CalculateTextureCoordinates();
+	if( !mLoadedFromCache ) {
+		reproducible = true;
 
-	// Load the texture
-	result = LoadTextures( device,
-		                   textureFileName1,
-						   textureFileName2,
-						   textureFileName3,
-						   textureFileName4,
-						   textureFileName5,
-						   textureFileName6,
-						   textureFileName7,
-						   textureFileName8 );
+		// Generate new terrain
+		// Pluggable generator if one was set, otherwise Diamond-Square
+		if( pHeightGenerator ) {
+			GenerateHeights();
+		} else {
+			srand( mSeed );
+			DiamondSquareAlgorithm( 10.0f, displacementValue, 2.0f );
+		}
 
-	if( !result ) {		   
-		return false;	   
-	}
+		// Smooth (5 passes)
+		SmoothHeights( smoothingPasses );
 
-	// Calculate the normal, tangent, and biNormal vectors for the model
-	CalculateModelVectors();
+		// Hydraulic and thermal erosion (if set)
+		if( pErosion ) {
+			reproducible = ErodeHeights();
+		}
 
-	// Initialize the vertex and index buffer that hold the geometry for the terrain
-	result = InitializeBuffers( device );
-	if( !result ) {
-		return false;
+		// Calculate the normals for the terrain data
+		result = CalculateNormals();
+		if( !result ) {
+			return false;
+		}
+
+		// Store for next time - failing to write only costs a regenerate
+		// Erosion the time budget cut short is not stored, the same
+		// settings would give different heights on another run
+		if( pHeightfieldCache && reproducible ) {
+			SaveCachedHeights( cacheKey );
+		}
 	}
 
+	// Calculate the texture coordinates, tangents and biNormals
+	UpdateVertexVectors();
+
 	return true;
 }
 
@@ -154,144 +224,415 @@ ID3D11ShaderResourceView** TerrainClass::GetTextureArray() {
 }
 
 
-// Initialize                         //
-// Added tangent & biNormal loading   //
-// The odd row and column are ignored //
-bool TerrainClass::InitializeBuffers( ID3D11Device* device ) {
-	VertexType* vertices;
-	unsigned long* indices;
-	int index, i, j;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
-	HRESULT result;
-	int index1, index2, index3, index4;
-	float tu, tv;
+// SetHeightGenerator                       //
+// NULL returns to DiamondSquareAlgorithm   //
+void TerrainClass::SetHeightGenerator( HeightGeneratorClass* generator ) {
+	pHeightGenerator = generator;
+}
 
-	// Calculate the number of vertices in the terrain mesh
-	mVertexCount = ( mTerrainWidth - 2 ) * ( mTerrainHeight - 2 ) * 6;
 
-	// Set the index count to the same as the vertex count
-	mIndexCount = mVertexCount;
+// SetErosion                  //
+// NULL skips the erosion stage //
+void TerrainClass::SetErosion( ErosionClass* erosion ) {
+	pErosion = erosion;
+}
+
 
-	// Create the vertex array.
-	vertices = new VertexType[ mVertexCount ];
-	if( !vertices ) {
-		return false;
+// SetSeed                                  //
+// Diamond-Square calls srand with this seed //
+void TerrainClass::SetSeed( unsigned int seed ) {
+	mSeed = seed;
+}
+
+
+// SetHeightfieldCache                     //
+// NULL disables loading and saving        //
+void TerrainClass::SetHeightfieldCache( HeightfieldCacheClass* cache, unsigned __int64 parametersKey ) {
+	pHeightfieldCache   = cache;
+	mCacheParametersKey = parametersKey;
+}
+
+
+// WasLoadedFromCache                   //
+// True if the last Initialize was a hit //
+bool TerrainClass::WasLoadedFromCache() {
+	return mLoadedFromCache;
+}
+
+
+// SetSimplification                 //
+// 0 keeps the uniform grid          //
+void TerrainClass::SetSimplification( float maxError ) {
+	mMaxError = maxError;
+}
+
+
+// SetJobSystem                  //
+// NULL runs the loops serially  //
+void TerrainClass::SetJobSystem( JobSystemClass* jobSystem ) {
+	pJobSystem = jobSystem;
+}
+
+
+// UpdateVertexVectors                       //
+// Texture coordinates first, the tangents   //
+// and biNormals are calculated from them    //
+void TerrainClass::UpdateVertexVectors() {
+	CalculateTextureCoordinates();
+	CalculateModelVectors();
+
+	return;
+}
+
+
+// GetTerrainWidth                             //
+// Points across the grid - every one is drawn //
+int TerrainClass::GetTerrainWidth() {
+	return mTerrainWidth;
+}
+
+
+// GetTerrainHeight                           //
+// Points down the grid - every one is drawn //
+int TerrainClass::GetTerrainHeight() {
+	return mTerrainHeight;
+}
+
+
+// GetHeightAt                                     //
+// Bilinear height between the four nearest points //
+// Positions off the grid are clamped to the edge  //
+float TerrainClass::GetHeightAt( float x, float z ) {
+	int i, j, index1, index2, index3, index4;
+	float fracX, fracZ, bottom, top;
+
+	// Clamp to the grid
+	if( x < 0.0f ) {
+		x = 0.0f;
+	} else if( x > ( float )( mTerrainWidth - 1 ) ) {
+		x = ( float )( mTerrainWidth - 1 );
 	}
 
-	// Create the index array
-	indices = new unsigned long[ mIndexCount ];
-	if( !indices ) {
-		return false;
+	if( z < 0.0f ) {
+		z = 0.0f;
+	} else if( z > ( float )( mTerrainHeight - 1 ) ) {
+		z = ( float )( mTerrainHeight - 1 );
 	}
 
-	// Initialize the index to the vertex buffer
-	index = 0;
+	// Cell and position within it (the far edge is the end of the last cell)
+	i = ( x < ( float )( mTerrainWidth - 2 ) ) ? ( int )x : ( mTerrainWidth - 2 );
+	j = ( z < ( float )( mTerrainHeight - 2 ) ) ? ( int )z : ( mTerrainHeight - 2 );
+	fracX = x - ( float )i;
+	fracZ = z - ( float )j;
 
-	// Load the vertex and index array with the terrain data
-	// ***HACK*** - cutting off the odd row and column (should be -1)
-	for( j = 0; j < ( mTerrainHeight - 2 ); j++ ) {
-		for( i = 0; i < ( mTerrainWidth - 2 ); i++ ) {
-			index1 = ( mTerrainHeight * j ) + i;                 // Bottom left
-			index2 = ( mTerrainHeight * j ) + ( i + 1 );         // Bottom right
-			index3 = ( mTerrainHeight * ( j + 1 ) ) + i;         // Upper left
-			index4 = ( mTerrainHeight * ( j + 1 ) ) + ( i + 1 ); // Upper right
+	index1 = ( mTerrainHeight * j ) + i;                 // Bottom left
+	index2 = ( mTerrainHeight * j ) + ( i + 1 );         // Bottom right
+	index3 = ( mTerrainHeight * ( j + 1 ) ) + i;         // Upper left
+	index4 = ( mTerrainHeight * ( j + 1 ) ) + ( i + 1 ); // Upper right
 
-			// Upper left
-			tv = pHeightMap[ index3 ].tv;
+	// Interpolate along x then z
+	bottom = pHeightMap[ index1 ].y + ( pHeightMap[ index2 ].y - pHeightMap[ index1 ].y ) * fracX;
+	top    = pHeightMap[ index3 ].y + ( pHeightMap[ index4 ].y - pHeightMap[ index3 ].y ) * fracX;
 
-			// Modify the texture coordinates to cover the top edge
-			if( tv == 1.0f ) { 
-				tv = 0.0f; 
-			}
+	return bottom + ( top - bottom ) * fracZ;
+}
 
-			vertices[ index ].position = D3DXVECTOR3( pHeightMap[ index3 ].x, pHeightMap[ index3 ].y, pHeightMap[ index3 ].z );
-			vertices[ index ].texture  = D3DXVECTOR2( pHeightMap[ index3 ].tu, tv );
-			vertices[ index ].normal   = D3DXVECTOR3( pHeightMap[ index3 ].nx, pHeightMap[ index3 ].ny, pHeightMap[ index3 ].nz );
-			vertices[ index ].tangent  = D3DXVECTOR3( pHeightMap[ index3 ].tx, pHeightMap[ index3 ].ty, pHeightMap[ index3 ].tz );
-			vertices[ index ].biNormal = D3DXVECTOR3( pHeightMap[ index3 ].bx, pHeightMap[ index3 ].by, pHeightMap[ index3 ].bz );
-			indices[ index ] = index;
-			index++;
-
-			// Upper right
-			tu = pHeightMap[ index4 ].tu;
-			tv = pHeightMap[ index4 ].tv;
-
-			// Modify the texture coordinates to cover the top and right edge
-			if( tu == 0.0f ) { 
-				tu = 1.0f; 
-			}
 
-			if( tv == 1.0f ) { 
-				tv = 0.0f; 
+// GetNormalAt                       //
+// Normal of the nearest grid point  //
+void TerrainClass::GetNormalAt( float x, float z, D3DXVECTOR3& normal ) {
+	int i, j, index;
+
+	// Nearest point, clamped to the grid (every point is drawn)
+	i = ( int )( x + 0.5f );
+	j = ( int )( z + 0.5f );
+
+	if( i < 0 ) {
+		i = 0;
+	} else if( i > mTerrainWidth - 1 ) {
+		i = mTerrainWidth - 1;
+	}
+
+	if( j < 0 ) {
+		j = 0;
+	} else if( j > mTerrainHeight - 1 ) {
+		j = mTerrainHeight - 1;
+	}
+
+	index = ( mTerrainHeight * j ) + i;
+
+	normal = D3DXVECTOR3( pHeightMap[ index ].nx, pHeightMap[ index ].ny, pHeightMap[ index ].nz );
+
+	return;
+}
+
+
+// GetHeights //
+void TerrainClass::GetHeights( int minX, int minZ, int maxX, int maxZ, float* heights, int rowPitch ) {
+	HeightMapType* point;
+
+	for( int j = minZ; j <= maxZ; j++ ) {
+		point = &pHeightMap[ ( mTerrainWidth * j ) + minX ];
+
+		for( int i = 0; i <= maxX - minX; i++ ) {
+			heights[ i ] = point[ i ].y;
+		}
+
+		heights += rowPitch;
+	}
+
+	return;
+}
+
+
+// ApplyBrush                                              //
+// Falloff is ( 1 - d^2 / r^2 )^2 - one at the centre and  //
+// flat at the edge so strokes blend into the terrain      //
+// Smoothing reads the heights from before the stroke so   //
+// the result does not depend on the loop order            //
+void TerrainClass::ApplyBrush( BrushType brush, float x, float z, float radius, float strength ) {
+	RegionType heights, copy;
+	int i, j, k, l, copyWide, count;
+	float dx, dz, distanceSquared, falloff, average, blend;
+	HeightMapType* point;
+
+	if( radius <= 0.0f ) {
+		return;
+	}
+
+	// Grid points the brush covers
+	heights.minX = ( int )ceil( x - radius );
+	heights.minZ = ( int )ceil( z - radius );
+	heights.maxX = ( int )floor( x + radius );
+	heights.maxZ = ( int )floor( z + radius );
+
+	heights.minX = ( heights.minX < 0 ) ? 0 : heights.minX;
+	heights.minZ = ( heights.minZ < 0 ) ? 0 : heights.minZ;
+	heights.maxX = ( heights.maxX > mTerrainWidth - 1 ) ? mTerrainWidth - 1 : heights.maxX;
+	heights.maxZ = ( heights.maxZ > mTerrainHeight - 1 ) ? mTerrainHeight - 1 : heights.maxZ;
+
+	if( heights.minX > heights.maxX || heights.minZ > heights.maxZ ) {
+		return;
+	}
+
+	// Copy the heights the 3x3 averages read
+	if( brush == BRUSH_SMOOTH ) {
+		copy.minX = ( heights.minX > 0 ) ? heights.minX - 1 : 0;
+		copy.minZ = ( heights.minZ > 0 ) ? heights.minZ - 1 : 0;
+		copy.maxX = ( heights.maxX < mTerrainWidth - 1 ) ? heights.maxX + 1 : mTerrainWidth - 1;
+		copy.maxZ = ( heights.maxZ < mTerrainHeight - 1 ) ? heights.maxZ + 1 : mTerrainHeight - 1;
+		copyWide  = copy.maxX - copy.minX + 1;
+
+		mBrushHeights.resize( copyWide * ( copy.maxZ - copy.minZ + 1 ) );
+		for( j = copy.minZ; j <= copy.maxZ; j++ ) {
+			for( i = copy.minX; i <= copy.maxX; i++ ) {
+				mBrushHeights[ ( ( j - copy.minZ ) * copyWide ) + ( i - copy.minX ) ] = pHeightMap[ ( mTerrainWidth * j ) + i ].y;
 			}
+		}
+	}
 
-			vertices[ index ].position = D3DXVECTOR3( pHeightMap[ index4 ].x, pHeightMap[ index4 ].y, pHeightMap[ index4 ].z );
-			vertices[ index ].texture  = D3DXVECTOR2( tu, tv );
-			vertices[ index ].normal   = D3DXVECTOR3( pHeightMap[ index4 ].nx, pHeightMap[ index4 ].ny, pHeightMap[ index4 ].nz );
-			vertices[ index ].tangent  = D3DXVECTOR3( pHeightMap[ index4 ].tx, pHeightMap[ index4 ].ty, pHeightMap[ index4 ].tz );
-			vertices[ index ].biNormal = D3DXVECTOR3( pHeightMap[ index4 ].bx, pHeightMap[ index4 ].by, pHeightMap[ index4 ].bz );
-			indices[ index ] = index;
-			index++;
-
-			// Bottom left
-			vertices[ index ].position = D3DXVECTOR3( pHeightMap[ index1 ].x, pHeightMap[ index1 ].y, pHeightMap[ index1 ].z );
-			vertices[ index ].texture  = D3DXVECTOR2( pHeightMap[ index1 ].tu, pHeightMap[ index1 ].tv );
-			vertices[ index ].normal   = D3DXVECTOR3( pHeightMap[ index1 ].nx, pHeightMap[ index1 ].ny, pHeightMap[ index1 ].nz );
-			vertices[ index ].tangent  = D3DXVECTOR3( pHeightMap[ index1 ].tx, pHeightMap[ index1 ].ty, pHeightMap[ index1 ].tz );
-			vertices[ index ].biNormal = D3DXVECTOR3( pHeightMap[ index1 ].bx, pHeightMap[ index1 ].by, pHeightMap[ index1 ].bz );
-			indices[ index ] = index;
-			index++;
-
-			// Bottom left
-			vertices[ index ].position = D3DXVECTOR3( pHeightMap[ index1 ].x, pHeightMap[ index1 ].y, pHeightMap[ index1 ].z );
-			vertices[ index ].texture  = D3DXVECTOR2( pHeightMap[ index1 ].tu, pHeightMap[ index1 ].tv );
-			vertices[ index ].normal   = D3DXVECTOR3( pHeightMap[ index1 ].nx, pHeightMap[ index1 ].ny, pHeightMap[ index1 ].nz );
-			vertices[ index ].tangent  = D3DXVECTOR3( pHeightMap[ index1 ].tx, pHeightMap[ index1 ].ty, pHeightMap[ index1 ].tz );
-			vertices[ index ].biNormal = D3DXVECTOR3( pHeightMap[ index1 ].bx, pHeightMap[ index1 ].by, pHeightMap[ index1 ].bz );
-			indices[ index ] = index;
-			index++;
-
-			// Upper right
-			tu = pHeightMap[ index4 ].tu;
-			tv = pHeightMap[ index4 ].tv;
-
-			// Modify the texture coordinates to cover the top and right edge
-			if( tu == 0.0f ) {
-				tu = 1.0f; 
+	for( j = heights.minZ; j <= heights.maxZ; j++ ) {
+		for( i = heights.minX; i <= heights.maxX; i++ ) {
+			dx = ( float )i - x;
+			dz = ( float )j - z;
+			distanceSquared = ( dx * dx ) + ( dz * dz );
+			if( distanceSquared >= radius * radius ) {
+				continue;
 			}
 
-			if( tv == 1.0f ) {
-				tv = 0.0f; 
+			falloff = 1.0f - ( distanceSquared / ( radius * radius ) );
+			falloff *= falloff;
+
+			point = &pHeightMap[ ( mTerrainWidth * j ) + i ];
+
+			switch( brush ) {
+			case BRUSH_RAISE:
+				point->y += strength * falloff;
+				break;
+
+			case BRUSH_LOWER:
+				point->y -= strength * falloff;
+				break;
+
+			case BRUSH_SMOOTH:
+				// Average of the point and its neighbours on the grid
+				average = 0.0f;
+				count   = 0;
+				for( l = j - 1; l <= j + 1; l++ ) {
+					for( k = i - 1; k <= i + 1; k++ ) {
+						if( k < copy.minX || l < copy.minZ || k > copy.maxX || l > copy.maxZ ) {
+							continue;
+						}
+
+						average += mBrushHeights[ ( ( l - copy.minZ ) * copyWide ) + ( k - copy.minX ) ];
+						count++;
+					}
+				}
+				average /= ( float )count;
+
+				blend = strength * falloff;
+				blend = ( blend > 1.0f ) ? 1.0f : blend;
+
+				point->y += ( average - point->y ) * blend;
+				break;
+
+			default:
+				break;
 			}
+		}
+	}
+
+	UpdateRegion( heights );
+
+	return;
+}
 
-			vertices[ index ].position = D3DXVECTOR3( pHeightMap[ index4 ].x, pHeightMap[ index4 ].y, pHeightMap[ index4 ].z );
-			vertices[ index ].texture  = D3DXVECTOR2( tu, tv );
-			vertices[ index ].normal   = D3DXVECTOR3( pHeightMap[ index4 ].nx, pHeightMap[ index4 ].ny, pHeightMap[ index4 ].nz );
-			vertices[ index ].tangent  = D3DXVECTOR3( pHeightMap[ index4 ].tx, pHeightMap[ index4 ].ty, pHeightMap[ index4 ].tz );
-			vertices[ index ].biNormal = D3DXVECTOR3( pHeightMap[ index4 ].bx, pHeightMap[ index4 ].by, pHeightMap[ index4 ].bz );
-			indices[ index ] = index;
-			index++;
 
-			// Bottom right
-			tu = pHeightMap[ index2 ].tu;
+// UpdateSimplifiedMesh                               //
+// Brush strokes only move vertices - a simplified    //
+// mesh needs new triangles for the changed heights,  //
+// as does a change of mMaxError to or from the grid  //
+bool TerrainClass::UpdateSimplifiedMesh( ID3D11Device* device ) {
+	if( mMaxError <= 0.0f && mIndexMaxError <= 0.0f ) {
+		return true;
+	}
+
+	if( pIndexBuffer ) {
+		pIndexBuffer->Release();
+		pIndexBuffer = 0;
+	}
+
+	return InitializeIndexBuffer( device );
+}
+
+
+// PickSurface                                              //
+// Clips the ray to the terrain's bounds, marches it in     //
+// steps of TERRAIN_PICK_STEP until it is below the height  //
+// map then bisects the last step                           //
+bool TerrainClass::PickSurface( const D3DXVECTOR3& origin, const D3DXVECTOR3& direction, D3DXVECTOR3& position ) {
+	float nearT, farT, stepT, previousT, t, middleT, length;
+	bool clipped;
 
-			// Modify the texture coordinates to cover the right edge
-			if( tu == 0.0f ) { 
-				tu = 1.0f; 
+	length = sqrt( ( direction.x * direction.x ) + ( direction.y * direction.y ) + ( direction.z * direction.z ) );
+	if( length <= 0.0f ) {
+		return false;
+	}
+
+	// Part of the ray inside the terrain's box
+	nearT = 0.0f;
+	farT  = 1.0e30f;
+
+	clipped = ClipRaySlab( origin.x, direction.x, 0.0f, ( float )( mTerrainWidth - 1 ), nearT, farT ) &&
+		      ClipRaySlab( origin.z, direction.z, 0.0f, ( float )( mTerrainHeight - 1 ), nearT, farT ) &&
+			  ClipRaySlab( origin.y, direction.y, mMinHeight, mMinHeight + mHeightRange, nearT, farT );
+	if( !clipped ) {
+		return false;
+	}
+
+	stepT     = TERRAIN_PICK_STEP / length;
+	previousT = nearT;
+
+	// Already under the surface where it enters the box
+	if( ( origin.y + ( direction.y * nearT ) ) <= GetHeightAt( origin.x + ( direction.x * nearT ), origin.z + ( direction.z * nearT ) ) ) {
+		position = origin + ( direction * nearT );
+		return true;
+	}
+
+	for( t = nearT + stepT; previousT < farT; t += stepT ) {
+		t = ( t > farT ) ? farT : t;
+
+		if( ( origin.y + ( direction.y * t ) ) <= GetHeightAt( origin.x + ( direction.x * t ), origin.z + ( direction.z * t ) ) ) {
+			// Crossed the surface between previousT and t
+			for( int i = 0; i < TERRAIN_PICK_BISECTS; i++ ) {
+				middleT = ( previousT + t ) * 0.5f;
+
+				if( ( origin.y + ( direction.y * middleT ) ) <= GetHeightAt( origin.x + ( direction.x * middleT ), origin.z + ( direction.z * middleT ) ) ) {
+					t = middleT;
+				} else {
+					previousT = middleT;
+				}
 			}
 
-			vertices[ index ].position = D3DXVECTOR3( pHeightMap[ index2 ].x, pHeightMap[ index2 ].y, pHeightMap[ index2 ].z );
-			vertices[ index ].texture  = D3DXVECTOR2( tu, pHeightMap[ index2 ].tv );
-			vertices[ index ].normal   = D3DXVECTOR3( pHeightMap[ index2 ].nx, pHeightMap[ index2 ].ny, pHeightMap[ index2 ].nz );
-			vertices[ index ].tangent  = D3DXVECTOR3( pHeightMap[ index2 ].tx, pHeightMap[ index2 ].ty, pHeightMap[ index2 ].tz );
-			vertices[ index ].biNormal = D3DXVECTOR3( pHeightMap[ index2 ].bx, pHeightMap[ index2 ].by, pHeightMap[ index2 ].bz );
-			indices[ index ] = index;
-			index++;
+			position   = origin + ( direction * t );
+			position.y = GetHeightAt( position.x, position.z );
+
+			return true;
 		}
+
+		previousT = t;
+	}
+
+	return false;
+}
+
+
+// UpdateRegion                                             //
+// A height feeds the faces of the cells around it, which   //
+// feed every point of those cells - so the points one      //
+// beyond the changed heights get new normals, tangents and //
+// biNormals, and are uploaded                              //
+void TerrainClass::UpdateRegion( const RegionType& heights ) {
+	RegionType points;
+
+	points.minX = ( heights.minX > 0 ) ? heights.minX - 1 : 0;
+	points.minZ = ( heights.minZ > 0 ) ? heights.minZ - 1 : 0;
+	points.maxX = ( heights.maxX < mTerrainWidth - 1 ) ? heights.maxX + 1 : mTerrainWidth - 1;
+	points.maxZ = ( heights.maxZ < mTerrainHeight - 1 ) ? heights.maxZ + 1 : mTerrainHeight - 1;
+
+	CalculateNormals( points );
+	CalculateModelVectors( points );
+
+	MarkDirty( points.minX, points.minZ, points.maxX, points.maxZ );
+	UpdateChunkBounds( heights );
+
+	return;
+}
+
+
+// ClipRaySlab                                         //
+// Narrows [nearT, farT] to where origin + direction t //
+// is between minimum and maximum on one axis          //
+bool TerrainClass::ClipRaySlab( float origin, float direction, float minimum, float maximum, float& nearT, float& farT ) {
+	float t1, t2, swap;
+
+	// Parallel to the slab
+	if( fabs( direction ) < 1.0e-8f ) {
+		return ( origin >= minimum && origin <= maximum );
+	}
+
+	t1 = ( minimum - origin ) / direction;
+	t2 = ( maximum - origin ) / direction;
+	if( t1 > t2 ) {
+		swap = t1;
+		t1   = t2;
+		t2   = swap;
 	}
 
-	// Set up the description of the static vertex buffer
+	nearT = ( t1 > nearT ) ? t1 : nearT;
+	farT  = ( t2 < farT ) ? t2 : farT;
+
+	return ( nearT <= farT );
+}
+
+
+// InitializeBuffers                                          //
+// One compact vertex per grid point, in grid order, so the   //
+// vertex shader can rebuild x / z (and the texture           //
+// coordinates) from SV_VertexID                              //
+// The vertex buffer is created empty - every vertex is       //
+// streamed in through the staging ring by the first          //
+// UploadDirtyRegion                                          //
+bool TerrainClass::InitializeBuffers( ID3D11Device* device ) {
+	D3D11_BUFFER_DESC vertexBufferDesc;
+	unsigned int stagingSize;
+	HRESULT result;
+	bool initialized;
+
+	// Calculate the number of vertices in the terrain mesh
+	mVertexCount = mTerrainWidth * mTerrainHeight;
+
+	// Set up the description of the vertex buffer
 	vertexBufferDesc.Usage               = D3D11_USAGE_DEFAULT;
 	vertexBufferDesc.ByteWidth           = sizeof( VertexType ) * mVertexCount;
 	vertexBufferDesc.BindFlags           = D3D11_BIND_VERTEX_BUFFER;
@@ -299,17 +640,185 @@ bool TerrainClass::InitializeBuffers( ID3D11Device* device ) {
 	vertexBufferDesc.MiscFlags           = 0;
 	vertexBufferDesc.StructureByteStride = 0;
 
-	// Give the subresource structure a pointer to the vertex data
-	vertexData.pSysMem          = vertices;
-	vertexData.SysMemPitch      = 0;
-	vertexData.SysMemSlicePitch = 0;
-
 	// Now create the vertex buffer
-	result = device->CreateBuffer( &vertexBufferDesc, &vertexData, &pVertexBuffer );
+	result = device->CreateBuffer( &vertexBufferDesc, NULL, &pVertexBuffer );
 	if( FAILED( result ) ) {
 		return false;
 	}
 
+	// Create the staging ring - each buffer holds the whole terrain
+	// up to TERRAIN_STAGING_SIZE, bigger uploads are sent in bands
+	pStagingRing = new StagingRingClass;
+	if( !pStagingRing ) {
+		return false;
+	}
+
+	stagingSize = sizeof( VertexType ) * mVertexCount;
+	if( stagingSize > TERRAIN_STAGING_SIZE ) {
+		stagingSize = TERRAIN_STAGING_SIZE;
+	}
+
+	initialized = pStagingRing->Initialize( device, TERRAIN_STAGING_BUFFERS, stagingSize );
+	if( !initialized ) {
+		return false;
+	}
+
+	// Quantize over the exact height range and upload it all
+	CalculateHeightRange( 0.0f );
+	MarkDirty( 0, 0, mTerrainWidth - 1, mTerrainHeight - 1 );
+
+	// Create the index buffer
+	initialized = InitializeIndexBuffer( device );
+	if( !initialized ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// InitializeIndexBuffer                         //
+// Uniform grid, or the RTIN mesh when mMaxError //
+// is set - both index the shared vertices       //
+// Triangles are stored chunk by chunk           //
+bool TerrainClass::InitializeIndexBuffer( ID3D11Device* device ) {
+	std::vector< unsigned long > indices, meshIndices;
+	std::vector< int > chunkCursors;
+	D3D11_BUFFER_DESC indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	HRESULT result;
+	RegionType points;
+	int index, i, j, chunk, chunkX, chunkZ, x, z;
+
+	// Chunks cover TERRAIN_CHUNK_CELLS cells, the last row and column may be smaller
+	mChunksWide = ( mTerrainWidth - 1 + TERRAIN_CHUNK_CELLS - 1 ) / TERRAIN_CHUNK_CELLS;
+	mChunksHigh = ( mTerrainHeight - 1 + TERRAIN_CHUNK_CELLS - 1 ) / TERRAIN_CHUNK_CELLS;
+	mChunks.resize( mChunksWide * mChunksHigh );
+
+	for( chunk = 0; chunk < ( int )mChunks.size(); chunk++ ) {
+		mChunks[ chunk ].points.minX = mTerrainWidth;
+		mChunks[ chunk ].points.minZ = mTerrainHeight;
+		mChunks[ chunk ].points.maxX = mChunks[ chunk ].points.maxZ = -1;
+		mChunks[ chunk ].indexStart  = mChunks[ chunk ].indexCount = 0;
+	}
+
+	// Load the index array
+	if( mMaxError > 0.0f ) {
+		// Adaptive mesh - RTIN vertices are grid indices
+		RTINClass rtin;
+		std::vector< float > heights;
+		std::vector< unsigned long > meshVertices;
+
+		// Must be (2^n) + 1 like Diamond-Square
+		if( !rtin.Initialize( mTerrainWidth ) || mTerrainWidth != mTerrainHeight ) {
+			return false;
+		}
+
+		heights.resize( mVertexCount );
+		for( index = 0; index < mVertexCount; index++ ) {
+			heights[ index ] = pHeightMap[ index ].y;
+		}
+
+		rtin.ComputeErrors( &heights[ 0 ] );
+		rtin.BuildMesh( mMaxError, meshVertices, meshIndices );
+
+		for( index = 0; index < ( int )meshIndices.size(); index++ ) {
+			meshIndices[ index ] = meshVertices[ meshIndices[ index ] ];
+		}
+
+		// Each triangle goes in the chunk holding its centre - large
+		// triangles reach outside it so the chunk grows to their points
+		for( index = 0; index < ( int )meshIndices.size(); index += 3 ) {
+			x = z = 0;
+			for( i = 0; i < 3; i++ ) {
+				x += meshIndices[ index + i ] % mTerrainWidth;
+				z += meshIndices[ index + i ] / mTerrainWidth;
+			}
+
+			chunkX = ( x / 3 ) / TERRAIN_CHUNK_CELLS;
+			chunkZ = ( z / 3 ) / TERRAIN_CHUNK_CELLS;
+			chunkX = ( chunkX < mChunksWide ) ? chunkX : mChunksWide - 1;
+			chunkZ = ( chunkZ < mChunksHigh ) ? chunkZ : mChunksHigh - 1;
+
+			ChunkType& meshChunk = mChunks[ ( chunkZ * mChunksWide ) + chunkX ];
+			meshChunk.indexCount += 3;
+
+			for( i = 0; i < 3; i++ ) {
+				x = meshIndices[ index + i ] % mTerrainWidth;
+				z = meshIndices[ index + i ] / mTerrainWidth;
+
+				meshChunk.points.minX = ( x < meshChunk.points.minX ) ? x : meshChunk.points.minX;
+				meshChunk.points.minZ = ( z < meshChunk.points.minZ ) ? z : meshChunk.points.minZ;
+				meshChunk.points.maxX = ( x > meshChunk.points.maxX ) ? x : meshChunk.points.maxX;
+				meshChunk.points.maxZ = ( z > meshChunk.points.maxZ ) ? z : meshChunk.points.maxZ;
+			}
+		}
+
+		// Counting sort into chunk order
+		chunkCursors.resize( mChunks.size() );
+		for( chunk = 0, index = 0; chunk < ( int )mChunks.size(); chunk++ ) {
+			mChunks[ chunk ].indexStart = chunkCursors[ chunk ] = index;
+			index += mChunks[ chunk ].indexCount;
+		}
+
+		indices.resize( meshIndices.size() );
+		for( index = 0; index < ( int )meshIndices.size(); index += 3 ) {
+			x = z = 0;
+			for( i = 0; i < 3; i++ ) {
+				x += meshIndices[ index + i ] % mTerrainWidth;
+				z += meshIndices[ index + i ] / mTerrainWidth;
+			}
+
+			chunkX = ( x / 3 ) / TERRAIN_CHUNK_CELLS;
+			chunkZ = ( z / 3 ) / TERRAIN_CHUNK_CELLS;
+			chunkX = ( chunkX < mChunksWide ) ? chunkX : mChunksWide - 1;
+			chunkZ = ( chunkZ < mChunksHigh ) ? chunkZ : mChunksHigh - 1;
+			chunk  = ( chunkZ * mChunksWide ) + chunkX;
+
+			for( i = 0; i < 3; i++ ) {
+				indices[ chunkCursors[ chunk ]++ ] = meshIndices[ index + i ];
+			}
+		}
+	} else {
+		// Uniform grid - two triangles per cell
+		indices.reserve( ( mTerrainWidth - 1 ) * ( mTerrainHeight - 1 ) * 6 );
+
+		for( chunkZ = 0; chunkZ < mChunksHigh; chunkZ++ ) {
+			for( chunkX = 0; chunkX < mChunksWide; chunkX++ ) {
+				ChunkType& gridChunk = mChunks[ ( chunkZ * mChunksWide ) + chunkX ];
+
+				// Cells of this chunk, the points run one further
+				gridChunk.points.minX = chunkX * TERRAIN_CHUNK_CELLS;
+				gridChunk.points.minZ = chunkZ * TERRAIN_CHUNK_CELLS;
+				gridChunk.points.maxX = ( ( chunkX + 1 ) * TERRAIN_CHUNK_CELLS < mTerrainWidth - 1 ) ? ( chunkX + 1 ) * TERRAIN_CHUNK_CELLS : mTerrainWidth - 1;
+				gridChunk.points.maxZ = ( ( chunkZ + 1 ) * TERRAIN_CHUNK_CELLS < mTerrainHeight - 1 ) ? ( chunkZ + 1 ) * TERRAIN_CHUNK_CELLS : mTerrainHeight - 1;
+				gridChunk.indexStart  = ( int )indices.size();
+
+				for( j = gridChunk.points.minZ; j < gridChunk.points.maxZ; j++ ) {
+					for( i = gridChunk.points.minX; i < gridChunk.points.maxX; i++ ) {
+						indices.push_back( ( mTerrainWidth * ( j + 1 ) ) + i );         // Upper left
+						indices.push_back( ( mTerrainWidth * ( j + 1 ) ) + ( i + 1 ) ); // Upper right
+						indices.push_back( ( mTerrainWidth * j ) + i );                 // Bottom left
+						indices.push_back( ( mTerrainWidth * j ) + i );                 // Bottom left
+						indices.push_back( ( mTerrainWidth * ( j + 1 ) ) + ( i + 1 ) ); // Upper right
+						indices.push_back( ( mTerrainWidth * j ) + ( i + 1 ) );         // Bottom right
+					}
+				}
+
+				gridChunk.indexCount = ( int )indices.size() - gridChunk.indexStart;
+			}
+		}
+	}
+
+	// Heights of every chunk
+	points.minX = points.minZ = 0;
+	points.maxX = mTerrainWidth - 1;
+	points.maxZ = mTerrainHeight - 1;
+	UpdateChunkBounds( points );
+
+	mIndexCount    = ( int )indices.size();
+	mIndexMaxError = mMaxError;
+
 	// Set up the description of the static index buffer
 	indexBufferDesc.Usage               = D3D11_USAGE_DEFAULT;
 	indexBufferDesc.ByteWidth           = sizeof( unsigned long ) * mIndexCount;
@@ -319,7 +828,7 @@ bool TerrainClass::InitializeBuffers( ID3D11Device* device ) {
 	indexBufferDesc.StructureByteStride = 0;
 
 	// Give the subresource structure a pointer to the index data
-	indexData.pSysMem          = indices;
+	indexData.pSysMem          = &indices[ 0 ];
 	indexData.SysMemPitch      = 0;
 	indexData.SysMemSlicePitch = 0;
 
@@ -329,14 +838,90 @@ bool TerrainClass::InitializeBuffers( ID3D11Device* device ) {
 		return false;
 	}
 
-	// Release the arrays now that the buffers have been created and loaded
-	delete [] vertices;
-	vertices = 0;
+	return true;
+}
 
-	delete [] indices;
-	indices = 0;
 
-	return true;
+// UpdateChunkBounds                                    //
+// Rebuilds the bounds of every chunk using any of the  //
+// points - heights can fall as well as rise so the     //
+// chunk's whole rectangle is scanned                   //
+void TerrainClass::UpdateChunkBounds( const RegionType& points ) {
+	float height, minHeight, maxHeight;
+
+	for( int chunk = 0; chunk < ( int )mChunks.size(); chunk++ ) {
+		ChunkType& bounds = mChunks[ chunk ];
+
+		// Empty, or clear of the points
+		if( bounds.indexCount == 0 ||
+			bounds.points.maxX < points.minX || bounds.points.minX > points.maxX ||
+			bounds.points.maxZ < points.minZ || bounds.points.minZ > points.maxZ ) {
+			continue;
+		}
+
+		minHeight = maxHeight = pHeightMap[ ( mTerrainWidth * bounds.points.minZ ) + bounds.points.minX ].y;
+		for( int j = bounds.points.minZ; j <= bounds.points.maxZ; j++ ) {
+			for( int i = bounds.points.minX; i <= bounds.points.maxX; i++ ) {
+				height = pHeightMap[ ( mTerrainWidth * j ) + i ].y;
+				minHeight = ( height < minHeight ) ? height : minHeight;
+				maxHeight = ( height > maxHeight ) ? height : maxHeight;
+			}
+		}
+
+		bounds.minimum = D3DXVECTOR3( ( float )bounds.points.minX, minHeight, ( float )bounds.points.minZ );
+		bounds.maximum = D3DXVECTOR3( ( float )bounds.points.maxX, maxHeight, ( float )bounds.points.maxZ );
+	}
+
+	return;
+}
+
+
+// GetChunkCount //
+int TerrainClass::GetChunkCount() {
+	return ( int )mChunks.size();
+}
+
+
+// GetChunk                                 //
+// Terrain space bounds and index range     //
+void TerrainClass::GetChunk( int chunk, D3DXVECTOR3& minimum, D3DXVECTOR3& maximum, int& indexStart, int& indexCount ) {
+	minimum    = mChunks[ chunk ].minimum;
+	maximum    = mChunks[ chunk ].maximum;
+	indexStart = mChunks[ chunk ].indexStart;
+	indexCount = mChunks[ chunk ].indexCount;
+
+	return;
+}
+
+
+// GetBounds                         //
+// Terrain space box of every chunk  //
+void TerrainClass::GetBounds( D3DXVECTOR3& minimum, D3DXVECTOR3& maximum ) {
+	bool first = true;
+
+	minimum = maximum = D3DXVECTOR3( 0.0f, 0.0f, 0.0f );
+
+	for( int chunk = 0; chunk < ( int )mChunks.size(); chunk++ ) {
+		if( mChunks[ chunk ].indexCount == 0 ) {
+			continue;
+		}
+
+		if( first ) {
+			minimum = mChunks[ chunk ].minimum;
+			maximum = mChunks[ chunk ].maximum;
+			first   = false;
+			continue;
+		}
+
+		minimum.x = ( mChunks[ chunk ].minimum.x < minimum.x ) ? mChunks[ chunk ].minimum.x : minimum.x;
+		minimum.y = ( mChunks[ chunk ].minimum.y < minimum.y ) ? mChunks[ chunk ].minimum.y : minimum.y;
+		minimum.z = ( mChunks[ chunk ].minimum.z < minimum.z ) ? mChunks[ chunk ].minimum.z : minimum.z;
+		maximum.x = ( mChunks[ chunk ].maximum.x > maximum.x ) ? mChunks[ chunk ].maximum.x : maximum.x;
+		maximum.y = ( mChunks[ chunk ].maximum.y > maximum.y ) ? mChunks[ chunk ].maximum.y : maximum.y;
+		maximum.z = ( mChunks[ chunk ].maximum.z > maximum.z ) ? mChunks[ chunk ].maximum.z : maximum.z;
+	}
+
+	return;
 }
 
 
@@ -354,6 +939,16 @@ void TerrainClass::ShutdownBuffers() {
 		pVertexBuffer = 0;
 	}
 
+	// Release the staging ring
+	if( pStagingRing ) {
+		pStagingRing->Shutdown();
+		delete pStagingRing;
+		pStagingRing = 0;
+	}
+
+	// Release the chunks
+	std::vector< ChunkType >().swap( mChunks );
+
 	return;
 }
 
@@ -535,28 +1130,49 @@ void TerrainClass::NormalizeHeightMap() {
 		}
 	}
 
-	return;
+	return;
+}
+
+
+// CalculateNormals       //
+// Whole height map        //
+bool TerrainClass::CalculateNormals() {
+	RegionType points;
+
+	points.minX = points.minZ = 0;
+	points.maxX = mTerrainWidth - 1;
+	points.maxZ = mTerrainHeight - 1;
+
+	CalculateNormals( points );
+
+	// Release the face normals - only brush sized regions keep theirs
+	std::vector< VectorType >().swap( mFaceNormals );
+
+	return true;
 }
 
 
-// CalculateNormals //
-bool TerrainClass::CalculateNormals() {
-	int i, j, index1, index2, index3, index, count;
+// CalculateNormals                                          //
+// Smooth normal of each point in the region - the average   //
+// of the (up to four) face normals around it, so only the   //
+// cells touching the region are calculated                  //
+void TerrainClass::CalculateNormals( const RegionType& points ) {
+	RegionType cells;
+	int i, j, cellI, cellJ, cellsWide, index1, index2, index3, index, count;
 	float vertex1[ 3 ], vertex2[ 3 ], vertex3[ 3 ], vector1[ 3 ], vector2[ 3 ], sum[ 3 ], length;
-	VectorType* normals;
 
-	// Create a temporary array to hold the un-normalized normal vectors
-	normals = new VectorType[ ( mTerrainHeight - 1 ) * ( mTerrainWidth - 1 ) ];
-	if( !normals ) {
-		return false;
-	}
+	GetCellsAround( points, cells );
+	cellsWide = cells.maxX - cells.minX + 1;
 
-	// Go through all the faces in the mesh and calculate their normals
-	for( j = 0; j < ( mTerrainHeight - 1 ); j++ ) {
-		for( i = 0; i < ( mTerrainWidth - 1 ); i++ ) {
-			index1 = ( j * mTerrainHeight ) + i;
-			index2 = ( j * mTerrainHeight ) + ( i + 1 );
-			index3 = ( ( j + 1 ) * mTerrainHeight ) + i;
+	// Un-normalized face normals of those cells
+	mFaceNormals.resize( cellsWide * ( cells.maxZ - cells.minZ + 1 ) );
+
+	// Go through all the faces in the region and calculate their normals
+	for( j = cells.minZ; j <= cells.maxZ; j++ ) {
+		for( i = cells.minX; i <= cells.maxX; i++ ) {
+			index1 = ( j * mTerrainWidth ) + i;
+			index2 = ( j * mTerrainWidth ) + ( i + 1 );
+			index3 = ( ( j + 1 ) * mTerrainWidth ) + i;
 
 			// Get three vertices from the face
 			vertex1[ 0 ] = pHeightMap[ index1 ].x;
@@ -579,19 +1195,19 @@ bool TerrainClass::CalculateNormals() {
 			vector2[ 1 ] = vertex3[ 1 ] - vertex2[ 1 ];
 			vector2[ 2 ] = vertex3[ 2 ] - vertex2[ 2 ];
 					   
-			index = ( j * ( mTerrainHeight - 1 ) ) + i;
+			index = ( ( j - cells.minZ ) * cellsWide ) + ( i - cells.minX );
 
 			// Calculate the cross product of those two vectors to get the un-normalized value for this face normal
-			normals[ index ].x = ( vector1[ 1 ] * vector2[ 2 ] ) - ( vector1[ 2 ] * vector2[ 1 ] );
-			normals[ index ].y = ( vector1[ 2 ] * vector2[ 0 ] ) - ( vector1[ 0 ] * vector2[ 2 ] );
-			normals[ index ].z = ( vector1[ 0 ] * vector2[ 1 ] ) - ( vector1[ 1 ] * vector2[ 0 ] );
+			mFaceNormals[ index ].x = ( vector1[ 1 ] * vector2[ 2 ] ) - ( vector1[ 2 ] * vector2[ 1 ] );
+			mFaceNormals[ index ].y = ( vector1[ 2 ] * vector2[ 0 ] ) - ( vector1[ 0 ] * vector2[ 2 ] );
+			mFaceNormals[ index ].z = ( vector1[ 0 ] * vector2[ 1 ] ) - ( vector1[ 1 ] * vector2[ 0 ] );
 		}
 	}
 
 	// Now go through all the vertices and take an average of each face normal 	
 	// that the vertex touches to get the averaged normal for that vertex
-	for( j = 0; j < mTerrainHeight; j++ ) {
-		for( i = 0; i < mTerrainWidth; i++ ) {
+	for( j = points.minZ; j <= points.maxZ; j++ ) {
+		for( i = points.minX; i <= points.maxX; i++ ) {
 			// Initialize the sum
 			sum[ 0 ] = 0.0f;
 			sum[ 1 ] = 0.0f;
@@ -600,44 +1216,20 @@ bool TerrainClass::CalculateNormals() {
 			// Initialize the count
 			count = 0;
 
-			// Bottom left face
-			if( ( ( i - 1 ) >= 0 ) && ( ( j - 1 ) >= 0 ) ) {
-				index = ( ( j - 1 ) * ( mTerrainHeight - 1 ) ) + ( i - 1 );
-
-				sum[ 0 ] += normals[ index ].x;
-				sum[ 1 ] += normals[ index ].y;
-				sum[ 2 ] += normals[ index ].z;
-				count++;
-			}
-
-			// Bottom right face
-			if( (i < ( mTerrainWidth - 1 ) ) && ( ( j - 1 ) >= 0 ) ) {
-				index = ( ( j - 1 ) * ( mTerrainHeight - 1 ) ) + i;
-
-				sum[ 0 ] += normals[ index ].x;
-				sum[ 1 ] += normals[ index ].y;
-				sum[ 2 ] += normals[ index ].z;
-				count++;
-			}
-
-			// Upper left face
-			if( ( ( i - 1 ) >= 0 ) && ( j < ( mTerrainHeight - 1 ) ) ) {
-				index = ( j * ( mTerrainHeight - 1 ) ) + ( i - 1 );
-
-				sum[ 0 ] += normals[ index ].x;
-				sum[ 1 ] += normals[ index ].y;
-				sum[ 2 ] += normals[ index ].z;
-				count++;
-			}
+			// Bottom left, bottom right, upper left then upper right face
+			for( cellJ = j - 1; cellJ <= j; cellJ++ ) {
+				for( cellI = i - 1; cellI <= i; cellI++ ) {
+					if( cellI < 0 || cellJ < 0 || cellI > ( mTerrainWidth - 2 ) || cellJ > ( mTerrainHeight - 2 ) ) {
+						continue;
+					}
 
-			// Upper right face
-			if( ( i < ( mTerrainWidth - 1 ) ) && ( j < ( mTerrainHeight - 1 ) ) ) {
-				index = ( j * ( mTerrainHeight - 1 ) ) + i;
+					index = ( ( cellJ - cells.minZ ) * cellsWide ) + ( cellI - cells.minX );
 
-				sum[ 0 ] += normals[ index ].x;
-				sum[ 1 ] += normals[ index ].y;
-				sum[ 2 ] += normals[ index ].z;
-				count++;
+					sum[ 0 ] += mFaceNormals[ index ].x;
+					sum[ 1 ] += mFaceNormals[ index ].y;
+					sum[ 2 ] += mFaceNormals[ index ].z;
+					count++;
+				}
 			}
 			
 			// Take the average of the faces touching this vertex
@@ -649,7 +1241,7 @@ bool TerrainClass::CalculateNormals() {
 			length = sqrt( ( sum[ 0 ] * sum[ 0 ] ) + ( sum[ 1 ] * sum[ 1 ] ) + ( sum[ 2 ] * sum[ 2 ] ) );
 			
 			// Get an index to the vertex location in the height map array
-			index = ( j * mTerrainHeight ) + i;
+			index = ( j * mTerrainWidth ) + i;
 
 			// Normalize the final shared normal for this vertex and store it in the height map array
 			pHeightMap[ index ].nx = ( sum[ 0 ] / length );
@@ -658,11 +1250,19 @@ bool TerrainClass::CalculateNormals() {
 		}
 	}
 
-	// Release the temporary normals
-	delete [] normals;
-	normals = 0;
+	return;
+}
+
 
-	return true;
+// GetCellsAround                                  //
+// Cells with a corner in the region of points     //
+void TerrainClass::GetCellsAround( const RegionType& points, RegionType& cells ) {
+	cells.minX = ( points.minX > 0 ) ? points.minX - 1 : 0;
+	cells.minZ = ( points.minZ > 0 ) ? points.minZ - 1 : 0;
+	cells.maxX = ( points.maxX < mTerrainWidth - 2 ) ? points.maxX : mTerrainWidth - 2;
+	cells.maxZ = ( points.maxZ < mTerrainHeight - 2 ) ? points.maxZ : mTerrainHeight - 2;
+
+	return;
 }
 
 
@@ -673,156 +1273,102 @@ void TerrainClass::ShutdownHeightMap() {
 		pHeightMap = 0;
 	}
 
+	// Release the face vectors and scratch rows
+	std::vector< VectorType >().swap( mFaceNormals );
+	std::vector< float >().swap( mBrushHeights );
+	std::vector< VectorType >().swap( mFaceTangents );
+	std::vector< VectorType >().swap( mFaceBiNormals );
+	for( int i = 0; i < JOB_MAX_THREADS; i++ ) {
+		std::vector< TempVertexType >().swap( mScratchRows[ i ] );
+	}
+
 	return;
 }
 
 
-// CalculateTextureCoordinates                      //
-// Requires even sized terrain                      //
-// Have cheated and lowered height and width by one //
+// CalculateTextureCoordinates                          //
+// Vertices are shared between cells so the coordinates //
+// keep increasing across the terrain and the sampler   //
+// wraps them - TEXTURE_REPEAT repeats per terrain      //
+// The vertex shader rebuilds the same values           //
 void TerrainClass::CalculateTextureCoordinates() {
-	int incrementCount, i, j, tuCount, tvCount;
-	float incrementValue, tuCoordinate, tvCoordinate;
-
-	// Calculate how much to increment the texture coordinates by
-	incrementValue = ( float )TEXTURE_REPEAT / ( float )mTerrainWidth;
-
-	// Calculate how many times to repeat the texture
-	incrementCount = mTerrainWidth / TEXTURE_REPEAT;
-
-	// Initialize the tu and tv coordinate values
-	tuCoordinate = 0.0f;
-	tvCoordinate = 1.0f;
-
-	// Initialize the tu and tv coordinate indexes
-	tuCount = 0;
-	tvCount = 0;
-
-	// Loop through the entire height map and calculate the tu and tv texture coordinates for each vertex
-	// Cheating here by removing a single row and column off the end(the odd size)
-	for( j = 0; j < mTerrainHeight - 1; j++ ) {
-		for(i = 0; i < mTerrainWidth - 1; i++ ) {
-			// Store the texture coordinate in the height map
-			pHeightMap[ ( mTerrainHeight * j ) + i ].tu = tuCoordinate;
-			pHeightMap[ ( mTerrainHeight * j ) + i ].tv = tvCoordinate;
-
-			// Increment the tu texture coordinate by the increment value and increment the index by one
-			tuCoordinate += incrementValue;
-			tuCount++;
-
-			// Check if at the far right end of the texture and if so then start at the beginning again
-			if( tuCount == incrementCount ) {
-				tuCoordinate = 0.0f;
-				tuCount = 0;
-			}
-		}
+	RunRows( 0, mTerrainHeight, TextureCoordinateRows );
 
-		// Increment the tv texture coordinate by the increment value and increment the index by one
-		tvCoordinate -= incrementValue;
-		tvCount++;
+	return;
+}
 
-		// Check if at the top of the texture and if so then start at the bottom again
-		if( tvCount == incrementCount ) {
-			tvCoordinate = 1.0f;
-			tvCount = 0;
-		}
-	}
+
+// CalculateModelVectors        //
+// Whole height map              //
+void TerrainClass::CalculateModelVectors() {
+	RegionType points;
+
+	points.minX = points.minZ = 0;
+	points.maxX = mTerrainWidth - 1;
+	points.maxZ = mTerrainHeight - 1;
+
+	CalculateModelVectors( points );
+
+	// Release the face vectors - only brush sized regions keep theirs
+	std::vector< VectorType >().swap( mFaceTangents );
+	std::vector< VectorType >().swap( mFaceBiNormals );
 
 	return;
 }
 
 
-// CalculateModelVectors //
-void TerrainClass::CalculateModelVectors() {
-	int faceCount, i, index;
-	TempVertexType vertex1, vertex2, vertex3;
-	VectorType tangent, biNormal, normal;
-
-	// Calculate the number of faces in the model.
-	faceCount = mVertexCount / 3;
-
-	// Initialize the index to the model data.
-	index = 0;
-
-	// Go through all the faces and calculate the the tangent, biNormal, and normal vectors
-	for( i = 0; i < faceCount; i++ ) {
-		// Get the three vertices for this face from the model
-		vertex1.x  = pHeightMap[ index ].x;
-		vertex1.y  = pHeightMap[ index ].y;
-		vertex1.z  = pHeightMap[ index ].z;
-		vertex1.tu = pHeightMap[ index ].tu;
-		vertex1.tv = pHeightMap[ index ].tv;
-		vertex1.nx = pHeightMap[ index ].nx;
-		vertex1.ny = pHeightMap[ index ].ny;
-		vertex1.nz = pHeightMap[ index ].nz;
-		index++;
-
-		vertex2.x  = pHeightMap[ index ].x;
-		vertex2.y  = pHeightMap[ index ].y;
-		vertex2.z  = pHeightMap[ index ].z;
-		vertex2.tu = pHeightMap[ index ].tu;
-		vertex2.tv = pHeightMap[ index ].tv;
-		vertex2.nx = pHeightMap[ index ].nx;
-		vertex2.ny = pHeightMap[ index ].ny;
-		vertex2.nz = pHeightMap[ index ].nz;
-		index++;
-
-		vertex3.x  = pHeightMap[ index ].x;
-		vertex3.y  = pHeightMap[ index ].y;
-		vertex3.z  = pHeightMap[ index ].z;
-		vertex3.tu = pHeightMap[ index ].tu;
-		vertex3.tv = pHeightMap[ index ].tv;
-		vertex3.nx = pHeightMap[ index ].nx;
-		vertex3.ny = pHeightMap[ index ].ny;
-		vertex3.nz = pHeightMap[ index ].nz;
-		index++;
-
-		// Calculate the tangent and biNormal of that face
-		CalculateTangentBiNormal( vertex1, vertex2, vertex3, tangent, biNormal );
-
-		// Calculate the new normal using the tangent and biNormal
-		CalculateNormal( tangent, biNormal, normal );
-
-		// Store the normal, tangent, and biNormal for this face back in the model structure
-		pHeightMap[ index - 1 ].nx = normal.x;
-		pHeightMap[ index - 1 ].ny = normal.y;
-		pHeightMap[ index - 1 ].nz = normal.z;
-		pHeightMap[ index - 1 ].tx = tangent.x;
-		pHeightMap[ index - 1 ].ty = tangent.y;
-		pHeightMap[ index - 1 ].tz = tangent.z;
-		pHeightMap[ index - 1 ].bx = biNormal.x;
-		pHeightMap[ index - 1 ].by = biNormal.y;
-		pHeightMap[ index - 1 ].bz = biNormal.z;
-
-		pHeightMap[ index - 2 ].nx = normal.x;
-		pHeightMap[ index - 2 ].ny = normal.y;
-		pHeightMap[ index - 2 ].nz = normal.z;
-		pHeightMap[ index - 2 ].tx = tangent.x;
-		pHeightMap[ index - 2 ].ty = tangent.y;
-		pHeightMap[ index - 2 ].tz = tangent.z;
-		pHeightMap[ index - 2 ].bx = biNormal.x;
-		pHeightMap[ index - 2 ].by = biNormal.y;
-		pHeightMap[ index - 2 ].bz = biNormal.z;
-
-		pHeightMap[ index - 3 ].nx = normal.x;
-		pHeightMap[ index - 3 ].ny = normal.y;
-		pHeightMap[ index - 3 ].nz = normal.z;
-		pHeightMap[ index - 3 ].tx = tangent.x;
-		pHeightMap[ index - 3 ].ty = tangent.y;
-		pHeightMap[ index - 3 ].tz = tangent.z;
-		pHeightMap[ index - 3 ].bx = biNormal.x;
-		pHeightMap[ index - 3 ].by = biNormal.y;
-		pHeightMap[ index - 3 ].bz = biNormal.z;
+// CalculateModelVectors                                 //
+// Tangent and biNormal of every face touching the       //
+// region (same two triangles per cell as the index      //
+// buffer), then each point sums the faces it touches    //
+// and normalizes - the smooth normals are kept for      //
+// lighting                                              //
+// Both passes only write their own rows so they are     //
+// split between the job system's threads                //
+void TerrainClass::CalculateModelVectors( const RegionType& points ) {
+	int threadCount, cellCount;
+
+	threadCount = pJobSystem ? pJobSystem->GetThreadCount() : 1;
+
+	mPointRegion = points;
+	GetCellsAround( points, mCellRegion );
+
+	cellCount = ( mCellRegion.maxX - mCellRegion.minX + 1 ) * ( mCellRegion.maxZ - mCellRegion.minZ + 1 );
+	mFaceTangents.resize( cellCount * 2 );
+	mFaceBiNormals.resize( cellCount * 2 );
+
+	for( int i = 0; i < threadCount; i++ ) {
+		mScratchRows[ i ].resize( mTerrainWidth * 2 );
 	}
 
+	// Go through the faces and calculate the tangent and biNormal vectors
+	RunRows( mCellRegion.minZ, mCellRegion.maxZ + 1, FaceVectorRows );
+
+	// Add them to each point
+	RunRows( mPointRegion.minZ, mPointRegion.maxZ + 1, VertexVectorRows );
+
 	return;
 }
 
 
+// GetTempVertex                                  //
+// Copies a height map point for the face maths   //
+void TerrainClass::GetTempVertex( int index, TempVertexType& vertex ) {
+	vertex.x  = pHeightMap[ index ].x;
+	vertex.y  = pHeightMap[ index ].y;
+	vertex.z  = pHeightMap[ index ].z;
+	vertex.tu = pHeightMap[ index ].tu;
+	vertex.tv = pHeightMap[ index ].tv;
+	vertex.nx = pHeightMap[ index ].nx;
+	vertex.ny = pHeightMap[ index ].ny;
+	vertex.nz = pHeightMap[ index ].nz;
+}
+
+
 // CalculateTangentbiNormal // 
-void TerrainClass::CalculateTangentBiNormal( TempVertexType vertex1,
-	                                         TempVertexType vertex2, 
-										     TempVertexType vertex3,
+void TerrainClass::CalculateTangentBiNormal( const TempVertexType& vertex1,
+	                                         const TempVertexType& vertex2, 
+										     const TempVertexType& vertex3,
 					                         VectorType& tangent, 
 										     VectorType& biNormal ) {
 	float vector1[ 3 ], vector2[ 3 ];
@@ -878,7 +1424,9 @@ void TerrainClass::CalculateTangentBiNormal( TempVertexType vertex1,
 }
 
 
-// CalculateNormal //
+// CalculateNormal                                      //
+// ***UNUSED*** - the smooth normals from CalculateNormals //
+// are kept for lighting                                 //
 void TerrainClass::CalculateNormal( VectorType tangent, VectorType biNormal, VectorType& normal ) {
 	float length;
 
@@ -899,6 +1447,153 @@ void TerrainClass::CalculateNormal( VectorType tangent, VectorType biNormal, Vec
 }
 
 
+// RunRows                                 //
+// Serial when there is no job system      //
+void TerrainClass::RunRows( int startRow, int endRow, JobSystemClass::RangeFunction function ) {
+	if( pJobSystem ) {
+		pJobSystem->ParallelFor( startRow, endRow, TERRAIN_JOB_ROWS, function, this );
+	} else {
+		function( this, startRow, endRow, 0 );
+	}
+
+	return;
+}
+
+
+// TextureCoordinateRows //
+void TerrainClass::TextureCoordinateRows( void* data, int startRow, int endRow, int threadIndex ) {
+	TerrainClass* terrain = ( TerrainClass* )data;
+	HeightMapType* point;
+	float textureScale;
+
+	textureScale = terrain->GetTextureScale();
+
+	for( int j = startRow; j < endRow; j++ ) {
+		point = &terrain->pHeightMap[ terrain->mTerrainWidth * j ];
+
+		for( int i = 0; i < terrain->mTerrainWidth; i++ ) {
+			point[ i ].tu = ( float )i * textureScale;
+			point[ i ].tv = 1.0f - ( ( float )j * textureScale );
+		}
+	}
+
+	return;
+}
+
+
+// FaceVectorRows                                       //
+// One row of cells per row - the two rows of points    //
+// are copied into this thread's scratch once and the   //
+// upper row becomes the next row's lower row           //
+void TerrainClass::FaceVectorRows( void* data, int startRow, int endRow, int threadIndex ) {
+	TerrainClass* terrain = ( TerrainClass* )data;
+	const RegionType& cells = terrain->mCellRegion;
+	TempVertexType *lower, *upper, *swap;
+	int width, cellsWide, pointsWide, face;
+
+	width      = terrain->mTerrainWidth;
+	cellsWide  = cells.maxX - cells.minX + 1;
+	pointsWide = cellsWide + 1;
+	lower      = &terrain->mScratchRows[ threadIndex ][ 0 ];
+	upper      = lower + pointsWide;
+
+	for( int i = 0; i < pointsWide; i++ ) {
+		terrain->GetTempVertex( ( width * startRow ) + cells.minX + i, lower[ i ] );
+	}
+
+	for( int j = startRow; j < endRow; j++ ) {
+		for( int i = 0; i < pointsWide; i++ ) {
+			terrain->GetTempVertex( ( width * ( j + 1 ) ) + cells.minX + i, upper[ i ] );
+		}
+
+		for( int i = 0; i < cellsWide; i++ ) {
+			face = ( ( ( j - cells.minZ ) * cellsWide ) + i ) * 2;
+
+			// Upper left, upper right, bottom left
+			terrain->CalculateTangentBiNormal( upper[ i ], upper[ i + 1 ], lower[ i ], terrain->mFaceTangents[ face ], terrain->mFaceBiNormals[ face ] );
+
+			// Bottom left, upper right, bottom right
+			terrain->CalculateTangentBiNormal( lower[ i ], upper[ i + 1 ], lower[ i + 1 ], terrain->mFaceTangents[ face + 1 ], terrain->mFaceBiNormals[ face + 1 ] );
+		}
+
+		swap  = lower;
+		lower = upper;
+		upper = swap;
+	}
+
+	return;
+}
+
+
+// VertexVectorRows                                    //
+// Sums the faces around each point then normalizes -  //
+// a point is the bottom left of both faces of the     //
+// cell above right of it, the bottom right of the     //
+// second face to its left, the upper left of the      //
+// first face below it and the upper right of both     //
+// faces of the cell below left of it                  //
+void TerrainClass::VertexVectorRows( void* data, int startRow, int endRow, int threadIndex ) {
+	TerrainClass* terrain = ( TerrainClass* )data;
+	const RegionType& cells  = terrain->mCellRegion;
+	const RegionType& points = terrain->mPointRegion;
+	int width, height, cellsWide, faces[ 6 ], faceCount;
+	VectorType tangent, biNormal;
+	HeightMapType* point;
+	float length;
+
+	width     = terrain->mTerrainWidth;
+	height    = terrain->mTerrainHeight;
+	cellsWide = cells.maxX - cells.minX + 1;
+
+	for( int j = startRow; j < endRow; j++ ) {
+		for( int i = points.minX; i <= points.maxX; i++ ) {
+			faceCount = 0;
+
+			if( i < ( width - 1 ) && j < ( height - 1 ) ) {
+				faces[ faceCount++ ] = ( ( ( j - cells.minZ ) * cellsWide ) + ( i - cells.minX ) ) * 2;
+				faces[ faceCount++ ] = ( ( ( ( j - cells.minZ ) * cellsWide ) + ( i - cells.minX ) ) * 2 ) + 1;
+			}
+			if( i > 0 && j < ( height - 1 ) ) {
+				faces[ faceCount++ ] = ( ( ( ( j - cells.minZ ) * cellsWide ) + ( i - 1 - cells.minX ) ) * 2 ) + 1;
+			}
+			if( i < ( width - 1 ) && j > 0 ) {
+				faces[ faceCount++ ] = ( ( ( j - 1 - cells.minZ ) * cellsWide ) + ( i - cells.minX ) ) * 2;
+			}
+			if( i > 0 && j > 0 ) {
+				faces[ faceCount++ ] = ( ( ( j - 1 - cells.minZ ) * cellsWide ) + ( i - 1 - cells.minX ) ) * 2;
+				faces[ faceCount++ ] = ( ( ( ( j - 1 - cells.minZ ) * cellsWide ) + ( i - 1 - cells.minX ) ) * 2 ) + 1;
+			}
+
+			tangent.x = tangent.y = tangent.z = 0.0f;
+			biNormal.x = biNormal.y = biNormal.z = 0.0f;
+
+			for( int k = 0; k < faceCount; k++ ) {
+				tangent.x  += terrain->mFaceTangents[ faces[ k ] ].x;
+				tangent.y  += terrain->mFaceTangents[ faces[ k ] ].y;
+				tangent.z  += terrain->mFaceTangents[ faces[ k ] ].z;
+				biNormal.x += terrain->mFaceBiNormals[ faces[ k ] ].x;
+				biNormal.y += terrain->mFaceBiNormals[ faces[ k ] ].y;
+				biNormal.z += terrain->mFaceBiNormals[ faces[ k ] ].z;
+			}
+
+			point = &terrain->pHeightMap[ ( width * j ) + i ];
+
+			length = sqrt( ( tangent.x * tangent.x ) + ( tangent.y * tangent.y ) + ( tangent.z * tangent.z ) );
+			point->tx = tangent.x / length;
+			point->ty = tangent.y / length;
+			point->tz = tangent.z / length;
+
+			length = sqrt( ( biNormal.x * biNormal.x ) + ( biNormal.y * biNormal.y ) + ( biNormal.z * biNormal.z ) );
+			point->bx = biNormal.x / length;
+			point->by = biNormal.y / length;
+			point->bz = biNormal.z / length;
+		}
+	}
+
+	return;
+}
+
+
 // RandomRange                           //
 // Random float between passed max & min //
 float RandomRange( float min, float max ) {
@@ -1140,3 +1835,465 @@ float TerrainClass::GetSquareAverage( std::vector< float > &vector, int i, int j
 	return newHeight;
 }
 
+
+// GenerateHeights                                  //
+// Fills the height map from pHeightGenerator - one //
+// sample per grid point starting at the origin     //
+void TerrainClass::GenerateHeights() {
+	std::vector< float > heights;
+
+	heights.resize( mTerrainWidth * mTerrainHeight );
+
+	pHeightGenerator->GenerateTile( &heights[ 0 ], mTerrainWidth, mTerrainHeight, 0.0f, 0.0f, 1.0f );
+
+	for( int index = 0; index < ( mTerrainWidth * mTerrainHeight ); index++ ) {
+		pHeightMap[ index ].y = heights[ index ];
+	}
+}
+
+
+// ErodeHeights                                //
+// Runs pErosion over a copy of the heights    //
+// True if every iteration ran                 //
+bool TerrainClass::ErodeHeights() {
+	std::vector< float > heights;
+
+	heights.resize( mTerrainWidth * mTerrainHeight );
+
+	for( int index = 0; index < ( mTerrainWidth * mTerrainHeight ); index++ ) {
+		heights[ index ] = pHeightMap[ index ].y;
+	}
+
+	pErosion->Erode( &heights[ 0 ], mTerrainWidth, mTerrainHeight );
+
+	for( int index = 0; index < ( mTerrainWidth * mTerrainHeight ); index++ ) {
+		pHeightMap[ index ].y = heights[ index ];
+	}
+
+	return pErosion->WasLastRunComplete();
+}
+
+
+// GetCacheKey                                   //
+// Folds the terrain's own settings into the     //
+// caller's key along with which stages ran      //
+unsigned __int64 TerrainClass::GetCacheKey( int terrainDimension, int smoothingPasses, float displacementValue ) {
+	unsigned __int64 key;
+	int stages[ 2 ];
+
+	stages[ 0 ] = pHeightGenerator ? 1 : 0;
+	stages[ 1 ] = pErosion ? 1 : 0;
+
+	key = HeightfieldCacheClass::HashParameters( &mCacheParametersKey, sizeof( mCacheParametersKey ), HEIGHTFIELD_HASH_BASIS );
+	key = HeightfieldCacheClass::HashParameters( &terrainDimension, sizeof( terrainDimension ), key );
+	key = HeightfieldCacheClass::HashParameters( &smoothingPasses, sizeof( smoothingPasses ), key );
+	key = HeightfieldCacheClass::HashParameters( &displacementValue, sizeof( displacementValue ), key );
+	key = HeightfieldCacheClass::HashParameters( stages, sizeof( stages ), key );
+
+	return key;
+}
+
+
+// LoadCachedHeights                               //
+// Reads heights and normals straight out of the   //
+// mapped cache file - false on a miss             //
+bool TerrainClass::LoadCachedHeights( unsigned __int64 cacheKey ) {
+	const HeightfieldCacheClass::HeaderType* header;
+
+	if( !pHeightfieldCache->Open( mSeed, cacheKey ) ) {
+		return false;
+	}
+
+	// Only usable if it matches this terrain and has normals
+	header = pHeightfieldCache->GetHeader();
+	if( header->width != mTerrainWidth || header->height != mTerrainHeight || !pHeightfieldCache->GetNormals() ) {
+		pHeightfieldCache->Close();
+		return false;
+	}
+
+	for( int index = 0; index < ( mTerrainWidth * mTerrainHeight ); index++ ) {
+		pHeightMap[ index ].y = pHeightfieldCache->GetHeight( index );
+		pHeightfieldCache->GetNormal( index, pHeightMap[ index ].nx, pHeightMap[ index ].ny, pHeightMap[ index ].nz );
+	}
+
+	pHeightfieldCache->Close();
+
+	return true;
+}
+
+
+// SaveCachedHeights                          //
+// Writes the finished heights and normals    //
+void TerrainClass::SaveCachedHeights( unsigned __int64 cacheKey ) {
+	std::vector< float > heights, normals;
+
+	heights.resize( mTerrainWidth * mTerrainHeight );
+	normals.resize( mTerrainWidth * mTerrainHeight * 3 );
+
+	for( int index = 0; index < ( mTerrainWidth * mTerrainHeight ); index++ ) {
+		heights[ index ]                 = pHeightMap[ index ].y;
+		normals[ ( index * 3 ) ]         = pHeightMap[ index ].nx;
+		normals[ ( index * 3 ) + 1 ]     = pHeightMap[ index ].ny;
+		normals[ ( index * 3 ) + 2 ]     = pHeightMap[ index ].nz;
+	}
+
+	HeightfieldCacheClass::Save( mSeed, cacheKey, mTerrainWidth, mTerrainHeight, &heights[ 0 ], &normals[ 0 ] );
+}
+
+
+// GetTextureScale                                //
+// Texture coordinate step per grid cell          //
+float TerrainClass::GetTextureScale() {
+	return 1.0f / ( float )( mTerrainWidth / TEXTURE_REPEAT );
+}
+
+
+// EncodeNormal                                               //
+// Octahedral mapping with y as the pole - the normal is      //
+// projected onto the octahedron |x| + |y| + |z| = 1 and the  //
+// lower half folded over the diagonals, leaving x / z        //
+void TerrainClass::EncodeNormal( const HeightMapType& point, short* encoded ) {
+	float sum, u, v, foldU, foldV;
+
+	sum = fabs( point.nx ) + fabs( point.ny ) + fabs( point.nz );
+	u = point.nx / sum;
+	v = point.nz / sum;
+
+	// Fold the lower hemisphere
+	if( point.ny < 0.0f ) {
+		foldU = ( 1.0f - fabs( v ) ) * ( ( u >= 0.0f ) ? 1.0f : -1.0f );
+		foldV = ( 1.0f - fabs( u ) ) * ( ( v >= 0.0f ) ? 1.0f : -1.0f );
+		u = foldU;
+		v = foldV;
+	}
+
+	encoded[ 0 ] = ( short )floor( ( u * 32767.0f ) + 0.5f );
+	encoded[ 1 ] = ( short )floor( ( v * 32767.0f ) + 0.5f );
+}
+
+
+// EncodeTangentFrame                                        //
+// Quaternion rotating +x / +y / -z onto the vertex's        //
+// tangent / normal / biNormal - the tangent is made         //
+// orthogonal to the normal and the biNormal rebuilt as      //
+// normal x tangent, so the handedness is always the same    //
+// and the original biNormal's direction is not kept         //
+void TerrainClass::EncodeTangentFrame( const HeightMapType& point, signed char* encoded ) {
+	float t[ 3 ], n[ 3 ], b[ 3 ], m[ 3 ][ 3 ], q[ 4 ];
+	float dot, length, trace, scale;
+
+	n[ 0 ] = point.nx;
+	n[ 1 ] = point.ny;
+	n[ 2 ] = point.nz;
+
+	// Gram-Schmidt the tangent against the normal
+	dot = ( point.tx * n[ 0 ] ) + ( point.ty * n[ 1 ] ) + ( point.tz * n[ 2 ] );
+	t[ 0 ] = point.tx - ( n[ 0 ] * dot );
+	t[ 1 ] = point.ty - ( n[ 1 ] * dot );
+	t[ 2 ] = point.tz - ( n[ 2 ] * dot );
+
+	length = sqrt( ( t[ 0 ] * t[ 0 ] ) + ( t[ 1 ] * t[ 1 ] ) + ( t[ 2 ] * t[ 2 ] ) );
+	if( length < 1.0e-6f ) {
+		// Degenerate - fall back to the texture's x direction
+		t[ 0 ] = n[ 1 ];
+		t[ 1 ] = -n[ 0 ];
+		t[ 2 ] = 0.0f;
+		length = sqrt( ( t[ 0 ] * t[ 0 ] ) + ( t[ 1 ] * t[ 1 ] ) );
+	}
+
+	t[ 0 ] /= length;
+	t[ 1 ] /= length;
+	t[ 2 ] /= length;
+
+	// biNormal = normal x tangent
+	b[ 0 ] = ( n[ 1 ] * t[ 2 ] ) - ( n[ 2 ] * t[ 1 ] );
+	b[ 1 ] = ( n[ 2 ] * t[ 0 ] ) - ( n[ 0 ] * t[ 2 ] );
+	b[ 2 ] = ( n[ 0 ] * t[ 1 ] ) - ( n[ 1 ] * t[ 0 ] );
+
+	// Rotation matrix - columns are where +x, +y and +z end up
+	for( int row = 0; row < 3; row++ ) {
+		m[ row ][ 0 ] = t[ row ];
+		m[ row ][ 1 ] = n[ row ];
+		m[ row ][ 2 ] = -b[ row ];
+	}
+
+	// Matrix to quaternion (x, y, z, w) - largest component first for precision
+	trace = m[ 0 ][ 0 ] + m[ 1 ][ 1 ] + m[ 2 ][ 2 ];
+	if( trace > 0.0f ) {
+		scale  = 0.5f / sqrt( trace + 1.0f );
+		q[ 3 ] = 0.25f / scale;
+		q[ 0 ] = ( m[ 2 ][ 1 ] - m[ 1 ][ 2 ] ) * scale;
+		q[ 1 ] = ( m[ 0 ][ 2 ] - m[ 2 ][ 0 ] ) * scale;
+		q[ 2 ] = ( m[ 1 ][ 0 ] - m[ 0 ][ 1 ] ) * scale;
+	} else if( m[ 0 ][ 0 ] > m[ 1 ][ 1 ] && m[ 0 ][ 0 ] > m[ 2 ][ 2 ] ) {
+		scale  = 2.0f * sqrt( 1.0f + m[ 0 ][ 0 ] - m[ 1 ][ 1 ] - m[ 2 ][ 2 ] );
+		q[ 3 ] = ( m[ 2 ][ 1 ] - m[ 1 ][ 2 ] ) / scale;
+		q[ 0 ] = 0.25f * scale;
+		q[ 1 ] = ( m[ 0 ][ 1 ] + m[ 1 ][ 0 ] ) / scale;
+		q[ 2 ] = ( m[ 0 ][ 2 ] + m[ 2 ][ 0 ] ) / scale;
+	} else if( m[ 1 ][ 1 ] > m[ 2 ][ 2 ] ) {
+		scale  = 2.0f * sqrt( 1.0f + m[ 1 ][ 1 ] - m[ 0 ][ 0 ] - m[ 2 ][ 2 ] );
+		q[ 3 ] = ( m[ 0 ][ 2 ] - m[ 2 ][ 0 ] ) / scale;
+		q[ 0 ] = ( m[ 0 ][ 1 ] + m[ 1 ][ 0 ] ) / scale;
+		q[ 1 ] = 0.25f * scale;
+		q[ 2 ] = ( m[ 1 ][ 2 ] + m[ 2 ][ 1 ] ) / scale;
+	} else {
+		scale  = 2.0f * sqrt( 1.0f + m[ 2 ][ 2 ] - m[ 0 ][ 0 ] - m[ 1 ][ 1 ] );
+		q[ 3 ] = ( m[ 1 ][ 0 ] - m[ 0 ][ 1 ] ) / scale;
+		q[ 0 ] = ( m[ 0 ][ 2 ] + m[ 2 ][ 0 ] ) / scale;
+		q[ 1 ] = ( m[ 1 ][ 2 ] + m[ 2 ][ 1 ] ) / scale;
+		q[ 2 ] = 0.25f * scale;
+	}
+
+	// q and -q are the same rotation - keep w positive
+	scale = ( q[ 3 ] < 0.0f ) ? -1.0f : 1.0f;
+	length = sqrt( ( q[ 0 ] * q[ 0 ] ) + ( q[ 1 ] * q[ 1 ] ) + ( q[ 2 ] * q[ 2 ] ) + ( q[ 3 ] * q[ 3 ] ) );
+
+	for( int i = 0; i < 4; i++ ) {
+		encoded[ i ] = ( signed char )floor( ( q[ i ] * scale / length * 127.0f ) + 0.5f );
+	}
+}
+
+
+// GetVertexDecode                                       //
+// Values Terrain.vs needs to rebuild a compact vertex - //
+// grid width, minimum height, height range and texture  //
+// coordinate step                                       //
+void TerrainClass::GetVertexDecode( D3DXVECTOR4& decode ) {
+	decode = D3DXVECTOR4( ( float )mTerrainWidth, mMinHeight, mHeightRange, GetTextureScale() );
+}
+
+
+// GetVertexLayout                                         //
+// Input layout for the compact vertex - used by the       //
+// shader classes that draw the terrain                    //
+const D3D11_INPUT_ELEMENT_DESC* TerrainClass::GetVertexLayout( unsigned int& elementCount ) {
+	static const D3D11_INPUT_ELEMENT_DESC layout[] = {
+		{ "NORMAL",   0, DXGI_FORMAT_R16G16_SNORM,      0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "TANGENT",  0, DXGI_FORMAT_R8G8B8A8_SNORM,    0, 4, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		{ "POSITION", 0, DXGI_FORMAT_R16_UNORM,         0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+	};
+
+	elementCount = sizeof( layout ) / sizeof( layout[ 0 ] );
+
+	return layout;
+}
+
+
+// MarkDirty                                          //
+// Grows the dirty rectangle to cover the grid points //
+// minX - maxX, minZ - maxZ (inclusive, clamped)      //
+void TerrainClass::MarkDirty( int minX, int minZ, int maxX, int maxZ ) {
+	minX = ( minX < 0 ) ? 0 : minX;
+	minZ = ( minZ < 0 ) ? 0 : minZ;
+	maxX = ( maxX > mTerrainWidth - 1 ) ? mTerrainWidth - 1 : maxX;
+	maxZ = ( maxZ > mTerrainHeight - 1 ) ? mTerrainHeight - 1 : maxZ;
+
+	if( minX > maxX || minZ > maxZ ) {
+		return;
+	}
+
+	if( !HasDirtyRegion() ) {
+		mDirtyMinX = minX;
+		mDirtyMinZ = minZ;
+		mDirtyMaxX = maxX;
+		mDirtyMaxZ = maxZ;
+	} else {
+		mDirtyMinX = ( minX < mDirtyMinX ) ? minX : mDirtyMinX;
+		mDirtyMinZ = ( minZ < mDirtyMinZ ) ? minZ : mDirtyMinZ;
+		mDirtyMaxX = ( maxX > mDirtyMaxX ) ? maxX : mDirtyMaxX;
+		mDirtyMaxZ = ( maxZ > mDirtyMaxZ ) ? maxZ : mDirtyMaxZ;
+	}
+
+	return;
+}
+
+
+// HasDirtyRegion //
+bool TerrainClass::HasDirtyRegion() {
+	return ( mDirtyMaxX >= mDirtyMinX );
+}
+
+
+// GetDirtyRegion                                     //
+// Points not yet uploaded - false when there are none //
+bool TerrainClass::GetDirtyRegion( int& minX, int& minZ, int& maxX, int& maxZ ) {
+	minX = mDirtyMinX;
+	minZ = mDirtyMinZ;
+	maxX = mDirtyMaxX;
+	maxZ = mDirtyMaxZ;
+
+	return HasDirtyRegion();
+}
+
+
+// UploadDirtyRegion                                      //
+// Encodes the dirty rectangle straight into the next     //
+// staging buffer, one row after another, then copies     //
+// each row to its place in the vertex buffer (one copy   //
+// if the rows span the whole width)                      //
+// Rectangles bigger than a staging buffer go in bands of //
+// as many rows as fit, one buffer each                   //
+// A height outside the quantized range requantizes the   //
+// whole terrain with some headroom                       //
+bool TerrainClass::UploadDirtyRegion( ID3D11DeviceContext* deviceContext ) {
+	VertexType* vertices;
+	float maxHeight;
+	int width, rows, bandStart, bandRows;
+	unsigned int rowSize;
+	bool outOfRange;
+
+	if( !HasDirtyRegion() ) {
+		mLastUploadCount = 0;
+		return true;
+	}
+
+	// Check the edited heights still fit
+	maxHeight  = mMinHeight + mHeightRange;
+	outOfRange = false;
+	for( int j = mDirtyMinZ; j <= mDirtyMaxZ && !outOfRange; j++ ) {
+		for( int i = mDirtyMinX; i <= mDirtyMaxX; i++ ) {
+			if( pHeightMap[ ( mTerrainWidth * j ) + i ].y < mMinHeight || pHeightMap[ ( mTerrainWidth * j ) + i ].y > maxHeight ) {
+				outOfRange = true;
+				break;
+			}
+		}
+	}
+
+	if( outOfRange ) {
+		CalculateHeightRange( TERRAIN_HEIGHT_HEADROOM );
+		MarkDirty( 0, 0, mTerrainWidth - 1, mTerrainHeight - 1 );
+	}
+
+	width   = mDirtyMaxX - mDirtyMinX + 1;
+	rows    = mDirtyMaxZ - mDirtyMinZ + 1;
+	rowSize = width * sizeof( VertexType );
+
+	for( bandStart = mDirtyMinZ; bandStart <= mDirtyMaxZ; bandStart += bandRows ) {
+		bandRows = ( int )( pStagingRing->GetBufferSize() / rowSize );
+		if( bandRows > ( mDirtyMaxZ - bandStart + 1 ) ) {
+			bandRows = mDirtyMaxZ - bandStart + 1;
+		}
+
+		vertices = ( VertexType* )pStagingRing->Map( deviceContext );
+		if( !vertices ) {
+			return false;
+		}
+
+		for( int j = 0; j < bandRows; j++ ) {
+			for( int i = 0; i < width; i++ ) {
+				EncodeVertex( ( mTerrainWidth * ( bandStart + j ) ) + ( mDirtyMinX + i ), vertices[ ( width * j ) + i ] );
+			}
+		}
+
+		pStagingRing->Unmap( deviceContext );
+
+		if( width == mTerrainWidth ) {
+			pStagingRing->CopyTo( deviceContext, pVertexBuffer, mTerrainWidth * bandStart * sizeof( VertexType ), 0, rowSize * bandRows );
+		} else {
+			for( int j = 0; j < bandRows; j++ ) {
+				pStagingRing->CopyTo( deviceContext,
+					                  pVertexBuffer,
+									  ( ( mTerrainWidth * ( bandStart + j ) ) + mDirtyMinX ) * sizeof( VertexType ),
+									  j * rowSize,
+									  rowSize );
+			}
+		}
+	}
+
+	mLastUploadCount = width * rows;
+
+	// Clean
+	mDirtyMinX = mDirtyMinZ = 0;
+	mDirtyMaxX = mDirtyMaxZ = -1;
+
+	return true;
+}
+
+
+// GetLastUploadCount                      //
+// Vertices sent by the last upload        //
+int TerrainClass::GetLastUploadCount() {
+	return mLastUploadCount;
+}
+
+
+// Regenerate                                            //
+// Builds a new height map with the current settings     //
+// and streams it into the existing vertex buffer - the  //
+// textures are kept and the index buffer is only        //
+// rebuilt for a simplified mesh                         //
+bool TerrainClass::Regenerate( ID3D11Device* device, int smoothingPasses, float displacementValue ) {
+	RegionType points;
+	bool result;
+
+	ShutdownHeightMap();
+
+	result = InitializeHeightMap( mTerrainWidth, smoothingPasses, displacementValue );
+	if( !result ) {
+		return false;
+	}
+
+	// Requantize over the new heights and upload it all
+	CalculateHeightRange( 0.0f );
+	MarkDirty( 0, 0, mTerrainWidth - 1, mTerrainHeight - 1 );
+
+	points.minX = points.minZ = 0;
+	points.maxX = mTerrainWidth - 1;
+	points.maxZ = mTerrainHeight - 1;
+
+	// The uniform grid does not depend on the heights
+	if( mMaxError > 0.0f || mIndexMaxError > 0.0f ) {
+		result = UpdateSimplifiedMesh( device );
+		if( !result ) {
+			return false;
+		}
+	} else {
+		UpdateChunkBounds( points );
+	}
+
+	return true;
+}
+
+
+// CalculateHeightRange                          //
+// Range the unorm16 heights are quantized over  //
+// headroom - fraction of the range added above  //
+// and below so small edits stay inside it       //
+void TerrainClass::CalculateHeightRange( float headroom ) {
+	float maxHeight;
+
+	mMinHeight = maxHeight = pHeightMap[ 0 ].y;
+	for( int index = 1; index < ( mTerrainWidth * mTerrainHeight ); index++ ) {
+		if( pHeightMap[ index ].y < mMinHeight ) {
+			mMinHeight = pHeightMap[ index ].y;
+		}
+		if( pHeightMap[ index ].y > maxHeight ) {
+			maxHeight = pHeightMap[ index ].y;
+		}
+	}
+
+	mHeightRange = ( maxHeight > mMinHeight ) ? ( maxHeight - mMinHeight ) : 1.0f;
+
+	mMinHeight   -= mHeightRange * headroom;
+	mHeightRange += mHeightRange * headroom * 2.0f;
+
+	return;
+}
+
+
+// EncodeVertex                        //
+// Compact vertex for one grid point   //
+void TerrainClass::EncodeVertex( int index, VertexType& vertex ) {
+	float height;
+
+	height = ( ( pHeightMap[ index ].y - mMinHeight ) / mHeightRange ) * 65535.0f;
+
+	vertex.height  = ( unsigned short )( height + 0.5f );
+	vertex.padding = 0;
+
+	EncodeNormal( pHeightMap[ index ], vertex.normal );
+	EncodeTangentFrame( pHeightMap[ index ], vertex.tangentFrame );
+
+	return;
+}
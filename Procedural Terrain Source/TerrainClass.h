@@ -11,27 +11,49 @@
 
 // Application Includes //
 #include "TextureArrayClass.h"
+#include "HeightGeneratorClass.h"
+#include "ErosionClass.h"
+#include "HeightfieldCacheClass.h"
+#include "RTINClass.h"
+#include "JobSystemClass.h"
+#include "StagingRingClass.h"
 
 
 // Texture Repeat Variable
 const int TEXTURE_REPEAT = 8;
 
+// Rows per job when building the vertex vectors
+const int TERRAIN_JOB_ROWS = 16;
+
+// Cells along each side of a culling chunk
+const int TERRAIN_CHUNK_CELLS = 32;
+
+// Vertex streaming variables
+const int   TERRAIN_STAGING_BUFFERS = 3;     // uploads in flight before Map has to wait
+const float TERRAIN_HEIGHT_HEADROOM = 0.25f; // extra range when an edit leaves the quantized range
+const unsigned int TERRAIN_STAGING_SIZE = 4 * 1024 * 1024; // bytes per staging buffer - bigger uploads are banded
+
+// Sculpting variables
+const float TERRAIN_PICK_STEP     = 0.5f; // ray march step in cells
+const int   TERRAIN_PICK_BISECTS  = 8;    // refinement steps once the ray is under the surface
+
 
 // TerrainClass - based off rastertek                                                  //
 // Added tangent and biNormal variables and calculations to allow bumpmapping          //
 // DiamondSqaureAlgorithm - my own work (see report for references)                    //
 // Replaced terrain texture loading with Diamond-Square Algorithm                      //
 // Though an odd size is passed to create the terrain (as required by Diamond-Square ) //
-// The odd row and column are ignored as it breaks the texturing                       //
+// Vertices are shared in a compact format with continuous texture coordinates, so    //
+// the odd row and column are no longer cut off                                        //
 class TerrainClass {
 private:
-	// Vertex data
+	// Compact vertex data - 12 bytes (was 56)                  //
+	// x / z and the texture coordinates come from SV_VertexID  //
 	struct VertexType {
-		D3DXVECTOR3 position;
-		D3DXVECTOR2 texture;
-		D3DXVECTOR3 normal;
-		D3DXVECTOR3 tangent;
-		D3DXVECTOR3 biNormal;
+		short normal[ 2 ];             // octahedral, snorm16
+		signed char tangentFrame[ 4 ]; // quaternion, snorm8
+		unsigned short height;         // unorm16 over the height range
+		unsigned short padding;        // keeps the stride 4 byte aligned
 	};
 
 	// HeightMap data
@@ -55,6 +77,27 @@ private:
 		float x, y, z;
 	};
 
+	// Rectangle of grid points or cells (inclusive)
+	struct RegionType {
+		int minX, minZ, maxX, maxZ;
+	};
+
+	// Culling chunk - a contiguous run of the index buffer
+	struct ChunkType {
+		RegionType points;          // grid points its triangles use
+		D3DXVECTOR3 minimum, maximum;
+		int indexStart, indexCount;
+	};
+
+public:
+	// Sculpting brushes
+	enum BrushType {
+		BRUSH_RAISE,
+		BRUSH_LOWER,
+		BRUSH_SMOOTH,
+		BRUSH_COUNT
+	};
+
 public:
 	TerrainClass();
 	TerrainClass( const TerrainClass& other );
@@ -83,11 +126,99 @@ public:
 
 	void GenerateNewTerrain();
 
+	// Height map half of Initialize - no device needed, so tools can
+	// build the terrain's height map and vectors on their own
+	bool InitializeHeightMap( int terrainDimension, int smoothingPasses, float displacementValue );
+
+	// Rebuilds the texture coordinates, tangents and biNormals
+	void UpdateVertexVectors();
+
+	// New height map with the current settings, streamed into the
+	// existing vertex buffer (textures are kept)
+	bool Regenerate( ID3D11Device* device, int smoothingPasses, float displacementValue );
+
+	// Vertex streaming                                             //
+	// Edits mark the grid points they change (inclusive) and the   //
+	// dirty rectangle is uploaded through the staging ring - call  //
+	// UploadDirtyRegion once a frame before drawing                //
+	void MarkDirty( int minX, int minZ, int maxX, int maxZ );
+	bool HasDirtyRegion();
+	bool GetDirtyRegion( int& minX, int& minZ, int& maxX, int& maxZ );
+	bool UploadDirtyRegion( ID3D11DeviceContext* deviceContext );
+	int GetLastUploadCount();
+
+	// Height source - DiamondSquareAlgorithm is used if none is set
+	// Must be set before Initialize, the generator is not owned
+	void SetHeightGenerator( HeightGeneratorClass* generator );
+
+	// Erosion stage run after smoothing - NULL skips it
+	// Must be set before Initialize, the erosion object is not owned
+	void SetErosion( ErosionClass* erosion );
+
+	// Seed for Diamond-Square (the noise generators carry their own)
+	void SetSeed( unsigned int seed );
+
+	// Heightfield cache - NULL always regenerates                   //
+	// parametersKey covers the caller's generator / erosion settings //
+	// The cache object is not owned                                  //
+	void SetHeightfieldCache( HeightfieldCacheClass* cache, unsigned __int64 parametersKey );
+	bool WasLoadedFromCache();
+
+	// Mesh simplification - largest vertical error allowed between the //
+	// mesh and the height map, 0 keeps the uniform grid                 //
+	// Must be set before Initialize                                     //
+	void SetSimplification( float maxError );
+
+	// Job system for the vertex vector loops - NULL runs them serially
+	// The job system is not owned
+	void SetJobSystem( JobSystemClass* jobSystem );
+
+	// Compact vertex decoding - see Terrain.vs
+	void GetVertexDecode( D3DXVECTOR4& decode );
+	static const D3D11_INPUT_ELEMENT_DESC* GetVertexLayout( unsigned int& elementCount );
+
+	// Height map queries - x / z in terrain (model) space
+	int GetTerrainWidth();
+	int GetTerrainHeight();
+	float GetHeightAt( float x, float z );
+	void GetNormalAt( float x, float z, D3DXVECTOR3& normal );
+
+	// Copies the heights of grid points minX - maxX, minZ - maxZ
+	// (inclusive) - rowPitch floats apart in heights
+	void GetHeights( int minX, int minZ, int maxX, int maxZ, float* heights, int rowPitch );
+
+	// Sculpting                                                     //
+	// The brush changes the heights within radius of x / z with a   //
+	// smooth falloff - strength is the height (raise / lower) or    //
+	// blend (smooth, 0 - 1) at the centre. Normals, tangents and    //
+	// biNormals are only recalculated around the brush, which is    //
+	// marked dirty for the next UploadDirtyRegion                   //
+	void ApplyBrush( BrushType brush, float x, float z, float radius, float strength );
+
+	// Rebuilds a simplified (RTIN) mesh over the sculpted heights so it //
+	// stays within its error - call when a stroke ends, or after        //
+	// SetSimplification to switch meshes. The uniform grid does not     //
+	// depend on the heights and is left alone once it is built          //
+	bool UpdateSimplifiedMesh( ID3D11Device* device );
+
+	// First point where a ray (terrain space) meets the surface
+	bool PickSurface( const D3DXVECTOR3& origin, const D3DXVECTOR3& direction, D3DXVECTOR3& position );
+
+	// Chunks                                                       //
+	// The index buffer is ordered in chunks of about               //
+	// TERRAIN_CHUNK_CELLS square so passes can cull the terrain    //
+	// Bounds are in terrain space and follow edits                 //
+	int GetChunkCount();
+	void GetChunk( int chunk, D3DXVECTOR3& minimum, D3DXVECTOR3& maximum, int& indexStart, int& indexCount );
+	void GetBounds( D3DXVECTOR3& minimum, D3DXVECTOR3& maximum );
+
 private:
 	// Initialization functions
 	//bool LoadHeightMap( char* ); // ***REMOVED*** - procedural terrain generation
 	void NormalizeHeightMap();     // ***UNUSED***  - duplicated in DiamondSquareAlgorithm
 	bool CalculateNormals();
+	void CalculateNormals( const RegionType& points );
+	void GetCellsAround( const RegionType& points, RegionType& cells );
 	void ShutdownHeightMap();
 
 	// Texture functions
@@ -105,14 +236,25 @@ private:
 
 	// Buffer functions
 	bool InitializeBuffers( ID3D11Device* device );
+	bool InitializeIndexBuffer( ID3D11Device* device );
+	void UpdateChunkBounds( const RegionType& points );
 	void ShutdownBuffers();
 	void RenderBuffers( ID3D11DeviceContext* deviceContext );
 
+	// Compact vertex functions
+	float GetTextureScale();
+	void EncodeNormal( const HeightMapType& point, short* encoded );
+	void EncodeTangentFrame( const HeightMapType& point, signed char* encoded );
+	void EncodeVertex( int index, VertexType& vertex );
+	void CalculateHeightRange( float headroom );
+
 	// Tangent / BiNormal functions
 	void CalculateModelVectors();
-	void CalculateTangentBiNormal( TempVertexType vertex1,
-		                           TempVertexType vertex2,
-								   TempVertexType vertex3,
+	void CalculateModelVectors( const RegionType& points );
+	void GetTempVertex( int index, TempVertexType& vertex );
+	void CalculateTangentBiNormal( const TempVertexType& vertex1,
+		                           const TempVertexType& vertex2,
+								   const TempVertexType& vertex3,
 								   VectorType& tangent,
 								   VectorType& biNormal );
 
@@ -120,20 +262,70 @@ private:
 		                  VectorType biNormal,
 						  VectorType& normal );
 
+	// Job functions - data is the TerrainClass
+	void RunRows( int startRow, int endRow, JobSystemClass::RangeFunction function );
+	static void TextureCoordinateRows( void* data, int startRow, int endRow, int threadIndex );
+	static void FaceVectorRows( void* data, int startRow, int endRow, int threadIndex );
+	static void VertexVectorRows( void* data, int startRow, int endRow, int threadIndex );
+
 	// Procedural terrain functions
 	void SmoothHeights( int strength );
 	void DiamondSquareAlgorithm( float cornerHeight, float randomRange, float heightScalar );
 	float GetSquareAverage( std::vector< float > &vector, int i, int j, int step, float randomRange, float smoothingValue );
+	void GenerateHeights();
+	bool ErodeHeights();
+
+	// Sculpting functions
+	void UpdateRegion( const RegionType& heights );
+	bool ClipRaySlab( float origin, float direction, float minimum, float maximum, float& nearT, float& farT );
+
+	// Heightfield cache functions
+	unsigned __int64 GetCacheKey( int terrainDimension, int smoothingPasses, float displacementValue );
+	bool LoadCachedHeights( unsigned __int64 cacheKey );
+	void SaveCachedHeights( unsigned __int64 cacheKey );
 
 private:
 	// Terrain variables
 	int mTerrainWidth, mTerrainHeight;
 	int mVertexCount, mIndexCount;
+	unsigned int mSeed;
+	unsigned __int64 mCacheParametersKey;
+	bool mLoadedFromCache;
+	float mMaxError;
+	float mMinHeight, mHeightRange;
+	float mIndexMaxError; // mMaxError the index buffer was built with
+
+	// Dirty rectangle in grid points (empty when max < min)
+	int mDirtyMinX, mDirtyMinZ, mDirtyMaxX, mDirtyMaxZ;
+	int mLastUploadCount;
 
 	// Object pointers
 	ID3D11Buffer *pVertexBuffer, *pIndexBuffer;
+	StagingRingClass* pStagingRing;
 	TextureArrayClass* pTextureArray;
 	HeightMapType*     pHeightMap;
+	HeightGeneratorClass* pHeightGenerator;
+	ErosionClass*         pErosion;
+	HeightfieldCacheClass* pHeightfieldCache;
+	JobSystemClass*        pJobSystem;
+
+	// Face normals of the cells around the last normal update
+	std::vector< VectorType > mFaceNormals;
+
+	// Tangent and biNormal of each face (two per cell) of mCellRegion -
+	// the cells around mPointRegion, the points being recalculated
+	std::vector< VectorType > mFaceTangents, mFaceBiNormals;
+	RegionType mPointRegion, mCellRegion;
+
+	// Culling chunks, row by row
+	std::vector< ChunkType > mChunks;
+	int mChunksWide, mChunksHigh;
+
+	// Heights under the smoothing brush before it is applied
+	std::vector< float > mBrushHeights;
+
+	// Per-thread copies of the two rows a strip of faces uses
+	std::vector< TempVertexType > mScratchRows[ JOB_MAX_THREADS ];
 };
 
 
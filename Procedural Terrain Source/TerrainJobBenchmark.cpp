@@ -0,0 +1,74 @@
+// TerrainJobBenchmark                                              //
+// Console timing of TerrainClass's texture coordinate, tangent and //
+// biNormal loops on the job system - each terrain size is run with //
+// 1 thread up to one per core and the speedup over 1 is printed    //
+// Only the height map half of TerrainClass is used, no device      //
+#include <stdio.h>
+#include "JobSystemClass.h"
+#include "TerrainClass.h"
+#include "BenchmarkTimer.h"
+
+
+// Benchmark Variables
+const int BENCHMARK_SIZE_COUNT = 3;
+const int BENCHMARK_SIZES[ BENCHMARK_SIZE_COUNT ] = { 257, 513, 1025 }; // (2^n) + 1 for Diamond-Square
+const int BENCHMARK_PASSES     = 20;
+
+
+int main() {
+	JobSystemClass jobSystem;
+	TerrainClass terrain;
+	SYSTEM_INFO systemInfo;
+	LARGE_INTEGER startTime, endTime;
+	double passTime, singleThreadTime;
+	int coreCount;
+
+	GetSystemInfo( &systemInfo );
+	coreCount = ( int )systemInfo.dwNumberOfProcessors;
+	if( coreCount > JOB_MAX_THREADS ) {
+		coreCount = JOB_MAX_THREADS;
+	}
+
+	printf( "%-11s %8s %12s %10s\n", "Terrain", "Threads", "ms / pass", "Speedup" );
+
+	for( int size = 0; size < BENCHMARK_SIZE_COUNT; size++ ) {
+		if( !terrain.InitializeHeightMap( BENCHMARK_SIZES[ size ], 5, 10.0f ) ) {
+			printf( "Could not build a %d terrain\n", BENCHMARK_SIZES[ size ] );
+			return 1;
+		}
+
+		singleThreadTime = 0.0;
+
+		for( int threads = 1; threads <= coreCount; threads++ ) {
+			if( !jobSystem.Initialize( threads ) ) {
+				printf( "Could not start %d threads\n", threads );
+				return 1;
+			}
+
+			terrain.SetJobSystem( &jobSystem );
+
+			// Warm up - sizes the face and scratch buffers
+			terrain.UpdateVertexVectors();
+
+			QueryPerformanceCounter( &startTime );
+			for( int pass = 0; pass < BENCHMARK_PASSES; pass++ ) {
+				terrain.UpdateVertexVectors();
+			}
+			QueryPerformanceCounter( &endTime );
+
+			passTime = GetMilliseconds( startTime, endTime ) / BENCHMARK_PASSES;
+			if( threads == 1 ) {
+				singleThreadTime = passTime;
+			}
+
+			printf( "%4d x %-5d %8d %12.3f %9.2fx\n", BENCHMARK_SIZES[ size ], BENCHMARK_SIZES[ size ], threads, passTime, singleThreadTime / passTime );
+
+			terrain.SetJobSystem( 0 );
+			jobSystem.Shutdown();
+		}
+
+		terrain.Shutdown();
+	}
+
+	return 0;
+}
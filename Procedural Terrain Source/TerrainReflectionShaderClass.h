@@ -0,0 +1,49 @@
+#ifndef _TERRAINREFLECTIONSHADERCLASS_H_
+#define _TERRAINREFLECTIONSHADERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <fstream>
+using namespace std;
+
+
+// Application Includes //
+#include "ShaderCacheClass.h"
+#include "TerrainShaderClass.h"
+
+
+// TerrainReflectionShaderClass                                       //
+// Cheaper terrain for the ocean's reflection and refraction textures //
+// (TerrainReflection.vs / .ps) - same texture blend, no bump maps or //
+// shadows, clipped against the per-pass clip plane                   //
+// Draws TerrainClass's compact vertex with the shared buffers from   //
+// ConstantBufferManagerClass - commit them first                     //
+class TerrainReflectionShaderClass {
+public:
+	TerrainReflectionShaderClass();
+	TerrainReflectionShaderClass( const TerrainReflectionShaderClass& other );
+	~TerrainReflectionShaderClass();
+
+	bool Initialize( ID3D11Device* device, HWND hwnd );
+	void Shutdown();
+	bool Render( ID3D11DeviceContext* deviceContext, int indexCount, ID3D11ShaderResourceView** textureArray );
+
+private:
+	bool InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename );
+	void ShutdownShader();
+	void OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename );
+
+	bool SetShaderParameters( ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView** textureArray );
+	void RenderShader( ID3D11DeviceContext* deviceContext, int indexCount );
+
+private:
+	ID3D11VertexShader* pVertexShader;
+	ID3D11PixelShader*  pPixelShader;
+	ID3D11InputLayout*  pLayout;
+	ID3D11SamplerState* pSampleState;
+};
+
+
+#endif
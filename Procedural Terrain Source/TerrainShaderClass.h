@@ -0,0 +1,53 @@
+#ifndef _TERRAINSHADERCLASS_H_
+#define _TERRAINSHADERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <fstream>
+using namespace std;
+
+
+// Application Includes //
+#include "ShaderCacheClass.h"
+#include "TerrainClass.h"
+
+
+// Terrain Shader Variables
+const int TERRAIN_SHADER_TEXTURE_COUNT = 8; // 4 colour maps then their 4 bump maps
+
+
+// TerrainShaderClass                                                 //
+// Height and slope blended, bump mapped terrain (Terrain.vs / .ps)   //
+// Draws TerrainClass's compact vertex - the per-frame, per-pass,     //
+// per-object, per-terrain and per-shadow buffers all come from       //
+// ConstantBufferManagerClass - commit them first. The shadow and     //
+// horizon maps are bound by the caller                               //
+class TerrainShaderClass {
+public:
+	TerrainShaderClass();
+	TerrainShaderClass( const TerrainShaderClass& other );
+	~TerrainShaderClass();
+
+	bool Initialize( ID3D11Device* device, HWND hwnd );
+	void Shutdown();
+	bool Render( ID3D11DeviceContext* deviceContext, int indexCount, ID3D11ShaderResourceView** textureArray );
+
+private:
+	bool InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename );
+	void ShutdownShader();
+	void OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename );
+
+	bool SetShaderParameters( ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView** textureArray );
+	void RenderShader( ID3D11DeviceContext* deviceContext, int indexCount );
+
+private:
+	ID3D11VertexShader* pVertexShader;
+	ID3D11PixelShader*  pPixelShader;
+	ID3D11InputLayout*  pLayout;
+	ID3D11SamplerState* pSampleState;
+};
+
+
+#endif
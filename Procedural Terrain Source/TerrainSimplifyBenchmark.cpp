@@ -0,0 +1,75 @@
+// TerrainSimplifyBenchmark                                        //
+// Headless report for RTINClass - builds terrain sized noise      //
+// tiles for several seeds and prints the triangle count and the   //
+// measured vertical error at each error limit                     //
+// Returns non zero if a mesh is further from the heights than its //
+// limit allows                                                    //
+#include <stdio.h>
+#include <vector>
+#include "NoiseGeneratorClass.h"
+#include "RTINClass.h"
+
+
+// Benchmark Variables
+const int   BENCHMARK_TILE_SIZE      = 257; // same size as the terrain
+const int   BENCHMARK_SEED_COUNT     = 4;
+const int   BENCHMARK_ERROR_COUNT    = 6;
+const float BENCHMARK_ERRORS[ BENCHMARK_ERROR_COUNT ] = { 0.0f, 0.05f, 0.1f, 0.25f, 0.5f, 1.0f };
+
+
+int main() {
+	NoiseGeneratorClass generator;
+	NoiseGeneratorClass::NoiseParametersType parameters;
+	RTINClass rtin;
+	std::vector< float > heights;
+	std::vector< unsigned long > vertices, indices;
+	char* typeNames[ 3 ] = { "fBm", "Ridged", "Warped" };
+	int gridTriangles;
+	float measuredError;
+	bool passed;
+
+	if( !rtin.Initialize( BENCHMARK_TILE_SIZE ) ) {
+		printf( "Tile size must be (2^n) + 1\n" );
+		return 1;
+	}
+
+	heights.resize( BENCHMARK_TILE_SIZE * BENCHMARK_TILE_SIZE );
+	gridTriangles = ( BENCHMARK_TILE_SIZE - 1 ) * ( BENCHMARK_TILE_SIZE - 1 ) * 2;
+	passed = true;
+
+	printf( "%-8s %6s %10s %10s %10s %10s\n", "Noise", "Seed", "Max Error", "Triangles", "% of Grid", "Measured" );
+
+	parameters = generator.GetParameters();
+
+	for( int type = 0; type < 3; type++ ) {
+		for( int seed = 1; seed <= BENCHMARK_SEED_COUNT; seed++ ) {
+			parameters.type = ( NoiseGeneratorClass::NoiseType )type;
+			parameters.seed = seed;
+			generator.Initialize( parameters );
+			generator.GenerateTile( &heights[ 0 ], BENCHMARK_TILE_SIZE, BENCHMARK_TILE_SIZE, 0.0f, 0.0f, 1.0f );
+
+			rtin.ComputeErrors( &heights[ 0 ] );
+
+			for( int e = 0; e < BENCHMARK_ERROR_COUNT; e++ ) {
+				rtin.BuildMesh( BENCHMARK_ERRORS[ e ], vertices, indices );
+				measuredError = rtin.MeasureError( &heights[ 0 ], vertices, indices );
+
+				printf( "%-8s %6d %10.3f %10d %9.1f%% %10.4f\n",
+					    typeNames[ type ],
+						seed,
+						BENCHMARK_ERRORS[ e ],
+						( int )indices.size() / 3,
+						( float )( indices.size() / 3 ) * 100.0f / ( float )gridTriangles,
+						measuredError );
+
+				if( measuredError > BENCHMARK_ERRORS[ e ] + 1.0e-4f ) {
+					passed = false;
+				}
+			}
+		}
+	}
+
+	printf( "Error limits %s\n", passed ? "held" : "EXCEEDED" );
+
+	return passed ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+// Screen Matrices - world, base view and ortho
+cbuffer MatrixBuffer {
+	matrix worldMatrix;
+	matrix viewMatrix;
+	matrix projectionMatrix;
+};
+
+// Vertex Data - colour is per vertex so every sentence shares one draw
+struct VertexInputType {
+    float4 position : POSITION;
+    float2 tex : TEXCOORD0;
+	float4 color : COLOR;
+};
+
+// Pixel Data
+struct PixelInputType {
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+	float4 color : COLOR;
+};
+
+// TextBatchVS
+PixelInputType TextBatchVertexShader( VertexInputType input ) {
+    PixelInputType output;
+
+    // Change the position vector to be 4 units for proper matrix calculations
+    input.position.w = 1.0f;
+
+    // Calculate the position of the vertex against the world, view, and projection matrices
+    output.position = mul( input.position, worldMatrix );
+    output.position = mul( output.position, viewMatrix );
+    output.position = mul( output.position, projectionMatrix );
+
+    // Store the texture coordinates and colour for the pixel shader
+    output.tex   = input.tex;
+	output.color = input.color;
+
+    return output;
+}
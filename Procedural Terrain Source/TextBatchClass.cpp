@@ -0,0 +1,344 @@
+#include "TextBatchClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+TextBatchClass::TextBatchClass()
+: pFont( 0 ), pFontShader( 0 ), pVertexBuffer( 0 ),
+  mScreenWidth( 0 ), mScreenHeight( 0 ), mVertexCount( 0 ), mRebuildCount( 0 ), mBatchDirty( false ) {
+	memset( mSentences, 0, sizeof( mSentences ) );
+}
+
+
+// Constructor //
+TextBatchClass::TextBatchClass( const TextBatchClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+TextBatchClass::~TextBatchClass() {
+}
+
+
+// Initialize                                    //
+// Font, shader and one shared dynamic buffer    //
+// big enough for every sentence at full length  //
+bool TextBatchClass::Initialize( ID3D11Device* device, HWND hwnd, int screenWidth, int screenHeight, D3DXMATRIX baseViewMatrix ) {
+	D3D11_BUFFER_DESC vertexBufferDesc;
+	HRESULT hResult;
+	bool result;
+
+	// Store the screen width and height
+	mScreenWidth  = screenWidth;
+	mScreenHeight = screenHeight;
+
+	// Store the base view matrix
+	mBaseViewMatrix = baseViewMatrix;
+
+	// Create the font object
+	pFont = new FontClass;
+	if( !pFont ) {
+		return false;
+	}
+
+	// Initialize the font object
+	result = pFont->Initialize( device, "fontdata.txt", L"font.dds" );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the font object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// Create the font shader object
+	pFontShader = new TextBatchShaderClass;
+	if( !pFontShader ) {
+		return false;
+	}
+
+	// Initialize the font shader object
+	result = pFontShader->Initialize( device, hwnd );
+	if( !result ) {
+		MessageBox( hwnd, L"Could not initialize the text batch shader object.", L"Error", MB_OK );
+		return false;
+	}
+
+	// Set up the description of the shared dynamic vertex buffer
+	vertexBufferDesc.Usage               = D3D11_USAGE_DYNAMIC;
+	vertexBufferDesc.ByteWidth           = sizeof( VertexType ) * TEXT_BATCH_MAX_SENTENCES * TEXT_BATCH_MAX_LENGTH * 6;
+	vertexBufferDesc.BindFlags           = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+	vertexBufferDesc.MiscFlags           = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	// Create the vertex buffer
+	hResult = device->CreateBuffer( &vertexBufferDesc, NULL, &pVertexBuffer );
+	if( FAILED( hResult ) ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// Shutdown //
+void TextBatchClass::Shutdown() {
+	// Release the vertex buffer
+	if( pVertexBuffer ) {
+		pVertexBuffer->Release();
+		pVertexBuffer = 0;
+	}
+
+	// Release the font shader object
+	if( pFontShader ) {
+		pFontShader->Shutdown();
+		delete pFontShader;
+		pFontShader = 0;
+	}
+
+	// Release the font object
+	if( pFont ) {
+		pFont->Shutdown();
+		delete pFont;
+		pFont = 0;
+	}
+
+	return;
+}
+
+
+// SetSentence                                   //
+// Only marks the sentence dirty if it changed   //
+void TextBatchClass::SetSentence( int index, char* text, int positionX, int positionY, float red, float green, float blue ) {
+	if( ( index < 0 ) || ( index >= TEXT_BATCH_MAX_SENTENCES ) ) {
+		return;
+	}
+
+	SentenceType& sentence = mSentences[ index ];
+
+	// Same as last frame - keep the cached geometry
+	if( sentence.used &&
+		( sentence.positionX == positionX ) && ( sentence.positionY == positionY ) &&
+		( sentence.red == red ) && ( sentence.green == green ) && ( sentence.blue == blue ) &&
+		( strncmp( sentence.text, text, TEXT_BATCH_MAX_LENGTH - 1 ) == 0 ) ) {
+		return;
+	}
+
+	strncpy_s( sentence.text, TEXT_BATCH_MAX_LENGTH, text, _TRUNCATE );
+	sentence.positionX = positionX;
+	sentence.positionY = positionY;
+	sentence.red       = red;
+	sentence.green     = green;
+	sentence.blue      = blue;
+	sentence.used      = true;
+	sentence.dirty     = true;
+
+	mBatchDirty = true;
+
+	return;
+}
+
+
+// SetFps                                   //
+// Green 60+, yellow below 60, red below 30 //
+void TextBatchClass::SetFps( int index, int fps, int positionX, int positionY ) {
+	char text[ TEXT_BATCH_MAX_LENGTH ];
+	float red, green, blue;
+
+	// Truncate the fps to below 10,000
+	if( fps > 9999 ) {
+		fps = 9999;
+	}
+
+	sprintf_s( text, TEXT_BATCH_MAX_LENGTH, "Framerate = %d", fps );
+
+	if( fps >= 60 ) {
+		red = 0.0f; green = 1.0f; blue = 0.0f;
+	} else if( fps >= 30 ) {
+		red = 1.0f; green = 1.0f; blue = 0.0f;
+	} else {
+		red = 1.0f; green = 0.0f; blue = 0.0f;
+	}
+
+	SetSentence( index, text, positionX, positionY, red, green, blue );
+
+	return;
+}
+
+
+// SetCpu                                    //
+// Green below 50%, yellow below 80%, else red //
+void TextBatchClass::SetCpu( int index, int cpu, int positionX, int positionY ) {
+	char text[ TEXT_BATCH_MAX_LENGTH ];
+	float red, green, blue;
+
+	sprintf_s( text, TEXT_BATCH_MAX_LENGTH, "CPU Usage = %d%%", cpu );
+
+	if( cpu < 50 ) {
+		red = 0.0f; green = 1.0f; blue = 0.0f;
+	} else if( cpu < 80 ) {
+		red = 1.0f; green = 1.0f; blue = 0.0f;
+	} else {
+		red = 1.0f; green = 0.0f; blue = 0.0f;
+	}
+
+	SetSentence( index, text, positionX, positionY, red, green, blue );
+
+	return;
+}
+
+
+// SetValue                      //
+// White "label value" sentence  //
+void TextBatchClass::SetValue( int index, char* label, int value, int positionX, int positionY ) {
+	char text[ TEXT_BATCH_MAX_LENGTH ];
+
+	sprintf_s( text, TEXT_BATCH_MAX_LENGTH, "%s%d", label, value );
+
+	SetSentence( index, text, positionX, positionY, 1.0f, 1.0f, 1.0f );
+
+	return;
+}
+
+
+// ClearSentence                     //
+// Removes a sentence from the batch //
+void TextBatchClass::ClearSentence( int index ) {
+	if( ( index < 0 ) || ( index >= TEXT_BATCH_MAX_SENTENCES ) ) {
+		return;
+	}
+
+	if( mSentences[ index ].used ) {
+		mSentences[ index ].used        = false;
+		mSentences[ index ].vertexCount = 0;
+		mBatchDirty = true;
+	}
+
+	return;
+}
+
+
+// Render                                         //
+// Deferred rebuild then a single draw call       //
+bool TextBatchClass::Render( ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX orthoMatrix ) {
+	unsigned int stride;
+	unsigned int offset;
+	bool result;
+
+	// Rebuild and upload only when something changed since the last draw
+	if( mBatchDirty ) {
+		result = UpdateBuffer( deviceContext );
+		if( !result ) {
+			return false;
+		}
+	}
+
+	if( mVertexCount == 0 ) {
+		return true;
+	}
+
+	// Set vertex buffer stride and offset
+	stride = sizeof( VertexType ); 
+	offset = 0;
+
+	// Set the vertex buffer to active in the input assembler so it can be rendered
+	deviceContext->IASetVertexBuffers( 0, 1, &pVertexBuffer, &stride, &offset );
+
+	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles
+	deviceContext->IASetPrimitiveTopology( D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST );
+
+	// Render every sentence at once
+	result = pFontShader->Render( deviceContext, mVertexCount, worldMatrix, mBaseViewMatrix, orthoMatrix, pFont->GetTexture() );
+	if( !result ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// GetRebuildCount //
+int TextBatchClass::GetRebuildCount() {
+	return mRebuildCount;
+}
+
+
+// ResetRebuildCount //
+void TextBatchClass::ResetRebuildCount() {
+	mRebuildCount = 0;
+}
+
+
+// BuildSentence                                       //
+// FontClass lays out the quads, colour is added here  //
+void TextBatchClass::BuildSentence( SentenceType& sentence ) {
+	FontVertexType fontVertices[ TEXT_BATCH_MAX_LENGTH * 6 ];
+	float drawX, drawY;
+	int length;
+
+	// Calculate the X and Y pixel position on the screen to start drawing to
+	drawX = ( float )( ( ( mScreenWidth / 2 ) * -1 ) + sentence.positionX );
+	drawY = ( float )( ( mScreenHeight / 2 ) - sentence.positionY );
+
+	// Use the font class to build the vertex array from the sentence text and sentence draw location
+	pFont->BuildVertexArray( ( void* )fontVertices, sentence.text, drawX, drawY );
+
+	// Spaces only advance the cursor - six vertices for every other letter
+	sentence.vertexCount = 0;
+	length = ( int )strlen( sentence.text );
+	for( int i = 0; i < length; i++ ) {
+		if( sentence.text[ i ] != ' ' ) {
+			sentence.vertexCount += 6;
+		}
+	}
+
+	for( int i = 0; i < sentence.vertexCount; i++ ) {
+		sentence.vertices[ i ].position = fontVertices[ i ].position;
+		sentence.vertices[ i ].texture  = fontVertices[ i ].texture;
+		sentence.vertices[ i ].color    = D3DXVECTOR4( sentence.red, sentence.green, sentence.blue, 1.0f );
+	}
+
+	sentence.dirty = false;
+	mRebuildCount++;
+
+	return;
+}
+
+
+// UpdateBuffer                                       //
+// Rebuilds dirty sentences then writes the whole     //
+// batch with one WRITE_DISCARD map                   //
+bool TextBatchClass::UpdateBuffer( ID3D11DeviceContext* deviceContext ) {
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	VertexType* verticesPtr;
+	HRESULT result;
+
+	// Lock the vertex buffer so it can be written to
+	result = deviceContext->Map( pVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	verticesPtr  = ( VertexType* )mappedResource.pData;
+	mVertexCount = 0;
+
+	for( int i = 0; i < TEXT_BATCH_MAX_SENTENCES; i++ ) {
+		if( !mSentences[ i ].used ) {
+			continue;
+		}
+
+		if( mSentences[ i ].dirty ) {
+			BuildSentence( mSentences[ i ] );
+		}
+
+		// Copy the cached geometry into the batch
+		memcpy( verticesPtr + mVertexCount, mSentences[ i ].vertices, sizeof( VertexType ) * mSentences[ i ].vertexCount );
+		mVertexCount += mSentences[ i ].vertexCount;
+	}
+
+	// Unlock the vertex buffer
+	deviceContext->Unmap( pVertexBuffer, 0 );
+
+	mBatchDirty = false;
+
+	return true;
+}
@@ -0,0 +1,98 @@
+#ifndef _TEXTBATCHCLASS_H_
+#define _TEXTBATCHCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <stdio.h>
+#include <string.h>
+
+
+// Application Includes //
+#include "FontClass.h"
+#include "TextBatchShaderClass.h"
+
+
+// Text Batch Variables
+const int TEXT_BATCH_MAX_SENTENCES = 16;
+const int TEXT_BATCH_MAX_LENGTH    = 64;
+
+
+// TextBatchClass                                                       //
+// Replacement for TextClass's one vertex buffer + one draw per sentence //
+// Setting a sentence only records it - if the text, position and       //
+// colour are unchanged nothing happens                                 //
+// Geometry is rebuilt lazily in Render, only for dirty sentences, and  //
+// every sentence is copied into one shared dynamic vertex buffer and   //
+// drawn in a single call with colour stored per vertex                 //
+// Nothing is rebuilt or uploaded while the UI is hidden                //
+class TextBatchClass {
+private:
+	// Layout written by FontClass::BuildVertexArray
+	struct FontVertexType {
+		D3DXVECTOR3 position;
+		D3DXVECTOR2 texture;
+	};
+
+	// Batched vertex - colour added per vertex
+	struct VertexType {
+		D3DXVECTOR3 position;
+		D3DXVECTOR2 texture;
+		D3DXVECTOR4 color;
+	};
+
+	// Cached sentence
+	struct SentenceType {
+		char text[ TEXT_BATCH_MAX_LENGTH ];
+		int positionX, positionY;
+		float red, green, blue;
+		bool used;
+		bool dirty;
+		int vertexCount;
+		VertexType vertices[ TEXT_BATCH_MAX_LENGTH * 6 ];
+	};
+
+public:
+	TextBatchClass();
+	TextBatchClass( const TextBatchClass& other );
+	~TextBatchClass();
+
+	bool Initialize( ID3D11Device* device, HWND hwnd, int screenWidth, int screenHeight, D3DXMATRIX baseViewMatrix );
+	void Shutdown();
+
+	// Sentence setters - cheap if nothing changed
+	void SetSentence( int index, char* text, int positionX, int positionY, float red, float green, float blue );
+	void SetFps( int index, int fps, int positionX, int positionY );
+	void SetCpu( int index, int cpu, int positionX, int positionY );
+	void SetValue( int index, char* label, int value, int positionX, int positionY );
+	void ClearSentence( int index );
+
+	// Rebuilds dirty sentences then draws the whole batch
+	bool Render( ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX orthoMatrix );
+
+	// Number of sentence rebuilds since the last reset (for profiling)
+	int GetRebuildCount();
+	void ResetRebuildCount();
+
+private:
+	void BuildSentence( SentenceType& sentence );
+	bool UpdateBuffer( ID3D11DeviceContext* deviceContext );
+
+private:
+	FontClass*            pFont;
+	TextBatchShaderClass* pFontShader;
+	ID3D11Buffer*         pVertexBuffer;
+
+	SentenceType mSentences[ TEXT_BATCH_MAX_SENTENCES ];
+
+	int mScreenWidth, mScreenHeight;
+	D3DXMATRIX mBaseViewMatrix;
+
+	int mVertexCount;
+	int mRebuildCount;
+	bool mBatchDirty;
+};
+
+
+#endif
@@ -0,0 +1,332 @@
+#include "TextBatchShaderClass.h"
+
+
+// Default Constructor  //
+// NULL object pointers //
+TextBatchShaderClass::TextBatchShaderClass()
+: pVertexShader( 0 ), pPixelShader( 0 ), pLayout( 0 ), pMatrixBuffer( 0 ), pSampleState( 0 ) {
+}
+
+
+// Constructor //
+TextBatchShaderClass::TextBatchShaderClass( const TextBatchShaderClass& other ) {
+}
+
+
+// Destructor                   //
+// Nothing to tidyup - Shutdown //
+TextBatchShaderClass::~TextBatchShaderClass() {
+}
+
+
+// Initialize //
+bool TextBatchShaderClass::Initialize( ID3D11Device* device, HWND hwnd ) {
+	bool result;
+
+	// Initialize the vertex and pixel shaders
+	result = InitializeShader( device, hwnd, L"TextBatch.vs", L"TextBatch.ps" );
+	if( !result ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// Shutdown //
+void TextBatchShaderClass::Shutdown() {
+	// Shutdown the vertex and pixel shaders as well as the related objects
+	ShutdownShader();
+
+	return;
+}
+
+
+// Render //
+bool TextBatchShaderClass::Render( ID3D11DeviceContext* deviceContext,
+	                               int vertexCount,
+								   D3DXMATRIX worldMatrix,
+								   D3DXMATRIX viewMatrix,
+								   D3DXMATRIX projectionMatrix,
+								   ID3D11ShaderResourceView* texture ) {
+	bool result;
+
+	// Set the shader parameters that it will use for rendering
+	result = SetShaderParameters( deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture );
+	if( !result ) {
+		return false;
+	}
+
+	// Now render the prepared buffers with the shader
+	RenderShader( deviceContext, vertexCount );
+
+	return true;
+}
+
+
+// InitializeShader //
+bool TextBatchShaderClass::InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename ) {
+	HRESULT result;
+	ID3D10Blob* errorMessage;
+	ID3D10Blob* vertexShaderBuffer;
+	ID3D10Blob* pixelShaderBuffer;
+	D3D11_INPUT_ELEMENT_DESC polygonLayout[ 3 ];
+	unsigned int numElements;
+	D3D11_BUFFER_DESC matrixBufferDesc;
+	D3D11_SAMPLER_DESC samplerDesc;
+
+	// Initialize the pointers this function will use to null
+	errorMessage       = 0;
+	vertexShaderBuffer = 0;
+	pixelShaderBuffer  = 0;
+
+	// Load the vertex shader code (compiled on a cache miss)
+	if( !ShaderCacheClass::LoadShader( vsFilename, "TextBatchVertexShader", "vs_5_0", NULL, &vertexShaderBuffer, &errorMessage ) ) {
+		// If the shader failed to compile it should have writen something to the error message
+		if( errorMessage ) {
+			OutputShaderErrorMessage( errorMessage, hwnd, vsFilename );
+		// If there was nothing in the error message then it simply could not find the shader file itself
+		} else {
+			MessageBox( hwnd, vsFilename, L"Missing Shader File", MB_OK );
+		}
+
+		return false;
+	}
+
+	// Load the pixel shader code (compiled on a cache miss)
+	if( !ShaderCacheClass::LoadShader( psFilename, "TextBatchPixelShader", "ps_5_0", NULL, &pixelShaderBuffer, &errorMessage ) ) {
+		// If the shader failed to compile it should have writen something to the error message
+		if( errorMessage ) {
+			OutputShaderErrorMessage( errorMessage, hwnd, psFilename );
+		// If there was nothing in the error message then it simply could not find the file itself
+		} else {
+			MessageBox( hwnd, psFilename, L"Missing Shader File", MB_OK );
+		}
+
+		return false;
+	}
+
+	// Create the vertex shader from the buffer
+	result = device->CreateVertexShader( vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &pVertexShader );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Create the pixel shader from the buffer
+	result = device->CreatePixelShader( pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pPixelShader );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Create the vertex input layout description
+	// This setup needs to match the VertexType stucture in TextBatchClass and in the shader
+	polygonLayout[ 0 ].SemanticName         = "POSITION";
+	polygonLayout[ 0 ].SemanticIndex        = 0;
+	polygonLayout[ 0 ].Format               = DXGI_FORMAT_R32G32B32_FLOAT;
+	polygonLayout[ 0 ].InputSlot            = 0;
+	polygonLayout[ 0 ].AlignedByteOffset    = 0;
+	polygonLayout[ 0 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 0 ].InstanceDataStepRate = 0;
+
+	polygonLayout[ 1 ].SemanticName         = "TEXCOORD";
+	polygonLayout[ 1 ].SemanticIndex        = 0;
+	polygonLayout[ 1 ].Format               = DXGI_FORMAT_R32G32_FLOAT;
+	polygonLayout[ 1 ].InputSlot            = 0;
+	polygonLayout[ 1 ].AlignedByteOffset    = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[ 1 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 1 ].InstanceDataStepRate = 0;
+
+	polygonLayout[ 2 ].SemanticName         = "COLOR";
+	polygonLayout[ 2 ].SemanticIndex        = 0;
+	polygonLayout[ 2 ].Format               = DXGI_FORMAT_R32G32B32A32_FLOAT;
+	polygonLayout[ 2 ].InputSlot            = 0;
+	polygonLayout[ 2 ].AlignedByteOffset    = D3D11_APPEND_ALIGNED_ELEMENT;
+	polygonLayout[ 2 ].InputSlotClass       = D3D11_INPUT_PER_VERTEX_DATA;
+	polygonLayout[ 2 ].InstanceDataStepRate = 0;
+
+	// Get a count of the elements in the layout
+    numElements = sizeof( polygonLayout ) / sizeof( polygonLayout[ 0 ] );
+
+	// Create the vertex input layout
+	result = device->CreateInputLayout( polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &pLayout );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Release the vertex shader buffer and pixel shader buffer since they are no longer needed
+	vertexShaderBuffer->Release();
+	vertexShaderBuffer = 0;
+
+	pixelShaderBuffer->Release();
+	pixelShaderBuffer = 0;
+
+	// Setup the description of the dynamic matrix constant buffer that is in the vertex shader
+    matrixBufferDesc.Usage               = D3D11_USAGE_DYNAMIC;
+	matrixBufferDesc.ByteWidth           = sizeof( MatrixBufferType );
+    matrixBufferDesc.BindFlags           = D3D11_BIND_CONSTANT_BUFFER;
+    matrixBufferDesc.CPUAccessFlags      = D3D11_CPU_ACCESS_WRITE;
+    matrixBufferDesc.MiscFlags           = 0;
+	matrixBufferDesc.StructureByteStride = 0;
+
+	// Create the constant buffer pointer so we can access the vertex shader constant buffer from within this class
+	result = device->CreateBuffer( &matrixBufferDesc, NULL, &pMatrixBuffer );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Create a texture sampler state description
+    samplerDesc.Filter         = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressV       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.AddressW       = D3D11_TEXTURE_ADDRESS_WRAP;
+    samplerDesc.MipLODBias     = 0.0f;
+    samplerDesc.MaxAnisotropy  = 1;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+    samplerDesc.BorderColor[0] = 0;
+	samplerDesc.BorderColor[1] = 0;
+	samplerDesc.BorderColor[2] = 0;
+	samplerDesc.BorderColor[3] = 0;
+    samplerDesc.MinLOD         = 0;
+    samplerDesc.MaxLOD         = D3D11_FLOAT32_MAX;
+
+	// Create the texture sampler state
+    result = device->CreateSamplerState( &samplerDesc, &pSampleState );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	return true;
+}
+
+
+// ShutdownShader //
+void TextBatchShaderClass::ShutdownShader() {
+	// Release the sampler state
+	if( pSampleState ) {
+		pSampleState->Release();
+		pSampleState = 0;
+	}
+
+	// Release the matrix constant buffer
+	if( pMatrixBuffer ) {
+		pMatrixBuffer->Release();
+		pMatrixBuffer = 0;
+	}
+
+	// Release the layout
+	if( pLayout ) {
+		pLayout->Release();
+		pLayout = 0;
+	}
+
+	// Release the pixel shader
+	if( pPixelShader ) {
+		pPixelShader->Release();
+		pPixelShader = 0;
+	}
+
+	// Release the vertex shader
+	if( pVertexShader ) {
+		pVertexShader->Release();
+		pVertexShader = 0;
+	}
+
+	return;
+}
+
+
+// OutputShaderErrorMessage                   //
+// Writes compiler output to shader-error.txt //
+void TextBatchShaderClass::OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename ) {
+	char* compileErrors;
+	unsigned long bufferSize, i;
+	ofstream fout;
+
+	// Get a pointer to the error message text buffer
+	compileErrors = ( char* )( errorMessage->GetBufferPointer() );
+
+	// Get the length of the message
+	bufferSize = errorMessage->GetBufferSize();
+
+	// Open a file to write the error message to
+	fout.open( "shader-error.txt" );
+
+	// Write out the error message
+	for( i = 0; i < bufferSize; i++ ) {
+		fout << compileErrors[ i ];
+	}
+
+	// Close the file
+	fout.close();
+
+	// Release the error message
+	errorMessage->Release();
+	errorMessage = 0;
+
+	// Pop a message up on the screen to notify the user to check the text file for compile errors
+	MessageBox( hwnd, L"Error compiling shader.  Check shader-error.txt for message.", shaderFilename, MB_OK );
+
+	return;
+}
+
+
+// SetShaderParameters //
+bool TextBatchShaderClass::SetShaderParameters( ID3D11DeviceContext* deviceContext,
+	                                            D3DXMATRIX worldMatrix,
+												D3DXMATRIX viewMatrix,
+												D3DXMATRIX projectionMatrix,
+												ID3D11ShaderResourceView* texture ) {
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	MatrixBufferType* dataPtr;
+
+	// Transpose the matrices to prepare them for the shader
+	D3DXMatrixTranspose( &worldMatrix, &worldMatrix );
+	D3DXMatrixTranspose( &viewMatrix, &viewMatrix );
+	D3DXMatrixTranspose( &projectionMatrix, &projectionMatrix );
+
+	// Lock the constant buffer so it can be written to
+	result = deviceContext->Map( pMatrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource );
+	if( FAILED( result ) ) {
+		return false;
+	}
+
+	// Get a pointer to the data in the constant buffer
+	dataPtr = ( MatrixBufferType* )mappedResource.pData;
+
+	// Copy the matrices into the constant buffer
+	dataPtr->world      = worldMatrix;
+	dataPtr->view       = viewMatrix;
+	dataPtr->projection = projectionMatrix;
+
+	// Unlock the constant buffer
+    deviceContext->Unmap( pMatrixBuffer, 0 );
+
+	// Now set the constant buffer in the vertex shader with the updated values
+    deviceContext->VSSetConstantBuffers( 0, 1, &pMatrixBuffer );
+
+	// Set shader texture resource in the pixel shader
+	deviceContext->PSSetShaderResources( 0, 1, &texture );
+
+	return true;
+}
+
+
+// RenderShader                         //
+// One non-indexed draw for every glyph //
+void TextBatchShaderClass::RenderShader( ID3D11DeviceContext* deviceContext, int vertexCount ) {
+	// Set the vertex input layout
+	deviceContext->IASetInputLayout( pLayout );
+
+	// Set the vertex and pixel shaders that will be used to render
+	deviceContext->VSSetShader( pVertexShader, NULL, 0 );
+	deviceContext->PSSetShader( pPixelShader, NULL, 0 );
+
+	// Set the sampler state in the pixel shader
+	deviceContext->PSSetSamplers( 0, 1, &pSampleState );
+
+	// Render the batch
+	deviceContext->Draw( vertexCount, 0 );
+
+	return;
+}
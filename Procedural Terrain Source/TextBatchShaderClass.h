@@ -0,0 +1,64 @@
+#ifndef _TEXTBATCHSHADERCLASS_H_
+#define _TEXTBATCHSHADERCLASS_H_
+
+
+// Includes //
+#include <d3d11.h>
+#include <d3dx10math.h>
+#include <fstream>
+using namespace std;
+
+
+// Application Includes //
+#include "ShaderCacheClass.h"
+
+
+// TextBatchShaderClass                                       //
+// Font shader for TextBatchClass - colour comes from the     //
+// vertex rather than a per-sentence constant so the whole    //
+// UI text batch is one draw call                             //
+class TextBatchShaderClass {
+private:
+	// Matrix data
+	struct MatrixBufferType {
+		D3DXMATRIX world;
+		D3DXMATRIX view;
+		D3DXMATRIX projection;
+	};
+
+public:
+	TextBatchShaderClass();
+	TextBatchShaderClass( const TextBatchShaderClass& other );
+	~TextBatchShaderClass();
+
+	bool Initialize( ID3D11Device* device, HWND hwnd );
+	void Shutdown();
+	bool Render( ID3D11DeviceContext* deviceContext,
+		         int vertexCount,
+				 D3DXMATRIX worldMatrix,
+				 D3DXMATRIX viewMatrix,
+				 D3DXMATRIX projectionMatrix,
+				 ID3D11ShaderResourceView* texture );
+
+private:
+	bool InitializeShader( ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename );
+	void ShutdownShader();
+	void OutputShaderErrorMessage( ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename );
+
+	bool SetShaderParameters( ID3D11DeviceContext* deviceContext,
+		                      D3DXMATRIX worldMatrix,
+							  D3DXMATRIX viewMatrix,
+							  D3DXMATRIX projectionMatrix,
+							  ID3D11ShaderResourceView* texture );
+	void RenderShader( ID3D11DeviceContext* deviceContext, int vertexCount );
+
+private:
+	ID3D11VertexShader* pVertexShader;
+	ID3D11PixelShader*  pPixelShader;
+	ID3D11InputLayout*  pLayout;
+	ID3D11Buffer*       pMatrixBuffer;
+	ID3D11SamplerState* pSampleState;
+};
+
+
+#endif
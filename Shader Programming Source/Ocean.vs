@@ -1,20 +1,26 @@
-// Scene Matrices - VS buffer 0
-cbuffer MatrixBuffer : register(b0) {
-    matrix worldMatrix;
-    matrix viewMatrix;
-    matrix projectionMatrix;
+// Per-Frame Data - buffer 0
+cbuffer PerFrameBuffer : register(b0) {
+	float4 ambientColor;
+	float4 diffuseColor;
+	float3 lightPosition;
+	float time;
+	float waveHeight;
+	float waterTranslation;
+	float reflectRefractScale;
+	float framePadding;
 };
 
-// Reflection Matrix - VS buffer 1
-cbuffer ReflectionBuffer : register(b1) {
-    matrix reflectionMatrix;
+// Per-Pass Data - buffer 1
+cbuffer PerPassBuffer : register(b1) {
+	matrix viewMatrix;
+	matrix projectionMatrix;
+	matrix reflectionMatrix;
+	float4 clipPlane;
 };
 
-// Wave Data - VS buffer 3
-cbuffer WaveBuffer : register(b3) {
-	float time;
-	float waveHeight;
-	float2 padding;
+// Per-Object Data - buffer 2
+cbuffer PerObjectBuffer : register(b2) {
+	matrix worldMatrix;
 };
 
 // Vertex Data
@@ -1,17 +1,29 @@
-// Scene Matrices - VS buffer 0
-cbuffer MatrixBuffer : register(b0) {
-    matrix worldMatrix;
-    matrix viewMatrix;
-    matrix projectionMatrix;
+// Per-Pass Data - buffer 1
+cbuffer PerPassBuffer : register(b1) {
+	matrix viewMatrix;
+	matrix projectionMatrix;
+	matrix reflectionMatrix;
+	float4 clipPlane;
 };
 
-// Vertex Data
+// Per-Object Data - buffer 2
+cbuffer PerObjectBuffer : register(b2) {
+	matrix worldMatrix;
+};
+
+// Per-Terrain Data - buffer 3
+// x = grid width, y = minimum height, z = height range, w = texture coordinate step
+cbuffer PerTerrainBuffer : register(b3) {
+	float4 vertexDecode;
+};
+
+// Compact Vertex Data - 12 bytes
+// x / z and the texture coordinates come from the vertex's index in the grid
 struct VertexInputType {
-    float4 position : POSITION;
-    float2 tex : TEXCOORD0;
-    float3 normal : NORMAL;
-	float3 tangent : TANGENT;
-    float3 binormal : BINORMAL;
+	float2 normal : NORMAL;        // octahedral
+	float4 tangentFrame : TANGENT; // quaternion
+	float height : POSITION;       // 0 - 1 over the height range
+	uint vertexID : SV_VertexID;
 };
 
 // Pixel Data
@@ -22,37 +34,70 @@ struct PixelInputType {
 	float3 tangent : TANGENT;
     float3 binormal : BINORMAL;
 	float3 position3D : TEXCOORD1;
+	float2 horizonTex : TEXCOORD2; // centre of the grid point's horizon texel
 };
 
+// DecodeNormal                                  //
+// Unfolds an octahedral normal (y is the pole) //
+float3 DecodeNormal( float2 encoded ) {
+	float3 normal = float3( encoded.x, 1.0f - abs( encoded.x ) - abs( encoded.y ), encoded.y );
+
+	// Lower hemisphere was folded over the diagonals
+	if( normal.y < 0.0f ) {
+		normal.xz = ( 1.0f - abs( normal.zx ) ) * ( normal.xz >= 0.0f ? 1.0f : -1.0f );
+	}
+
+	return normalize( normal );
+}
+
+// RotateVector                 //
+// Rotates v by the quaternion q //
+float3 RotateVector( float4 q, float3 v ) {
+	return v + 2.0f * cross( q.xyz, cross( q.xyz, v ) + q.w * v );
+}
+
 // TerrainVS
 PixelInputType TerrainVertexShader( VertexInputType input ) {
     PixelInputType output;
-   
-    // Change the position vector to be 4 units for proper matrix calculations
-    input.position.w = 1.0f;
+	float4 position;
+	float4 tangentFrame;
+	float gridWidth;
+
+	// Rebuild the grid position from the vertex index
+	gridWidth = vertexDecode.x;
+	position.x = ( float )( input.vertexID % ( uint )gridWidth );
+	position.z = ( float )( input.vertexID / ( uint )gridWidth );
+	position.y = vertexDecode.y + input.height * vertexDecode.z;
+	position.w = 1.0f;
 
     // Calculate the position of the vertex against the world, view, and projection matrices
-    output.position = mul( input.position, worldMatrix );
+    output.position = mul( position, worldMatrix );
     output.position = mul( output.position, viewMatrix );
     output.position = mul( output.position, projectionMatrix );
 
-    // Store the texture coordinates for the pixel shader
-    output.tex = input.tex;
+    // Texture coordinates keep increasing across the terrain - the sampler wraps them
+    output.tex = float2( position.x * vertexDecode.w, 1.0f - position.z * vertexDecode.w );
 
     // Calculate the normal vector against the world matrix only
-	output.normal = mul( input.normal, ( float3x3 )worldMatrix );
+	output.normal = mul( DecodeNormal( input.normal ), ( float3x3 )worldMatrix );
 	output.normal = normalize( output.normal );
 
+	// Tangent and binormal are the quaternion applied to +x and -z
+	tangentFrame = normalize( input.tangentFrame );
+
 	// Calculate the tangent vector against the world matrix only
-	output.tangent = mul( input.tangent, ( float3x3 )worldMatrix );
+	output.tangent = mul( RotateVector( tangentFrame, float3( 1.0f, 0.0f, 0.0f ) ), ( float3x3 )worldMatrix );
 	output.tangent = normalize( output.tangent );
 
 	// Calculate the binormal vector against the world matrix only 
-	output.binormal = mul( input.binormal, ( float3x3 )worldMatrix );
+	output.binormal = mul( RotateVector( tangentFrame, float3( 0.0f, 0.0f, -1.0f ) ), ( float3x3 )worldMatrix );
 	output.binormal = normalize( output.binormal );
 
 	// 3D position of the vertex
-	output.position3D = mul( input.position, worldMatrix );
+	output.position3D = mul( position, worldMatrix );
+
+	// One horizon texel per grid point (the grid is square)
+	output.horizonTex = ( position.xz + 0.5f ) / gridWidth;
 
     return output;
 }
\ No newline at end of file
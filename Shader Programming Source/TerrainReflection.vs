@@ -0,0 +1,85 @@
+// Per-Pass Data - buffer 1
+cbuffer PerPassBuffer : register(b1) {
+	matrix viewMatrix;
+	matrix projectionMatrix;
+	matrix reflectionMatrix;
+	float4 clipPlane;
+};
+
+// Per-Object Data - buffer 2
+cbuffer PerObjectBuffer : register(b2) {
+	matrix worldMatrix;
+};
+
+// Per-Terrain Data - buffer 3
+// x = grid width, y = minimum height, z = height range, w = texture coordinate step
+cbuffer PerTerrainBuffer : register(b3) {
+	float4 vertexDecode;
+};
+
+// Compact Vertex Data - 12 bytes
+// x / z and the texture coordinates come from the vertex's index in the grid
+struct VertexInputType {
+	float2 normal : NORMAL;        // octahedral
+	float4 tangentFrame : TANGENT; // quaternion
+	float height : POSITION;       // 0 - 1 over the height range
+	uint vertexID : SV_VertexID;
+};
+
+// Pixel Data
+struct PixelInputType {
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float3 normal : NORMAL;
+	float3 position3D : TEXCOORD1;
+	float clip : SV_ClipDistance0;
+};
+
+// DecodeNormal                                  //
+// Unfolds an octahedral normal (y is the pole) //
+float3 DecodeNormal( float2 encoded ) {
+	float3 normal = float3( encoded.x, 1.0f - abs( encoded.x ) - abs( encoded.y ), encoded.y );
+
+	// Lower hemisphere was folded over the diagonals
+	if( normal.y < 0.0f ) {
+		normal.xz = ( 1.0f - abs( normal.zx ) ) * ( normal.xz >= 0.0f ? 1.0f : -1.0f );
+	}
+
+	return normalize( normal );
+}
+
+// TerrainReflectionVS                                  //
+// Same decode as Terrain.vs - only the normal is kept //
+PixelInputType TerrainReflectionVertexShader( VertexInputType input ) {
+    PixelInputType output;
+	float4 position;
+	float4 worldPosition;
+	float gridWidth;
+
+	// Rebuild the grid position from the vertex index
+	gridWidth = vertexDecode.x;
+	position.x = ( float )( input.vertexID % ( uint )gridWidth );
+	position.z = ( float )( input.vertexID / ( uint )gridWidth );
+	position.y = vertexDecode.y + input.height * vertexDecode.z;
+	position.w = 1.0f;
+
+    // Calculate the position of the vertex against the world, view, and projection matrices
+	worldPosition = mul( position, worldMatrix );
+    output.position = mul( worldPosition, viewMatrix );
+    output.position = mul( output.position, projectionMatrix );
+
+    // Texture coordinates keep increasing across the terrain - the sampler wraps them
+    output.tex = float2( position.x * vertexDecode.w, 1.0f - position.z * vertexDecode.w );
+
+    // Calculate the normal vector against the world matrix only
+	output.normal = mul( DecodeNormal( input.normal ), ( float3x3 )worldMatrix );
+	output.normal = normalize( output.normal );
+
+	// 3D position of the vertex
+	output.position3D = worldPosition.xyz;
+
+	// Cut off everything on the far side of the water
+	output.clip = dot( worldPosition, clipPlane );
+
+    return output;
+}
\ No newline at end of file